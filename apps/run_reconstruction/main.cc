@@ -1,3 +1,4 @@
+#include "ChainedEventDataReader.hh"
 #include "EventDataReader.hh"
 #include "GeometryManager.hh"
 #include "MagneticField.hh"
@@ -6,11 +7,17 @@
 #include "NEBULAPlusReco.hh"
 #include "NebulaJointReco.hh"
 #include "NeutronDetectorConfig.hh"
+#include "PDCFitResultCache.hh"
 #include "PDCFrameRotation.hh"
 #include "PDCSimAna.hh"
 #include "PDCMomentumReconstructor.hh"
+#include "PDCRecoFactory.hh"
 #include "PDCRecoRuntime.hh"
 #include "RecoEvent.hh"
+#include "RecoNTupleIO.hh"
+#include "RecoOutputSchema.hh"
+#include "RecoProfiler.hh"
+#include "RandomStreams.hh"
 #include "SMLogger.hh"
 #include "TBeamSimData.hh"
 #include "TNEBULAPlusSimParameter.hh"
@@ -18,23 +25,38 @@
 
 #include "TFile.h"
 #include "TNamed.h"
+#include "TROOT.h"
 #include "TTree.h"
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <exception>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <limits>
+#include <map>
+#include <sstream>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace fs = std::filesystem;
 namespace reco = analysis::pdc::anaroot_like;
 namespace neutron = analysis::neutron;
+namespace profiling = analysis::profiling;
+namespace reco_output = analysis::reco_output;
 
 namespace {
 
@@ -56,6 +78,51 @@ constexpr bool kUseLegacyDefaults = true;
 constexpr bool kUseLegacyDefaults = false;
 #endif
 
+// [EN] Batch sharding: "--shard i/N". Single-file runs take a contiguous entry range, directory runs
+// take the files whose relative-path hash lands on shard i (--shard-by files) or a contiguous range of the
+// chained global event numbering (--shard-by events), so every shard is reproducible on its own.
+// [CN] 批处理分片 "--shard i/N"：单文件按连续事件区间划分，目录模式按相对路径哈希分配文件（--shard-by files）
+// 或按链式全局事件编号取连续区间（--shard-by events），各分片可独立复现。
+struct ShardSpec {
+    int index = 0;
+    int count = 1;
+
+    bool Enabled() const { return count > 1; }
+
+    Long64_t FirstEntry(Long64_t total_entries) const {
+        return total_entries * index / count;
+    }
+
+    Long64_t LastEntry(Long64_t total_entries) const {
+        return total_entries * (index + 1) / count;
+    }
+};
+
+// [EN] Local entry range [first, last) of one input cut out of a chain partition; unset (last < 0) means the
+// whole file or, in single-file mode, the ShardSpec range. / [CN] 从链分区切出的单个输入的局部区间 [first, last)；
+// 未设置（last < 0）表示整个文件，单文件模式下则为 ShardSpec 区间。
+struct EntryRange {
+    Long64_t first = 0;
+    Long64_t last = -1;
+
+    bool IsSet() const { return last >= 0; }
+};
+
+// [EN] Output container, recoTree layout and file compression; see RecoOutputSchema.hh. / [CN] 输出容器、recoTree 布局与文件压缩，见 RecoOutputSchema.hh。
+struct OutputFormat {
+    reco_output::OutputBackend backend = reco_output::OutputBackend::kTTree;
+    reco_output::OutputSchema schema = reco_output::OutputSchema::kLegacy;
+    reco_output::CompressionProfile compression = reco_output::CompressionProfile::kDefault;
+    bool compact_covariance = false;
+};
+
+// [EN] Persistent fit-result cache (PDCFitResultCache): one file per input under dir; empty dir disables it.
+// [CN] 持久化拟合结果缓存：dir 下每个输入一个文件；dir 为空表示关闭。
+struct FitCacheSettings {
+    std::string dir;
+    std::uint64_t field_fingerprint = 0;
+};
+
 struct CliOptions {
     std::string input_file;
     std::string output_file;
@@ -64,14 +131,23 @@ struct CliOptions {
     std::string geometry_macro;
     std::string nn_model_json;
     std::string magnetic_field_map;
+    std::string manifest_file;
     reco::RuntimeBackend backend = reco::RuntimeBackend::kAuto;
     neutron::NeutronDetectorMode neutron_detector_mode = neutron::NeutronDetectorMode::kAuto;
     int max_files = 0;
+    int threads = 1;
+    int jobs = 1;
+    bool resume = false;
+    ShardSpec shard;
+    bool shard_by_events = false;
     int max_iterations = 40;
     double pdc_sigma_u_mm = 2.0;
     double pdc_sigma_v_mm = 2.0;
     double pdc_uv_correlation = 0.0;
     double pdc_angle_deg = 57.0;
+    bool pdc_multi_track = false;
+    double nebula_adjacency_gap_mm = -1.0;
+    int random_seed = 1;
     double target_sigma_xy_mm = 5.0;
     bool momentum_prior_enabled = false;
     double momentum_prior_center_mev_c = 0.0;
@@ -85,6 +161,12 @@ struct CliOptions {
     reco::RkFitMode rk_fit_mode = reco::RkFitMode::kThreePointFree;
     bool rk_write_errors = true;
     bool rk_write_laplace = true;
+    bool profile = false;
+    bool profile_tree = false;
+    int read_cache_mb = -1;
+    bool prefetch = false;
+    OutputFormat output_format;
+    std::string fit_cache_dir;
 };
 
 struct FileStats {
@@ -101,6 +183,7 @@ struct FileStats {
 struct RunStats {
     long long files_total = 0;
     long long files_succeeded = 0;
+    long long files_skipped = 0;
     long long total_events = 0;
     long long processed_events = 0;
     long long pdc_hit_events = 0;
@@ -143,6 +226,65 @@ bool ParseBoolOption(const std::string& text, const char* key) {
     throw std::runtime_error(std::string("invalid boolean value for ") + key + ": " + text);
 }
 
+ShardSpec ParseShard(const std::string& text) {
+    const std::size_t slash = text.find('/');
+    if (slash == std::string::npos) {
+        throw std::runtime_error("invalid --shard value (expected i/N): " + text);
+    }
+    ShardSpec shard;
+    shard.index = ParseInt(text.substr(0, slash), "--shard");
+    shard.count = ParseInt(text.substr(slash + 1), "--shard");
+    if (shard.count <= 0 || shard.index < 0 || shard.index >= shard.count) {
+        throw std::runtime_error("invalid --shard value (need 0 <= i < N): " + text);
+    }
+    return shard;
+}
+
+// [EN] FNV-1a over the path relative to the input directory; independent of the platform, file order and --max-files. / [CN] 对相对输入目录的路径做 FNV-1a，与平台、文件顺序无关。
+std::uint64_t StablePathHash(const fs::path& input_file, const fs::path& input_dir) {
+    std::error_code ec;
+    fs::path rel = fs::relative(input_file, input_dir, ec);
+    if (ec || rel.empty()) {
+        rel = input_file.filename();
+    }
+    std::uint64_t hash = 1469598103934665603ULL;
+    for (const unsigned char c : rel.generic_string()) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// [EN] Every option that changes what is written, so a manifest is only resumed with the settings that produced it.
+// Threads, jobs, I/O tuning, profiling and the fit cache are left out: they do not change the output.
+// [CN] 所有影响输出内容的选项；清单只能用生成它的设置续跑。线程数、并发文件数、I/O 调优、性能分析与拟合缓存不影响输出，不计入。
+std::string ManifestOptionsKey(const CliOptions& opts) {
+    std::ostringstream key;
+    key.precision(17);
+    key << reco::RuntimeBackendName(opts.backend) << '|' << opts.geometry_macro << '|' << opts.nn_model_json << '|'
+        << opts.magnetic_field_map << '|' << opts.magnet_rotation_deg << '|'
+        << neutron::NeutronDetectorModeName(opts.neutron_detector_mode) << '|' << opts.max_iterations << '|'
+        << opts.pdc_sigma_u_mm << '|' << opts.pdc_sigma_v_mm << '|' << opts.pdc_uv_correlation << '|'
+        << opts.pdc_angle_deg << '|' << opts.pdc_multi_track << '|' << opts.nebula_adjacency_gap_mm << '|'
+        << opts.random_seed << '|' << opts.target_sigma_xy_mm << '|' << opts.momentum_prior_enabled << '|'
+        << opts.momentum_prior_center_mev_c << '|' << opts.momentum_prior_sigma_mev_c << '|' << opts.p_min_mevc
+        << '|' << opts.p_max_mevc << '|' << opts.tolerance_mm << '|' << opts.rk_step_mm << '|'
+        << opts.center_brho_tm << '|' << reco::RkFitModeName(opts.rk_fit_mode) << '|' << opts.rk_write_errors
+        << '|' << opts.rk_write_laplace << '|' << reco_output::OutputBackendName(opts.output_format.backend) << '|'
+        << reco_output::OutputSchemaName(opts.output_format.schema) << '|'
+        << reco_output::CompressionProfileName(opts.output_format.compression) << '|'
+        << opts.output_format.compact_covariance << '|' << opts.shard.index << '/' << opts.shard.count << '|'
+        << opts.shard_by_events;
+    std::uint64_t hash = 1469598103934665603ULL;
+    for (const unsigned char c : key.str()) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    std::ostringstream hex;
+    hex << std::hex << hash;
+    return hex.str();
+}
+
 void PrintUsage(const char* argv0) {
     std::cout
         << "Usage(single-file): " << argv0
@@ -155,14 +297,38 @@ void PrintUsage(const char* argv0) {
         << "                   [--neutron-detectors auto|none|nebula|nebula-plus|joint]\n"
         << "                   [--rk-write-errors on|off] [--rk-write-laplace on|off]\n"
         << "                   [--momentum-prior-mev-c V --momentum-prior-sigma-mev-c V]\n"
+        << "                   [--threads N]   (event-level worker threads, 0 = all cores; output order is preserved)\n"
+        << "                   [--pdc-multi-track]   (cluster PDC layers and emit every compatible PDC1/PDC2 track)\n"
+        << "                   [--nebula-cluster-gap-mm V]   (cluster NEBULA hits over modules at most V mm apart\n"
+        << "                                                  within the time window; default: time window only)\n"
+        << "                   [--seed N]   (run seed; smearing is keyed by (seed, file, entry), so output does not\n"
+        << "                                 depend on --threads, --jobs or sharding)\n"
         << "\n"
         << "Usage(directory): " << argv0
-        << " --input-dir DIR --output-dir DIR --geometry-macro FILE [--backend auto|nn|rk|multidim]\n"
+        << " --input-dir DIR|GLOB|@LIST --output-dir DIR --geometry-macro FILE [--backend auto|nn|rk|multidim]\n"
         << "                   [--nn-model-json FILE] [--magnetic-field-map FILE] [--magnet-rotation-deg DEG]\n"
         << "                   [--max-files N] [--pdc-sigma-u-mm V] [--pdc-sigma-v-mm V] [--pdc-angle-deg V]\n"
         << "                   [--target-sigma-mm V] [--p-min-mevc V] [--p-max-mevc V]\n"
         << "                   [--neutron-detectors auto|none|nebula|nebula-plus|joint]\n"
-        << "                   [--rk-write-errors on|off] [--rk-write-laplace on|off]\n";
+        << "                   [--rk-write-errors on|off] [--rk-write-laplace on|off] [--threads N] [--pdc-multi-track]\n"
+        << "                   [--jobs N]   (files processed concurrently, largest first, 0 = all cores)\n"
+        << "                   [--manifest FILE] [--resume]   (per-file status log, default OUTPUT_DIR/<tag>_manifest.tsv;\n"
+        << "                                                   --resume skips files recorded as done whose output is\n"
+        << "                                                   unchanged; refused if the reconstruction options differ)\n"
+        << "                   [--shard i/N]   (directory: stable file-hash partition; single-file: entry range)\n"
+        << "                   [--shard-by files|events]   (directory: events = equal slices of the chained event\n"
+        << "                                                numbering, outputs named <stem>_reco.shardIofN.root)\n"
+        << "\n"
+        << "Input I/O (both modes): [--read-cache-mb N]   (TTreeCache size, 0 = off, default ROOT's)\n"
+        << "                        [--prefetch]   (read the next basket cluster on a background thread)\n"
+        << "Output (both modes):    [--output-format ttree|rntuple]   (rntuple: recoNTuple with track/proton/neutron collections)\n"
+        << "                        [--output-schema legacy|compact]   (compact: flat per-proton arrays, no hit collections)\n"
+        << "                        [--compression default|fast|balanced|archive]   (LZ4-4 / ZSTD-5 / LZMA-8)\n"
+        << "                        [--compact-covariance on|off]   (compact schema: store the 6-element momentum covariance)\n"
+        << "Fit cache (both modes): [--fit-cache-dir DIR]   (reuse proton fits from earlier passes; invalidated when\n"
+        << "                                                   hits, field map, target geometry or solver config change)\n"
+        << "Profiling (both modes): [--profile]   (per-stage timing summary and RSS/peak RSS per file)\n"
+        << "                        [--profile-tree]   (also write per-event stage timings to a recoTiming tree)\n";
 }
 
 CliOptions ParseArgs(int argc, char* argv[]) {
@@ -210,6 +376,41 @@ CliOptions ParseArgs(int argc, char* argv[]) {
             opts.neutron_detector_mode = neutron::ParseNeutronDetectorMode(argv[++i]);
         } else if (arg == "--max-files" && i + 1 < argc) {
             opts.max_files = ParseInt(argv[++i], "--max-files");
+        } else if (arg == "--threads" && i + 1 < argc) {
+            opts.threads = ParseInt(argv[++i], "--threads");
+        } else if (arg == "--jobs" && i + 1 < argc) {
+            opts.jobs = ParseInt(argv[++i], "--jobs");
+        } else if (arg == "--manifest" && i + 1 < argc) {
+            opts.manifest_file = argv[++i];
+        } else if (arg == "--resume") {
+            opts.resume = true;
+        } else if (arg == "--shard" && i + 1 < argc) {
+            opts.shard = ParseShard(argv[++i]);
+        } else if (arg == "--shard-by" && i + 1 < argc) {
+            const std::string mode = argv[++i];
+            if (mode != "files" && mode != "events") {
+                throw std::runtime_error("invalid --shard-by value (expected files|events): " + mode);
+            }
+            opts.shard_by_events = mode == "events";
+        } else if (arg == "--read-cache-mb" && i + 1 < argc) {
+            opts.read_cache_mb = ParseInt(argv[++i], "--read-cache-mb");
+        } else if (arg == "--prefetch") {
+            opts.prefetch = true;
+        } else if (arg == "--output-format" && i + 1 < argc) {
+            opts.output_format.backend = reco_output::ParseOutputBackend(argv[++i]);
+        } else if (arg == "--output-schema" && i + 1 < argc) {
+            opts.output_format.schema = reco_output::ParseOutputSchema(argv[++i]);
+        } else if (arg == "--compression" && i + 1 < argc) {
+            opts.output_format.compression = reco_output::ParseCompressionProfile(argv[++i]);
+        } else if (arg == "--compact-covariance" && i + 1 < argc) {
+            opts.output_format.compact_covariance = ParseBoolOption(argv[++i], "--compact-covariance");
+        } else if (arg == "--fit-cache-dir" && i + 1 < argc) {
+            opts.fit_cache_dir = argv[++i];
+        } else if (arg == "--profile") {
+            opts.profile = true;
+        } else if (arg == "--profile-tree") {
+            opts.profile = true;
+            opts.profile_tree = true;
         } else if (arg == "--max-iterations" && i + 1 < argc) {
             opts.max_iterations = ParseInt(argv[++i], "--max-iterations");
         } else if (arg == "--pdc-sigma-u-mm" && i + 1 < argc) {
@@ -220,6 +421,12 @@ CliOptions ParseArgs(int argc, char* argv[]) {
             opts.pdc_uv_correlation = ParseDouble(argv[++i], "--pdc-uv-correlation");
         } else if (arg == "--pdc-angle-deg" && i + 1 < argc) {
             opts.pdc_angle_deg = ParseDouble(argv[++i], "--pdc-angle-deg");
+        } else if (arg == "--pdc-multi-track") {
+            opts.pdc_multi_track = true;
+        } else if (arg == "--nebula-cluster-gap-mm" && i + 1 < argc) {
+            opts.nebula_adjacency_gap_mm = ParseDouble(argv[++i], "--nebula-cluster-gap-mm");
+        } else if (arg == "--seed" && i + 1 < argc) {
+            opts.random_seed = ParseInt(argv[++i], "--seed");
         } else if (arg == "--momentum-prior-mev-c" && i + 1 < argc) {
             opts.momentum_prior_center_mev_c = ParseDouble(argv[++i], "--momentum-prior-mev-c");
             opts.momentum_prior_enabled = true;
@@ -275,6 +482,18 @@ CliOptions ParseArgs(int argc, char* argv[]) {
     if (opts.max_files < 0) {
         throw std::runtime_error("--max-files must be >= 0");
     }
+    if (opts.threads < 0) {
+        throw std::runtime_error("--threads must be >= 0 (0 = all hardware threads)");
+    }
+    if (opts.jobs < 0) {
+        throw std::runtime_error("--jobs must be >= 0 (0 = all hardware threads)");
+    }
+    if (opts.random_seed < 0) {
+        throw std::runtime_error("--seed must be >= 0");
+    }
+    if (single_file_mode && (opts.resume || !opts.manifest_file.empty())) {
+        throw std::runtime_error("--resume/--manifest are only supported in directory mode");
+    }
     if (opts.max_iterations <= 0) {
         throw std::runtime_error("--max-iterations must be > 0");
     }
@@ -296,33 +515,10 @@ CliOptions ParseArgs(int argc, char* argv[]) {
     if (opts.tolerance_mm <= 0.0) {
         throw std::runtime_error("--tolerance-mm must be > 0");
     }
-    return opts;
-}
-
-std::vector<fs::path> CollectInputFiles(const fs::path& input_dir, int max_files) {
-    std::vector<fs::path> files;
-    if (!fs::exists(input_dir)) {
-        return files;
-    }
-    for (const auto& entry : fs::recursive_directory_iterator(input_dir)) {
-        if (!entry.is_regular_file()) {
-            continue;
-        }
-        const fs::path path = entry.path();
-        if (path.extension() != ".root") {
-            continue;
-        }
-        const std::string name = path.filename().string();
-        if (name.find("_reco.root") != std::string::npos) {
-            continue;
-        }
-        files.push_back(path);
-    }
-    std::sort(files.begin(), files.end());
-    if (max_files > 0 && static_cast<int>(files.size()) > max_files) {
-        files.resize(static_cast<std::size_t>(max_files));
+    if (opts.output_format.backend == reco_output::OutputBackend::kRNTuple && !reco_output::RNTupleAvailable()) {
+        throw std::runtime_error("--output-format rntuple needs a build with WITH_RNTUPLE (ROOT >= 6.34)");
     }
-    return files;
+    return opts;
 }
 
 fs::path BuildOutputPath(const fs::path& input_file, const fs::path& input_dir, const fs::path& output_dir) {
@@ -336,6 +532,14 @@ fs::path BuildOutputPath(const fs::path& input_file, const fs::path& input_dir,
     return out;
 }
 
+// [EN] Event shards of one chain may cut the same input, so each shard writes its own file. / [CN] 事件分片可能切分同一输入，故每个分片写独立文件。
+fs::path BuildShardOutputPath(const fs::path& output_file, const ShardSpec& shard) {
+    fs::path out = output_file;
+    out.replace_filename(out.stem().string() + ".shard" + std::to_string(shard.index) + "of" +
+                         std::to_string(shard.count) + out.extension().string());
+    return out;
+}
+
 fs::path BuildLogPath(const fs::path& output_file) {
     fs::path log_path = output_file;
     log_path.replace_extension(".log");
@@ -384,332 +588,710 @@ void LogNeutronRecoConfig(const neutron::DetectorAvailability& availability,
     SM_INFO("  IgnoredNEBULAPlusBranch={}", resolved.ignored_nebula_plus_branch ? "true" : "false");
 }
 
-bool ProcessSingleFile(const fs::path& input_file,
-                       const fs::path& output_file,
-                       const std::string& log_tag,
-                       const std::string& backend_name,
-                       bool write_rk_errors,
-                       bool write_rk_laplace,
-                       PDCSimAna& pdc_ana,
-                       NEBULAReco& nebula_reco,
-                       NEBULAPlusReco& nebula_plus_reco,
-                       NebulaJointReco& nebula_joint_reco,
-                       reco::PDCMomentumReconstructor& proton_reco,
-                       const reco::RecoConfig& proton_config,
-                       const reco::TargetConstraint& target_constraint,
-                       neutron::NeutronDetectorMode requested_neutron_mode,
-                       double target_angle_rad,
-                       FileStats* stats) {
-    if (!stats) {
-        return false;
-    }
-
-    EventDataReader reader(input_file.c_str());
-    if (!reader.IsOpen()) {
-        std::cerr << "[" << log_tag << "] failed to open input file: " << input_file << std::endl;
-        return false;
-    }
-
-    const neutron::DetectorAvailability detector_availability = BuildDetectorAvailability(reader);
-    const neutron::ResolvedNeutronDetectorMode neutron_mode =
-        neutron::ResolveNeutronDetectorMode(requested_neutron_mode, detector_availability);
-    LogNeutronRecoConfig(detector_availability, neutron_mode);
-
-    EnsureParentDirectory(output_file);
-    TFile out(output_file.c_str(), "RECREATE");
-    if (out.IsZombie()) {
-        std::cerr << "[" << log_tag << "] failed to create output file: " << output_file << std::endl;
-        return false;
+// [EN] Per-event proton output columns; one element per reconstructed proton track. / [CN] 每事件质子输出列，每条重建质子径迹一个元素。
+struct ProtonColumns : reco_output::LegacyProtonColumns {
+    void Append(const reco::RecoResult& reco_result, bool write_rk_errors, bool write_rk_laplace) {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        auto append_interval = [nan](const reco::IntervalEstimate& interval,
+                                     std::vector<double>* lower68,
+                                     std::vector<double>* upper68,
+                                     std::vector<double>* lower95,
+                                     std::vector<double>* upper95) {
+            lower68->push_back(interval.valid ? interval.lower68 : nan);
+            upper68->push_back(interval.valid ? interval.upper68 : nan);
+            lower95->push_back(interval.valid ? interval.lower95 : nan);
+            upper95->push_back(interval.valid ? interval.upper95 : nan);
+        };
+        px.push_back(reco_result.p4_at_target.Px());
+        py.push_back(reco_result.p4_at_target.Py());
+        pz.push_back(reco_result.p4_at_target.Pz());
+        e.push_back(reco_result.p4_at_target.E());
+        if (!write_rk_errors) {
+            return;
+        }
+        p.push_back(reco_result.p4_at_target.P());
+        status.push_back(static_cast<int>(reco_result.status));
+        method.push_back(static_cast<int>(reco_result.method_used));
+        ndf.push_back(reco_result.ndf);
+        iterations.push_back(reco_result.iterations);
+        uncertainty_valid.push_back(reco_result.uncertainty_valid ? 1 : 0);
+        posterior_valid.push_back(reco_result.posterior_valid ? 1 : 0);
+        chi2_raw.push_back(reco_result.chi2_raw);
+        chi2_reduced.push_back(reco_result.chi2_reduced);
+        px_sigma.push_back(reco_result.px_interval.valid ? reco_result.px_interval.sigma : nan);
+        py_sigma.push_back(reco_result.py_interval.valid ? reco_result.py_interval.sigma : nan);
+        pz_sigma.push_back(reco_result.pz_interval.valid ? reco_result.pz_interval.sigma : nan);
+        p_sigma.push_back(reco_result.p_interval.valid ? reco_result.p_interval.sigma : nan);
+        for (const std::size_t index : {0U, 1U, 2U, 4U, 5U, 8U}) {
+            momentum_cov.push_back(reco_result.uncertainty_valid ? reco_result.momentum_covariance[index] : nan);
+        }
+        if (write_rk_laplace) {
+            append_interval(reco_result.px_credible, &px_lower68, &px_upper68, &px_lower95, &px_upper95);
+            append_interval(reco_result.py_credible, &py_lower68, &py_upper68, &py_lower95, &py_upper95);
+            append_interval(reco_result.pz_credible, &pz_lower68, &pz_upper68, &pz_lower95, &pz_upper95);
+            append_interval(reco_result.p_credible, &p_lower68, &p_upper68, &p_lower95, &p_upper95);
+        }
     }
+};
 
-    TTree reco_tree("recoTree", "Reconstruction tree with proton and NEBULA neutron");
-
+// [EN] Everything one input entry contributes to recoTree plus the per-event counters.
+// Workers fill these independently; the writer swaps them into the branch-bound instance.
+// [CN] 单个输入事件写入 recoTree 的全部内容及事件级计数；worker 独立填充，写出线程再交换进绑定分支的实例。
+struct EventOutput {
+    Long64_t entry = -1;
+    bool valid = false;
     RecoEvent reco_event;
-    RecoEvent* reco_event_ptr = &reco_event;
-
     bool truth_has_proton = false;
     bool truth_has_neutron = false;
-    TLorentzVector truth_proton_p4(0.0, 0.0, 0.0, 0.0);
-    TLorentzVector truth_neutron_p4(0.0, 0.0, 0.0, 0.0);
-    TVector3 truth_proton_pos(0.0, 0.0, 0.0);
-    TVector3 truth_neutron_pos(0.0, 0.0, 0.0);
-
-    std::vector<double> reco_proton_px;
-    std::vector<double> reco_proton_py;
-    std::vector<double> reco_proton_pz;
-    std::vector<double> reco_proton_e;
-    std::vector<double> reco_proton_p;
-    std::vector<int> reco_proton_status;
-    std::vector<int> reco_proton_method;
-    std::vector<int> reco_proton_ndf;
-    std::vector<int> reco_proton_iterations;
-    std::vector<int> reco_proton_uncertainty_valid;
-    std::vector<int> reco_proton_posterior_valid;
-    std::vector<double> reco_proton_chi2_raw;
-    std::vector<double> reco_proton_chi2_reduced;
-    std::vector<double> reco_proton_px_sigma;
-    std::vector<double> reco_proton_py_sigma;
-    std::vector<double> reco_proton_pz_sigma;
-    std::vector<double> reco_proton_p_sigma;
-    std::vector<double> reco_proton_px_lower68;
-    std::vector<double> reco_proton_px_upper68;
-    std::vector<double> reco_proton_px_lower95;
-    std::vector<double> reco_proton_px_upper95;
-    std::vector<double> reco_proton_py_lower68;
-    std::vector<double> reco_proton_py_upper68;
-    std::vector<double> reco_proton_py_lower95;
-    std::vector<double> reco_proton_py_upper95;
-    std::vector<double> reco_proton_pz_lower68;
-    std::vector<double> reco_proton_pz_upper68;
-    std::vector<double> reco_proton_pz_lower95;
-    std::vector<double> reco_proton_pz_upper95;
-    std::vector<double> reco_proton_p_lower68;
-    std::vector<double> reco_proton_p_upper68;
-    std::vector<double> reco_proton_p_lower95;
-    std::vector<double> reco_proton_p_upper95;
-
-    reco_tree.Branch("recoEvent", &reco_event_ptr);
-    reco_tree.Branch("truth_has_proton", &truth_has_proton);
-    reco_tree.Branch("truth_has_neutron", &truth_has_neutron);
-    reco_tree.Branch("truth_proton_p4", &truth_proton_p4);
-    reco_tree.Branch("truth_neutron_p4", &truth_neutron_p4);
-    reco_tree.Branch("truth_proton_pos", &truth_proton_pos);
-    reco_tree.Branch("truth_neutron_pos", &truth_neutron_pos);
-    reco_tree.Branch("reco_proton_px", &reco_proton_px);
-    reco_tree.Branch("reco_proton_py", &reco_proton_py);
-    reco_tree.Branch("reco_proton_pz", &reco_proton_pz);
-    reco_tree.Branch("reco_proton_e", &reco_proton_e);
-    if (write_rk_errors) {
-        reco_tree.Branch("reco_proton_p", &reco_proton_p);
-        reco_tree.Branch("reco_proton_status", &reco_proton_status);
-        reco_tree.Branch("reco_proton_method", &reco_proton_method);
-        reco_tree.Branch("reco_proton_ndf", &reco_proton_ndf);
-        reco_tree.Branch("reco_proton_iterations", &reco_proton_iterations);
-        reco_tree.Branch("reco_proton_uncertainty_valid", &reco_proton_uncertainty_valid);
-        reco_tree.Branch("reco_proton_posterior_valid", &reco_proton_posterior_valid);
-        reco_tree.Branch("reco_proton_chi2_raw", &reco_proton_chi2_raw);
-        reco_tree.Branch("reco_proton_chi2_reduced", &reco_proton_chi2_reduced);
-        reco_tree.Branch("reco_proton_px_sigma", &reco_proton_px_sigma);
-        reco_tree.Branch("reco_proton_py_sigma", &reco_proton_py_sigma);
-        reco_tree.Branch("reco_proton_pz_sigma", &reco_proton_pz_sigma);
-        reco_tree.Branch("reco_proton_p_sigma", &reco_proton_p_sigma);
-        if (write_rk_laplace) {
-            reco_tree.Branch("reco_proton_px_lower68", &reco_proton_px_lower68);
-            reco_tree.Branch("reco_proton_px_upper68", &reco_proton_px_upper68);
-            reco_tree.Branch("reco_proton_px_lower95", &reco_proton_px_lower95);
-            reco_tree.Branch("reco_proton_px_upper95", &reco_proton_px_upper95);
-            reco_tree.Branch("reco_proton_py_lower68", &reco_proton_py_lower68);
-            reco_tree.Branch("reco_proton_py_upper68", &reco_proton_py_upper68);
-            reco_tree.Branch("reco_proton_py_lower95", &reco_proton_py_lower95);
-            reco_tree.Branch("reco_proton_py_upper95", &reco_proton_py_upper95);
-            reco_tree.Branch("reco_proton_pz_lower68", &reco_proton_pz_lower68);
-            reco_tree.Branch("reco_proton_pz_upper68", &reco_proton_pz_upper68);
-            reco_tree.Branch("reco_proton_pz_lower95", &reco_proton_pz_lower95);
-            reco_tree.Branch("reco_proton_pz_upper95", &reco_proton_pz_upper95);
-            reco_tree.Branch("reco_proton_p_lower68", &reco_proton_p_lower68);
-            reco_tree.Branch("reco_proton_p_upper68", &reco_proton_p_upper68);
-            reco_tree.Branch("reco_proton_p_lower95", &reco_proton_p_lower95);
-            reco_tree.Branch("reco_proton_p_upper95", &reco_proton_p_upper95);
-        }
-    }
-
-    stats->total_events = reader.GetTotalEvents();
-
-    for (Long64_t i = 0; i < stats->total_events; ++i) {
-        if (!reader.GoToEvent(i)) {
-            continue;
-        }
-        ++stats->processed_events;
+    TLorentzVector truth_proton_p4{0.0, 0.0, 0.0, 0.0};
+    TLorentzVector truth_neutron_p4{0.0, 0.0, 0.0, 0.0};
+    TVector3 truth_proton_pos{0.0, 0.0, 0.0};
+    TVector3 truth_neutron_pos{0.0, 0.0, 0.0};
+    ProtonColumns protons;
+
+    bool pdc_hit = false;
+    bool nebula_hit = false;
+    bool nebula_plus_hit = false;
+    bool neutron_reco = false;
+    long long reco_proton_count = 0;
+    // [EN] Per-event stage time in ns; only filled while profiling is enabled. / [CN] 单事件各阶段耗时（ns），仅在开启 profiling 时填写。
+    std::array<Long64_t, profiling::kRecoStageCount> stage_ns{};
 
+    void Reset(Long64_t entry_number) {
+        entry = entry_number;
+        valid = false;
         reco_event.Clear();
-        reco_proton_px.clear();
-        reco_proton_py.clear();
-        reco_proton_pz.clear();
-        reco_proton_e.clear();
-        reco_proton_p.clear();
-        reco_proton_status.clear();
-        reco_proton_method.clear();
-        reco_proton_ndf.clear();
-        reco_proton_iterations.clear();
-        reco_proton_uncertainty_valid.clear();
-        reco_proton_posterior_valid.clear();
-        reco_proton_chi2_raw.clear();
-        reco_proton_chi2_reduced.clear();
-        reco_proton_px_sigma.clear();
-        reco_proton_py_sigma.clear();
-        reco_proton_pz_sigma.clear();
-        reco_proton_p_sigma.clear();
-        reco_proton_px_lower68.clear();
-        reco_proton_px_upper68.clear();
-        reco_proton_px_lower95.clear();
-        reco_proton_px_upper95.clear();
-        reco_proton_py_lower68.clear();
-        reco_proton_py_upper68.clear();
-        reco_proton_py_lower95.clear();
-        reco_proton_py_upper95.clear();
-        reco_proton_pz_lower68.clear();
-        reco_proton_pz_upper68.clear();
-        reco_proton_pz_lower95.clear();
-        reco_proton_pz_upper95.clear();
-        reco_proton_p_lower68.clear();
-        reco_proton_p_upper68.clear();
-        reco_proton_p_lower95.clear();
-        reco_proton_p_upper95.clear();
+        protons.Clear();
         truth_has_proton = false;
         truth_has_neutron = false;
         truth_proton_p4.SetPxPyPzE(0.0, 0.0, 0.0, 0.0);
         truth_neutron_p4.SetPxPyPzE(0.0, 0.0, 0.0, 0.0);
         truth_proton_pos.SetXYZ(0.0, 0.0, 0.0);
         truth_neutron_pos.SetXYZ(0.0, 0.0, 0.0);
+        pdc_hit = false;
+        nebula_hit = false;
+        nebula_plus_hit = false;
+        neutron_reco = false;
+        reco_proton_count = 0;
+        stage_ns.fill(0);
+    }
 
-        TClonesArray* hits = reader.GetHits();
-        if (hits && hits->GetEntries() > 0) {
-            pdc_ana.ProcessEvent(hits, reco_event);
-            ++stats->pdc_hit_events;
-        }
+    // [EN] Swap contents but keep object addresses, so TTree branch addresses stay valid. / [CN] 只交换内容不改地址，TTree 分支地址保持有效。
+    void Swap(EventOutput& other) {
+        std::swap(entry, other.entry);
+        std::swap(valid, other.valid);
+        std::swap(reco_event.eventID, other.reco_event.eventID);
+        std::swap(reco_event.rawHits, other.reco_event.rawHits);
+        std::swap(reco_event.smearedHits, other.reco_event.smearedHits);
+        std::swap(reco_event.tracks, other.reco_event.tracks);
+        std::swap(reco_event.neutrons, other.reco_event.neutrons);
+        std::swap(truth_has_proton, other.truth_has_proton);
+        std::swap(truth_has_neutron, other.truth_has_neutron);
+        std::swap(truth_proton_p4, other.truth_proton_p4);
+        std::swap(truth_neutron_p4, other.truth_neutron_p4);
+        std::swap(truth_proton_pos, other.truth_proton_pos);
+        std::swap(truth_neutron_pos, other.truth_neutron_pos);
+        protons.Swap(other.protons);
+        std::swap(pdc_hit, other.pdc_hit);
+        std::swap(nebula_hit, other.nebula_hit);
+        std::swap(nebula_plus_hit, other.nebula_plus_hit);
+        std::swap(neutron_reco, other.neutron_reco);
+        std::swap(reco_proton_count, other.reco_proton_count);
+        std::swap(stage_ns, other.stage_ns);
+    }
+};
 
-        TClonesArray* nebula_hits = reader.GetNEBULAHits();
-        TClonesArray* nebula_plus_hits = reader.GetNEBULAPlusHits();
-        const bool nebula_has_hits = nebula_hits && nebula_hits->GetEntries() > 0;
-        const bool nebula_plus_has_hits = nebula_plus_hits && nebula_plus_hits->GetEntries() > 0;
-        if (nebula_has_hits) {
-            ++stats->nebula_hit_events;
-        }
-        if (nebula_plus_has_hits) {
-            ++stats->nebula_plus_hit_events;
-        }
+// [EN] Mutable per-thread analysis objects; construct one set per worker. / [CN] 每线程可变分析对象，每个 worker 构造一套。
+struct EventAnalyzers {
+    explicit EventAnalyzers(const GeometryManager& geometry,
+                            const PDCTrackFinderConfig& track_finder = PDCTrackFinderConfig())
+        : pdc_ana(geometry),
+          nebula_reco(geometry),
+          nebula_plus_reco(geometry),
+          nebula_joint_reco(geometry) {
+        pdc_ana.SetSmearing(0.5, 0.5);
+        pdc_ana.SetTrackFinder(track_finder);
+        pdc_ana.SetRandomGenerator(&pdc_random);
+
+        nebula_reco.SetTargetPosition(geometry.GetTargetPosition());
+        nebula_reco.SetTimeWindow(10.0);
+        nebula_reco.SetEnergyThreshold(1.0);
+
+        nebula_plus_reco.SetTargetPosition(geometry.GetTargetPosition());
+        nebula_plus_reco.SetTimeWindow(10.0);
+        nebula_plus_reco.SetEnergyThreshold(1.0);
+
+        nebula_joint_reco.SetTargetPosition(geometry.GetTargetPosition());
+        nebula_joint_reco.SetTimeWindow(10.0);
+        nebula_joint_reco.SetEnergyThreshold(1.0);
+    }
+
+    PDCSimAna pdc_ana;
+    NEBULAReco nebula_reco;
+    NEBULAPlusReco nebula_plus_reco;
+    NebulaJointReco nebula_joint_reco;
+    PhiloxRandom pdc_random;
+};
+
+// [EN] Read-only inputs shared by every worker of one file. / [CN] 同一文件所有 worker 共享的只读输入。
+struct EventRecoContext {
+    EventDataReaderOptions reader_options;
+    const reco::PDCMomentumReconstructor* proton_reco = nullptr;
+    const reco::RecoConfig* proton_config = nullptr;
+    const reco::TargetConstraint* target_constraint = nullptr;
+    reco::PDCFitResultCache* fit_cache = nullptr;
+    neutron::NeutronDetectorMode neutron_mode = neutron::NeutronDetectorMode::kNone;
+    PDCTrackFinderConfig pdc_track_finder;
+    const NEBULAModuleAdjacency* nebula_adjacency = nullptr;
+    RandomStreams random_streams;
+    double target_angle_rad = 0.0;
+    bool write_rk_errors = true;
+    bool write_rk_laplace = true;
+};
+
+void ReconstructEvent(const EventDataReader& reader,
+                      Long64_t entry,
+                      EventAnalyzers& analyzers,
+                      const EventRecoContext& context,
+                      EventOutput* output) {
+    output->Reset(entry);
+    output->valid = true;
+    RecoEvent& reco_event = output->reco_event;
+    // [EN] Every random number of this entry comes from streams keyed by its entry number, so the result does not
+    // depend on which worker or chunk reconstructs it. / [CN] 本事件的全部随机数来自以事件号为键的流，结果与处理它的 worker 或分块无关。
+    context.random_streams.Attach(analyzers.pdc_random, entry, "PDC");
+    analyzers.nebula_reco.AttachRandomStream(context.random_streams, entry);
+    analyzers.nebula_plus_reco.AttachRandomStream(context.random_streams, entry);
+    analyzers.nebula_joint_reco.AttachRandomStream(context.random_streams, entry);
+    analyzers.nebula_reco.SetModuleAdjacency(context.nebula_adjacency);
+    analyzers.nebula_plus_reco.SetModuleAdjacency(context.nebula_adjacency);
+    analyzers.nebula_joint_reco.SetModuleAdjacency(context.nebula_adjacency);
+
+    TClonesArray* hits = reader.GetHits();
+    if (hits && hits->GetEntries() > 0) {
+        SM_PROFILE_STAGE(profiling::RecoStage::kPdcAna);
+        analyzers.pdc_ana.ProcessEvent(hits, reco_event);
+        output->pdc_hit = true;
+    }
 
-        const std::size_t neutron_count_before = reco_event.neutrons.size();
-        switch (neutron_mode.effective_mode) {
+    TClonesArray* nebula_hits = reader.GetNEBULAHits();
+    TClonesArray* nebula_plus_hits = reader.GetNEBULAPlusHits();
+    const bool nebula_has_hits = nebula_hits && nebula_hits->GetEntries() > 0;
+    const bool nebula_plus_has_hits = nebula_plus_hits && nebula_plus_hits->GetEntries() > 0;
+    output->nebula_hit = nebula_has_hits;
+    output->nebula_plus_hit = nebula_plus_has_hits;
+
+    const std::size_t neutron_count_before = reco_event.neutrons.size();
+    {
+        SM_PROFILE_STAGE(profiling::RecoStage::kNebulaReco);
+        switch (context.neutron_mode) {
             case neutron::NeutronDetectorMode::kNone:
                 break;
             case neutron::NeutronDetectorMode::kNebula:
                 if (nebula_has_hits) {
-                    nebula_reco.ProcessEvent(nebula_hits, reco_event);
+                    analyzers.nebula_reco.ProcessEvent(nebula_hits, reco_event);
                 }
                 break;
             case neutron::NeutronDetectorMode::kNebulaPlus:
                 if (nebula_plus_has_hits) {
-                    nebula_plus_reco.ProcessEvent(nebula_plus_hits, reco_event);
+                    analyzers.nebula_plus_reco.ProcessEvent(nebula_plus_hits, reco_event);
                 }
                 break;
             case neutron::NeutronDetectorMode::kJoint:
                 if (nebula_has_hits || nebula_plus_has_hits) {
-                    nebula_joint_reco.SetInputs(nebula_hits, nebula_plus_hits);
-                    nebula_joint_reco.ProcessEvent(reco_event);
+                    analyzers.nebula_joint_reco.SetInputs(nebula_hits, nebula_plus_hits);
+                    analyzers.nebula_joint_reco.ProcessEvent(reco_event);
                 }
                 break;
             case neutron::NeutronDetectorMode::kAuto:
                 break;
         }
         if (reco_event.neutrons.size() > neutron_count_before) {
-            ++stats->neutron_reco_events;
+            output->neutron_reco = true;
             // [EN] Rotate reco neutron direction(s) from lab frame to target (beam-as-Z) frame so reco_neutron matches truth_neutron_p4. / [CN] 把重建中子方向从 lab 系旋到靶系，使 reco_neutron 与 truth_neutron_p4 的坐标系一致。
             analysis::nebula::RotateRecoNeutronsToTargetFrame(reco_event,
-                                                              target_angle_rad);
+                                                              context.target_angle_rad);
         }
+    }
 
-        bool event_has_reco_proton = false;
-        for (const auto& track : reco_event.tracks) {
-            if (track.pdgCode == 2112) {
-                // [EN] Keep neutron reconstruction unchanged while restricting momentum inversion to charged proton tracks. / [CN] 保持中子重建链不变，同时只对带电质子轨迹执行动量反演。
-                continue;
+    for (const auto& track : reco_event.tracks) {
+        if (track.pdgCode == 2112) {
+            // [EN] Keep neutron reconstruction unchanged while restricting momentum inversion to charged proton tracks. / [CN] 保持中子重建链不变，同时只对带电质子轨迹执行动量反演。
+            continue;
+        }
+        reco::PDCInputTrack pdc_track;
+        pdc_track.pdc1 = track.start;
+        pdc_track.pdc2 = track.end;
+
+        reco::RecoResult reco_result_lab;
+        {
+            SM_PROFILE_STAGE(profiling::RecoStage::kProtonReco);
+            reco_result_lab = context.proton_reco->Reconstruct(pdc_track, *context.target_constraint,
+                                                               *context.proton_config, nullptr, context.fit_cache);
+        }
+        if ((reco_result_lab.status == reco::SolverStatus::kSuccess ||
+             reco_result_lab.status == reco::SolverStatus::kNotConverged) &&
+            reco_result_lab.p4_at_target.P() > 0.0) {
+            // [EN] Rotate reco from lab frame to target frame so it matches truth
+            // (truth stays in the event-generator "beam-as-Z" frame).
+            // [CN] 把 reco 从 lab 系旋到靶系，与 truth（事件发生器的 beam-as-Z 系）对齐。
+            SM_PROFILE_STAGE(profiling::RecoStage::kOutputPrep);
+            const reco::RecoResult reco_result =
+                RotateRecoResultToTargetFrame(reco_result_lab, context.target_angle_rad);
+            output->protons.Append(reco_result, context.write_rk_errors, context.write_rk_laplace);
+            ++output->reco_proton_count;
+        }
+    }
+
+    const std::vector<TBeamSimData>* beam_data = reader.GetBeamData();
+    if (beam_data) {
+        SM_PROFILE_STAGE(profiling::RecoStage::kOutputPrep);
+        for (const auto& particle : *beam_data) {
+            if (!output->truth_has_proton &&
+                (particle.fParticleName == "proton" || (particle.fZ == 1 && particle.fA == 1))) {
+                output->truth_has_proton = true;
+                output->truth_proton_p4 = particle.fMomentum;
+                output->truth_proton_pos = particle.fPosition;
+            } else if (!output->truth_has_neutron &&
+                       (particle.fParticleName == "neutron" || (particle.fZ == 0 && particle.fA == 1))) {
+                output->truth_has_neutron = true;
+                output->truth_neutron_p4 = particle.fMomentum;
+                output->truth_neutron_pos = particle.fPosition;
             }
-            reco::PDCInputTrack pdc_track;
-            pdc_track.pdc1 = track.start;
-            pdc_track.pdc2 = track.end;
-
-            const reco::RecoResult reco_result_lab = proton_reco.Reconstruct(pdc_track, target_constraint, proton_config);
-            if ((reco_result_lab.status == reco::SolverStatus::kSuccess ||
-                 reco_result_lab.status == reco::SolverStatus::kNotConverged) &&
-                reco_result_lab.p4_at_target.P() > 0.0) {
-                // [EN] Rotate reco from lab frame to target frame so it matches truth
-                // (truth stays in the event-generator "beam-as-Z" frame).
-                // [CN] 把 reco 从 lab 系旋到靶系，与 truth（事件发生器的 beam-as-Z 系）对齐。
-                const reco::RecoResult reco_result =
-                    RotateRecoResultToTargetFrame(reco_result_lab, target_angle_rad);
-                const double nan = std::numeric_limits<double>::quiet_NaN();
-                auto append_interval = [](const reco::IntervalEstimate& interval,
-                                          std::vector<double>* lower68,
-                                          std::vector<double>* upper68,
-                                          std::vector<double>* lower95,
-                                          std::vector<double>* upper95) {
-                    lower68->push_back(interval.valid ? interval.lower68
-                                                      : std::numeric_limits<double>::quiet_NaN());
-                    upper68->push_back(interval.valid ? interval.upper68
-                                                      : std::numeric_limits<double>::quiet_NaN());
-                    lower95->push_back(interval.valid ? interval.lower95
-                                                      : std::numeric_limits<double>::quiet_NaN());
-                    upper95->push_back(interval.valid ? interval.upper95
-                                                      : std::numeric_limits<double>::quiet_NaN());
-                };
-                reco_proton_px.push_back(reco_result.p4_at_target.Px());
-                reco_proton_py.push_back(reco_result.p4_at_target.Py());
-                reco_proton_pz.push_back(reco_result.p4_at_target.Pz());
-                reco_proton_e.push_back(reco_result.p4_at_target.E());
-                if (write_rk_errors) {
-                    reco_proton_p.push_back(reco_result.p4_at_target.P());
-                    reco_proton_status.push_back(static_cast<int>(reco_result.status));
-                    reco_proton_method.push_back(static_cast<int>(reco_result.method_used));
-                    reco_proton_ndf.push_back(reco_result.ndf);
-                    reco_proton_iterations.push_back(reco_result.iterations);
-                    reco_proton_uncertainty_valid.push_back(reco_result.uncertainty_valid ? 1 : 0);
-                    reco_proton_posterior_valid.push_back(reco_result.posterior_valid ? 1 : 0);
-                    reco_proton_chi2_raw.push_back(reco_result.chi2_raw);
-                    reco_proton_chi2_reduced.push_back(reco_result.chi2_reduced);
-                    reco_proton_px_sigma.push_back(reco_result.px_interval.valid ? reco_result.px_interval.sigma : nan);
-                    reco_proton_py_sigma.push_back(reco_result.py_interval.valid ? reco_result.py_interval.sigma : nan);
-                    reco_proton_pz_sigma.push_back(reco_result.pz_interval.valid ? reco_result.pz_interval.sigma : nan);
-                    reco_proton_p_sigma.push_back(reco_result.p_interval.valid ? reco_result.p_interval.sigma : nan);
-                    if (write_rk_laplace) {
-                        append_interval(reco_result.px_credible,
-                                        &reco_proton_px_lower68,
-                                        &reco_proton_px_upper68,
-                                        &reco_proton_px_lower95,
-                                        &reco_proton_px_upper95);
-                        append_interval(reco_result.py_credible,
-                                        &reco_proton_py_lower68,
-                                        &reco_proton_py_upper68,
-                                        &reco_proton_py_lower95,
-                                        &reco_proton_py_upper95);
-                        append_interval(reco_result.pz_credible,
-                                        &reco_proton_pz_lower68,
-                                        &reco_proton_pz_upper68,
-                                        &reco_proton_pz_lower95,
-                                        &reco_proton_pz_upper95);
-                        append_interval(reco_result.p_credible,
-                                        &reco_proton_p_lower68,
-                                        &reco_proton_p_upper68,
-                                        &reco_proton_p_lower95,
-                                        &reco_proton_p_upper95);
+        }
+    }
+
+    reco_event.eventID = static_cast<int>(entry);
+}
+
+// [EN] Read one entry and reconstruct it; with profiling on, the row also carries this event's stage times.
+// Returns false (row left invalid) when the entry cannot be read.
+// [CN] 读取并重建单个事件；开启 profiling 时该行同时记录本事件各阶段耗时。读取失败返回 false（行保持无效）。
+bool ReadAndReconstructEvent(EventDataReader& reader,
+                             Long64_t entry,
+                             EventAnalyzers& analyzers,
+                             const EventRecoContext& context,
+                             EventOutput* output) {
+    const bool profiling_enabled = SMSIM_RECO_PROFILING && profiling::RecoProfiler::Enabled();
+    profiling::StageTotals before;
+    if (profiling_enabled) {
+        before = profiling::RecoProfiler::ThreadCounters().Snapshot();
+    }
+
+    bool read_ok = false;
+    {
+        SM_PROFILE_STAGE(profiling::RecoStage::kRead);
+        read_ok = reader.GoToEvent(entry);
+    }
+    if (!read_ok) {
+        output->Reset(entry);
+        return false;
+    }
+    ReconstructEvent(reader, entry, analyzers, context, output);
+
+    if (profiling_enabled) {
+        const profiling::StageTotals delta = profiling::RecoProfiler::ThreadCounters().Snapshot() - before;
+        for (std::size_t i = 0; i < profiling::kRecoStageCount; ++i) {
+            output->stage_ns[i] = static_cast<Long64_t>(delta.ns[i]);
+        }
+    }
+    return true;
+}
+
+void AccumulateEventStats(const EventOutput& output, FileStats* stats) {
+    ++stats->processed_events;
+    stats->pdc_hit_events += output.pdc_hit ? 1 : 0;
+    stats->nebula_hit_events += output.nebula_hit ? 1 : 0;
+    stats->nebula_plus_hit_events += output.nebula_plus_hit ? 1 : 0;
+    stats->neutron_reco_events += output.neutron_reco ? 1 : 0;
+    stats->proton_reco_events += output.reco_proton_count > 0 ? 1 : 0;
+    stats->reco_proton_count += output.reco_proton_count;
+}
+
+void BindOutputBranches(TTree& reco_tree,
+                        EventOutput& row,
+                        RecoEvent** reco_event_ptr,
+                        bool write_rk_errors,
+                        bool write_rk_laplace) {
+    reco_tree.Branch("recoEvent", reco_event_ptr);
+    reco_tree.Branch("truth_has_proton", &row.truth_has_proton);
+    reco_tree.Branch("truth_has_neutron", &row.truth_has_neutron);
+    reco_tree.Branch("truth_proton_p4", &row.truth_proton_p4);
+    reco_tree.Branch("truth_neutron_p4", &row.truth_neutron_p4);
+    reco_tree.Branch("truth_proton_pos", &row.truth_proton_pos);
+    reco_tree.Branch("truth_neutron_pos", &row.truth_neutron_pos);
+    row.protons.BindForWrite(reco_tree, write_rk_errors, write_rk_laplace);
+}
+
+// [EN] Side tree with one entry per recoTree entry (same order), usable as a friend. / [CN] 与 recoTree 逐条对应（顺序一致）的旁路树，可作为 friend 使用。
+void BindTimingBranches(TTree& timing_tree, EventOutput& row) {
+    timing_tree.Branch("eventID", &row.reco_event.eventID);
+    for (std::size_t i = 0; i < profiling::kRecoStageCount; ++i) {
+        const std::string name =
+            std::string(profiling::RecoStageName(static_cast<profiling::RecoStage>(i))) + "_ns";
+        timing_tree.Branch(name.c_str(), &row.stage_ns[i]);
+    }
+}
+
+// [EN] Multi-threaded event loop. Workers claim fixed-size chunks of entries through an atomic
+// counter, each with its own EventDataReader and EventAnalyzers; the calling thread is the only
+// writer and drains finished chunks from a reorder buffer strictly in chunk order, so recoTree
+// entry order is identical to the serial loop. At most max_in_flight chunks are buffered.
+// [CN] 多线程事件循环：worker 通过原子计数器领取固定大小的事件块，各自持有 EventDataReader 与
+// EventAnalyzers；调用线程是唯一写出者，按块序从重排缓冲区取出结果，因此 recoTree 条目顺序与串行一致。
+class OrderedEventPipeline {
+public:
+    OrderedEventPipeline(const fs::path& input_file,
+                         const GeometryManager& geometry,
+                         const EventRecoContext& context,
+                         Long64_t first_entry,
+                         Long64_t last_entry,
+                         int threads)
+        : fInputFile(input_file),
+          fGeometry(geometry),
+          fContext(context),
+          fFirstEntry(first_entry),
+          fLastEntry(std::max(first_entry, last_entry)),
+          fThreads(std::max(1, threads)),
+          fChunkCount((fLastEntry - fFirstEntry + kEventChunkSize - 1) / kEventChunkSize),
+          fMaxInFlight(static_cast<Long64_t>(std::max(1, threads)) * 4) {}
+
+    // [EN] Calls sink(row) for every readable entry in input order; returns false if any worker failed. An exception
+    // from a worker or the sink stops the pipeline and is rethrown once every worker has joined.
+    // [CN] 按输入顺序对每个可读事件调用 sink(row)；任一 worker 失败则返回 false。worker 或 sink 抛出的异常会停止流水线，
+    // 并在所有 worker 汇合后重新抛出。
+    template <typename Sink>
+    bool Run(Sink&& sink) {
+        std::vector<std::thread> workers;
+        workers.reserve(static_cast<std::size_t>(fThreads));
+        fActiveWorkers = fThreads;
+        for (int t = 0; t < fThreads; ++t) {
+            workers.emplace_back([this, t] { WorkerLoop(t); });
+        }
+
+        bool ok = true;
+        for (Long64_t chunk = 0; chunk < fChunkCount; ++chunk) {
+            std::vector<EventOutput> rows;
+            {
+                std::unique_lock<std::mutex> lock(fMutex);
+                fReadyCv.wait(lock, [&] { return fReady.count(chunk) > 0 || fActiveWorkers == 0 || fError; });
+                auto it = fReady.find(chunk);
+                if (it == fReady.end()) {
+                    ok = false;
+                    break;
+                }
+                rows = std::move(it->second);
+                fReady.erase(it);
+                fNextToWrite = chunk + 1;
+            }
+            fSpaceCv.notify_all();
+            try {
+                for (auto& row : rows) {
+                    if (row.valid) {
+                        sink(row);
                     }
                 }
-                ++stats->reco_proton_count;
-                event_has_reco_proton = true;
-            }
-        }
-        if (event_has_reco_proton) {
-            ++stats->proton_reco_events;
-        }
-
-        const std::vector<TBeamSimData>* beam_data = reader.GetBeamData();
-        if (beam_data) {
-            for (const auto& particle : *beam_data) {
-                if (!truth_has_proton && (particle.fParticleName == "proton" || (particle.fZ == 1 && particle.fA == 1))) {
-                    truth_has_proton = true;
-                    truth_proton_p4 = particle.fMomentum;
-                    truth_proton_pos = particle.fPosition;
-                } else if (!truth_has_neutron &&
-                           (particle.fParticleName == "neutron" || (particle.fZ == 0 && particle.fA == 1))) {
-                    truth_has_neutron = true;
-                    truth_neutron_p4 = particle.fMomentum;
-                    truth_neutron_pos = particle.fPosition;
+            } catch (...) {
+                Fail(std::current_exception());
+                ok = false;
+                break;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fAbort = true;
+        }
+        fSpaceCv.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        if (fError) {
+            std::rethrow_exception(fError);
+        }
+        return ok && !fWorkerFailed;
+    }
+
+private:
+    static constexpr Long64_t kEventChunkSize = 64;
+
+    // [EN] Nothing may escape a std::thread: the first exception is kept for Run() and the others are dropped.
+    // [CN] 异常不得逃出 std::thread：保留第一个异常交给 Run()，其余丢弃。
+    void WorkerLoop(int worker_index) {
+        try {
+            ProcessChunks(worker_index);
+        } catch (...) {
+            Fail(std::current_exception());
+            FinishWorker(true);
+        }
+    }
+
+    void Fail(std::exception_ptr error) {
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            if (!fError) {
+                fError = error;
+            }
+            fAbort = true;
+        }
+        fSpaceCv.notify_all();
+        fReadyCv.notify_all();
+    }
+
+    void ProcessChunks(int worker_index) {
+        EventDataReader reader(fInputFile.c_str(), fContext.reader_options);
+        if (!reader.IsOpen()) {
+            std::cerr << "[" << kLogTag << "] worker " << worker_index
+                      << " failed to open input file: " << fInputFile << std::endl;
+            FinishWorker(true);
+            return;
+        }
+        EventAnalyzers analyzers(fGeometry, fContext.pdc_track_finder);
+
+        while (true) {
+            const Long64_t chunk = fNextChunk.fetch_add(1);
+            if (chunk >= fChunkCount) {
+                break;
+            }
+            {
+                std::unique_lock<std::mutex> lock(fMutex);
+                fSpaceCv.wait(lock, [&] { return fAbort || chunk < fNextToWrite + fMaxInFlight; });
+                if (fAbort) {
+                    break;
                 }
             }
+
+            const Long64_t first = fFirstEntry + chunk * kEventChunkSize;
+            const Long64_t last = std::min(fLastEntry, first + kEventChunkSize);
+            std::vector<EventOutput> rows(static_cast<std::size_t>(last - first));
+            for (Long64_t entry = first; entry < last; ++entry) {
+                ReadAndReconstructEvent(reader, entry, analyzers, fContext,
+                                        &rows[static_cast<std::size_t>(entry - first)]);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(fMutex);
+                fReady.emplace(chunk, std::move(rows));
+            }
+            fReadyCv.notify_all();
+        }
+        FinishWorker(false);
+    }
+
+    void FinishWorker(bool failed) {
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            --fActiveWorkers;
+            if (failed) {
+                fWorkerFailed = true;
+            }
+        }
+        fReadyCv.notify_all();
+    }
+
+    const fs::path fInputFile;
+    const GeometryManager& fGeometry;
+    const EventRecoContext fContext;
+    const Long64_t fFirstEntry;
+    const Long64_t fLastEntry;
+    const int fThreads;
+    const Long64_t fChunkCount;
+    const Long64_t fMaxInFlight;
+
+    std::atomic<Long64_t> fNextChunk{0};
+    std::mutex fMutex;
+    std::condition_variable fReadyCv;
+    std::condition_variable fSpaceCv;
+    std::map<Long64_t, std::vector<EventOutput>> fReady;
+    Long64_t fNextToWrite = 0;
+    int fActiveWorkers = 0;
+    bool fWorkerFailed = false;
+    bool fAbort = false;
+    std::exception_ptr fError;
+};
+
+bool ProcessSingleFile(const fs::path& input_file,
+                       const fs::path& output_file,
+                       const std::string& log_tag,
+                       const std::string& backend_name,
+                       bool write_rk_errors,
+                       bool write_rk_laplace,
+                       const GeometryManager& geometry,
+                       EventAnalyzers& analyzers,
+                       const reco::PDCMomentumReconstructor& proton_reco,
+                       const reco::RecoConfig& proton_config,
+                       const reco::TargetConstraint& target_constraint,
+                       neutron::NeutronDetectorMode requested_neutron_mode,
+                       int threads,
+                       const ShardSpec& entry_shard,
+                       const EntryRange& entry_range,
+                       const EventDataReaderOptions& reader_options,
+                       const OutputFormat& output_format,
+                       const FitCacheSettings& fit_cache_settings,
+                       const RandomStreams& random_streams,
+                       double nebula_adjacency_gap_mm,
+                       bool write_timing_tree,
+                       FileStats* stats) {
+    if (!stats) {
+        return false;
+    }
+
+    EventDataReader reader(input_file.c_str(), reader_options);
+    if (!reader.IsOpen()) {
+        std::cerr << "[" << log_tag << "] failed to open input file: " << input_file << std::endl;
+        return false;
+    }
+
+    const neutron::DetectorAvailability detector_availability = BuildDetectorAvailability(reader);
+    const neutron::ResolvedNeutronDetectorMode neutron_mode =
+        neutron::ResolveNeutronDetectorMode(requested_neutron_mode, detector_availability);
+    LogNeutronRecoConfig(detector_availability, neutron_mode);
+
+    // [EN] Only decompress the neutron branches the resolved mode actually consumes. / [CN] 只解压实际使用的中子探测器分支。
+    EventDataReaderOptions effective_reader_options = reader_options;
+    const neutron::NeutronDetectorMode effective_neutron_mode = neutron_mode.effective_mode;
+    effective_reader_options.read_nebula = effective_neutron_mode == neutron::NeutronDetectorMode::kNebula ||
+                                           effective_neutron_mode == neutron::NeutronDetectorMode::kJoint;
+    effective_reader_options.read_nebula_plus = effective_neutron_mode == neutron::NeutronDetectorMode::kNebulaPlus ||
+                                                effective_neutron_mode == neutron::NeutronDetectorMode::kJoint;
+    reader.ApplyOptions(effective_reader_options);
+
+    EnsureParentDirectory(output_file);
+    TFile out(output_file.c_str(), "RECREATE");
+    if (out.IsZombie()) {
+        std::cerr << "[" << log_tag << "] failed to create output file: " << output_file << std::endl;
+        return false;
+    }
+    // [EN] Must precede tree creation: branches pick up the file setting when they are made. / [CN] 须在建树前设置，分支创建时继承文件压缩设置。
+    reco_output::ApplyCompressionProfile(out, output_format.compression);
+
+    EventOutput row;
+    RecoEvent* reco_event_ptr = &row.reco_event;
+    std::unique_ptr<TTree> reco_tree;
+    std::unique_ptr<reco_output::CompactRecoRow> compact_row;
+    std::unique_ptr<reco_output::RecoNTupleWriter> ntuple_writer;
+    if (output_format.backend == reco_output::OutputBackend::kRNTuple) {
+        ntuple_writer = std::make_unique<reco_output::RecoNTupleWriter>(out, output_format.compression);
+    } else {
+        reco_tree = std::make_unique<TTree>("recoTree", "Reconstruction tree with proton and NEBULA neutron");
+        if (output_format.schema == reco_output::OutputSchema::kCompact) {
+            compact_row = std::make_unique<reco_output::CompactRecoRow>();
+            compact_row->BindForWrite(*reco_tree, write_rk_errors, write_rk_errors && write_rk_laplace,
+                                      write_rk_errors && output_format.compact_covariance);
+        } else {
+            BindOutputBranches(*reco_tree, row, &reco_event_ptr, write_rk_errors, write_rk_laplace);
         }
+    }
+    long long compact_dropped_protons = 0;
+    long long compact_dropped_neutrons = 0;
 
-        reco_event.eventID = static_cast<int>(i);
-        reco_tree.Fill();
+    std::unique_ptr<TTree> timing_tree;
+    if (write_timing_tree) {
+        timing_tree = std::make_unique<TTree>("recoTiming", "Per-event reconstruction stage timings [ns]");
+        BindTimingBranches(*timing_tree, row);
+    }
+    auto fill_row = [&] {
+        AccumulateEventStats(row, stats);
+        SM_PROFILE_STAGE(profiling::RecoStage::kTreeFill);
+        if (compact_row) {
+            compact_row->Clear();
+            compact_row->SetEvent(row.reco_event);
+            compact_row->SetTruth(row.truth_has_proton, row.truth_proton_p4, row.truth_proton_pos,
+                                  row.truth_has_neutron, row.truth_neutron_p4, row.truth_neutron_pos);
+            compact_row->SetProtons(row.protons);
+            compact_dropped_protons += compact_row->n_proton_dropped;
+            compact_dropped_neutrons += compact_row->n_neutron_dropped;
+        }
+        if (ntuple_writer) {
+            reco_output::RecoNTupleRow& ntuple_row = ntuple_writer->Row();
+            ntuple_row.SetEvent(row.reco_event);
+            ntuple_row.SetTruth(row.truth_has_proton, row.truth_proton_p4, row.truth_proton_pos,
+                                row.truth_has_neutron, row.truth_neutron_p4, row.truth_neutron_pos);
+            ntuple_row.SetProtons(row.protons);
+            ntuple_writer->Fill();
+        } else {
+            reco_tree->Fill();
+        }
+        if (timing_tree) {
+            timing_tree->Fill();
+        }
+    };
+
+    EventRecoContext context;
+    context.reader_options = effective_reader_options;
+    context.proton_reco = &proton_reco;
+    context.proton_config = &proton_config;
+    context.target_constraint = &target_constraint;
+    std::unique_ptr<reco::PDCFitResultCache> fit_cache;
+    if (!fit_cache_settings.dir.empty()) {
+        // [EN] Entry shards of one input run as separate processes, so each gets its own append-only file.
+        // [CN] 同一输入的事件分片在不同进程运行，因此各自使用独立的追加文件。
+        const std::string shard_tag = entry_shard.count > 1
+            ? "shard" + std::to_string(entry_shard.index) + "of" + std::to_string(entry_shard.count)
+            : std::string();
+        const std::string cache_path =
+            reco::PDCFitResultCache::PathForInput(fit_cache_settings.dir, input_file.string(), shard_tag);
+        fit_cache = std::make_unique<reco::PDCFitResultCache>(fit_cache_settings.field_fingerprint);
+        std::string cache_reason;
+        if (fit_cache->Open(cache_path, &cache_reason)) {
+            context.fit_cache = fit_cache.get();
+        } else {
+            SM_WARN("Fit cache disabled for {}: {}", input_file.string(), cache_reason);
+            fit_cache.reset();
+        }
+    }
+    context.neutron_mode = neutron_mode.effective_mode;
+    context.pdc_track_finder = analyzers.pdc_ana.GetTrackFinder();
+    // [EN] Module adjacency comes from this file's own geometry parameters and is shared read-only by all workers.
+    // [CN] 模块邻接图取自本文件的几何参数，所有 worker 只读共享。
+    NEBULAModuleAdjacency nebula_adjacency;
+    if (nebula_adjacency_gap_mm >= 0.0 && effective_neutron_mode != neutron::NeutronDetectorMode::kNone) {
+        if (reader.GetNEBULAParameter()) {
+            nebula_adjacency.AddDetector(*reader.GetNEBULAParameter());
+        }
+        if (reader.GetNEBULAPlusParameter()) {
+            nebula_adjacency.AddDetector(*reader.GetNEBULAPlusParameter());
+        }
+        nebula_adjacency.Build(nebula_adjacency_gap_mm);
+        if (nebula_adjacency.GetNModules() > 0) {
+            context.nebula_adjacency = &nebula_adjacency;
+            SM_INFO("  NEBULAModuleAdjacency: modules={} neighbour_pairs={} gap_mm={}",
+                    nebula_adjacency.GetNModules(), nebula_adjacency.GetNNeighbourPairs(), nebula_adjacency_gap_mm);
+        } else {
+            SM_WARN("No NEBULA/NEBULA-Plus module parameters in {}, keeping time-only clustering",
+                    input_file.string());
+        }
+    }
+    context.random_streams = random_streams;
+    context.target_angle_rad = geometry.GetTargetAngleRad();
+    context.write_rk_errors = write_rk_errors;
+    context.write_rk_laplace = write_rk_laplace;
+
+    const Long64_t input_total_entries = reader.GetTotalEvents();
+    const Long64_t first_entry = entry_range.IsSet()
+        ? std::min(entry_range.first, input_total_entries)
+        : entry_shard.FirstEntry(input_total_entries);
+    const Long64_t last_entry = entry_range.IsSet()
+        ? std::min(entry_range.last, input_total_entries)
+        : entry_shard.LastEntry(input_total_entries);
+    stats->total_events = last_entry - first_entry;
+
+    if (threads <= 1) {
+        for (Long64_t i = first_entry; i < last_entry; ++i) {
+            if (ReadAndReconstructEvent(reader, i, analyzers, context, &row)) {
+                fill_row();
+            }
+        }
+    } else {
+        OrderedEventPipeline pipeline(input_file, geometry, context, first_entry, last_entry, threads);
+        const bool pipeline_ok = pipeline.Run([&](EventOutput& ready) {
+            row.Swap(ready);
+            fill_row();
+        });
+        if (!pipeline_ok) {
+            std::cerr << "[" << log_tag << "] multi-threaded event loop failed: " << input_file << std::endl;
+            return false;
+        }
     }
 
     const std::string processed_events_text = std::to_string(stats->processed_events);
@@ -737,6 +1319,21 @@ bool ProcessSingleFile(const fs::path& input_file,
                                     neutron_mode.ignored_nebula_plus_branch ? "true" : "false");
     TNamed info_nebula_count("InputNEBULADetectorCount", nebula_detector_count_text.c_str());
     TNamed info_nebula_plus_count("InputNEBULAPlusDetectorCount", nebula_plus_detector_count_text.c_str());
+    // [EN] Entry-range bookkeeping consumed by merge_reco_outputs; LastEntry is exclusive. / [CN] 供 merge_reco_outputs 使用的事件区间信息，LastEntry 不含。
+    const std::string shard_index_text = std::to_string(entry_shard.index);
+    const std::string shard_count_text = std::to_string(entry_shard.count);
+    const std::string first_entry_text = std::to_string(first_entry);
+    const std::string last_entry_text = std::to_string(last_entry);
+    const std::string input_entries_text = std::to_string(input_total_entries);
+    TNamed info_shard_index("ShardIndex", shard_index_text.c_str());
+    TNamed info_shard_count("ShardCount", shard_count_text.c_str());
+    TNamed info_first_entry("ShardFirstEntry", first_entry_text.c_str());
+    TNamed info_last_entry("ShardLastEntry", last_entry_text.c_str());
+    TNamed info_input_entries("InputTotalEntries", input_entries_text.c_str());
+    TNamed info_backend_format("RecoOutputFormat", reco_output::OutputBackendName(output_format.backend).c_str());
+    TNamed info_schema("RecoOutputSchema", reco_output::OutputSchemaName(output_format.schema).c_str());
+    TNamed info_compression("OutputCompression",
+                            reco_output::CompressionProfileName(output_format.compression).c_str());
     info_input.Write();
     info_backend.Write();
     info_events.Write();
@@ -751,13 +1348,192 @@ bool ProcessSingleFile(const fs::path& input_file,
     info_ignored_nebula_plus.Write();
     info_nebula_count.Write();
     info_nebula_plus_count.Write();
+    info_shard_index.Write();
+    info_shard_count.Write();
+    info_first_entry.Write();
+    info_last_entry.Write();
+    info_input_entries.Write();
+    info_backend_format.Write();
+    info_schema.Write();
+    info_compression.Write();
+    if (fit_cache) {
+        std::string cache_reason;
+        if (!fit_cache->Flush(&cache_reason)) {
+            SM_WARN("{}", cache_reason);
+        }
+        const reco::PDCFitResultCache::Stats cache_stats = fit_cache->GetStats();
+        SM_INFO("Fit cache {}: loaded={} hits={} misses={} stored={} discarded_bytes={}", fit_cache->GetPath(),
+                cache_stats.loaded, cache_stats.hits, cache_stats.misses, cache_stats.inserted,
+                cache_stats.discarded);
+    }
+    if (compact_dropped_protons > 0) {
+        SM_WARN("Compact output kept at most {} protons per event; {} protons were dropped",
+                reco_output::CompactRecoRow::kMaxProtons, compact_dropped_protons);
+    }
+    if (compact_dropped_neutrons > 0) {
+        SM_WARN("Compact output kept at most {} neutrons per event; {} neutrons were dropped",
+                reco_output::CompactRecoRow::kMaxNeutrons, compact_dropped_neutrons);
+    }
 
+    SM_PROFILE_STAGE(profiling::RecoStage::kWrite);
     out.cd();
-    reco_tree.Write();
+    if (ntuple_writer) {
+        ntuple_writer->Commit();
+    } else {
+        reco_tree->Write();
+        reco_tree.reset();
+    }
+    if (timing_tree) {
+        timing_tree->Write();
+        timing_tree.reset();
+    }
     out.Close();
     return true;
 }
 
+int ResolveWorkerCount(int requested) {
+    if (requested > 0) {
+        return requested;
+    }
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+struct FileJob {
+    std::size_t index = 0;
+    fs::path input_file;
+    fs::path output_file;
+    std::uintmax_t size_bytes = 0;
+    EntryRange entry_range;
+};
+
+// [EN] Append-only, tab-separated per-file status log (status, input, output, processed, total, seconds, output bytes).
+// The last line for an input wins, so a run killed mid-file leaves "started" and is redone on --resume; a "done" output
+// whose size changed since (truncated, rewritten) is redone as well. The "# options" line pins the settings: resuming
+// with different ones is refused.
+// [CN] 仅追加的逐文件状态清单（制表符分隔，含输出字节数）；同一输入以最后一行为准，中断时留下 "started"，--resume 时重做；
+// 记录为 "done" 但大小已变化（被截断或改写）的输出同样重做。"# options" 行固定运行设置，设置不同则拒绝续跑。
+class RunManifest {
+public:
+    RunManifest(fs::path path, std::string options_key)
+        : fPath(std::move(path)), fOptionsKey(std::move(options_key)) {}
+
+    const fs::path& Path() const { return fPath; }
+
+    bool Load(std::string* reason) {
+        std::ifstream in(fPath);
+        if (!in) {
+            // [EN] No manifest yet means nothing to resume. / [CN] 清单不存在即无可续跑内容。
+            return true;
+        }
+        // [EN] Each run starts with an "# options" line; the lines after the last one must be from these settings.
+        // [CN] 每次运行以 "# options" 行开头；最后一个该行之后的记录必须来自当前设置。
+        const std::string options_prefix = "# options\t";
+        bool options_differ = false;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.compare(0, options_prefix.size(), options_prefix) == 0) {
+                options_differ = line.substr(options_prefix.size()) != fOptionsKey;
+                if (options_differ) {
+                    fCompleted.clear();
+                }
+                continue;
+            }
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            std::vector<std::string> fields;
+            std::size_t begin = 0;
+            while (true) {
+                const std::size_t tab = line.find('\t', begin);
+                fields.push_back(line.substr(begin, tab == std::string::npos ? std::string::npos : tab - begin));
+                if (tab == std::string::npos) {
+                    break;
+                }
+                begin = tab + 1;
+            }
+            if (fields.size() < 3) {
+                if (reason) {
+                    *reason = "malformed manifest line in " + fPath.string() + ": " + line;
+                }
+                return false;
+            }
+            if (fields[0] == "done") {
+                CompletedOutput& done = fCompleted[fields[1]];
+                done.path = fields[2];
+                done.bytes = fields.size() > 6 ? std::strtoull(fields[6].c_str(), nullptr, 10) : 0;
+            } else {
+                fCompleted.erase(fields[1]);
+            }
+        }
+        if (options_differ) {
+            if (reason) {
+                *reason = "manifest " + fPath.string() +
+                          " was written with different reconstruction options; remove it or run without --resume";
+            }
+            return false;
+        }
+        return true;
+    }
+
+    bool IsCompleted(const FileJob& job) const {
+        const auto it = fCompleted.find(job.input_file.string());
+        if (it == fCompleted.end() || it->second.path != job.output_file.string()) {
+            return false;
+        }
+        std::error_code ec;
+        const std::uintmax_t bytes = fs::file_size(job.output_file, ec);
+        // [EN] Lines without a size (older manifests) only need the file to exist. / [CN] 无大小字段的旧清单行只要求文件存在。
+        return !ec && (it->second.bytes == 0 || it->second.bytes == bytes);
+    }
+
+    void Record(const FileJob& job, const char* status, const FileStats& stats, double seconds) {
+        std::lock_guard<std::mutex> lock(fMutex);
+        const bool write_header = !fs::exists(fPath);
+        std::ofstream out(fPath, std::ios::app);
+        if (!out) {
+            SM_WARN("failed to append to reconstruction manifest {}", fPath.string());
+            return;
+        }
+        if (write_header) {
+            out << "# status\tinput\toutput\tprocessed_events\ttotal_events\tseconds\toutput_bytes\n";
+        }
+        if (!fWroteOptions) {
+            out << "# options\t" << fOptionsKey << '\n';
+            fWroteOptions = true;
+        }
+        std::error_code ec;
+        const std::uintmax_t bytes = std::strcmp(status, "done") == 0 ? fs::file_size(job.output_file, ec) : 0;
+        out << status << '\t' << job.input_file.string() << '\t' << job.output_file.string() << '\t'
+            << stats.processed_events << '\t' << stats.total_events << '\t' << seconds << '\t' << (ec ? 0 : bytes)
+            << '\n';
+        out.flush();
+    }
+
+private:
+    struct CompletedOutput {
+        std::string path;
+        std::uintmax_t bytes = 0;
+    };
+
+    fs::path fPath;
+    std::string fOptionsKey;
+    bool fWroteOptions = false;
+    std::mutex fMutex;
+    std::map<std::string, CompletedOutput> fCompleted;
+};
+
+void AccumulateFileStats(const FileStats& file_stats, RunStats* run_stats) {
+    ++run_stats->files_succeeded;
+    run_stats->total_events += file_stats.total_events;
+    run_stats->processed_events += file_stats.processed_events;
+    run_stats->pdc_hit_events += file_stats.pdc_hit_events;
+    run_stats->nebula_hit_events += file_stats.nebula_hit_events;
+    run_stats->nebula_plus_hit_events += file_stats.nebula_plus_hit_events;
+    run_stats->neutron_reco_events += file_stats.neutron_reco_events;
+    run_stats->proton_reco_events += file_stats.proton_reco_events;
+    run_stats->reco_proton_count += file_stats.reco_proton_count;
+}
+
 }  // namespace
 
 int main(int argc, char* argv[]) {
@@ -777,8 +1553,6 @@ int main(int argc, char* argv[]) {
             if (!fs::exists(input_file_single)) {
                 throw std::runtime_error("input-file does not exist: " + input_file_single.string());
             }
-        } else if (!fs::exists(input_dir)) {
-            throw std::runtime_error("input-dir does not exist: " + input_dir.string());
         }
 
         if (!fs::exists(geometry_macro)) {
@@ -817,6 +1591,12 @@ int main(int argc, char* argv[]) {
         SM_INFO("  ProtonRecoBackend={}", backend_name);
         SM_INFO("  RecoNeutronRequestedMode={}",
                 neutron::NeutronDetectorModeName(opts.neutron_detector_mode));
+        if (opts.profile && !SMSIM_RECO_PROFILING) {
+            SM_WARN("--profile ignored: stage timers were compiled out (WITH_RECO_PROFILING=OFF)");
+        }
+        const bool profile = opts.profile && SMSIM_RECO_PROFILING;
+        profiling::RecoProfiler::SetEnabled(profile);
+        SM_INFO("  Profiling={}", profile ? (opts.profile_tree ? "summary+tree" : "summary") : "off");
 
         GeometryManager geometry;
         if (!reco::LoadGeometryFromMacro(geometry, geometry_macro.string())) {
@@ -831,25 +1611,10 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        PDCSimAna pdc_ana(geometry);
-        pdc_ana.SetSmearing(0.5, 0.5);
-
-        NEBULAReco nebula_reco(geometry);
-        nebula_reco.SetTargetPosition(geometry.GetTargetPosition());
-        nebula_reco.SetTimeWindow(10.0);
-        nebula_reco.SetEnergyThreshold(1.0);
+        PDCTrackFinderConfig pdc_track_finder;
+        pdc_track_finder.enabled = opts.pdc_multi_track;
+        EventAnalyzers analyzers(geometry, pdc_track_finder);
 
-        NEBULAPlusReco nebula_plus_reco(geometry);
-        nebula_plus_reco.SetTargetPosition(geometry.GetTargetPosition());
-        nebula_plus_reco.SetTimeWindow(10.0);
-        nebula_plus_reco.SetEnergyThreshold(1.0);
-
-        NebulaJointReco nebula_joint_reco(geometry);
-        nebula_joint_reco.SetTargetPosition(geometry.GetTargetPosition());
-        nebula_joint_reco.SetTimeWindow(10.0);
-        nebula_joint_reco.SetEnergyThreshold(1.0);
-
-        reco::PDCMomentumReconstructor proton_reco(magnetic_field.get());
         reco::RuntimeOptions runtime_options;
         runtime_options.backend = opts.backend;
         runtime_options.pdc_sigma_u_mm = opts.pdc_sigma_u_mm;
@@ -873,61 +1638,253 @@ int main(int argc, char* argv[]) {
 
         const reco::RecoConfig proton_config = reco::BuildRecoConfig(runtime_options, magnetic_field != nullptr);
         const reco::TargetConstraint target_constraint = reco::BuildTargetConstraint(geometry, runtime_options);
+        // [EN] Field map, config and NN weights are loaded once and shared read-only by all event threads. / [CN] 磁场、配置与 NN 权重只加载一次，由所有事件线程只读共享。
+        std::string shared_state_reason;
+        auto proton_shared_state = reco::PDCRecoFactory::CreateSharedState(
+            magnetic_field.get(), target_constraint, proton_config, &shared_state_reason);
+        if (!proton_shared_state) {
+            throw std::runtime_error("failed to prepare proton reconstruction: " + shared_state_reason);
+        }
+        const reco::PDCMomentumReconstructor proton_reco(std::move(proton_shared_state));
+        FitCacheSettings fit_cache_settings;
+        fit_cache_settings.dir = opts.fit_cache_dir;
+        if (!fit_cache_settings.dir.empty()) {
+            fit_cache_settings.field_fingerprint =
+                reco::PDCFitResultCache::FieldMapFingerprint(magnetic_field.get());
+        }
+
+        EventDataReaderOptions reader_options;
+        reader_options.cache_size_bytes =
+            opts.read_cache_mb < 0 ? -1 : static_cast<Long64_t>(opts.read_cache_mb) * 1024 * 1024;
+        reader_options.prefetch_clusters = opts.prefetch;
 
+        const bool shard_by_events = !single_file_mode && opts.shard.Enabled() && opts.shard_by_events;
         std::vector<fs::path> files;
+        std::vector<EntryRange> entry_ranges;
+        // [EN] Base for relative output paths and file hashes: the input directory, or the common parent of a glob/list.
+        // [CN] 相对输出路径与文件哈希的基准：输入目录，或通配/列表输入的公共父目录。
+        fs::path input_root = input_dir;
         if (single_file_mode) {
             files.push_back(input_file_single);
         } else {
-            files = CollectInputFiles(input_dir, opts.max_files);
-            if (files.empty()) {
-                throw std::runtime_error("no input root files found under " + input_dir.string());
+            std::string expand_reason;
+            std::vector<std::string> inputs = ChainedEventDataReader::ExpandInputs(opts.input_dir, &expand_reason);
+            if (inputs.empty()) {
+                throw std::runtime_error(expand_reason.empty() ? "no input root files found under " + opts.input_dir
+                                                               : expand_reason);
+            }
+            if (opts.max_files > 0 && static_cast<int>(inputs.size()) > opts.max_files) {
+                inputs.resize(static_cast<std::size_t>(opts.max_files));
+            }
+            std::error_code dir_ec;
+            if (!fs::is_directory(input_dir, dir_ec)) {
+                input_root = fs::path(ChainedEventDataReader::DefaultIndexCachePath(inputs)).parent_path();
+            }
+            if (shard_by_events) {
+                // [EN] Equal slices of the chained global numbering; the index is cached next to the inputs, so the
+                // N shard processes do not each reopen every file. / [CN] 按链式全局编号均分；索引缓存在输入旁，N 个分片进程无需各自重开所有文件。
+                ChainedEventDataReader chain(inputs, reader_options);
+                std::string index_reason;
+                if (!chain.BuildIndex(ChainedEventDataReader::DefaultIndexCachePath(inputs), &index_reason)) {
+                    throw std::runtime_error("failed to index input files: " + index_reason);
+                }
+                const std::pair<Long64_t, Long64_t> range = chain.PartitionRange(opts.shard.index, opts.shard.count);
+                for (const ChainedEventDataReader::FileRecord& record : chain.GetFiles()) {
+                    const Long64_t first = std::max(range.first, record.first_entry);
+                    const Long64_t last = std::min(range.second, record.first_entry + record.entries);
+                    if (first >= last) {
+                        continue;
+                    }
+                    files.emplace_back(record.path);
+                    entry_ranges.push_back(EntryRange{first - record.first_entry, last - record.first_entry});
+                }
+                SM_INFO("  ChainEvents={} ShardEvents=[{}, {}) IndexedFiles={} ScannedFiles={}",
+                        chain.GetTotalEvents(), range.first, range.second, chain.GetFiles().size(),
+                        chain.GetScannedFileCount());
+            } else {
+                files.assign(inputs.begin(), inputs.end());
+                if (opts.shard.Enabled()) {
+                    files.erase(std::remove_if(files.begin(), files.end(),
+                                               [&](const fs::path& file) {
+                                                   return StablePathHash(file, input_root) %
+                                                              static_cast<std::uint64_t>(opts.shard.count) !=
+                                                          static_cast<std::uint64_t>(opts.shard.index);
+                                               }),
+                                files.end());
+                }
             }
         }
+        entry_ranges.resize(files.size());
+        // [EN] File-hash shards process each file in full; event shards carry the shard spec for the output metadata
+        // and the fit-cache file name. / [CN] 文件哈希分片完整处理每个文件；事件分片保留分片信息，用于输出元数据与拟合缓存文件名。
+        const ShardSpec entry_shard = (single_file_mode || shard_by_events) ? opts.shard : ShardSpec{};
+        SM_INFO("  Shard={}/{} ({})", opts.shard.index, opts.shard.count,
+                !opts.shard.Enabled() ? "off"
+                                      : (single_file_mode ? "entry-range" : (shard_by_events ? "chain-events" : "file-hash")));
 
         RunStats run_stats;
         run_stats.files_total = static_cast<long long>(files.size());
 
-        for (const auto& input_file : files) {
-            const fs::path output_file = single_file_mode
+        std::vector<FileJob> jobs;
+        jobs.reserve(files.size());
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            FileJob job;
+            job.index = i;
+            job.input_file = files[i];
+            job.output_file = single_file_mode
                 ? output_file_single
-                : BuildOutputPath(input_file, input_dir, output_dir);
-            std::cout << "[" << kLogTag << "] input:  " << input_file << std::endl;
-            std::cout << "[" << kLogTag << "] output: " << output_file << std::endl;
-            std::cout << "[" << kLogTag << "] backend: " << backend_name << std::endl;
+                : BuildOutputPath(files[i], input_root, output_dir);
+            if (shard_by_events) {
+                job.output_file = BuildShardOutputPath(job.output_file, opts.shard);
+            }
+            job.entry_range = entry_ranges[i];
+            std::error_code size_ec;
+            job.size_bytes = fs::file_size(files[i], size_ec);
+            jobs.push_back(std::move(job));
+        }
 
+        std::unique_ptr<RunManifest> manifest;
+        if (!single_file_mode) {
+            std::string manifest_name = std::string(kLogTag) + "_manifest";
+            if (opts.shard.Enabled()) {
+                // [EN] One manifest per shard so concurrent batch slots never append to the same file. / [CN] 每个分片独立清单，避免并发批处理写同一文件。
+                manifest_name += ".shard" + std::to_string(opts.shard.index) + "of" + std::to_string(opts.shard.count);
+            }
+            const fs::path manifest_path = opts.manifest_file.empty()
+                ? output_dir / (manifest_name + ".tsv")
+                : fs::path(opts.manifest_file);
+            EnsureParentDirectory(manifest_path);
+            manifest = std::make_unique<RunManifest>(manifest_path, ManifestOptionsKey(opts));
+            if (opts.resume) {
+                std::string manifest_reason;
+                if (!manifest->Load(&manifest_reason)) {
+                    throw std::runtime_error(manifest_reason);
+                }
+                const std::size_t before = jobs.size();
+                jobs.erase(std::remove_if(jobs.begin(), jobs.end(),
+                                          [&](const FileJob& job) { return manifest->IsCompleted(job); }),
+                           jobs.end());
+                run_stats.files_skipped = static_cast<long long>(before - jobs.size());
+            }
+            SM_INFO("  Manifest={}", manifest->Path().string());
+        }
+
+        const int threads = ResolveWorkerCount(opts.threads);
+        const int file_jobs = static_cast<int>(
+            std::min<std::size_t>(static_cast<std::size_t>(ResolveWorkerCount(opts.jobs)),
+                                  std::max<std::size_t>(1, jobs.size())));
+        if (threads > 1 || file_jobs > 1) {
+            ROOT::EnableThreadSafety();
+        }
+        if (file_jobs > 1) {
+            // [EN] Largest files first so the long tail does not end up on a single worker. / [CN] 大文件优先，避免长尾落在单个 worker 上。
+            std::stable_sort(jobs.begin(), jobs.end(), [](const FileJob& a, const FileJob& b) {
+                return a.size_bytes > b.size_bytes;
+            });
+        }
+        SM_INFO("  ReadCache={}", opts.read_cache_mb < 0 ? std::string("default") : std::to_string(opts.read_cache_mb) + " MB");
+        SM_INFO("  Prefetch={}", opts.prefetch ? "on" : "off");
+        SM_INFO("  OutputFormat={}", reco_output::OutputBackendName(opts.output_format.backend));
+        SM_INFO("  OutputSchema={}", reco_output::OutputSchemaName(opts.output_format.schema));
+        SM_INFO("  OutputCompression={}", reco_output::CompressionProfileName(opts.output_format.compression));
+        SM_INFO("  FitCache={}", opts.fit_cache_dir.empty() ? std::string("off") : opts.fit_cache_dir);
+        SM_INFO("  RandomSeed={}", opts.random_seed);
+        SM_INFO("  EventThreads={}", threads);
+        SM_INFO("  FileJobs={}", file_jobs);
+        SM_INFO("  FilesSkippedByResume={}", run_stats.files_skipped);
+
+        const RandomStreams run_streams(static_cast<std::uint64_t>(opts.random_seed));
+        std::mutex run_mutex;
+        auto run_job = [&](const FileJob& job, EventAnalyzers& job_analyzers) {
+            {
+                std::lock_guard<std::mutex> lock(run_mutex);
+                std::cout << "[" << kLogTag << "] input:  " << job.input_file << std::endl;
+                std::cout << "[" << kLogTag << "] output: " << job.output_file << std::endl;
+                std::cout << "[" << kLogTag << "] backend: " << backend_name << std::endl;
+            }
             FileStats file_stats;
-            const bool ok = ProcessSingleFile(input_file,
-                                              output_file,
-                                              kLogTag,
-                                              backend_name,
-                                              opts.rk_write_errors,
-                                              opts.rk_write_laplace,
-                                              pdc_ana,
-                                              nebula_reco,
-                                              nebula_plus_reco,
-                                              nebula_joint_reco,
-                                              proton_reco,
-                                              proton_config,
-                                              target_constraint,
-                                              opts.neutron_detector_mode,
-                                              geometry.GetTargetAngleRad(),
-                                              &file_stats);
+            // [EN] Keyed by the file's relative path, not its position in the job list. / [CN] 以文件相对路径为键，而非其在任务列表中的位置。
+            const RandomStreams file_streams = run_streams.ForSubRun(
+                StablePathHash(job.input_file, single_file_mode ? job.input_file.parent_path() : input_root));
+            if (manifest) {
+                manifest->Record(job, "started", file_stats, 0.0);
+            }
+            const auto start_time = std::chrono::steady_clock::now();
+            bool ok = false;
+            try {
+                ok = ProcessSingleFile(job.input_file,
+                                       job.output_file,
+                                       kLogTag,
+                                       backend_name,
+                                       opts.rk_write_errors,
+                                       opts.rk_write_laplace,
+                                       geometry,
+                                       job_analyzers,
+                                       proton_reco,
+                                       proton_config,
+                                       target_constraint,
+                                       opts.neutron_detector_mode,
+                                       threads,
+                                       entry_shard,
+                                       job.entry_range,
+                                       reader_options,
+                                       opts.output_format,
+                                       fit_cache_settings,
+                                       file_streams,
+                                       opts.nebula_adjacency_gap_mm,
+                                       profile && opts.profile_tree,
+                                       &file_stats);
+            } catch (const std::exception& ex) {
+                std::cerr << "[" << kLogTag << "] failed on " << job.input_file << ": " << ex.what() << std::endl;
+            }
+            const double seconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+            if (manifest) {
+                manifest->Record(job, ok ? "done" : "failed", file_stats, seconds);
+            }
             if (!ok) {
-                continue;
+                return;
+            }
+            std::lock_guard<std::mutex> lock(run_mutex);
+            AccumulateFileStats(file_stats, &run_stats);
+            if (profile) {
+                const profiling::MemoryUsage memory = profiling::SampleMemoryUsage();
+                SM_INFO("profile: {} events={} seconds={:.3f} rss_kb={} peak_rss_kb={}",
+                        job.input_file.filename().string(), file_stats.processed_events, seconds,
+                        memory.rss_kb, memory.peak_rss_kb);
+            }
+        };
+
+        const auto run_start_time = std::chrono::steady_clock::now();
+
+        if (file_jobs <= 1) {
+            for (const auto& job : jobs) {
+                run_job(job, analyzers);
+            }
+        } else {
+            // [EN] Geometry, field map and NN weights are shared; each worker only owns its analysis objects and RNG. / [CN] 几何、磁场与 NN 权重共享；每个 worker 只持有自己的分析对象与随机数发生器。
+            std::atomic<std::size_t> next_job{0};
+            std::vector<std::thread> workers;
+            workers.reserve(static_cast<std::size_t>(file_jobs));
+            for (int w = 0; w < file_jobs; ++w) {
+                workers.emplace_back([&] {
+                    EventAnalyzers job_analyzers(geometry, pdc_track_finder);
+                    for (std::size_t j = next_job.fetch_add(1); j < jobs.size(); j = next_job.fetch_add(1)) {
+                        run_job(jobs[j], job_analyzers);
+                    }
+                });
+            }
+            for (auto& worker : workers) {
+                worker.join();
             }
-            ++run_stats.files_succeeded;
-            run_stats.total_events += file_stats.total_events;
-            run_stats.processed_events += file_stats.processed_events;
-            run_stats.pdc_hit_events += file_stats.pdc_hit_events;
-            run_stats.nebula_hit_events += file_stats.nebula_hit_events;
-            run_stats.nebula_plus_hit_events += file_stats.nebula_plus_hit_events;
-            run_stats.neutron_reco_events += file_stats.neutron_reco_events;
-            run_stats.proton_reco_events += file_stats.proton_reco_events;
-            run_stats.reco_proton_count += file_stats.reco_proton_count;
         }
 
         const double denom = run_stats.processed_events > 0 ? static_cast<double>(run_stats.processed_events) : 1.0;
-        std::cout << "[" << kLogTag << "] files: " << run_stats.files_succeeded << "/" << run_stats.files_total << std::endl;
+        std::cout << "[" << kLogTag << "] files: " << run_stats.files_succeeded << "/" << run_stats.files_total;
+        if (run_stats.files_skipped > 0) {
+            std::cout << " (+" << run_stats.files_skipped << " already done, skipped by --resume)";
+        }
+        std::cout << std::endl;
         std::cout << "[" << kLogTag << "] events processed: " << run_stats.processed_events << "/" << run_stats.total_events << std::endl;
         std::cout << "[" << kLogTag << "] pdc-hit ratio: " << (run_stats.pdc_hit_events * 100.0 / denom) << "%" << std::endl;
         std::cout << "[" << kLogTag << "] nebula-hit ratio: " << (run_stats.nebula_hit_events * 100.0 / denom) << "%" << std::endl;
@@ -935,6 +1892,16 @@ int main(int argc, char* argv[]) {
         std::cout << "[" << kLogTag << "] neutron-reco ratio: " << (run_stats.neutron_reco_events * 100.0 / denom) << "%" << std::endl;
         std::cout << "[" << kLogTag << "] proton-reco ratio: " << (run_stats.proton_reco_events * 100.0 / denom) << "%" << std::endl;
         std::cout << "[" << kLogTag << "] reco proton count: " << run_stats.reco_proton_count << std::endl;
+        if (profile) {
+            // [EN] Stage totals are summed over threads, so shares can exceed 100% with --threads/--jobs. / [CN] 各阶段时间为全部线程之和，多线程时占比可超过 100%。
+            const double run_seconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start_time).count();
+            const profiling::MemoryUsage memory = profiling::SampleMemoryUsage();
+            std::cout << "[" << kLogTag << "] profile (wall " << run_seconds << " s, rss " << memory.rss_kb
+                      << " kB, peak rss " << memory.peak_rss_kb << " kB):\n"
+                      << profiling::RecoProfiler::FormatSummary(profiling::RecoProfiler::CollectTotals(), run_seconds)
+                      << std::flush;
+        }
         SMLogger::Logger::Instance().Shutdown();
         return 0;
     } catch (const std::exception& ex) {
@@ -32,29 +32,16 @@
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 #include "G4RunManager.hh"
+#include "G4RunManagerFactory.hh"
 #include "G4UImanager.hh"
 
 #include "Randomize.hh"
 
-#include "SimDataManager.hh"
-#include "BeamSimDataInitializer.hh"
-#include "FragSimDataInitializer.hh"
-#include "NEBULASimDataInitializer.hh"
-#include "NEBULAPlusSimDataInitializer.hh"
-
-#include "NEBULASimDataConverter_TArtNEBULAPla.hh"
-#include "NEBULAPlusSimDataConverter_TArtNEBULAPlusPla.hh"
-#include "FragSimDataConverter_Basic.hh"
-#include "EventTruthConverter.hh"
-
 #include "G4PhysListFactorySAMURAI.hh"
 #include "G4VModularPhysicsList.hh"
 
 #include "DeutDetectorConstruction.hh"
-#include "DeutPrimaryGeneratorAction.hh"
-#include "RunActionBasic.hh"
-#include "EventActionBasic.hh"
-#include "TrackingActionBasic.hh"
+#include "DeutActionInitialization.hh"
 
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
@@ -63,7 +50,12 @@
 #include "G4GDMLParser.hh"
 #endif
 #include "G4PhysicalVolumeStore.hh"
+#include "TROOT.h"
+#include <algorithm>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
 
 #include "SMLogger.hh"
 
@@ -71,6 +63,22 @@
 
 int main(int argc,char** argv)
 {
+  // [EN] "-t N" / "--threads N" selects the number of worker threads and is removed from the
+  //      argument list, so the positional macro / physics list arguments keep their meaning.
+  // [CN] "-t N" / "--threads N" 指定 worker 线程数，并从参数表中移除，位置参数（宏文件 / 物理列表）含义不变。
+  G4int nThreads = 1;
+  std::vector<char*> args;
+  for (int i=0; i<argc; ++i) {
+    if ((std::strcmp(argv[i],"-t")==0 || std::strcmp(argv[i],"--threads")==0) && i+1<argc) {
+      nThreads = std::max(1, std::atoi(argv[++i]));
+      continue;
+    }
+    args.push_back(argv[i]);
+  }
+  argc = (int)args.size();
+  args.push_back(nullptr);
+  argv = args.data();
+
   SMLogger::LogConfig logConfig;
   logConfig.async = false;
   logConfig.console = true;
@@ -79,8 +87,10 @@ int main(int argc,char** argv)
   logConfig.level = SMLogger::LogLevel::INFO;
   SMLogger::Logger::Instance().Initialize(SMLogger::MakeLogConfigFromEnvironment(logConfig));
 
-  // Construct the default run manager
-  G4RunManager * runManager = new G4RunManager;
+  // Construct the run manager: sequential by default, multi-threaded with -t N (N>1)
+  if (nThreads>1) ROOT::EnableThreadSafety();
+  G4RunManager * runManager = G4RunManagerFactory::CreateRunManager(
+    nThreads>1 ? G4RunManagerType::Default : G4RunManagerType::Serial, nThreads);
 
   // detector construction
   DeutDetectorConstruction* detector = new DeutDetectorConstruction();
@@ -104,31 +114,9 @@ int main(int argc,char** argv)
   //
   CLHEP::HepRandom::setTheEngine(new CLHEP::RanecuEngine);
   
-  G4UserTrackingAction* userTrackingAction = new TrackingActionBasic;
-  runManager->SetUserAction(userTrackingAction);
-     
-  // Set user action classes
+  // Set user action classes (per thread in multi-threaded mode)
   //
-  SimDataManager* simDataManager = SimDataManager::GetSimDataManager();
-  simDataManager->RegistInitializer(new BeamSimDataInitializer);
-  simDataManager->RegistInitializer(new FragSimDataInitializer);
-  simDataManager->RegistInitializer(new NEBULASimDataInitializer);
-  simDataManager->RegistInitializer(new NEBULAPlusSimDataInitializer);
-  simDataManager->RegistConverter(new FragSimDataConverter_Basic);
-  simDataManager->RegistConverter(new NEBULASimDataConverter_TArtNEBULAPla);
-  simDataManager->RegistConverter(new NEBULAPlusSimDataConverter_TArtNEBULAPlusPla);
-  simDataManager->RegistConverter(new EventTruthConverter);
-
-  G4UserRunAction* userRunAction = new RunActionBasic;
-  runManager->SetUserAction(userRunAction);
-
-  auto userPrimaryGeneratorAction = new DeutPrimaryGeneratorAction;
-  // Put the primary generator at the position and orientation of the target
-  userPrimaryGeneratorAction->SetUseTargetParameters(true);
-  runManager->SetUserAction(userPrimaryGeneratorAction);
-
-  G4UserEventAction* userEventAction = new EventActionBasic;
-  runManager->SetUserAction(userEventAction);
+  runManager->SetUserInitialization(new DeutActionInitialization);
 
   // Initialize G4 kernel
   runManager->Initialize();
@@ -0,0 +1,411 @@
+#include "RecoEvent.hh"
+#include "RecoNTupleIO.hh"
+#include "RecoOutputSchema.hh"
+
+#include "TBranch.h"
+#include "TFile.h"
+#include "TKey.h"
+#include "TList.h"
+#include "TNamed.h"
+#include "TObjArray.h"
+#include "TTree.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+namespace reco_output = analysis::reco_output;
+
+namespace {
+
+#if defined(SMSIM_CONVERT_LOG_TAG)
+constexpr const char* kLogTag = SMSIM_CONVERT_LOG_TAG;
+#else
+constexpr const char* kLogTag = "convert_reco_output";
+#endif
+
+struct CliOptions {
+    std::string input_file;
+    std::string output_file;
+    reco_output::OutputBackend format = reco_output::OutputBackend::kTTree;
+    reco_output::OutputSchema schema = reco_output::OutputSchema::kCompact;
+    reco_output::CompressionProfile compression = reco_output::CompressionProfile::kBalanced;
+    bool benchmark = false;
+};
+
+void PrintUsage(const char* argv0) {
+    std::cout
+        << "Usage: " << argv0 << " --input FILE --output FILE [--format ttree|rntuple] [--schema legacy|compact]\n"
+        << "                   [--compression default|fast|balanced|archive] [--benchmark]\n"
+        << "  Rewrites a reconstruction output (recoTree + metadata) with another schema and/or compression.\n"
+        << "  legacy -> compact drops the RecoEvent hit collections; compact -> legacy is not possible.\n"
+        << "  Same-schema runs only recompress. Default: --schema compact --compression balanced.\n"
+        << "  --format rntuple writes a recoNTuple (legacy input only; --schema is ignored)\n"
+        << "  --benchmark      print write time, file size and full read-back time of input and output\n";
+}
+
+CliOptions ParseArgs(int argc, char* argv[]) {
+    CliOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--input" && i + 1 < argc) {
+            opts.input_file = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            opts.output_file = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            opts.format = reco_output::ParseOutputBackend(argv[++i]);
+        } else if (arg == "--schema" && i + 1 < argc) {
+            opts.schema = reco_output::ParseOutputSchema(argv[++i]);
+        } else if (arg == "--compression" && i + 1 < argc) {
+            opts.compression = reco_output::ParseCompressionProfile(argv[++i]);
+        } else if (arg == "--benchmark") {
+            opts.benchmark = true;
+        } else if (arg == "--help" || arg == "-h") {
+            PrintUsage(argv[0]);
+            std::exit(0);
+        } else {
+            throw std::runtime_error("unknown argument: " + arg);
+        }
+    }
+    if (opts.input_file.empty() || opts.output_file.empty()) {
+        throw std::runtime_error("missing required argument --input/--output");
+    }
+    if (opts.format == reco_output::OutputBackend::kRNTuple && !reco_output::RNTupleAvailable()) {
+        throw std::runtime_error("--format rntuple needs a build with WITH_RNTUPLE (ROOT >= 6.34)");
+    }
+    if (fs::exists(opts.output_file) && fs::equivalent(opts.input_file, opts.output_file)) {
+        throw std::runtime_error("--output must differ from --input");
+    }
+    return opts;
+}
+
+std::map<std::string, std::string> ReadMetadata(TFile& file) {
+    std::map<std::string, std::string> metadata;
+    TIter next_key(file.GetListOfKeys());
+    while (auto* key = static_cast<TKey*>(next_key())) {
+        if (std::string(key->GetClassName()) != "TNamed") {
+            continue;
+        }
+        if (auto* named = dynamic_cast<TNamed*>(key->ReadObj())) {
+            metadata[named->GetName()] = named->GetTitle();
+            delete named;
+        }
+    }
+    return metadata;
+}
+
+void SetBranchCompression(TObjArray* branches, int settings) {
+    if (!branches) {
+        return;
+    }
+    for (Int_t i = 0; i < branches->GetEntriesFast(); ++i) {
+        auto* branch = static_cast<TBranch*>(branches->UncheckedAt(i));
+        branch->SetCompressionSettings(settings);
+        SetBranchCompression(branch->GetListOfBranches(), settings);
+    }
+}
+
+// [EN] Binds the legacy vector branches through pointer-to-pointer addresses, as ROOT requires. / [CN] 按 ROOT 要求以指针的指针绑定旧布局向量分支。
+class LegacyRowReader {
+public:
+    explicit LegacyRowReader(TTree& tree) : fTree(tree) {
+        tree.SetBranchAddress("recoEvent", &fEvent);
+        BindIfPresent(tree, "truth_has_proton", &fTruthHasProton);
+        BindIfPresent(tree, "truth_has_neutron", &fTruthHasNeutron);
+        BindIfPresent(tree, "truth_proton_p4", &fTruthProtonP4);
+        BindIfPresent(tree, "truth_neutron_p4", &fTruthNeutronP4);
+        BindIfPresent(tree, "truth_proton_pos", &fTruthProtonPos);
+        BindIfPresent(tree, "truth_neutron_pos", &fTruthNeutronPos);
+
+        reco_output::LegacyProtonColumns& c = fColumns;
+        const std::pair<const char*, std::vector<double>*> doubles[] = {
+            {"reco_proton_px", &c.px}, {"reco_proton_py", &c.py}, {"reco_proton_pz", &c.pz},
+            {"reco_proton_e", &c.e}, {"reco_proton_p", &c.p},
+            {"reco_proton_chi2_raw", &c.chi2_raw}, {"reco_proton_chi2_reduced", &c.chi2_reduced},
+            {"reco_proton_px_sigma", &c.px_sigma}, {"reco_proton_py_sigma", &c.py_sigma},
+            {"reco_proton_pz_sigma", &c.pz_sigma}, {"reco_proton_p_sigma", &c.p_sigma},
+            {"reco_proton_px_lower68", &c.px_lower68}, {"reco_proton_px_upper68", &c.px_upper68},
+            {"reco_proton_px_lower95", &c.px_lower95}, {"reco_proton_px_upper95", &c.px_upper95},
+            {"reco_proton_py_lower68", &c.py_lower68}, {"reco_proton_py_upper68", &c.py_upper68},
+            {"reco_proton_py_lower95", &c.py_lower95}, {"reco_proton_py_upper95", &c.py_upper95},
+            {"reco_proton_pz_lower68", &c.pz_lower68}, {"reco_proton_pz_upper68", &c.pz_upper68},
+            {"reco_proton_pz_lower95", &c.pz_lower95}, {"reco_proton_pz_upper95", &c.pz_upper95},
+            {"reco_proton_p_lower68", &c.p_lower68}, {"reco_proton_p_upper68", &c.p_upper68},
+            {"reco_proton_p_lower95", &c.p_lower95}, {"reco_proton_p_upper95", &c.p_upper95},
+        };
+        const std::pair<const char*, std::vector<int>*> ints[] = {
+            {"reco_proton_status", &c.status}, {"reco_proton_method", &c.method},
+            {"reco_proton_ndf", &c.ndf}, {"reco_proton_iterations", &c.iterations},
+            {"reco_proton_uncertainty_valid", &c.uncertainty_valid},
+            {"reco_proton_posterior_valid", &c.posterior_valid},
+        };
+        fDoubles.reserve(std::size(doubles));
+        for (const auto& [name, target] : doubles) {
+            if (tree.GetBranch(name)) {
+                fDoubles.push_back({target, nullptr});
+                tree.SetBranchAddress(name, &fDoubles.back().source);
+            }
+        }
+        fInts.reserve(std::size(ints));
+        for (const auto& [name, target] : ints) {
+            if (tree.GetBranch(name)) {
+                fInts.push_back({target, nullptr});
+                tree.SetBranchAddress(name, &fInts.back().source);
+            }
+        }
+        fHasErrors = tree.GetBranch("reco_proton_p") != nullptr;
+        fHasLaplace = tree.GetBranch("reco_proton_px_lower68") != nullptr;
+    }
+
+    ~LegacyRowReader() {
+        fTree.ResetBranchAddresses();
+        delete fEvent;
+        delete fTruthProtonP4;
+        delete fTruthNeutronP4;
+        delete fTruthProtonPos;
+        delete fTruthNeutronPos;
+        for (auto& binding : fDoubles) delete binding.source;
+        for (auto& binding : fInts) delete binding.source;
+    }
+
+    bool HasErrors() const { return fHasErrors; }
+    bool HasLaplace() const { return fHasLaplace; }
+
+    void Fill(reco_output::CompactRecoRow* row) {
+        LoadColumns();
+        row->Clear();
+        if (fEvent) {
+            row->SetEvent(*fEvent);
+        }
+        row->SetTruth(fTruthHasProton, TruthP4(fTruthProtonP4), TruthPos(fTruthProtonPos),
+                      fTruthHasNeutron, TruthP4(fTruthNeutronP4), TruthPos(fTruthNeutronPos));
+        row->SetProtons(fColumns);
+    }
+
+    void Fill(reco_output::RecoNTupleRow* row) {
+        LoadColumns();
+        row->Clear();
+        if (fEvent) {
+            row->SetEvent(*fEvent);
+        }
+        row->SetTruth(fTruthHasProton, TruthP4(fTruthProtonP4), TruthPos(fTruthProtonPos),
+                      fTruthHasNeutron, TruthP4(fTruthNeutronP4), TruthPos(fTruthNeutronPos));
+        row->SetProtons(fColumns);
+    }
+
+private:
+    template <typename T>
+    struct Binding {
+        std::vector<T>* target;
+        std::vector<T>* source;
+    };
+
+    void LoadColumns() {
+        fColumns.Clear();
+        for (auto& binding : fDoubles) {
+            if (binding.source) *binding.target = *binding.source;
+        }
+        for (auto& binding : fInts) {
+            if (binding.source) *binding.target = *binding.source;
+        }
+    }
+
+    static TLorentzVector TruthP4(const TLorentzVector* p4) {
+        return p4 ? *p4 : TLorentzVector(0.0, 0.0, 0.0, 0.0);
+    }
+
+    static TVector3 TruthPos(const TVector3* pos) {
+        return pos ? *pos : TVector3(0.0, 0.0, 0.0);
+    }
+
+    template <typename T>
+    static void BindIfPresent(TTree& tree, const char* name, T* address) {
+        if (tree.GetBranch(name)) {
+            tree.SetBranchAddress(name, address);
+        }
+    }
+
+    TTree& fTree;
+    RecoEvent* fEvent = nullptr;
+    bool fTruthHasProton = false;
+    bool fTruthHasNeutron = false;
+    TLorentzVector* fTruthProtonP4 = nullptr;
+    TLorentzVector* fTruthNeutronP4 = nullptr;
+    TVector3* fTruthProtonPos = nullptr;
+    TVector3* fTruthNeutronPos = nullptr;
+    reco_output::LegacyProtonColumns fColumns;
+    std::vector<Binding<double>> fDoubles;
+    std::vector<Binding<int>> fInts;
+    bool fHasErrors = false;
+    bool fHasLaplace = false;
+};
+
+struct ReadBenchmark {
+    std::uintmax_t file_bytes = 0;
+    Long64_t entries = 0;
+    Long64_t unzipped_bytes = 0;
+    double seconds = 0.0;
+};
+
+ReadBenchmark BenchmarkRead(const fs::path& path) {
+    ReadBenchmark result;
+    result.file_bytes = fs::file_size(path);
+    TFile fin(path.c_str(), "READ");
+    if (reco_output::HasRecoNTuple(fin)) {
+        reco_output::RecoNTupleReader reader(path.string());
+        result.entries = reader.GetEntries();
+        const auto start = std::chrono::steady_clock::now();
+        for (Long64_t i = 0; i < result.entries; ++i) {
+            reader.LoadEntry(i);
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+    TTree* tree = nullptr;
+    fin.GetObject("recoTree", tree);
+    if (!tree) {
+        throw std::runtime_error("recoTree not found in " + path.string());
+    }
+    result.entries = tree->GetEntries();
+    const auto start = std::chrono::steady_clock::now();
+    for (Long64_t i = 0; i < result.entries; ++i) {
+        result.unzipped_bytes += tree->GetEntry(i);
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void PrintBenchmark(const char* label, const ReadBenchmark& bench) {
+    const double mb = static_cast<double>(bench.file_bytes) / (1024.0 * 1024.0);
+    std::cout << "[" << kLogTag << "] " << label << ": size=" << std::fixed << std::setprecision(2) << mb << " MB"
+              << " bytes/event=" << std::setprecision(1)
+              << (bench.entries > 0 ? static_cast<double>(bench.file_bytes) / static_cast<double>(bench.entries) : 0.0)
+              << " read=" << std::setprecision(3) << bench.seconds << " s"
+              << " (" << std::setprecision(0)
+              << (bench.seconds > 0.0 ? static_cast<double>(bench.entries) / bench.seconds : 0.0) << " events/s)\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        const CliOptions opts = ParseArgs(argc, argv);
+
+        TFile fin(opts.input_file.c_str(), "READ");
+        if (fin.IsZombie()) {
+            throw std::runtime_error("cannot open " + opts.input_file);
+        }
+        TTree* input_tree = nullptr;
+        fin.GetObject("recoTree", input_tree);
+        if (!input_tree) {
+            throw std::runtime_error("recoTree not found in " + opts.input_file);
+        }
+        const reco_output::OutputSchema input_schema = reco_output::DetectOutputSchema(fin, *input_tree);
+        if (input_schema == reco_output::OutputSchema::kCompact && opts.schema == reco_output::OutputSchema::kLegacy) {
+            throw std::runtime_error("compact -> legacy is not supported: hit collections are not stored in compact outputs");
+        }
+        std::map<std::string, std::string> metadata = ReadMetadata(fin);
+
+        const fs::path output_file(opts.output_file);
+        if (!output_file.parent_path().empty()) {
+            fs::create_directories(output_file.parent_path());
+        }
+        TFile out(output_file.c_str(), "RECREATE");
+        if (out.IsZombie()) {
+            throw std::runtime_error("cannot create " + output_file.string());
+        }
+        reco_output::ApplyCompressionProfile(out, opts.compression);
+        const int settings = reco_output::CompressionSettings(opts.compression);
+
+        const bool to_ntuple = opts.format == reco_output::OutputBackend::kRNTuple;
+        if (to_ntuple && input_schema != reco_output::OutputSchema::kLegacy) {
+            throw std::runtime_error("--format rntuple needs a legacy-schema input");
+        }
+        Long64_t written = 0;
+        long long dropped_protons = 0;
+        long long dropped_neutrons = 0;
+        const auto write_start = std::chrono::steady_clock::now();
+        if (to_ntuple) {
+            LegacyRowReader reader(*input_tree);
+            reco_output::RecoNTupleWriter writer(out, opts.compression);
+            const Long64_t entries = input_tree->GetEntries();
+            for (Long64_t i = 0; i < entries; ++i) {
+                input_tree->GetEntry(i);
+                reader.Fill(&writer.Row());
+                writer.Fill();
+            }
+            writer.Commit();
+            written = entries;
+        } else if (input_schema == opts.schema) {
+            // [EN] Cloned branches inherit the input compression, so reset it before copying (no "fast" basket copy). / [CN] 克隆分支继承输入压缩，复制前重设（不做 fast 拷贝）。
+            TTree* output_tree = input_tree->CloneTree(0);
+            if (settings >= 0) {
+                SetBranchCompression(output_tree->GetListOfBranches(), settings);
+            }
+            written = output_tree->CopyEntries(input_tree, -1);
+            output_tree->Write();
+        } else {
+            LegacyRowReader reader(*input_tree);
+            auto row = std::make_unique<reco_output::CompactRecoRow>();
+            TTree output_tree("recoTree", input_tree->GetTitle());
+            // [EN] Legacy outputs carry no covariance, so proton_cov is never written here. / [CN] 旧布局不含协方差，此处不写 proton_cov。
+            row->BindForWrite(output_tree, reader.HasErrors(), reader.HasLaplace(), false);
+            const Long64_t entries = input_tree->GetEntries();
+            for (Long64_t i = 0; i < entries; ++i) {
+                input_tree->GetEntry(i);
+                reader.Fill(row.get());
+                dropped_protons += row->n_proton_dropped;
+                dropped_neutrons += row->n_neutron_dropped;
+                output_tree.Fill();
+            }
+            written = output_tree.GetEntries();
+            output_tree.Write();
+        }
+
+        const double write_seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - write_start).count();
+
+        metadata["RecoOutputFormat"] = reco_output::OutputBackendName(opts.format);
+        metadata["RecoOutputSchema"] = reco_output::OutputSchemaName(to_ntuple ? input_schema : opts.schema);
+        metadata["OutputCompression"] = reco_output::CompressionProfileName(opts.compression);
+        metadata["ConvertedFrom"] = opts.input_file;
+        for (const auto& [key, value] : metadata) {
+            TNamed info(key.c_str(), value.c_str());
+            info.Write();
+        }
+        out.Close();
+        fin.Close();
+
+        std::cout << "[" << kLogTag << "] " << reco_output::OutputSchemaName(input_schema) << " -> "
+                  << (to_ntuple ? std::string("rntuple") : reco_output::OutputSchemaName(opts.schema)) << " ("
+                  << reco_output::CompressionProfileName(opts.compression) << "), entries=" << written
+                  << " write=" << std::fixed << std::setprecision(3) << write_seconds << " s"
+                  << " output=" << output_file.string() << "\n";
+        if (dropped_protons > 0) {
+            std::cerr << "[" << kLogTag << "] warning: " << dropped_protons << " protons beyond "
+                      << reco_output::CompactRecoRow::kMaxProtons << " per event were dropped\n";
+        }
+        if (dropped_neutrons > 0) {
+            std::cerr << "[" << kLogTag << "] warning: " << dropped_neutrons << " neutrons beyond "
+                      << reco_output::CompactRecoRow::kMaxNeutrons << " per event were dropped\n";
+        }
+
+        if (opts.benchmark) {
+            PrintBenchmark("input ", BenchmarkRead(opts.input_file));
+            PrintBenchmark("output", BenchmarkRead(output_file));
+        }
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "[" << kLogTag << "] failed: " << ex.what() << "\n";
+        return 1;
+    }
+}
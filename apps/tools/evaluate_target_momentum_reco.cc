@@ -1,3 +1,6 @@
+#include "RecoNTupleIO.hh"
+#include "RecoOutputSchema.hh"
+
 #include "TLorentzVector.h"
 #include "TFile.h"
 #include "TNamed.h"
@@ -13,6 +16,7 @@
 #include <iostream>
 #include <limits>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -20,6 +24,7 @@
 #include <vector>
 
 namespace fs = std::filesystem;
+namespace reco_output = analysis::reco_output;
 
 namespace {
 
@@ -290,6 +295,94 @@ EventRecord MakeEventRecord(const std::string& backend, const fs::path& source_f
     return record;
 }
 
+// [EN] Matches the reco candidate closest in |p| to the truth proton and records the residuals. / [CN] 取 |p| 最接近真值的重建候选并记录残差。
+void AccumulateEvent(const std::string& backend,
+                     const fs::path& file_path,
+                     Long64_t entry,
+                     const TLorentzVector& truth_proton_p4,
+                     const std::vector<double>* reco_proton_px,
+                     const std::vector<double>* reco_proton_py,
+                     const std::vector<double>* reco_proton_pz,
+                     Summary* summary) {
+    ++summary->events_with_truth_proton;
+
+    EventRecord record = MakeEventRecord(backend, file_path, entry);
+    record.truth_px = truth_proton_p4.Px();
+    record.truth_py = truth_proton_p4.Py();
+    record.truth_pz = truth_proton_p4.Pz();
+
+    const std::size_t count_px = reco_proton_px ? reco_proton_px->size() : 0U;
+    const std::size_t count_py = reco_proton_py ? reco_proton_py->size() : 0U;
+    const std::size_t count_pz = reco_proton_pz ? reco_proton_pz->size() : 0U;
+    const std::size_t n_reco = std::min({count_px, count_py, count_pz});
+    if (n_reco > 0U) {
+        ++summary->events_with_reco_proton;
+
+        const double truth_p = truth_proton_p4.P();
+        std::size_t best_idx = 0;
+        double best_delta_p = std::numeric_limits<double>::infinity();
+        for (std::size_t j = 0; j < n_reco; ++j) {
+            const double px = reco_proton_px->at(j);
+            const double py = reco_proton_py->at(j);
+            const double pz = reco_proton_pz->at(j);
+            const double reco_p = std::sqrt(px * px + py * py + pz * pz);
+            const double delta = std::abs(reco_p - truth_p);
+            if (delta < best_delta_p) {
+                best_delta_p = delta;
+                best_idx = j;
+            }
+        }
+
+        record.reco_px = reco_proton_px->at(best_idx);
+        record.reco_py = reco_proton_py->at(best_idx);
+        record.reco_pz = reco_proton_pz->at(best_idx);
+        record.dpx = record.reco_px - record.truth_px;
+        record.dpy = record.reco_py - record.truth_py;
+        record.dpz = record.reco_pz - record.truth_pz;
+        record.matched = true;
+
+        summary->err_px.Add(record.dpx);
+        summary->err_py.Add(record.dpy);
+        summary->err_pz.Add(record.dpz);
+        summary->err_pmag.Add(
+            std::sqrt(record.reco_px * record.reco_px + record.reco_py * record.reco_py + record.reco_pz * record.reco_pz) -
+            truth_p
+        );
+        ++summary->matched_events;
+    }
+
+    AddEventRecord(record, summary);
+}
+
+void ProcessNTupleFile(const fs::path& file_path, const std::string& backend, Summary* summary) {
+    reco_output::RecoNTupleReader reader(file_path.string());
+    const reco_output::RecoNTupleRow& row = reader.Row();
+    std::vector<double> reco_px;
+    std::vector<double> reco_py;
+    std::vector<double> reco_pz;
+    TLorentzVector truth_p4;
+
+    const Long64_t n_entries = reader.GetEntries();
+    summary->events_total += n_entries;
+    for (Long64_t i = 0; i < n_entries; ++i) {
+        reader.LoadEntry(i);
+        if (!row.truth_has_proton) {
+            continue;
+        }
+        truth_p4.SetPxPyPzE(row.truth_proton_p4[0], row.truth_proton_p4[1], row.truth_proton_p4[2],
+                            row.truth_proton_p4[3]);
+        reco_px.clear();
+        reco_py.clear();
+        reco_pz.clear();
+        for (const auto& proton : row.protons) {
+            reco_px.push_back(proton.px);
+            reco_py.push_back(proton.py);
+            reco_pz.push_back(proton.pz);
+        }
+        AccumulateEvent(backend, file_path, i, truth_p4, &reco_px, &reco_py, &reco_pz, summary);
+    }
+}
+
 void ProcessFile(const fs::path& file_path, Summary* summary) {
     if (!summary) {
         return;
@@ -300,6 +393,17 @@ void ProcessFile(const fs::path& file_path, Summary* summary) {
         std::cerr << "[" << kLogTag << "] warning: cannot open " << file_path << "\n";
         return;
     }
+    const std::string backend = ReadBackendName(fin);
+    if (reco_output::HasRecoNTuple(fin)) {
+        try {
+            ProcessNTupleFile(file_path, backend, summary);
+        } catch (const std::exception& ex) {
+            std::cerr << "[" << kLogTag << "] warning: cannot read recoNTuple in " << file_path << ": " << ex.what()
+                      << "\n";
+        }
+        return;
+    }
+
     TTree* tree = nullptr;
     fin.GetObject("recoTree", tree);
     if (!tree) {
@@ -307,76 +411,59 @@ void ProcessFile(const fs::path& file_path, Summary* summary) {
         return;
     }
 
-    const std::string backend = ReadBackendName(fin);
-
+    // [EN] Every layout is reduced to (truth momentum, reco candidates) per event. / [CN] 各种布局都归约为每事件（真值动量，重建候选）。
+    const bool compact = tree->GetBranch("n_proton") != nullptr;
     bool truth_has_proton = false;
     TLorentzVector* truth_proton_p4 = nullptr;
     std::vector<double>* reco_proton_px = nullptr;
     std::vector<double>* reco_proton_py = nullptr;
     std::vector<double>* reco_proton_pz = nullptr;
-
-    tree->SetBranchAddress("truth_has_proton", &truth_has_proton);
-    tree->SetBranchAddress("truth_proton_p4", &truth_proton_p4);
-    tree->SetBranchAddress("reco_proton_px", &reco_proton_px);
-    tree->SetBranchAddress("reco_proton_py", &reco_proton_py);
-    tree->SetBranchAddress("reco_proton_pz", &reco_proton_pz);
+    std::unique_ptr<reco_output::CompactRecoRow> compact_row;
+    std::vector<double> compact_px;
+    std::vector<double> compact_py;
+    std::vector<double> compact_pz;
+
+    if (compact) {
+        compact_row = std::make_unique<reco_output::CompactRecoRow>();
+        tree->SetBranchStatus("*", false);
+        for (const char* name : {"truth_has_proton", "truth_proton", "n_proton", "proton_px", "proton_py", "proton_pz"}) {
+            tree->SetBranchStatus(name, true);
+        }
+        compact_row->BindForRead(*tree);
+        reco_proton_px = &compact_px;
+        reco_proton_py = &compact_py;
+        reco_proton_pz = &compact_pz;
+    } else {
+        tree->SetBranchAddress("truth_has_proton", &truth_has_proton);
+        tree->SetBranchAddress("truth_proton_p4", &truth_proton_p4);
+        tree->SetBranchAddress("reco_proton_px", &reco_proton_px);
+        tree->SetBranchAddress("reco_proton_py", &reco_proton_py);
+        tree->SetBranchAddress("reco_proton_pz", &reco_proton_pz);
+    }
+    TLorentzVector compact_truth_p4;
 
     const Long64_t n_entries = tree->GetEntries();
     summary->events_total += n_entries;
 
     for (Long64_t i = 0; i < n_entries; ++i) {
         tree->GetEntry(i);
+        if (compact_row) {
+            truth_has_proton = compact_row->truth_has_proton;
+            const Float_t* truth = compact_row->truth_proton;
+            compact_truth_p4.SetPxPyPzE(truth[0], truth[1], truth[2], truth[3]);
+            truth_proton_p4 = &compact_truth_p4;
+            compact_px.assign(compact_row->proton_px, compact_row->proton_px + compact_row->n_proton);
+            compact_py.assign(compact_row->proton_py, compact_row->proton_py + compact_row->n_proton);
+            compact_pz.assign(compact_row->proton_pz, compact_row->proton_pz + compact_row->n_proton);
+        }
         if (!truth_has_proton || truth_proton_p4 == nullptr) {
             continue;
         }
-        ++summary->events_with_truth_proton;
-
-        EventRecord record = MakeEventRecord(backend, file_path, i);
-        record.truth_px = truth_proton_p4->Px();
-        record.truth_py = truth_proton_p4->Py();
-        record.truth_pz = truth_proton_p4->Pz();
-
-        const std::size_t count_px = reco_proton_px ? reco_proton_px->size() : 0U;
-        const std::size_t count_py = reco_proton_py ? reco_proton_py->size() : 0U;
-        const std::size_t count_pz = reco_proton_pz ? reco_proton_pz->size() : 0U;
-        const std::size_t n_reco = std::min({count_px, count_py, count_pz});
-        if (n_reco > 0U) {
-            ++summary->events_with_reco_proton;
-
-            const double truth_p = truth_proton_p4->P();
-            std::size_t best_idx = 0;
-            double best_delta_p = std::numeric_limits<double>::infinity();
-            for (std::size_t j = 0; j < n_reco; ++j) {
-                const double px = reco_proton_px->at(j);
-                const double py = reco_proton_py->at(j);
-                const double pz = reco_proton_pz->at(j);
-                const double reco_p = std::sqrt(px * px + py * py + pz * pz);
-                const double delta = std::abs(reco_p - truth_p);
-                if (delta < best_delta_p) {
-                    best_delta_p = delta;
-                    best_idx = j;
-                }
-            }
-
-            record.reco_px = reco_proton_px->at(best_idx);
-            record.reco_py = reco_proton_py->at(best_idx);
-            record.reco_pz = reco_proton_pz->at(best_idx);
-            record.dpx = record.reco_px - record.truth_px;
-            record.dpy = record.reco_py - record.truth_py;
-            record.dpz = record.reco_pz - record.truth_pz;
-            record.matched = true;
-
-            summary->err_px.Add(record.dpx);
-            summary->err_py.Add(record.dpy);
-            summary->err_pz.Add(record.dpz);
-            summary->err_pmag.Add(
-                std::sqrt(record.reco_px * record.reco_px + record.reco_py * record.reco_py + record.reco_pz * record.reco_pz) -
-                truth_p
-            );
-            ++summary->matched_events;
-        }
-
-        AddEventRecord(record, summary);
+        AccumulateEvent(backend, file_path, i, *truth_proton_p4, reco_proton_px, reco_proton_py, reco_proton_pz,
+                        summary);
+    }
+    if (compact) {
+        tree->ResetBranchAddresses();
     }
 }
 
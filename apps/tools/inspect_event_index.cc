@@ -0,0 +1,142 @@
+#include "ChainedEventDataReader.hh"
+#include "SMLogger.hh"
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+#if defined(SMSIM_INDEX_LOG_TAG)
+constexpr const char* kLogTag = SMSIM_INDEX_LOG_TAG;
+#else
+constexpr const char* kLogTag = "inspect_event_index";
+#endif
+
+struct CliOptions {
+    std::string inputs;
+    std::string index_file;
+    bool no_cache = false;
+    bool list_files = false;
+    int partitions = 0;
+    std::vector<long long> locate;
+};
+
+void PrintUsage(const char* argv0) {
+    std::cout
+        << "Usage: " << argv0 << " --inputs DIR|'DIR/pattern*.root'|@LIST [--index FILE | --no-cache]\n"
+        << "                   [--list] [--partitions N] [--locate GLOBAL_ENTRY ...]\n"
+        << "  Builds (or refreshes) the global event index of a chain of simulation files.\n"
+        << "  --index FILE       index cache path (default: <common input dir>/.smsim_event_index.tsv)\n"
+        << "  --list             print file, first global entry and entry count for every input\n"
+        << "  --partitions N     print the balanced global entry ranges and the files they span\n"
+        << "  --locate G         print file and local entry (= RecoEvent::eventID) of global entry G\n";
+}
+
+long long ParseLong(const std::string& text, const char* key) {
+    try {
+        return std::stoll(text);
+    } catch (...) {
+        throw std::runtime_error(std::string("invalid integer value for ") + key + ": " + text);
+    }
+}
+
+CliOptions ParseArgs(int argc, char* argv[]) {
+    CliOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--inputs" && i + 1 < argc) {
+            opts.inputs = argv[++i];
+        } else if (arg == "--index" && i + 1 < argc) {
+            opts.index_file = argv[++i];
+        } else if (arg == "--no-cache") {
+            opts.no_cache = true;
+        } else if (arg == "--list") {
+            opts.list_files = true;
+        } else if (arg == "--partitions" && i + 1 < argc) {
+            opts.partitions = static_cast<int>(ParseLong(argv[++i], "--partitions"));
+        } else if (arg == "--locate" && i + 1 < argc) {
+            opts.locate.push_back(ParseLong(argv[++i], "--locate"));
+        } else if (arg == "--help" || arg == "-h") {
+            PrintUsage(argv[0]);
+            std::exit(0);
+        } else {
+            throw std::runtime_error("unknown argument: " + arg);
+        }
+    }
+    if (opts.inputs.empty()) {
+        throw std::runtime_error("missing required argument --inputs");
+    }
+    if (opts.partitions < 0) {
+        throw std::runtime_error("--partitions must be >= 0");
+    }
+    return opts;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        const CliOptions opts = ParseArgs(argc, argv);
+
+        std::string reason;
+        std::vector<std::string> files = ChainedEventDataReader::ExpandInputs(opts.inputs, &reason);
+        if (files.empty()) {
+            throw std::runtime_error(reason);
+        }
+        const std::string index_file = opts.no_cache
+            ? std::string()
+            : (opts.index_file.empty() ? ChainedEventDataReader::DefaultIndexCachePath(files) : opts.index_file);
+
+        ChainedEventDataReader chain(std::move(files));
+        if (!chain.BuildIndex(index_file, &reason)) {
+            throw std::runtime_error("failed to build event index: " + reason);
+        }
+
+        const auto& records = chain.GetFiles();
+        std::cout << "[" << kLogTag << "] files: " << records.size()
+                  << " (scanned " << chain.GetScannedFileCount() << ")" << std::endl;
+        std::cout << "[" << kLogTag << "] events: " << chain.GetTotalEvents() << std::endl;
+        if (!index_file.empty()) {
+            std::cout << "[" << kLogTag << "] index: " << index_file << std::endl;
+        }
+
+        if (opts.list_files) {
+            for (std::size_t i = 0; i < records.size(); ++i) {
+                std::cout << i << '\t' << records[i].first_entry << '\t' << records[i].entries << '\t'
+                          << records[i].path << '\n';
+            }
+        }
+
+        for (int p = 0; p < opts.partitions; ++p) {
+            const auto range = chain.PartitionRange(p, opts.partitions);
+            std::cout << "partition " << p << "/" << opts.partitions << ": [" << range.first << ", "
+                      << range.second << ")";
+            ChainedEventDataReader::Location first;
+            ChainedEventDataReader::Location last;
+            if (range.second > range.first && chain.Locate(range.first, &first) &&
+                chain.Locate(range.second - 1, &last)) {
+                std::cout << " files " << first.file_index << ":" << first.local_entry << " .. "
+                          << last.file_index << ":" << last.local_entry;
+            }
+            std::cout << '\n';
+        }
+
+        for (const long long global_entry : opts.locate) {
+            ChainedEventDataReader::Location location;
+            if (!chain.Locate(global_entry, &location)) {
+                std::cout << global_entry << "\tout of range\n";
+                continue;
+            }
+            std::cout << global_entry << '\t' << records[location.file_index].path << '\t'
+                      << location.local_entry << '\n';
+        }
+        std::cout << std::flush;
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "[" << kLogTag << "] failed: " << ex.what() << std::endl;
+        return 1;
+    }
+}
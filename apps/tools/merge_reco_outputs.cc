@@ -0,0 +1,384 @@
+#include "RecoEvent.hh"
+
+#include "TBranch.h"
+#include "TChain.h"
+#include "TFile.h"
+#include "TKey.h"
+#include "TList.h"
+#include "TNamed.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+#if defined(SMSIM_MERGE_LOG_TAG)
+constexpr const char* kLogTag = SMSIM_MERGE_LOG_TAG;
+#else
+constexpr const char* kLogTag = "merge_reco_outputs";
+#endif
+
+// [EN] Metadata that must agree between shards; merging different reco configurations is refused unless --force. / [CN] 分片间必须一致的元数据；配置不同默认拒绝合并（--force 可跳过）。
+const char* const kMustMatchKeys[] = {
+    "ProtonRecoBackend",
+    "RkErrorBranches",
+    "RkLaplaceBranches",
+    "RecoNeutronEffectiveMode",
+    "RecoOutputSchema",
+    "ShardCount",
+};
+
+// [EN] Per-shard keys that are recomputed for the merged file instead of copied. / [CN] 合并时重新计算而非直接复制的分片级键。
+const std::set<std::string> kRecomputedKeys = {
+    "InputFile",
+    "ProcessedEvents",
+    "ShardIndex",
+    "ShardCount",
+    "ShardFirstEntry",
+    "ShardLastEntry",
+    "InputTotalEntries",
+};
+
+struct CliOptions {
+    std::string output_file;
+    std::vector<std::string> input_files;
+    bool allow_missing = false;
+    bool force = false;
+};
+
+struct ShardInfo {
+    fs::path path;
+    std::map<std::string, std::string> metadata;
+    std::string input_file;
+    long long shard_index = 0;
+    long long shard_count = 1;
+    long long first_entry = 0;
+    long long last_entry = 0;
+    long long input_total_entries = 0;
+    long long processed_events = 0;
+    long long tree_entries = 0;
+    std::vector<long long> event_ids;
+};
+
+void PrintUsage(const char* argv0) {
+    std::cout
+        << "Usage: " << argv0 << " --output-file FILE [--allow-missing] [--force] SHARD.root [SHARD.root ...]\n"
+        << "  Concatenates recoTree from reconstruct_target_momentum outputs in (InputFile, ShardFirstEntry)\n"
+        << "  order after checking that every event ID of every input appears exactly once.\n"
+        << "  --allow-missing  accept entries the reconstruction could not read (gaps inside a shard range)\n"
+        << "  --force          merge even if shard reconstruction metadata disagrees\n";
+}
+
+CliOptions ParseArgs(int argc, char* argv[]) {
+    CliOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--output-file" && i + 1 < argc) {
+            opts.output_file = argv[++i];
+        } else if (arg == "--allow-missing") {
+            opts.allow_missing = true;
+        } else if (arg == "--force") {
+            opts.force = true;
+        } else if (arg == "--help" || arg == "-h") {
+            PrintUsage(argv[0]);
+            std::exit(0);
+        } else if (!arg.empty() && arg[0] == '-') {
+            throw std::runtime_error("unknown argument: " + arg);
+        } else {
+            opts.input_files.push_back(arg);
+        }
+    }
+    if (opts.output_file.empty()) {
+        throw std::runtime_error("missing required argument --output-file");
+    }
+    if (opts.input_files.empty()) {
+        throw std::runtime_error("no shard files given");
+    }
+    return opts;
+}
+
+long long MetadataInt(const ShardInfo& shard, const char* key, long long fallback) {
+    const auto it = shard.metadata.find(key);
+    if (it == shard.metadata.end()) {
+        return fallback;
+    }
+    try {
+        return std::stoll(it->second);
+    } catch (...) {
+        throw std::runtime_error(std::string("invalid ") + key + " metadata in " + shard.path.string());
+    }
+}
+
+ShardInfo ReadShard(const fs::path& path) {
+    ShardInfo shard;
+    shard.path = path;
+
+    TFile fin(path.c_str(), "READ");
+    if (fin.IsZombie()) {
+        throw std::runtime_error("cannot open " + path.string());
+    }
+    TIter next_key(fin.GetListOfKeys());
+    while (auto* key = static_cast<TKey*>(next_key())) {
+        if (std::string(key->GetClassName()) != "TNamed") {
+            continue;
+        }
+        if (auto* named = dynamic_cast<TNamed*>(key->ReadObj())) {
+            shard.metadata[named->GetName()] = named->GetTitle();
+            delete named;
+        }
+    }
+
+    TTree* tree = nullptr;
+    fin.GetObject("recoTree", tree);
+    if (!tree) {
+        throw std::runtime_error("recoTree not found in " + path.string());
+    }
+    shard.tree_entries = tree->GetEntries();
+
+    const auto input_it = shard.metadata.find("InputFile");
+    shard.input_file = input_it != shard.metadata.end() ? input_it->second : path.string();
+    shard.processed_events = MetadataInt(shard, "ProcessedEvents", shard.tree_entries);
+    shard.shard_index = MetadataInt(shard, "ShardIndex", 0);
+    shard.shard_count = MetadataInt(shard, "ShardCount", 1);
+    shard.first_entry = MetadataInt(shard, "ShardFirstEntry", 0);
+    // [EN] Outputs written before shard metadata existed cover their whole input. / [CN] 旧输出无分片元数据，视为覆盖整个输入。
+    shard.input_total_entries = MetadataInt(shard, "InputTotalEntries", shard.tree_entries);
+    shard.last_entry = MetadataInt(shard, "ShardLastEntry", shard.input_total_entries);
+
+    shard.event_ids.reserve(static_cast<std::size_t>(shard.tree_entries));
+    if (TBranch* id_branch = tree->GetBranch("event_id")) {
+        // [EN] Compact schema: the event ID is a plain Long64_t leaf. / [CN] 紧凑布局：事件号为 Long64_t 叶。
+        Long64_t event_id = -1;
+        tree->SetBranchAddress("event_id", &event_id);
+        for (Long64_t i = 0; i < shard.tree_entries; ++i) {
+            id_branch->GetEntry(i);
+            shard.event_ids.push_back(static_cast<long long>(event_id));
+        }
+        tree->ResetBranchAddresses();
+        return shard;
+    }
+
+    // [EN] Only the recoEvent branch is read; TBranch::GetEntry skips the ~40 proton vector branches. / [CN] 只读取 recoEvent 分支，跳过约 40 个质子向量分支。
+    RecoEvent* reco_event = nullptr;
+    tree->SetBranchAddress("recoEvent", &reco_event);
+    TBranch* branch = tree->GetBranch("recoEvent");
+    if (!branch) {
+        throw std::runtime_error("recoEvent branch not found in " + path.string());
+    }
+    for (Long64_t i = 0; i < shard.tree_entries; ++i) {
+        branch->GetEntry(i);
+        shard.event_ids.push_back(reco_event ? static_cast<long long>(reco_event->eventID) : -1);
+    }
+    tree->ResetBranchAddresses();
+    delete reco_event;
+    return shard;
+}
+
+// [EN] Returns the number of problems found for one InputFile group; prints each one. / [CN] 检查同一 InputFile 的所有分片，返回问题数并逐条打印。
+int ValidateInputGroup(const std::string& input_file, const std::vector<const ShardInfo*>& shards, bool allow_missing) {
+    const std::string prefix = std::string("[") + kLogTag + "]";
+    int problems = 0;
+
+    const long long total_entries = shards.front()->input_total_entries;
+    const long long shard_count = shards.front()->shard_count;
+    std::set<long long> shard_indices;
+    long long expected_first = 0;
+    for (const ShardInfo* shard : shards) {
+        if (shard->input_total_entries != total_entries || shard->shard_count != shard_count) {
+            std::cerr << prefix << " error: " << shard->path << " disagrees on InputTotalEntries/ShardCount for "
+                      << input_file << "\n";
+            ++problems;
+        }
+        if (!shard_indices.insert(shard->shard_index).second) {
+            std::cerr << prefix << " error: shard " << shard->shard_index << " of " << input_file
+                      << " given more than once (" << shard->path << ")\n";
+            ++problems;
+        }
+        if (shard->first_entry != expected_first) {
+            std::cerr << prefix << " error: " << input_file << " entry range gap/overlap at " << expected_first
+                      << " (next shard starts at " << shard->first_entry << ", " << shard->path << ")\n";
+            ++problems;
+        }
+        expected_first = shard->last_entry;
+        if (shard->tree_entries != shard->processed_events) {
+            std::cerr << prefix << " error: " << shard->path << " has " << shard->tree_entries
+                      << " entries but ProcessedEvents=" << shard->processed_events << "\n";
+            ++problems;
+        }
+    }
+    if (expected_first != total_entries) {
+        std::cerr << prefix << " error: " << input_file << " covers entries [0, " << expected_first << ") of "
+                  << total_entries << "\n";
+        ++problems;
+    }
+
+    std::vector<unsigned char> seen(static_cast<std::size_t>(std::max(0LL, total_entries)), 0);
+    long long duplicates = 0;
+    long long out_of_range = 0;
+    for (const ShardInfo* shard : shards) {
+        for (const long long id : shard->event_ids) {
+            if (id < shard->first_entry || id >= shard->last_entry || id >= total_entries) {
+                ++out_of_range;
+                continue;
+            }
+            if (seen[static_cast<std::size_t>(id)]++) {
+                ++duplicates;
+            }
+        }
+    }
+    const long long missing = static_cast<long long>(std::count(seen.begin(), seen.end(), 0));
+    if (duplicates > 0 || out_of_range > 0) {
+        std::cerr << prefix << " error: " << input_file << " has " << duplicates << " duplicated and "
+                  << out_of_range << " out-of-range event IDs\n";
+        ++problems;
+    }
+    if (missing > 0) {
+        std::cerr << prefix << (allow_missing ? " warning: " : " error: ") << input_file << " is missing "
+                  << missing << " event IDs\n";
+        if (!allow_missing) {
+            ++problems;
+        }
+    }
+    return problems;
+}
+
+int ValidateMetadata(const std::vector<ShardInfo>& shards) {
+    const std::string prefix = std::string("[") + kLogTag + "]";
+    int problems = 0;
+    for (const char* key : kMustMatchKeys) {
+        std::set<std::string> values;
+        for (const auto& shard : shards) {
+            const auto it = shard.metadata.find(key);
+            values.insert(it != shard.metadata.end() ? it->second : std::string("<unset>"));
+        }
+        if (values.size() > 1) {
+            std::cerr << prefix << " error: shards disagree on " << key << "\n";
+            ++problems;
+        }
+    }
+    return problems;
+}
+
+void WriteMergedMetadata(const fs::path& output_file,
+                         const std::vector<ShardInfo>& shards,
+                         const std::map<std::string, std::vector<const ShardInfo*>>& groups) {
+    std::map<std::string, std::string> merged;
+    std::set<std::string> mixed;
+    for (const auto& shard : shards) {
+        for (const auto& [key, value] : shard.metadata) {
+            if (kRecomputedKeys.count(key) > 0) {
+                continue;
+            }
+            const auto [it, inserted] = merged.emplace(key, value);
+            if (!inserted && it->second != value) {
+                mixed.insert(key);
+            }
+        }
+    }
+    for (const auto& key : mixed) {
+        merged[key] = "mixed";
+    }
+
+    long long processed = 0;
+    for (const auto& shard : shards) {
+        processed += shard.tree_entries;
+    }
+    merged["ProcessedEvents"] = std::to_string(processed);
+    merged["MergedShardFiles"] = std::to_string(shards.size());
+    merged["MergedInputFiles"] = std::to_string(groups.size());
+    if (groups.size() == 1) {
+        const auto& group = groups.begin()->second;
+        merged["InputFile"] = groups.begin()->first;
+        merged["ShardIndex"] = "0";
+        merged["ShardCount"] = "1";
+        merged["ShardFirstEntry"] = "0";
+        merged["ShardLastEntry"] = std::to_string(group.front()->input_total_entries);
+        merged["InputTotalEntries"] = std::to_string(group.front()->input_total_entries);
+    } else {
+        merged["InputFile"] = "mixed";
+    }
+
+    TFile out(output_file.c_str(), "UPDATE");
+    if (out.IsZombie()) {
+        throw std::runtime_error("cannot reopen merged output for metadata: " + output_file.string());
+    }
+    for (const auto& [key, value] : merged) {
+        TNamed info(key.c_str(), value.c_str());
+        info.Write(nullptr, TObject::kOverwrite);
+    }
+    out.Close();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        const CliOptions opts = ParseArgs(argc, argv);
+        const std::string prefix = std::string("[") + kLogTag + "]";
+
+        std::vector<ShardInfo> shards;
+        shards.reserve(opts.input_files.size());
+        for (const auto& input : opts.input_files) {
+            shards.push_back(ReadShard(input));
+        }
+        // [EN] Deterministic output order: by input file, then by entry range. / [CN] 输出顺序确定：先按输入文件，再按事件区间。
+        std::sort(shards.begin(), shards.end(), [](const ShardInfo& a, const ShardInfo& b) {
+            if (a.input_file != b.input_file) {
+                return a.input_file < b.input_file;
+            }
+            return a.first_entry < b.first_entry;
+        });
+
+        std::map<std::string, std::vector<const ShardInfo*>> groups;
+        for (const auto& shard : shards) {
+            groups[shard.input_file].push_back(&shard);
+        }
+
+        int problems = ValidateMetadata(shards);
+        if (problems > 0 && opts.force) {
+            std::cerr << prefix << " warning: --force given, merging despite metadata mismatch\n";
+            problems = 0;
+        }
+        for (const auto& [input_file, group] : groups) {
+            problems += ValidateInputGroup(input_file, group, opts.allow_missing);
+        }
+        if (problems > 0) {
+            throw std::runtime_error(std::to_string(problems) + " consistency problem(s); nothing written");
+        }
+
+        const fs::path output_file(opts.output_file);
+        if (!output_file.parent_path().empty()) {
+            fs::create_directories(output_file.parent_path());
+        }
+        TChain chain("recoTree");
+        for (const auto& shard : shards) {
+            chain.Add(shard.path.c_str());
+        }
+        // [EN] "fast" copies compressed baskets without unzipping; the output keeps the input compression. / [CN] "fast" 直接拷贝压缩 basket，不解压。
+        if (chain.Merge(output_file.c_str(), "fast") <= 0) {
+            throw std::runtime_error("TChain::Merge failed for " + output_file.string());
+        }
+        WriteMergedMetadata(output_file, shards, groups);
+
+        long long entries = 0;
+        for (const auto& shard : shards) {
+            entries += shard.tree_entries;
+        }
+        std::cout << prefix << " shards=" << shards.size() << " inputs=" << groups.size() << " entries=" << entries
+                  << " output=" << output_file.string() << "\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "[" << kLogTag << "] failed: " << ex.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,277 @@
+#include "EventDataReader.hh"
+#include "EventStore.hh"
+#include "GeometryManager.hh"
+#include "MagneticField.hh"
+#include "PDCFrameRotation.hh"
+#include "PDCMomentumReconstructor.hh"
+#include "PDCRecoFactory.hh"
+#include "PDCRecoRuntime.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace event_cache = analysis::event_cache;
+namespace reco = analysis::pdc::anaroot_like;
+
+namespace {
+
+constexpr const char* kLogTag = "scan_pdc_smearing";
+
+struct CliOptions {
+    std::string input_file;
+    std::string geometry_macro;
+    std::string magnetic_field_map;
+    double magnet_rotation_deg = 30.0;
+    std::vector<double> sigmas{0.25, 0.5, 1.0, 2.0};
+    unsigned int seed = 1;
+    int threads = 1;
+    long long max_events = -1;
+};
+
+void PrintUsage(const char* argv0) {
+    std::cout
+        << "Usage: " << argv0 << " --input FILE --geometry-macro FILE [--sigmas S1,S2,...] [--seed N]\n"
+        << "                   [--threads N] [--max-events N] [--magnetic-field-map FILE [--magnet-rotation-deg DEG]]\n"
+        << "  Reads the input once into memory, then replays PDC smearing for every sigma (mm, U = V).\n"
+        << "  Reports the PDC1/PDC2 point shift against an unsmeared pass; with a field map also the\n"
+        << "  proton momentum residual (reco - truth, target frame).\n";
+}
+
+double ParseDouble(const std::string& text, const char* key) {
+    try {
+        return std::stod(text);
+    } catch (...) {
+        throw std::runtime_error(std::string("invalid numeric value for ") + key + ": " + text);
+    }
+}
+
+std::vector<double> ParseSigmaList(const std::string& text) {
+    std::vector<double> sigmas;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            sigmas.push_back(ParseDouble(item, "--sigmas"));
+        }
+    }
+    if (sigmas.empty()) {
+        throw std::runtime_error("--sigmas needs at least one value");
+    }
+    return sigmas;
+}
+
+CliOptions ParseArgs(int argc, char* argv[]) {
+    CliOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--input" && i + 1 < argc) {
+            opts.input_file = argv[++i];
+        } else if (arg == "--geometry-macro" && i + 1 < argc) {
+            opts.geometry_macro = argv[++i];
+        } else if (arg == "--magnetic-field-map" && i + 1 < argc) {
+            opts.magnetic_field_map = argv[++i];
+        } else if (arg == "--magnet-rotation-deg" && i + 1 < argc) {
+            opts.magnet_rotation_deg = ParseDouble(argv[++i], "--magnet-rotation-deg");
+        } else if (arg == "--sigmas" && i + 1 < argc) {
+            opts.sigmas = ParseSigmaList(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            opts.seed = static_cast<unsigned int>(ParseDouble(argv[++i], "--seed"));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            opts.threads = static_cast<int>(ParseDouble(argv[++i], "--threads"));
+        } else if (arg == "--max-events" && i + 1 < argc) {
+            opts.max_events = static_cast<long long>(ParseDouble(argv[++i], "--max-events"));
+        } else if (arg == "--help" || arg == "-h") {
+            PrintUsage(argv[0]);
+            std::exit(0);
+        } else {
+            throw std::runtime_error("unknown argument: " + arg);
+        }
+    }
+    if (opts.input_file.empty() || opts.geometry_macro.empty()) {
+        throw std::runtime_error("missing required argument --input or --geometry-macro");
+    }
+    for (const double sigma : opts.sigmas) {
+        if (!(sigma >= 0.0)) {
+            throw std::runtime_error("--sigmas values must be >= 0");
+        }
+    }
+    return opts;
+}
+
+struct RunningStat {
+    long long n = 0;
+    double sum = 0.0;
+    double sum2 = 0.0;
+
+    void Add(double value) {
+        ++n;
+        sum += value;
+        sum2 += value * value;
+    }
+    double Mean() const { return n > 0 ? sum / static_cast<double>(n) : std::nan(""); }
+    double Rms() const {
+        if (n < 2) {
+            return std::nan("");
+        }
+        const double mean = Mean();
+        return std::sqrt(std::max(0.0, sum2 / static_cast<double>(n) - mean * mean));
+    }
+};
+
+struct PassSummary {
+    long long tracks = 0;
+    RunningStat pdc1_shift_mm;
+    RunningStat pdc2_shift_mm;
+    RunningStat p_residual_mevc;
+    long long reco_success = 0;
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        const CliOptions opts = ParseArgs(argc, argv);
+
+        GeometryManager geometry;
+        if (!reco::LoadGeometryFromMacro(geometry, opts.geometry_macro)) {
+            throw std::runtime_error("failed to load geometry macro: " + opts.geometry_macro);
+        }
+
+        std::unique_ptr<MagneticField> magnetic_field;
+        std::unique_ptr<reco::PDCMomentumReconstructor> proton_reco;
+        if (!opts.magnetic_field_map.empty()) {
+            magnetic_field = std::make_unique<MagneticField>();
+            if (!reco::LoadMagneticField(*magnetic_field, opts.magnetic_field_map, opts.magnet_rotation_deg)) {
+                throw std::runtime_error("failed to load magnetic field map: " + opts.magnetic_field_map);
+            }
+            reco::RuntimeOptions runtime_options;
+            runtime_options.backend = reco::RuntimeBackend::kRungeKutta;
+            runtime_options.magnetic_field_rotation_deg = opts.magnet_rotation_deg;
+            runtime_options.compute_uncertainty = false;
+            runtime_options.compute_posterior_laplace = false;
+            std::string reason;
+            auto shared = reco::PDCRecoFactory::CreateSharedState(
+                magnetic_field.get(), reco::BuildTargetConstraint(geometry, runtime_options),
+                reco::BuildRecoConfig(runtime_options, true), &reason);
+            if (!shared) {
+                throw std::runtime_error("failed to prepare proton reconstruction: " + reason);
+            }
+            proton_reco = std::make_unique<reco::PDCMomentumReconstructor>(std::move(shared));
+        }
+
+        const auto load_start = std::chrono::steady_clock::now();
+        EventDataReader reader(opts.input_file.c_str());
+        if (!reader.IsOpen()) {
+            throw std::runtime_error("failed to open input file: " + opts.input_file);
+        }
+        event_cache::EventStoreOptions store_options;
+        store_options.last_entry = opts.max_events;
+        event_cache::EventStore store;
+        std::string reason;
+        if (!store.Build(reader, geometry, store_options, &reason)) {
+            throw std::runtime_error("failed to build event store: " + reason);
+        }
+        const double load_seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - load_start).count();
+        std::cout << "[" << kLogTag << "] events: " << store.GetEventCount() << ", PDC hits: "
+                  << store.GetPdcHitCount() << ", memory: " << store.MemoryBytes() / 1024 << " KiB, load: "
+                  << std::fixed << std::setprecision(2) << load_seconds << " s" << std::endl;
+
+        // [EN] Pass 0 is the unsmeared reference for the point-shift columns. / [CN] 第 0 个 pass 为未涂抹参照，用于计算点位偏移。
+        std::vector<event_cache::SmearingPass> passes(1);
+        passes[0].label = "reference";
+        passes[0].pdc_sigma_u_mm = 0.0;
+        passes[0].pdc_sigma_v_mm = 0.0;
+        passes[0].reconstruct_neutrons = false;
+        for (const double sigma : opts.sigmas) {
+            event_cache::SmearingPass pass;
+            pass.label = "sigma=" + std::to_string(sigma);
+            pass.pdc_sigma_u_mm = sigma;
+            pass.pdc_sigma_v_mm = sigma;
+            pass.seed = opts.seed;
+            pass.reconstruct_neutrons = false;
+            passes.push_back(pass);
+        }
+
+        std::vector<std::vector<RecoTrack>> reference(store.GetEventCount());
+        if (!event_cache::RunSmearingPasses(
+                store, geometry, {passes[0]},
+                [&](std::size_t, std::size_t event, const RecoEvent& reco_event) {
+                    reference[event] = reco_event.tracks;
+                },
+                1, &reason)) {
+            throw std::runtime_error(reason);
+        }
+
+        const double target_angle_rad = geometry.GetTargetAngleRad();
+        const std::vector<event_cache::SmearingPass> smeared(passes.begin() + 1, passes.end());
+        std::vector<PassSummary> summaries(smeared.size());
+        const auto scan_start = std::chrono::steady_clock::now();
+        // [EN] Each pass touches only its own summary, so the visitor needs no lock. / [CN] 每个 pass 只写自己的汇总，访问者无需加锁。
+        const bool ok = event_cache::RunSmearingPasses(
+            store, geometry, smeared,
+            [&](std::size_t pass, std::size_t event, const RecoEvent& reco_event) {
+                PassSummary& summary = summaries[pass];
+                if (reco_event.tracks.empty()) {
+                    return;
+                }
+                const RecoTrack& track = reco_event.tracks.front();
+                ++summary.tracks;
+                if (!reference[event].empty()) {
+                    summary.pdc1_shift_mm.Add((track.start - reference[event].front().start).Mag());
+                    summary.pdc2_shift_mm.Add((track.end - reference[event].front().end).Mag());
+                }
+                const event_cache::EventTruth truth = store.Truth(event);
+                if (!proton_reco || !truth.has_proton) {
+                    return;
+                }
+                reco::PDCInputTrack input;
+                input.pdc1 = track.start;
+                input.pdc2 = track.end;
+                const reco::RecoResult result = proton_reco->Reconstruct(input, nullptr);
+                if (result.status != reco::SolverStatus::kSuccess) {
+                    return;
+                }
+                ++summary.reco_success;
+                const reco::RecoResult target_frame = reco::RotateRecoResultToTargetFrame(result, target_angle_rad);
+                summary.p_residual_mevc.Add(target_frame.p4_at_target.P() - truth.proton_p4.P());
+            },
+            opts.threads, &reason);
+        if (!ok) {
+            throw std::runtime_error(reason);
+        }
+        const double scan_seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - scan_start).count();
+
+        std::cout << "sigma_mm\ttracks\tpdc1_shift_mean_mm\tpdc2_shift_mean_mm";
+        if (proton_reco) {
+            std::cout << "\treco_ok\tdp_mean_mevc\tdp_rms_mevc";
+        }
+        std::cout << '\n' << std::setprecision(4);
+        for (std::size_t p = 0; p < smeared.size(); ++p) {
+            const PassSummary& summary = summaries[p];
+            std::cout << smeared[p].pdc_sigma_u_mm << '\t' << summary.tracks << '\t'
+                      << summary.pdc1_shift_mm.Mean() << '\t' << summary.pdc2_shift_mm.Mean();
+            if (proton_reco) {
+                std::cout << '\t' << summary.reco_success << '\t' << summary.p_residual_mevc.Mean() << '\t'
+                          << summary.p_residual_mevc.Rms();
+            }
+            std::cout << '\n';
+        }
+        std::cout << "[" << kLogTag << "] " << smeared.size() << " passes in " << std::setprecision(2)
+                  << scan_seconds << " s (" << opts.threads << " threads, no re-read)" << std::endl;
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "[" << kLogTag << "] failed: " << ex.what() << std::endl;
+        return 1;
+    }
+}
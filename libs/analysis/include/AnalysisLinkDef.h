@@ -17,4 +17,11 @@
 #pragma link C++ class RecoHit+;
 #pragma link C++ class RecoNeutron+;
 
+// RNTuple 输出的逐对象记录
+#pragma link C++ namespace analysis;
+#pragma link C++ namespace analysis::reco_output;
+#pragma link C++ class analysis::reco_output::TrackRecord+;
+#pragma link C++ class analysis::reco_output::ProtonRecord+;
+#pragma link C++ class analysis::reco_output::NeutronRecord+;
+
 #endif
@@ -0,0 +1,83 @@
+#ifndef CHAINED_EVENT_DATA_READER_H
+#define CHAINED_EVENT_DATA_READER_H
+
+#include "EventDataReader.hh"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// [EN] Presents a list of simulation files as one event sequence with a global entry number.
+// The index (per-file entry counts and offsets) is built once and cached as a small TSV next to
+// the inputs, keyed by path, size and mtime, so re-opening a large chain does not touch every file.
+// A global entry maps to (file, local entry); the local entry is also the event ID the
+// reconstruction writes to RecoEvent::eventID.
+// [CN] 把一组模拟文件视为带全局编号的单一事件序列。索引（每个文件的事件数与偏移）只建立一次，
+// 并以 TSV 缓存在输入旁，按路径、大小与修改时间校验，重新打开大链时无需逐个打开文件。
+// 全局编号映射为（文件, 文件内编号），文件内编号即重建写入 RecoEvent::eventID 的事件号。
+class ChainedEventDataReader {
+public:
+    struct FileRecord {
+        std::string path;
+        Long64_t entries = 0;
+        Long64_t first_entry = 0;
+        std::uintmax_t size_bytes = 0;
+        std::int64_t mtime = 0;
+    };
+
+    struct Location {
+        std::size_t file_index = 0;
+        Long64_t local_entry = -1;
+    };
+
+    explicit ChainedEventDataReader(std::vector<std::string> files,
+                                    const EventDataReaderOptions& options = EventDataReaderOptions{});
+    ~ChainedEventDataReader();
+
+    // [EN] Expands a directory (recursive *.root, skipping *_reco.root), a glob on the file name
+    // ("dir/run_*.root") or "@list.txt" (one path per line, '#' comments) into a sorted file list.
+    // [CN] 将目录（递归 *.root，跳过 *_reco.root）、文件名通配（"dir/run_*.root"）或 "@list.txt" 展开为排序后的文件列表。
+    static std::vector<std::string> ExpandInputs(const std::string& spec, std::string* reason = nullptr);
+    // [EN] "<common parent of all inputs>/.smsim_event_index.tsv" / [CN] 所有输入公共父目录下的 .smsim_event_index.tsv
+    static std::string DefaultIndexCachePath(const std::vector<std::string>& files);
+
+    // [EN] Loads fresh records from cache_path, scans only new or changed files, then rewrites the
+    // cache (atomically; an unwritable cache is not an error). Empty cache_path disables caching.
+    // [CN] 从缓存读取仍有效的记录，只扫描新增或变化的文件，再原子地重写缓存（不可写不视为错误）。cache_path 为空则不缓存。
+    bool BuildIndex(const std::string& cache_path, std::string* reason = nullptr);
+    bool HasIndex() const { return m_indexed; }
+    std::size_t GetScannedFileCount() const { return m_scannedFiles; }
+
+    const std::vector<FileRecord>& GetFiles() const { return m_files; }
+    Long64_t GetTotalEvents() const { return m_totalEvents; }
+
+    bool Locate(Long64_t globalEntry, Location* location) const;
+    Long64_t ToGlobalEntry(std::size_t fileIndex, Long64_t localEntry) const;
+    // [EN] Contiguous global range [first, last) of partition i out of n, balanced by event count. / [CN] 第 i/n 个分区的连续全局区间 [first, last)，按事件数均分。
+    std::pair<Long64_t, Long64_t> PartitionRange(int index, int count) const;
+
+    // [EN] Opens the owning file on demand; sequential access keeps the current file open. / [CN] 按需打开所在文件；顺序访问时保持当前文件打开。
+    bool GoToEvent(Long64_t globalEntry);
+    bool NextEvent();
+
+    EventDataReader* GetCurrentReader() const { return m_reader.get(); }
+    Long64_t GetCurrentEventNumber() const { return m_currentEntry; }
+    const Location& GetCurrentLocation() const { return m_currentLocation; }
+
+private:
+    bool OpenFile(std::size_t fileIndex);
+
+    std::vector<FileRecord> m_files;
+    EventDataReaderOptions m_options;
+    std::unique_ptr<EventDataReader> m_reader;
+    std::size_t m_readerFileIndex;
+    Long64_t m_totalEvents;
+    Long64_t m_currentEntry;
+    Location m_currentLocation;
+    std::size_t m_scannedFiles;
+    bool m_indexed;
+};
+
+#endif // CHAINED_EVENT_DATA_READER_H
@@ -6,45 +6,91 @@
 #include "TClonesArray.h"
 #include "TString.h"
 #include "TLorentzVector.h"
+#include <memory>
 #include <vector>
 
 // Forward declaration for TBeamSimData from smg4lib
 class TBeamSimData;
 class TNEBULASimParameter;
 class TNEBULAPlusSimParameter;
+class TSimNameTable;
+class EventClusterPrefetcher;
+
+// [EN] Read configuration; the defaults reproduce the legacy "read every branch" behaviour.
+// Disabled branches are never decompressed and their getters return nullptr.
+// [CN] 读取配置；默认值与旧行为（读取全部分支）一致。关闭的分支不会被解压，对应 getter 返回 nullptr。
+struct EventDataReaderOptions {
+    bool read_fragments = true;
+    bool read_nebula = true;
+    bool read_nebula_plus = true;
+    bool read_beam = true;
+    // [EN] TTreeCache size in bytes: <0 keeps ROOT's default, 0 disables the cache. / [CN] TTreeCache 大小（字节）：<0 保持 ROOT 默认，0 关闭缓存。
+    Long64_t cache_size_bytes = -1;
+    // [EN] Read the next cluster's baskets on a background thread while the current one is processed (local files only).
+    // [CN] 处理当前 cluster 时由后台线程预读下一个 cluster 的 basket（仅限本地文件）。
+    bool prefetch_clusters = false;
+    // [EN] Let TTreeCacheUnzip decompress cached baskets ahead of GetEntry. / [CN] 由 TTreeCacheUnzip 在 GetEntry 之前提前解压缓存中的 basket。
+    bool parallel_unzip = false;
+};
 
 class EventDataReader {
 public:
     EventDataReader(const char* filePath);
+    EventDataReader(const char* filePath, const EventDataReaderOptions& options);
     ~EventDataReader();
 
+    EventDataReader(const EventDataReader&) = delete;
+    EventDataReader& operator=(const EventDataReader&) = delete;
+
     bool IsOpen() const { return m_file != nullptr && !m_file->IsZombie(); }
 
+    // [EN] Re-select branches and cache settings, e.g. once the neutron detector mode is known. / [CN] 重新选择分支与缓存设置，例如在确定中子探测器模式之后。
+    void ApplyOptions(const EventDataReaderOptions& options);
+    const EventDataReaderOptions& GetOptions() const { return m_options; }
+
     bool NextEvent();
     bool PrevEvent();
     bool GoToEvent(Long64_t eventNumber);
 
-    TClonesArray* GetHits() const { return m_fragSimDataArray; }
-    TClonesArray* GetNEBULAHits() const { return m_nebulaDataArray; }
-    TClonesArray* GetNEBULAPlusHits() const { return m_nebulaPlusDataArray; }
+    // [EN] Always TSimData; files written with /action/data/CompactHits are expanded from FragSimHit on read.
+    // [CN] 总是 TSimData；用 /action/data/CompactHits 写出的文件在读取时由 FragSimHit 展开。
+    TClonesArray* GetHits() const { return m_options.read_fragments ? m_fragSimDataArray : nullptr; }
+    TClonesArray* GetNEBULAHits() const { return m_options.read_nebula ? m_nebulaDataArray : nullptr; }
+    TClonesArray* GetNEBULAPlusHits() const { return m_options.read_nebula_plus ? m_nebulaPlusDataArray : nullptr; }
+    // [EN] Branch presence in the file, independent of whether it is being read. / [CN] 文件中是否存在该分支，与是否读取无关。
     bool HasNEBULABranch() const { return m_hasNEBULABranch; }
     bool HasNEBULAPlusBranch() const { return m_hasNEBULAPlusBranch; }
     const TNEBULASimParameter* GetNEBULAParameter() const { return m_nebulaParameter; }
     const TNEBULAPlusSimParameter* GetNEBULAPlusParameter() const { return m_nebulaPlusParameter; }
-    
+
     // Beam data access methods
-    const std::vector<TBeamSimData>* GetBeamData() const { return m_beamDataVector; }
+    const std::vector<TBeamSimData>* GetBeamData() const { return m_options.read_beam ? m_beamDataVector : nullptr; }
     int GetBeamParticleCount() const;
     const TBeamSimData* GetBeamParticle(int index) const;
-    
+
     Long64_t GetCurrentEventNumber() const { return m_currentEvent; }
     Long64_t GetTotalEvents() const { return m_totalEvents; }
     const char* GetFilePath() const { return m_filePath.Data(); }
+    // [EN] Bytes read from the input file so far (all branches, including cache and prefetch misses). / [CN] 迄今从输入文件读取的字节数。
+    Long64_t GetBytesRead() const { return m_file ? m_file->GetBytesRead() : 0; }
+    // [EN] Effective read settings, for diagnostics and tests. / [CN] 实际生效的读取设置，用于诊断与测试。
+    Long64_t GetCacheSize() const { return m_tree ? m_tree->GetCacheSize() : 0; }
+    bool IsBranchRead(const char* name) const {
+        return m_tree && m_tree->GetBranch(name) && m_tree->GetBranchStatus(name);
+    }
+    bool IsPrefetching() const { return m_prefetcher != nullptr; }
 
 private:
+    void Open();
+    std::vector<const char*> EnabledBranchNames() const;
+    void SchedulePrefetch(Long64_t eventNumber);
+
     TFile* m_file;
     TTree* m_tree;
     TClonesArray* m_fragSimDataArray;
+    TClonesArray* m_fragSimHitArray;
+    TSimNameTable* m_nameTable;
+    bool m_compactFragments;  // FragSimHit file: m_fragSimDataArray is owned by the reader
     TClonesArray* m_nebulaDataArray;
     TClonesArray* m_nebulaPlusDataArray;
     std::vector<TBeamSimData>* m_beamDataVector;
@@ -52,9 +98,15 @@ private:
     TNEBULAPlusSimParameter* m_nebulaPlusParameter;
     bool m_hasNEBULABranch;
     bool m_hasNEBULAPlusBranch;
+    bool m_hasBeamBranch;
     Long64_t        m_currentEvent;
     Long64_t        m_totalEvents;
     TString         m_filePath;
+    EventDataReaderOptions m_options;
+    std::unique_ptr<EventClusterPrefetcher> m_prefetcher;
+    // [EN] Entry range of the cluster whose successor was last handed to the prefetcher. / [CN] 最近一次预读请求所对应的当前 cluster 区间。
+    Long64_t        m_prefetchClusterBegin;
+    Long64_t        m_prefetchClusterEnd;
 };
 
 #endif // EVENT_DATA_READER_H
@@ -0,0 +1,134 @@
+#ifndef ANALYSIS_EVENT_STORE_HH
+#define ANALYSIS_EVENT_STORE_HH
+
+#include "GeometryManager.hh"
+#include "NEBULABaseReco.hh"
+#include "NeutronDetectorConfig.hh"
+#include "PDCSimAna.hh"
+#include "RecoEvent.hh"
+
+#include "TLorentzVector.h"
+#include "TVector3.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class EventDataReader;
+
+namespace analysis::event_cache {
+
+struct EventStoreOptions {
+    bool pdc = true;
+    bool truth = true;
+    // [EN] Neutron hits to decode; kAuto is rejected, resolve it first (ResolveNeutronDetectorMode).
+    // [CN] 要解码的中子探测器；不接受 kAuto，需先经 ResolveNeutronDetectorMode 确定。
+    neutron::NeutronDetectorMode neutron_mode = neutron::NeutronDetectorMode::kNone;
+    Long64_t first_entry = 0;
+    Long64_t last_entry = -1;  // exclusive; <0 = all entries
+};
+
+// [EN] First proton / neutron of the beam record, as selected by run_reconstruction. / [CN] 与 run_reconstruction 相同规则选出的首个质子/中子真值。
+struct EventTruth {
+    bool has_proton = false;
+    bool has_neutron = false;
+    TLorentzVector proton_p4{0.0, 0.0, 0.0, 0.0};
+    TVector3 proton_position{0.0, 0.0, 0.0};
+    TLorentzVector neutron_p4{0.0, 0.0, 0.0, 0.0};
+    TVector3 neutron_position{0.0, 0.0, 0.0};
+};
+
+// [EN] Compact in-memory copy of one input (or entry range): PDC hits, neutron-wall hits and truth decoded once
+// from EventDataReader into flat per-column arrays indexed through per-event offsets. Every further smearing or
+// reconstruction pass then runs from memory without re-reading or re-decoding the TClonesArray branches.
+// Immutable after Build(); safe to read from several threads.
+// [CN] 单个输入（或事件区间）的紧凑内存副本：PDC 击中、中子墙击中与真值从 EventDataReader 解码一次，按列存成扁平数组，
+// 经逐事件偏移索引。之后每次涂抹/重建都直接从内存运行，无需重新读取和解码 TClonesArray 分支。Build() 后不可变，可多线程读取。
+class EventStore {
+public:
+    bool Build(EventDataReader& reader,
+               const GeometryManager& geometry,
+               const EventStoreOptions& options,
+               std::string* reason = nullptr);
+    void Clear();
+
+    std::size_t GetEventCount() const { return fEntry.size(); }
+    Long64_t GetEntry(std::size_t event) const { return fEntry[event]; }
+    const EventStoreOptions& GetOptions() const { return fOptions; }
+
+    PDCHitArrays PdcHits(std::size_t event) const;
+    std::size_t GetNeutronHitCount(std::size_t event) const {
+        return fNeutronBegin[event + 1] - fNeutronBegin[event];
+    }
+    void NeutronHits(std::size_t event, std::vector<NEBULAHit>* hits) const;
+    EventTruth Truth(std::size_t event) const;
+
+    std::size_t GetPdcHitCount() const { return fPdcX.size(); }
+    std::size_t GetNeutronHitCount() const { return fNeutronModule.size(); }
+    std::size_t MemoryBytes() const;
+
+private:
+    EventStoreOptions fOptions;
+    std::vector<Long64_t> fEntry;
+
+    // [EN] PDC hits of event i are [fPdcBegin[i], fPdcBegin[i+1]). / [CN] 事件 i 的 PDC 击中为 [fPdcBegin[i], fPdcBegin[i+1])。
+    std::vector<std::uint32_t> fPdcBegin{0};
+    std::vector<double> fPdcX;
+    std::vector<double> fPdcY;
+    std::vector<double> fPdcZ;
+    std::vector<double> fPdcEnergy;
+    std::vector<signed char> fPdcPlane;
+    std::vector<signed char> fPdcLayer;
+
+    std::vector<std::uint32_t> fNeutronBegin{0};
+    std::vector<int> fNeutronModule;
+    std::vector<double> fNeutronX;
+    std::vector<double> fNeutronY;
+    std::vector<double> fNeutronZ;
+    std::vector<double> fNeutronEnergy;
+    std::vector<double> fNeutronTime;
+    std::vector<double> fNeutronQave;
+    std::vector<signed char> fNeutronWallTag;
+
+    // [EN] bit 0: proton, bit 1: neutron; kinematics as (px, py, pz, E, x, y, z) blocks of 7.
+    // [CN] 第0位：质子，第1位：中子；运动学按 (px, py, pz, E, x, y, z) 每 7 个一组。
+    std::vector<unsigned char> fTruthFlags;
+    std::vector<double> fTruthProton;
+    std::vector<double> fTruthNeutron;
+};
+
+// [EN] One smearing / reconstruction configuration replayed over an EventStore. / [CN] 在 EventStore 上重放的一组涂抹/重建配置。
+struct SmearingPass {
+    std::string label;
+    double pdc_sigma_u_mm = 0.5;
+    double pdc_sigma_v_mm = 0.5;
+    // [EN] Seed of this pass's own TRandom3; equal seeds give identical passes whatever the thread count.
+    // [CN] 本 pass 独立 TRandom3 的种子；种子相同则结果与线程数无关。
+    unsigned int seed = 1;
+    bool reconstruct_neutrons = true;
+    double nebula_time_window_ns = 10.0;
+    double nebula_energy_threshold_mev = 1.0;
+};
+
+// [EN] Called once per (pass, event) with the reconstructed event; calls for one pass are sequential and in
+// store order, different passes may run concurrently. / [CN] 每个 (pass, 事件) 调用一次；同一 pass 内按存储顺序串行，
+// 不同 pass 可能并发。
+using PassVisitor = std::function<void(std::size_t pass, std::size_t event, const RecoEvent& reco_event)>;
+
+// [EN] Runs PDCSimAna (and the NEBULA cluster reco when the store holds neutron hits) for every pass. Passes are
+// distributed over up to `threads` workers; returns false (with reason) on invalid input, or when a pass or the visitor
+// throws, in which case the remaining passes are not run.
+// [CN] 对每个 pass 运行 PDCSimAna（存有中子击中时也运行 NEBULA 聚类重建）。pass 分配给至多 threads 个线程；输入无效，
+// 或某个 pass、visitor 抛出异常时返回 false，此时其余 pass 不再运行。
+bool RunSmearingPasses(const EventStore& store,
+                       const GeometryManager& geometry,
+                       const std::vector<SmearingPass>& passes,
+                       const PassVisitor& visitor,
+                       int threads = 1,
+                       std::string* reason = nullptr);
+
+}  // namespace analysis::event_cache
+
+#endif  // ANALYSIS_EVENT_STORE_HH
@@ -6,6 +6,8 @@
 #include <vector>
 
 #include "GeometryManager.hh"
+#include "NEBULAModuleAdjacency.hh"
+#include "RandomStreams.hh"
 #include "RecoEvent.hh"
 
 // NEBULAHit struct — unified hit view. Lives here so derived classes
@@ -35,6 +37,16 @@ public:
     void SetPositionSmearing(double s)         { fPositionSmearing = s; }
     void SetTimeSmearing(double s)             { fTimeSmearing = s; }
     void SetTargetPosition(const TVector3& p)  { fTargetPosition = p; }
+    // Position/time smearing draws from the (run seed, event, "NEBULA/reco") stream until the next call.
+    void AttachRandomStream(const RandomStreams& streams, Long64_t event_id) {
+        streams.Attach(fRandom, event_id, "NEBULA/reco");
+    }
+
+    // Spatial-temporal clustering: hits merge only when they are within the time window AND sit in the
+    // same or neighbouring modules (NEBULA/NPL detector picked from wall_tag). nullptr (default) keeps
+    // the legacy time-only grouping. Not owned; must outlive the reco.
+    void SetModuleAdjacency(const NEBULAModuleAdjacency* adjacency) { fAdjacency = adjacency; }
+    const NEBULAModuleAdjacency* GetModuleAdjacency() const { return fAdjacency; }
 
     double GetTimeWindow()      const { return fTimeWindow; }
     double GetEnergyThreshold() const { return fEnergyThreshold; }
@@ -45,17 +57,28 @@ public:
     // Convenience: run pipeline and populate event (matches legacy ProcessEvent semantics).
     void ProcessEvent(RecoEvent& event);
 
+    // Hit-level entry points: ExtractHits() output can be kept (e.g. in an in-memory
+    // event store) and fed back later without the detector-specific input arrays.
+    std::vector<NEBULAHit> CollectHits() { return ExtractHits(); }
+    std::vector<RecoNeutron> ReconstructNeutrons(const std::vector<NEBULAHit>& hits);
+    void ProcessHits(const std::vector<NEBULAHit>& hits, RecoEvent& event);
+
 protected:
     // Derived classes supply the detector-specific hit extraction.
     virtual std::vector<NEBULAHit> ExtractHits() = 0;
 
     // Shared algorithm steps ported from legacy NEBULAReco.
-    std::vector<std::vector<NEBULAHit>> ClusterHits(const std::vector<NEBULAHit>& hits);
-    RecoNeutron  ReconstructFromCluster(const std::vector<NEBULAHit>& cluster);
+    // ClusterHits() fills fClusterStart/fClusterMembers (hit indices per cluster, time-ordered) and
+    // returns the number of clusters; cluster c is members [fClusterStart[c], fClusterStart[c + 1]).
+    std::size_t  ClusterHits(const std::vector<NEBULAHit>& hits);
+    RecoNeutron  ReconstructFromCluster(const std::vector<NEBULAHit>& hits, const int* members, std::size_t count);
     double       CalculateBeta(double flightLength, double tof);
     double       CalculateNeutronEnergy(double beta);
     TVector3     ApplyPositionSmearing(const TVector3& pos);
     double       ApplyTimeSmearing(double time);
+    void         ClusterByTime(const std::vector<NEBULAHit>& hits);
+    void         ClusterByModule(const std::vector<NEBULAHit>& hits);
+    int          FindRoot(int i);
 
     const GeometryManager& fGeoManager;
     TVector3 fTargetPosition{0, 0, 0};
@@ -66,10 +89,21 @@ protected:
     double fPositionSmearing = 5.0;    // mm
     double fTimeSmearing     = 0.5;    // ns
 
+    PhiloxRandom fRandom;  //! smearing generator, see AttachRandomStream()
+    const NEBULAModuleAdjacency* fAdjacency = nullptr;  //! see SetModuleAdjacency()
+
+    // Clustering scratch, reused across events so steady-state clustering does not allocate.
+    std::vector<int> fOrder;           //! hit indices sorted by time
+    std::vector<int> fParent;          //! union-find forest over hit indices
+    std::vector<int> fModuleIndex;     //! adjacency index of each hit's module (-1 = unknown)
+    std::vector<int> fClusterOf;       //! cluster label per hit
+    std::vector<int> fClusterStart;    //! CSR offsets into fClusterMembers
+    std::vector<int> fClusterMembers;  //! hit indices grouped by cluster
+
     static const double kLightSpeed;   // cm/ns
     static const double kNeutronMass;  // MeV/c²
 
-    ClassDef(NEBULABaseReco, 1);
+    ClassDef(NEBULABaseReco, 3);
 };
 
 #endif // NEBULABASERECO_HH
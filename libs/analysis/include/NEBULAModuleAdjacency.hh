@@ -0,0 +1,59 @@
+#ifndef NEBULAMODULEADJACENCY_HH
+#define NEBULAMODULEADJACENCY_HH
+
+#include "TVector3.h"
+
+#include <cstddef>
+#include <vector>
+
+class TNEBULASimParameter;
+class TNEBULAPlusSimParameter;
+
+// [EN] Module neighbourhood graph of NEBULA / NEBULA-Plus, built once per geometry from the simulation
+//      parameters. Two modules are neighbours when their boxes are at most `gap_mm` apart on every axis
+//      (touching bars of one wall, bars stacked in adjacent sub-layers). Stored as CSR index arrays, so
+//      the per-hit lookup in NEBULABaseReco is a table read plus a scan of at most a few dozen ints.
+//      Immutable after Build(): one instance can be shared by every worker of a file.
+// [CN] NEBULA / NEBULA-Plus 模块邻接图，每套几何由模拟参数构建一次。两模块在各轴上间隙均不超过 gap_mm
+//      时视为相邻（同一墙内相接的棒、相邻子层叠放的棒）。以 CSR 索引数组存储，NEBULABaseReco 中逐击中
+//      查询只需一次查表和几十个整数的扫描。Build() 之后只读，可由同一文件的所有 worker 共享。
+class NEBULAModuleAdjacency {
+public:
+    enum Detector { kNEBULA = 0, kNEBULAPlus = 1, kNDetectors = 2 };
+
+    void Clear();
+
+    // [EN] Register modules; positions are lab-frame centres in mm. / [CN] 注册模块；位置为实验室系中心（mm）。
+    void AddModule(int detector, int id, const TVector3& center, const TVector3& size);
+    void AddDetector(const TNEBULASimParameter& prm);
+    void AddDetector(const TNEBULAPlusSimParameter& prm);
+
+    // [EN] Computes the neighbour lists of every registered module. / [CN] 计算全部已注册模块的邻居表。
+    void Build(double gap_mm = 10.0);
+
+    // [EN] Dense module index of (detector, id), or -1 when the module is unknown. / [CN] (探测器, ID) 对应的稠密模块索引，未知模块返回 -1。
+    int Index(int detector, int id) const {
+        if (detector < 0 || detector >= kNDetectors || id < 0) return -1;
+        const std::vector<int>& table = fIndexByID[detector];
+        return static_cast<std::size_t>(id) < table.size() ? table[id] : -1;
+    }
+    bool Adjacent(int a, int b) const;
+
+    // [EN] Largest centre distance of any neighbour pair; the spatial cut for hits of unknown modules.
+    // [CN] 所有相邻模块对中心距离的最大值，用作未知模块击中的空间判据。
+    double GetMaxNeighbourDistance() const { return fMaxNeighbourDistance; }
+    std::size_t GetNModules() const { return fCenters.size(); }
+    std::size_t GetNNeighbourPairs() const { return fNeighbours.size() / 2; }
+    bool IsBuilt() const { return fBuilt; }
+
+private:
+    std::vector<TVector3> fCenters;
+    std::vector<TVector3> fSizes;
+    std::vector<int> fIndexByID[kNDetectors];
+    std::vector<int> fOffsets;     // CSR row starts, size GetNModules() + 1
+    std::vector<int> fNeighbours;  // CSR columns, sorted per row
+    double fMaxNeighbourDistance = 0.0;
+    bool fBuilt = false;
+};
+
+#endif // NEBULAMODULEADJACENCY_HH
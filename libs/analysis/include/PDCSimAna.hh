@@ -4,8 +4,14 @@
 #include "TObject.h"
 #include "TVector3.h"
 #include "TClonesArray.h"
+#include "TRandom3.h"
+#include "TString.h"
+#include <cstddef>
 #include <vector>
 
+class TRandom;
+class TSimData;
+
 #include "GeometryManager.hh" // Include GeometryManager
 #include "RecoEvent.hh"       // 重建事件数据结构
 
@@ -19,6 +25,63 @@ struct Hit {
     Hit(double pos, double e, double z_val) : position(pos), energy(e), z(z_val) {}
 };
 
+// [EN] Pre-decoded PDC hits of one event as parallel arrays (see analysis::event_cache::EventStore).
+// plane: 0 = PDC1, 1 = PDC2, -1 = other fID; layer: 0 = U, 1 = V, -1 = other module. Hits with plane or
+// layer -1 are kept only as raw hits, exactly like the TClonesArray path.
+// [CN] 单事件预解码 PDC 击中的并行数组视图。plane：0=PDC1，1=PDC2，-1=其它；layer：0=U，1=V，-1=其它模块。
+// plane/layer 为 -1 的击中只作为原始击中保留，与 TClonesArray 路径一致。
+struct PDCHitArrays {
+    const double* x = nullptr;
+    const double* y = nullptr;
+    const double* z = nullptr;
+    const double* energy = nullptr;
+    const signed char* plane = nullptr;
+    const signed char* layer = nullptr;
+    std::size_t size = 0;
+};
+
+// [EN] Multi-track PDC finding. Disabled by default: PDCSimAna then reconstructs one track per event from the
+// energy-weighted centre of each U/V layer. When enabled, each layer is split into 1D clusters; U x V cluster
+// combinations form space points per PDC, and PDC1/PDC2 points are paired greedily by a score combining the
+// vertical straight-line residual (no vertical bending in the dipole, so y must extrapolate linearly from the
+// target), the angle to the PDC normal and the U/V energy asymmetry of both points (ghost suppression).
+// Events whose layers hold at most one cluster each, or where no pair passes the cuts, fall back to the
+// single-track path, so single-track output and cost are unchanged.
+// [CN] 多径迹 PDC 寻迹。默认关闭：每事件用各 U/V 层的能量加权中心重建一条径迹。开启后每层分为一维团簇，U x V 团簇组合
+// 构成各 PDC 的空间点，再按得分贪心配对 PDC1/PDC2 点；得分综合竖直直线残差（二极磁铁不偏转竖直方向，y 应从靶点线性外推）、
+// 与 PDC 法向的夹角以及两点的 U/V 能量不对称度（抑制鬼点）。每层至多一个团簇或无配对通过时回退到单径迹路径，
+// 因此单径迹事件的输出与开销不变。
+struct PDCTrackFinderConfig {
+    bool enabled = false;
+    double cluster_gap_mm = 10.0;           // neighbouring hits closer than this along U/V share a cluster
+    double max_uv_energy_asymmetry = 0.8;   // |E_U - E_V| / (E_U + E_V) above this rejects a space point
+    double max_y_residual_mm = 40.0;        // vertical straight-line residual at PDC2
+    double max_normal_angle_rad = 0.6;      // PDC1 -> PDC2 direction vs PDC normal (x-z plane)
+    std::size_t max_tracks = 4;
+    std::size_t max_clusters_per_layer = 16;  // busier layers fall back to the single-track path
+};
+
+// [EN] Maps TSimData detector/module names to the integer plane/layer codes above. A run only carries a handful of
+// distinct names, so each is pattern-matched once and every later hit costs a length check plus a short memcmp
+// against the cached entry (most recent name first) instead of a substring search.
+// [CN] 把 TSimData 的探测器/模块名映射为上述整数 plane/layer 编码。一次运行只有少数几种名字，每种只做一次模式匹配，
+// 之后每个击中只需与缓存项（最近使用者优先）做长度比较和短 memcmp，而非子串搜索。
+class PDCHitClassifier {
+public:
+    // [EN] false for non-PDC hits; otherwise plane/layer as in PDCHitArrays. / [CN] 非 PDC 击中返回 false；否则按 PDCHitArrays 约定给出 plane/layer。
+    bool Classify(const TSimData& hit, signed char* plane, signed char* layer);
+
+private:
+    struct NameCode {
+        TString name;
+        signed char code;
+    };
+    static signed char Lookup(std::vector<NameCode>& table, const TString& name, bool detector);
+
+    std::vector<NameCode> fDetectors;
+    std::vector<NameCode> fModules;
+};
+
 class PDCSimAna : public TObject {
 public:
     // Constructor now takes a reference to the geometry manager
@@ -27,12 +90,20 @@ public:
 
     // --- Configuration ---
     void SetSmearing(double sigma_u, double sigma_v);
+    // [EN] Use a caller-owned generator for smearing instead of the instance's own TRandom3. / [CN] 使用调用方持有的随机数发生器代替实例自带的 TRandom3。
+    void SetRandomGenerator(TRandom* rng) { fRandom = rng; }
+    // [EN] Reseeds the instance's own generator (default seed 4357, the same as a fresh gRandom). / [CN] 重设实例自带发生器的种子（默认 4357，与新建的 gRandom 相同）。
+    void SetSeed(UInt_t seed) { fOwnRandom.SetSeed(seed); }
+    void SetTrackFinder(const PDCTrackFinderConfig& config) { fTrackFinder = config; }
+    const PDCTrackFinderConfig& GetTrackFinder() const { return fTrackFinder; }
 
     // --- Main Processing Method ---
     // 处理原始 hits 并返回重建结果
     RecoEvent ProcessEvent(TClonesArray* fragSimData);
     // 处理批处理版本（填充已有的 RecoEvent 对象，可用于批处理）
     void ProcessEvent(TClonesArray* fragSimData, RecoEvent& outEvent);
+    // [EN] Same result (for the same generator state) without touching TSimData objects. / [CN] 不访问 TSimData 对象，结果与上面一致（随机数状态相同时）。
+    void ProcessEvent(const PDCHitArrays& hits, RecoEvent& outEvent);
 
     // --- 为了向后兼容的 Getters ---
     TVector3 GetRecoPoint1() const { return fRecoPoint1; }
@@ -42,12 +113,54 @@ public:
 private:
     // --- Helper Methods ---
     void ClearAll();
+    void UpdateFrame();
+    void AddLayerHit(int plane, int layer, const TVector3& pos, double energy);
+    void SmearAndReconstruct(RecoEvent& outEvent);
     TVector3 ReconstructPDC(const std::vector<Hit>& u_hits, const std::vector<Hit>& v_hits, const TVector3& pdc_position) const;
+    TVector3 ToGlobal(double u, double v, const TVector3& pdc_position) const;
     double CalculateCoM(const std::vector<Hit>& hits) const;
 
+    // --- Multi-track finding (PDCSimAnaTrackFinder.cc) ---
+    struct LayerCluster {
+        double position;
+        double energy;
+    };
+    struct SpacePoint {
+        TVector3 position;
+        int u_cluster;
+        int v_cluster;
+        double asymmetry;
+    };
+    struct TrackPair {
+        int p1;
+        int p2;
+        double score;
+    };
+    bool FindTracks(RecoEvent& outEvent);
+    bool BuildClusters(const std::vector<Hit>& hits, std::vector<LayerCluster>& clusters);
+    void BuildSpacePoints(const std::vector<LayerCluster>& u, const std::vector<LayerCluster>& v,
+                          const TVector3& pdc_position, std::vector<SpacePoint>& points) const;
+
     // --- Geometry ---
     const GeometryManager& fGeoManager;
     double fSigmaU, fSigmaV;
+    TRandom* fRandom; //! not owned; nullptr means fOwnRandom
+    TRandom3 fOwnRandom; //!
+    PDCHitClassifier fClassifier; //!
+
+    // --- Cached PDC frame (refreshed when the geometry angle / centers change) ---
+    double fFrameAngle; //!
+    double fCosAngle, fSinAngle; //!
+    double fCosNegAngle, fSinNegAngle; //!
+    TVector3 fFramePDC1, fFramePDC2; //! geometry centers the cache was built from
+    TVector3 fPDC1Rotated, fPDC2Rotated; //!
+
+    // --- Multi-track finding configuration and per-event scratch ---
+    PDCTrackFinderConfig fTrackFinder; //!
+    std::vector<Hit> fSortScratch; //!
+    std::vector<LayerCluster> fClustersU1, fClustersV1, fClustersU2, fClustersV2; //!
+    std::vector<SpacePoint> fPoints1, fPoints2; //!
+    std::vector<TrackPair> fPairs, fAccepted; //!
 
     // --- Internal Hit Storage ---
     std::vector<Hit> fU1_hits, fV1_hits, fU2_hits, fV2_hits;
@@ -57,7 +170,7 @@ private:
     TVector3 fRecoPoint1;
     TVector3 fRecoPoint2;
 
-    ClassDef(PDCSimAna, 4); // Version 4 of the class
+    ClassDef(PDCSimAna, 6); // Version 6 of the class
 };
 
 #endif // PDCSIMANA_HH
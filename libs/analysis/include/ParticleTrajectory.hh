@@ -27,7 +27,7 @@ public:
     };
 
 private:
-    MagneticField* fMagField;           // Magnetic field object
+    const MagneticField* fMagField;     // Magnetic field object (read-only, shareable across threads)
     double fStepSize;                   // Integration step size [mm]
     double fMaxTime;                    // Maximum integration time [ns]
     double fMaxDistance;                // Maximum distance from origin [mm]
@@ -38,7 +38,7 @@ private:
     static const double kChargeUnit;    // Elementary charge unit for B-field calculation
     
 public:
-    ParticleTrajectory(MagneticField* magField);
+    ParticleTrajectory(const MagneticField* magField);
     ~ParticleTrajectory();
     
     // Configuration methods
@@ -0,0 +1,93 @@
+#ifndef RECO_NTUPLE_IO_HH
+#define RECO_NTUPLE_IO_HH
+
+#include "RecoEvent.hh"
+#include "RecoNTupleRecords.hh"
+#include "RecoOutputSchema.hh"
+
+#include "TLorentzVector.h"
+#include "TVector3.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TFile;
+
+namespace analysis::reco_output {
+
+// [EN] Name of the RNTuple written next to (instead of) recoTree. / [CN] 代替 recoTree 写出的 RNTuple 名称。
+inline constexpr const char* kRecoNTupleName = "recoNTuple";
+
+// [EN] One RNTuple entry. Top-level fields keep the legacy branch names so RDataFrame code can
+// switch backends by changing only the dataset name. / [CN] 单条 RNTuple 记录；顶层字段沿用旧分支名。
+struct RecoNTupleRow {
+    std::int64_t event_id = -1;
+    bool truth_has_proton = false;
+    bool truth_has_neutron = false;
+    // [EN] (px, py, pz, E) and (x, y, z) / [CN] (px, py, pz, E) 与 (x, y, z)
+    std::array<double, 4> truth_proton_p4{};
+    std::array<double, 4> truth_neutron_p4{};
+    std::array<double, 3> truth_proton_pos{};
+    std::array<double, 3> truth_neutron_pos{};
+    std::vector<TrackRecord> tracks;
+    std::vector<ProtonRecord> protons;
+    std::vector<NeutronRecord> neutrons;
+
+    void Clear();
+    void SetTruth(bool has_proton, const TLorentzVector& proton_p4, const TVector3& proton_pos,
+                  bool has_neutron, const TLorentzVector& neutron_p4, const TVector3& neutron_pos);
+    // [EN] Copies eventID, tracks and neutrons; hits are not part of the RNTuple model. / [CN] 复制事件号、径迹与中子；不含击中。
+    void SetEvent(const RecoEvent& event);
+    void SetProtons(const LegacyProtonColumns& columns);
+};
+
+// [EN] Compile-time availability of the backend (WITH_RNTUPLE and ROOT >= 6.34). / [CN] 编译期是否启用 RNTuple 后端。
+bool RNTupleAvailable();
+// [EN] True if the file holds a kRecoNTupleName key. / [CN] 文件中是否存在 kRecoNTupleName。
+bool HasRecoNTuple(TFile& file);
+
+// [EN] Appends kRecoNTupleName to an open TFile, so TNamed metadata and side trees can share the file.
+// Commit() must run before the TFile is closed. Constructors throw std::runtime_error when the
+// backend is not compiled in.
+// [CN] 向已打开的 TFile 追加 RNTuple，元数据与旁路树可同在一个文件；关闭 TFile 前须调用 Commit()。
+// 未编译该后端时构造函数抛出 std::runtime_error。
+class RecoNTupleWriter {
+public:
+    RecoNTupleWriter(TFile& file, CompressionProfile compression);
+    ~RecoNTupleWriter();
+    RecoNTupleWriter(const RecoNTupleWriter&) = delete;
+    RecoNTupleWriter& operator=(const RecoNTupleWriter&) = delete;
+
+    // [EN] The row bound to the model's default entry; fill it, then call Fill(). / [CN] 绑定默认 entry 的行，填好后调用 Fill()。
+    RecoNTupleRow& Row();
+    void Fill();
+    void Commit();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> fImpl;
+};
+
+class RecoNTupleReader {
+public:
+    explicit RecoNTupleReader(const std::string& path);
+    ~RecoNTupleReader();
+    RecoNTupleReader(const RecoNTupleReader&) = delete;
+    RecoNTupleReader& operator=(const RecoNTupleReader&) = delete;
+
+    std::int64_t GetEntries() const;
+    // [EN] Loads entry i into Row(). / [CN] 将第 i 条读入 Row()。
+    void LoadEntry(std::int64_t entry);
+    const RecoNTupleRow& Row() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> fImpl;
+};
+
+}  // namespace analysis::reco_output
+
+#endif  // RECO_NTUPLE_IO_HH
@@ -0,0 +1,61 @@
+#ifndef RECO_NTUPLE_RECORDS_HH
+#define RECO_NTUPLE_RECORDS_HH
+
+#include <array>
+
+namespace analysis::reco_output {
+
+// [EN] Plain per-object records stored as std::vector collections in the RNTuple output. No TObject
+// base: RNTuple only needs the dictionary, and the records stay trivially copyable.
+// [CN] RNTuple 输出中以 std::vector 集合存储的逐对象记录；不继承 TObject，RNTuple 只需字典。
+
+struct TrackRecord {
+    double start_x = 0.0;
+    double start_y = 0.0;
+    double start_z = 0.0;
+    double end_x = 0.0;
+    double end_y = 0.0;
+    double end_z = 0.0;
+    int pdg_code = 0;
+    double chi2 = 0.0;
+};
+
+// [EN] Same quantities as the legacy reco_proton_* vectors; interval order is (px, py, pz, p) x
+// (lower68, upper68, lower95, upper95), covariance is the packed upper triangle (xx, xy, xz, yy, yz, zz).
+// [CN] 与旧布局 reco_proton_* 向量同样的量；区间与协方差顺序同紧凑布局。
+struct ProtonRecord {
+    double px = 0.0;
+    double py = 0.0;
+    double pz = 0.0;
+    double e = 0.0;
+    double p = 0.0;
+    int status = 0;
+    int method = 0;
+    int ndf = 0;
+    int iterations = 0;
+    bool uncertainty_valid = false;
+    bool posterior_valid = false;
+    double chi2_raw = 0.0;
+    double chi2_reduced = 0.0;
+    std::array<double, 4> sigma{};
+    std::array<double, 16> interval{};
+    std::array<double, 6> covariance{};
+};
+
+struct NeutronRecord {
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+    double dir_x = 0.0;
+    double dir_y = 0.0;
+    double dir_z = 1.0;
+    double energy = 0.0;
+    double time_of_flight = 0.0;
+    double beta = 0.0;
+    double flight_length = 0.0;
+    int hit_multiplicity = 0;
+};
+
+}  // namespace analysis::reco_output
+
+#endif  // RECO_NTUPLE_RECORDS_HH
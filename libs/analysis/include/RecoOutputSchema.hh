@@ -0,0 +1,181 @@
+#ifndef RECO_OUTPUT_SCHEMA_HH
+#define RECO_OUTPUT_SCHEMA_HH
+
+#include "RecoEvent.hh"
+
+#include "TLorentzVector.h"
+#include "TVector3.h"
+
+#include <string>
+#include <vector>
+
+class TFile;
+class TTree;
+
+namespace analysis::reco_output {
+
+// [EN] recoTree layouts. kLegacy: RecoEvent object + truth TLorentzVector/TVector3 + one std::vector<double>
+// branch per proton quantity. kCompact: flat Float_t/Short_t/Char_t arrays sized by n_proton / n_neutron,
+// no hit collections; a single-track event is a handful of scalars.
+// [CN] recoTree 布局。kLegacy：RecoEvent 对象 + 真值 TLorentzVector/TVector3 + 每个质子量一个 vector<double> 分支。
+// kCompact：按 n_proton / n_neutron 计数的扁平数组（Float_t/Short_t/Char_t），不含击中集合。
+enum class OutputSchema {
+    kLegacy,
+    kCompact
+};
+
+// [EN] Container for the per-event results: recoTree (TTree, either schema) or recoNTuple (RNTuple,
+// see RecoNTupleIO.hh). / [CN] 逐事件结果容器：recoTree（TTree，任一布局）或 recoNTuple（RNTuple）。
+enum class OutputBackend {
+    kTTree,
+    kRNTuple
+};
+
+// [EN] kDefault leaves ROOT's file default untouched. / [CN] kDefault 保持 ROOT 文件默认压缩。
+enum class CompressionProfile {
+    kDefault,
+    kFast,      // LZ4 level 4: write/read speed first
+    kBalanced,  // ZSTD level 5
+    kArchive    // LZMA level 8: smallest files, slowest
+};
+
+OutputSchema ParseOutputSchema(const std::string& text);
+std::string OutputSchemaName(OutputSchema schema);
+OutputBackend ParseOutputBackend(const std::string& text);
+std::string OutputBackendName(OutputBackend backend);
+CompressionProfile ParseCompressionProfile(const std::string& text);
+std::string CompressionProfileName(CompressionProfile profile);
+// [EN] ROOT compression setting (algorithm * 100 + level), or -1 for kDefault. / [CN] ROOT 压缩设置（算法*100+级别），kDefault 返回 -1。
+int CompressionSettings(CompressionProfile profile);
+void ApplyCompressionProfile(TFile& file, CompressionProfile profile);
+// [EN] Reads the RecoOutputSchema TNamed, falling back to branch detection for older files. / [CN] 读取 RecoOutputSchema 元数据，旧文件按分支判断。
+OutputSchema DetectOutputSchema(TFile& file, TTree& tree);
+
+// [EN] The legacy per-proton vector columns, one element per reconstructed proton. / [CN] 旧布局的逐质子向量列，每条重建质子一个元素。
+struct LegacyProtonColumns {
+    std::vector<double> px;
+    std::vector<double> py;
+    std::vector<double> pz;
+    std::vector<double> e;
+    std::vector<double> p;
+    std::vector<int> status;
+    std::vector<int> method;
+    std::vector<int> ndf;
+    std::vector<int> iterations;
+    std::vector<int> uncertainty_valid;
+    std::vector<int> posterior_valid;
+    std::vector<double> chi2_raw;
+    std::vector<double> chi2_reduced;
+    std::vector<double> px_sigma;
+    std::vector<double> py_sigma;
+    std::vector<double> pz_sigma;
+    std::vector<double> p_sigma;
+    std::vector<double> px_lower68;
+    std::vector<double> px_upper68;
+    std::vector<double> px_lower95;
+    std::vector<double> px_upper95;
+    std::vector<double> py_lower68;
+    std::vector<double> py_upper68;
+    std::vector<double> py_lower95;
+    std::vector<double> py_upper95;
+    std::vector<double> pz_lower68;
+    std::vector<double> pz_upper68;
+    std::vector<double> pz_lower95;
+    std::vector<double> pz_upper95;
+    std::vector<double> p_lower68;
+    std::vector<double> p_upper68;
+    std::vector<double> p_lower95;
+    std::vector<double> p_upper95;
+    // [EN] Packed upper triangle (xx, xy, xz, yy, yz, zz) of the momentum covariance, 6 per proton.
+    // Not a legacy branch; carried so the compact writer can store it.
+    // [CN] 动量协方差上三角打包（xx,xy,xz,yy,yz,zz），每质子 6 个；不写入旧布局，仅供紧凑布局使用。
+    std::vector<double> momentum_cov;
+
+    template <typename Fn>
+    void ForEachDouble(Fn&& fn) {
+        for (auto* column : {&px, &py, &pz, &e, &p, &chi2_raw, &chi2_reduced,
+                             &px_sigma, &py_sigma, &pz_sigma, &p_sigma,
+                             &px_lower68, &px_upper68, &px_lower95, &px_upper95,
+                             &py_lower68, &py_upper68, &py_lower95, &py_upper95,
+                             &pz_lower68, &pz_upper68, &pz_lower95, &pz_upper95,
+                             &p_lower68, &p_upper68, &p_lower95, &p_upper95,
+                             &momentum_cov}) {
+            fn(*column);
+        }
+    }
+
+    template <typename Fn>
+    void ForEachInt(Fn&& fn) {
+        for (auto* column : {&status, &method, &ndf, &iterations, &uncertainty_valid, &posterior_valid}) {
+            fn(*column);
+        }
+    }
+
+    void Clear();
+    void Swap(LegacyProtonColumns& other);
+
+    void BindForWrite(TTree& tree, bool write_errors, bool write_laplace);
+};
+
+// [EN] Compact row. Per-proton arrays hold up to kMaxProtons entries and per-neutron arrays up to kMaxNeutrons;
+// extra ones are counted in n_proton_dropped / n_neutron_dropped. Interval order is
+// (px, py, pz, p) x (lower68, upper68, lower95, upper95).
+// [CN] 紧凑行。逐质子数组最多 kMaxProtons 个、逐中子数组最多 kMaxNeutrons 个，超出的分别计入
+// n_proton_dropped / n_neutron_dropped。
+// 区间顺序为 (px, py, pz, p) x (lower68, upper68, lower95, upper95)。
+struct CompactRecoRow {
+    static constexpr int kMaxProtons = 16;
+    static constexpr int kMaxNeutrons = 16;
+
+    Long64_t event_id = -1;
+    Int_t n_track = 0;
+    Bool_t truth_has_proton = false;
+    Bool_t truth_has_neutron = false;
+    // [EN] (px, py, pz, E, x, y, z) / [CN] (px, py, pz, E, x, y, z)
+    Float_t truth_proton[7] = {};
+    Float_t truth_neutron[7] = {};
+
+    Int_t n_proton = 0;
+    Int_t n_proton_dropped = 0;
+    Float_t proton_px[kMaxProtons] = {};
+    Float_t proton_py[kMaxProtons] = {};
+    Float_t proton_pz[kMaxProtons] = {};
+    Float_t proton_e[kMaxProtons] = {};
+    Char_t proton_status[kMaxProtons] = {};
+    Char_t proton_method[kMaxProtons] = {};
+    // [EN] bit 0: uncertainty_valid, bit 1: posterior_valid / [CN] 第0位 uncertainty_valid，第1位 posterior_valid
+    UChar_t proton_flags[kMaxProtons] = {};
+    Short_t proton_ndf[kMaxProtons] = {};
+    Short_t proton_iterations[kMaxProtons] = {};
+    Float_t proton_chi2_raw[kMaxProtons] = {};
+    Float_t proton_chi2_reduced[kMaxProtons] = {};
+    Float_t proton_sigma[kMaxProtons][4] = {};
+    Float_t proton_interval[kMaxProtons][16] = {};
+    Float_t proton_cov[kMaxProtons][6] = {};
+
+    Int_t n_neutron = 0;
+    Int_t n_neutron_dropped = 0;
+    Float_t neutron_px[kMaxNeutrons] = {};
+    Float_t neutron_py[kMaxNeutrons] = {};
+    Float_t neutron_pz[kMaxNeutrons] = {};
+    Float_t neutron_x[kMaxNeutrons] = {};
+    Float_t neutron_y[kMaxNeutrons] = {};
+    Float_t neutron_z[kMaxNeutrons] = {};
+    Float_t neutron_tof[kMaxNeutrons] = {};
+    Float_t neutron_beta[kMaxNeutrons] = {};
+    Float_t neutron_energy[kMaxNeutrons] = {};
+    Short_t neutron_multiplicity[kMaxNeutrons] = {};
+
+    void Clear();
+    void SetTruth(bool has_proton, const TLorentzVector& proton_p4, const TVector3& proton_pos,
+                  bool has_neutron, const TLorentzVector& neutron_p4, const TVector3& neutron_pos);
+    void SetEvent(const RecoEvent& event);
+    void SetProtons(const LegacyProtonColumns& columns);
+
+    void BindForWrite(TTree& tree, bool write_errors, bool write_laplace, bool write_covariance);
+    void BindForRead(TTree& tree);
+};
+
+}  // namespace analysis::reco_output
+
+#endif  // RECO_OUTPUT_SCHEMA_HH
@@ -0,0 +1,296 @@
+#include "ChainedEventDataReader.hh"
+#include "SMLogger.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <sstream>
+
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char* kIndexHeader = "# smsim-event-index v1\tpath\tsize_bytes\tmtime\tentries";
+
+std::int64_t FileMTime(const fs::path& path, std::error_code& ec) {
+    const auto stamp = fs::last_write_time(path, ec);
+    return ec ? 0 : static_cast<std::int64_t>(stamp.time_since_epoch().count());
+}
+
+// [EN] Cache keys are relative to the cache directory so a moved data tree keeps its index. / [CN] 缓存键相对缓存目录，数据目录整体搬移后索引仍可用。
+std::string CacheKey(const std::string& path, const fs::path& cache_dir) {
+    std::error_code ec;
+    const fs::path rel = fs::relative(fs::absolute(path, ec), cache_dir, ec);
+    return ec || rel.empty() ? fs::path(path).generic_string() : rel.generic_string();
+}
+
+std::regex GlobToRegex(const std::string& pattern) {
+    std::string expr;
+    for (char c : pattern) {
+        switch (c) {
+            case '*': expr += "[^/]*"; break;
+            case '?': expr += "[^/]"; break;
+            case '.': case '+': case '(': case ')': case '[': case ']':
+            case '{': case '}': case '^': case '$': case '|': case '\\':
+                expr += '\\';
+                expr += c;
+                break;
+            default: expr += c; break;
+        }
+    }
+    return std::regex(expr);
+}
+
+bool CountEntries(const std::string& path, Long64_t* entries, std::string* reason) {
+    std::unique_ptr<TFile> file(TFile::Open(path.c_str(), "READ"));
+    if (!file || file->IsZombie()) {
+        if (reason) *reason = "cannot open " + path;
+        return false;
+    }
+    TTree* tree = dynamic_cast<TTree*>(file->Get("tree"));
+    if (!tree) {
+        if (reason) *reason = "no 'tree' in " + path;
+        return false;
+    }
+    *entries = tree->GetEntries();
+    return true;
+}
+
+}  // namespace
+
+ChainedEventDataReader::ChainedEventDataReader(std::vector<std::string> files,
+                                               const EventDataReaderOptions& options)
+    : m_options(options), m_readerFileIndex(0), m_totalEvents(0), m_currentEntry(-1),
+      m_scannedFiles(0), m_indexed(false)
+{
+    m_files.reserve(files.size());
+    for (auto& path : files) {
+        FileRecord record;
+        record.path = std::move(path);
+        m_files.push_back(std::move(record));
+    }
+}
+
+ChainedEventDataReader::~ChainedEventDataReader() = default;
+
+std::vector<std::string> ChainedEventDataReader::ExpandInputs(const std::string& spec, std::string* reason) {
+    std::vector<std::string> files;
+    std::error_code ec;
+    if (!spec.empty() && spec[0] == '@') {
+        std::ifstream list(spec.substr(1));
+        if (!list) {
+            if (reason) *reason = "cannot read file list " + spec.substr(1);
+            return files;
+        }
+        const fs::path base = fs::path(spec.substr(1)).parent_path();
+        std::string line;
+        while (std::getline(list, line)) {
+            line.erase(0, line.find_first_not_of(" \t"));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            const fs::path path(line);
+            files.push_back((path.is_relative() ? base / path : path).string());
+        }
+        // [EN] A list keeps its own order; it defines the global numbering. / [CN] 列表保持原有顺序，即全局编号顺序。
+        return files;
+    }
+
+    if (fs::is_directory(spec, ec)) {
+        for (const auto& entry : fs::recursive_directory_iterator(spec)) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".root") {
+                continue;
+            }
+            if (entry.path().filename().string().find("_reco.root") != std::string::npos) {
+                continue;
+            }
+            files.push_back(entry.path().string());
+        }
+    } else if (spec.find_first_of("*?") != std::string::npos) {
+        const fs::path pattern(spec);
+        const fs::path dir = pattern.has_parent_path() ? pattern.parent_path() : fs::path(".");
+        const std::regex name_regex = GlobToRegex(pattern.filename().string());
+        if (fs::is_directory(dir, ec)) {
+            for (const auto& entry : fs::directory_iterator(dir)) {
+                if (entry.is_regular_file() && std::regex_match(entry.path().filename().string(), name_regex)) {
+                    files.push_back(entry.path().string());
+                }
+            }
+        }
+    } else if (fs::is_regular_file(spec, ec)) {
+        files.push_back(spec);
+    }
+
+    if (files.empty() && reason) {
+        *reason = "no input files match " + spec;
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+std::string ChainedEventDataReader::DefaultIndexCachePath(const std::vector<std::string>& files) {
+    if (files.empty()) {
+        return std::string();
+    }
+    std::error_code ec;
+    fs::path common = fs::absolute(files.front(), ec).parent_path();
+    for (const auto& path : files) {
+        const fs::path dir = fs::absolute(path, ec).parent_path();
+        fs::path shared;
+        auto a = common.begin();
+        auto b = dir.begin();
+        for (; a != common.end() && b != dir.end() && *a == *b; ++a, ++b) {
+            shared /= *a;
+        }
+        common = shared;
+    }
+    return (common / ".smsim_event_index.tsv").string();
+}
+
+bool ChainedEventDataReader::BuildIndex(const std::string& cache_path, std::string* reason) {
+    const fs::path cache_dir = cache_path.empty() ? fs::path() : fs::absolute(cache_path).parent_path();
+
+    struct CachedRecord {
+        std::uintmax_t size_bytes = 0;
+        std::int64_t mtime = 0;
+        Long64_t entries = 0;
+    };
+    std::map<std::string, CachedRecord> cached;
+    if (!cache_path.empty()) {
+        std::ifstream in(cache_path);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            std::istringstream fields(line);
+            std::string key;
+            CachedRecord record;
+            if (std::getline(fields, key, '\t') && fields >> record.size_bytes >> record.mtime >> record.entries) {
+                cached[key] = record;
+            }
+        }
+    }
+
+    m_scannedFiles = 0;
+    Long64_t offset = 0;
+    for (auto& file : m_files) {
+        std::error_code ec;
+        file.size_bytes = fs::file_size(file.path, ec);
+        if (ec) {
+            if (reason) *reason = "cannot stat " + file.path;
+            return false;
+        }
+        file.mtime = FileMTime(file.path, ec);
+
+        const std::string key = cache_path.empty() ? std::string() : CacheKey(file.path, cache_dir);
+        const auto hit = cached.find(key);
+        if (hit != cached.end() && hit->second.size_bytes == file.size_bytes && hit->second.mtime == file.mtime) {
+            file.entries = hit->second.entries;
+        } else {
+            if (!CountEntries(file.path, &file.entries, reason)) {
+                return false;
+            }
+            ++m_scannedFiles;
+            if (!key.empty()) {
+                cached[key] = CachedRecord{file.size_bytes, file.mtime, file.entries};
+            }
+        }
+        file.first_entry = offset;
+        offset += file.entries;
+    }
+    m_totalEvents = offset;
+    m_indexed = true;
+
+    if (!cache_path.empty() && m_scannedFiles > 0) {
+        // [EN] Write-then-rename so concurrent readers never see a partial index. / [CN] 先写临时文件再重命名，并发读取者不会看到半截索引。
+        const std::string tmp_path = cache_path + ".tmp" + std::to_string(static_cast<long long>(::getpid()));
+        std::ofstream out(tmp_path);
+        if (out) {
+            out << kIndexHeader << '\n';
+            for (const auto& [key, record] : cached) {
+                out << key << '\t' << record.size_bytes << '\t' << record.mtime << '\t' << record.entries << '\n';
+            }
+            out.close();
+            std::error_code ec;
+            fs::rename(tmp_path, cache_path, ec);
+            if (ec) {
+                fs::remove(tmp_path, ec);
+                SM_WARN("ChainedEventDataReader: cannot update index cache {}", cache_path);
+            }
+        } else {
+            SM_WARN("ChainedEventDataReader: index cache {} is not writable", cache_path);
+        }
+    }
+    SM_INFO("ChainedEventDataReader: {} files, {} events ({} scanned, {} from cache)",
+            m_files.size(), m_totalEvents, m_scannedFiles, m_files.size() - m_scannedFiles);
+    return true;
+}
+
+bool ChainedEventDataReader::Locate(Long64_t globalEntry, Location* location) const {
+    if (!m_indexed || globalEntry < 0 || globalEntry >= m_totalEvents || !location) {
+        return false;
+    }
+    // [EN] Last file whose first entry is <= globalEntry; empty files are skipped naturally. / [CN] 取首条编号 <= globalEntry 的最后一个文件，空文件自然跳过。
+    const auto it = std::upper_bound(m_files.begin(), m_files.end(), globalEntry,
+                                     [](Long64_t value, const FileRecord& file) { return value < file.first_entry; });
+    const std::size_t index = static_cast<std::size_t>(std::distance(m_files.begin(), it)) - 1;
+    location->file_index = index;
+    location->local_entry = globalEntry - m_files[index].first_entry;
+    return true;
+}
+
+Long64_t ChainedEventDataReader::ToGlobalEntry(std::size_t fileIndex, Long64_t localEntry) const {
+    if (!m_indexed || fileIndex >= m_files.size() || localEntry < 0 || localEntry >= m_files[fileIndex].entries) {
+        return -1;
+    }
+    return m_files[fileIndex].first_entry + localEntry;
+}
+
+std::pair<Long64_t, Long64_t> ChainedEventDataReader::PartitionRange(int index, int count) const {
+    if (count <= 0 || index < 0 || index >= count) {
+        return {0, 0};
+    }
+    return {m_totalEvents * index / count, m_totalEvents * (index + 1) / count};
+}
+
+bool ChainedEventDataReader::OpenFile(std::size_t fileIndex) {
+    if (m_reader && m_readerFileIndex == fileIndex) {
+        return true;
+    }
+    m_reader.reset();
+    auto reader = std::make_unique<EventDataReader>(m_files[fileIndex].path.c_str(), m_options);
+    if (!reader->IsOpen()) {
+        return false;
+    }
+    m_reader = std::move(reader);
+    m_readerFileIndex = fileIndex;
+    return true;
+}
+
+bool ChainedEventDataReader::GoToEvent(Long64_t globalEntry) {
+    Location location;
+    if (!Locate(globalEntry, &location)) {
+        SM_ERROR("Global event number {} is out of range.", globalEntry);
+        return false;
+    }
+    if (!OpenFile(location.file_index) || !m_reader->GoToEvent(location.local_entry)) {
+        return false;
+    }
+    m_currentEntry = globalEntry;
+    m_currentLocation = location;
+    return true;
+}
+
+bool ChainedEventDataReader::NextEvent() {
+    if (m_currentEntry + 1 >= m_totalEvents) return false;
+    return GoToEvent(m_currentEntry + 1);
+}
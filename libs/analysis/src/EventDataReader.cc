@@ -1,17 +1,163 @@
 #include "EventDataReader.hh"
 #include "SMLogger.hh"
+#include "TBranch.h"
 #include "TSystem.h"
 #include "TBeamSimData.hh"
 #include "TNEBULAPlusSimParameter.hh"
 #include "TNEBULASimParameter.hh"
+#include "TSimData.hh"
+#include "TSimHit.hh"
+#include "TSimNameTable.hh"
 
-EventDataReader::EventDataReader(const char* filePath) 
-    : m_file(nullptr), m_tree(nullptr), m_fragSimDataArray(nullptr), m_nebulaDataArray(nullptr),
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+// [EN] Background read-ahead for one input file. It preads the basket byte ranges of the next
+// cluster through its own descriptor, so they are already in the page cache when the TTreeCache
+// asks for them; ROOT's own TFile is never touched from this thread.
+// [CN] 单个输入文件的后台预读：通过独立文件描述符 pread 下一个 cluster 的 basket 字节区间，
+// 使 TTreeCache 请求时数据已在页缓存中；本线程从不访问 ROOT 的 TFile。
+class EventClusterPrefetcher {
+public:
+    using ByteRange = std::pair<Long64_t, Long64_t>;  // (offset, length)
+
+    explicit EventClusterPrefetcher(const char* path)
+        : fFd(::open(path, O_RDONLY)) {
+        if (fFd >= 0) {
+            fThread = std::thread([this] { Run(); });
+        }
+    }
+
+    ~EventClusterPrefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fStop = true;
+        }
+        fCv.notify_all();
+        if (fThread.joinable()) {
+            fThread.join();
+        }
+        if (fFd >= 0) {
+            ::close(fFd);
+        }
+    }
+
+    bool IsValid() const { return fFd >= 0; }
+
+    // [EN] Replaces any request that has not started yet; only the newest cluster matters. / [CN] 覆盖尚未开始的请求，只关心最新的 cluster。
+    void Request(std::vector<ByteRange> ranges) {
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fPending = std::move(ranges);
+            fHasPending = true;
+        }
+        fCv.notify_one();
+    }
+
+private:
+    static constexpr std::size_t kChunkBytes = 4u << 20;
+
+    void Run() {
+        std::vector<char> buffer(kChunkBytes);
+        std::vector<ByteRange> ranges;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(fMutex);
+                fCv.wait(lock, [this] { return fStop || fHasPending; });
+                if (fStop) {
+                    return;
+                }
+                ranges.swap(fPending);
+                fPending.clear();
+                fHasPending = false;
+            }
+            for (const auto& range : ranges) {
+                Long64_t offset = range.first;
+                Long64_t remaining = range.second;
+                while (remaining > 0) {
+                    const std::size_t request = static_cast<std::size_t>(
+                        std::min<Long64_t>(remaining, static_cast<Long64_t>(buffer.size())));
+                    const ssize_t got = ::pread(fFd, buffer.data(), request, static_cast<off_t>(offset));
+                    if (got <= 0) {
+                        break;
+                    }
+                    offset += got;
+                    remaining -= got;
+                }
+            }
+        }
+    }
+
+    int fFd;
+    std::thread fThread;
+    std::mutex fMutex;
+    std::condition_variable fCv;
+    std::vector<ByteRange> fPending;
+    bool fHasPending = false;
+    bool fStop = false;
+};
+
+namespace {
+
+void CollectBasketRanges(TBranch* branch,
+                         Long64_t first,
+                         Long64_t last,
+                         std::vector<EventClusterPrefetcher::ByteRange>* ranges) {
+    if (!branch) {
+        return;
+    }
+    const Int_t baskets = branch->GetWriteBasket();
+    const Long64_t* basket_entry = branch->GetBasketEntry();
+    const Int_t* basket_bytes = branch->GetBasketBytes();
+    if (basket_entry && basket_bytes) {
+        for (Int_t i = 0; i < baskets; ++i) {
+            const Long64_t begin = basket_entry[i];
+            const Long64_t end = (i + 1 < baskets) ? basket_entry[i + 1] : branch->GetEntries();
+            const Long64_t seek = branch->GetBasketSeek(i);
+            if (end <= first || begin >= last || seek <= 0) {
+                continue;
+            }
+            ranges->emplace_back(seek, basket_bytes[i]);
+        }
+    }
+    TObjArray* children = branch->GetListOfBranches();
+    if (!children) {
+        return;
+    }
+    for (Int_t i = 0; i < children->GetEntriesFast(); ++i) {
+        CollectBasketRanges(static_cast<TBranch*>(children->UncheckedAt(i)), first, last, ranges);
+    }
+}
+
+bool IsLocalPath(const TString& path) {
+    return !path.Contains("://") || path.BeginsWith("file://");
+}
+
+}  // namespace
+
+EventDataReader::EventDataReader(const char* filePath)
+    : EventDataReader(filePath, EventDataReaderOptions{}) {}
+
+EventDataReader::EventDataReader(const char* filePath, const EventDataReaderOptions& options)
+    : m_file(nullptr), m_tree(nullptr), m_fragSimDataArray(nullptr), m_fragSimHitArray(nullptr),
+      m_nameTable(nullptr), m_compactFragments(false), m_nebulaDataArray(nullptr),
       m_nebulaPlusDataArray(nullptr), m_beamDataVector(nullptr),
       m_nebulaParameter(nullptr), m_nebulaPlusParameter(nullptr),
-      m_hasNEBULABranch(false), m_hasNEBULAPlusBranch(false),
-      m_currentEvent(-1), m_totalEvents(0), m_filePath(filePath) 
+      m_hasNEBULABranch(false), m_hasNEBULAPlusBranch(false), m_hasBeamBranch(false),
+      m_currentEvent(-1), m_totalEvents(0), m_filePath(filePath), m_options(options),
+      m_prefetchClusterBegin(-1), m_prefetchClusterEnd(-1)
 {
+    Open();
+}
+
+void EventDataReader::Open() {
     // It is good practice to load libraries in the main macro,
     // but loading here ensures the class is self-contained.
     // [EN] Load ROOT dictionary so branch objects (e.g., TBeamSimData) can be instantiated. / [CN] 加载ROOT字典以便分支对象（如TBeamSimData）可被实例化。
@@ -30,8 +176,20 @@ EventDataReader::EventDataReader(const char* filePath)
         return;
     }
     // [EN] FragSimData is the mandatory fragment hit branch used by reconstruction. / [CN] FragSimData是重建必需的碎片击中分支。
-    m_tree->SetBranchAddress("FragSimData", &m_fragSimDataArray);
-    
+    if (!m_tree->GetBranch("FragSimData") && m_tree->GetBranch("FragSimHit")) {
+        // [EN] Compact output: read TSimHit and expand it per event. / [CN] 紧凑输出：读取 TSimHit，逐事件展开。
+        m_compactFragments = true;
+        m_tree->SetBranchAddress("FragSimHit", &m_fragSimHitArray);
+        m_nameTable = dynamic_cast<TSimNameTable*>(m_file->Get("SimNameTable"));
+        if (!m_nameTable) {
+            SM_WARN("EventDataReader: FragSimHit without SimNameTable in {}, hit names will be empty", m_filePath.Data());
+        }
+        m_fragSimDataArray = new TClonesArray("TSimData", 256);
+        SM_INFO("EventDataReader: Found compact FragSimHit branch");
+    } else {
+        m_tree->SetBranchAddress("FragSimData", &m_fragSimDataArray);
+    }
+
     // Try to set NEBULA branch
     // [EN] NEBULAPla is optional; allow analysis to run without NEBULA data. / [CN] NEBULAPla是可选分支，允许无NEBULA数据时继续分析。
     if (m_tree->GetBranch("NEBULAPla")) {
@@ -54,35 +212,138 @@ EventDataReader::EventDataReader(const char* filePath)
 
     m_nebulaParameter = dynamic_cast<TNEBULASimParameter*>(m_file->Get("NEBULAParameter"));
     m_nebulaPlusParameter = dynamic_cast<TNEBULAPlusSimParameter*>(m_file->Get("NEBULAPlusParameter"));
-    
+
     // Try to set beam branch using vector<TBeamSimData> format
     // [EN] Beam vector is optional and only present in newer simulation outputs. / [CN] beam向量是可选的，仅出现在较新的模拟输出中。
     if (m_tree->GetBranch("beam")) {
+        m_hasBeamBranch = true;
         m_tree->SetBranchAddress("beam", &m_beamDataVector);
         SM_INFO("EventDataReader: Found beam branch (vector<TBeamSimData> format)");
     } else {
         SM_DEBUG("EventDataReader: No beam branch found in file");
         m_beamDataVector = nullptr;
     }
-    
+
     m_totalEvents = m_tree->GetEntries();
+    ApplyOptions(m_options);
     SM_INFO("EventDataReader: Opened {} with {} events.", m_filePath.Data(), m_totalEvents);
 }
 
 EventDataReader::~EventDataReader() {
+    // [EN] Stop the read-ahead thread before the file goes away. / [CN] 关闭文件前先停止预读线程。
+    m_prefetcher.reset();
+    if (m_compactFragments) {
+        delete m_fragSimDataArray;
+    }
     if (m_file) {
         m_file->Close();
         // m_file is owned by TFile::Open, ROOT will manage it.
     }
 }
 
+std::vector<const char*> EventDataReader::EnabledBranchNames() const {
+    std::vector<const char*> names;
+    if (m_options.read_fragments) {
+        names.push_back(m_compactFragments ? "FragSimHit" : "FragSimData");
+    }
+    if (m_options.read_nebula && m_hasNEBULABranch) {
+        names.push_back("NEBULAPla");
+    }
+    if (m_options.read_nebula_plus && m_hasNEBULAPlusBranch) {
+        names.push_back("NEBULAPlusPla");
+    }
+    if (m_options.read_beam && m_hasBeamBranch) {
+        names.push_back("beam");
+    }
+    return names;
+}
+
+void EventDataReader::ApplyOptions(const EventDataReaderOptions& options) {
+    m_options = options;
+    if (!IsOpen() || !m_tree) {
+        return;
+    }
+
+    // [EN] Only enabled branches (and their split sub-branches) are read by GetEntry. / [CN] GetEntry 只读取启用的分支及其拆分子分支。
+    const std::vector<const char*> branches = EnabledBranchNames();
+    m_tree->SetBranchStatus("*", false);
+    for (const char* name : branches) {
+        m_tree->SetBranchStatus(name, true);
+        TBranch* branch = m_tree->GetBranch(name);
+        if (branch && branch->GetListOfBranches() && branch->GetListOfBranches()->GetEntriesFast() > 0) {
+            m_tree->SetBranchStatus((std::string(name) + ".*").c_str(), true);
+        }
+    }
+
+    // [EN] Must precede cache creation so ROOT instantiates a TTreeCacheUnzip. / [CN] 必须在创建缓存前设置，ROOT 才会创建 TTreeCacheUnzip。
+    m_tree->SetParallelUnzip(m_options.parallel_unzip);
+    if (m_options.cache_size_bytes == 0) {
+        m_tree->SetCacheSize(0);
+    } else {
+        m_tree->SetCacheSize(m_options.cache_size_bytes > 0 ? m_options.cache_size_bytes : -1);
+        // [EN] The branch set is known up front, so skip the learning phase entirely. / [CN] 分支集合预先已知，直接跳过学习阶段。
+        for (const char* name : branches) {
+            m_tree->AddBranchToCache(name, true);
+        }
+        m_tree->StopCacheLearningPhase();
+    }
+
+    m_prefetchClusterBegin = -1;
+    m_prefetchClusterEnd = -1;
+    if (!m_options.prefetch_clusters) {
+        m_prefetcher.reset();
+    } else if (!m_prefetcher) {
+        if (!IsLocalPath(m_filePath)) {
+            SM_WARN("EventDataReader: cluster prefetch needs a local file, disabled for {}", m_filePath.Data());
+        } else {
+            TString local_path = m_filePath;
+            if (local_path.BeginsWith("file://")) {
+                local_path.Remove(0, 7);
+            }
+            m_prefetcher = std::make_unique<EventClusterPrefetcher>(local_path.Data());
+            if (!m_prefetcher->IsValid()) {
+                SM_WARN("EventDataReader: cluster prefetch could not open {}, disabled", local_path.Data());
+                m_prefetcher.reset();
+            }
+        }
+    }
+}
+
+void EventDataReader::SchedulePrefetch(Long64_t eventNumber) {
+    if (eventNumber >= m_prefetchClusterBegin && eventNumber < m_prefetchClusterEnd) {
+        return;
+    }
+    TTree::TClusterIterator clusters = m_tree->GetClusterIterator(eventNumber);
+    m_prefetchClusterBegin = clusters();
+    m_prefetchClusterEnd = clusters.GetNextEntry();
+    const Long64_t next_begin = clusters();
+    const Long64_t next_end = std::min(clusters.GetNextEntry(), m_totalEvents);
+    if (next_begin >= m_totalEvents || next_end <= next_begin) {
+        return;
+    }
+
+    std::vector<EventClusterPrefetcher::ByteRange> ranges;
+    for (const char* name : EnabledBranchNames()) {
+        CollectBasketRanges(m_tree->GetBranch(name), next_begin, next_end, &ranges);
+    }
+    std::sort(ranges.begin(), ranges.end());
+    m_prefetcher->Request(std::move(ranges));
+}
+
 bool EventDataReader::GoToEvent(Long64_t eventNumber) {
     if (!IsOpen() || !m_tree) return false;
     if (eventNumber < 0 || eventNumber >= m_totalEvents) {
         SM_ERROR("Event number {} is out of range.", eventNumber);
         return false;
     }
+    if (m_prefetcher) {
+        SchedulePrefetch(eventNumber);
+    }
     m_tree->GetEntry(eventNumber);
+    if (m_compactFragments && m_options.read_fragments && m_fragSimHitArray) {
+        m_fragSimDataArray->Delete();
+        TSimHit::ExpandArray(m_fragSimHitArray, m_nameTable, m_fragSimDataArray);
+    }
     m_currentEvent = eventNumber;
     return true;
 }
@@ -98,13 +359,15 @@ bool EventDataReader::PrevEvent() {
 }
 
 int EventDataReader::GetBeamParticleCount() const {
-    if (!m_beamDataVector) return 0;
-    return m_beamDataVector->size();
+    const std::vector<TBeamSimData>* beam = GetBeamData();
+    if (!beam) return 0;
+    return beam->size();
 }
 
 const TBeamSimData* EventDataReader::GetBeamParticle(int index) const {
-    if (!m_beamDataVector || index < 0 || index >= (int)m_beamDataVector->size()) {
+    const std::vector<TBeamSimData>* beam = GetBeamData();
+    if (!beam || index < 0 || index >= (int)beam->size()) {
         return nullptr;
     }
-    return &((*m_beamDataVector)[index]);
+    return &((*beam)[index]);
 }
@@ -0,0 +1,347 @@
+#include "EventStore.hh"
+
+#include "EventDataReader.hh"
+#include "NEBULAPlusReco.hh"
+#include "NEBULAReco.hh"
+#include "NebulaJointReco.hh"
+#include "TBeamSimData.hh"
+#include "TSimData.hh"
+
+#include "TRandom3.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace analysis::event_cache {
+
+namespace {
+
+void SetReason(std::string* reason, const std::string& text) {
+    if (reason) {
+        *reason = text;
+    }
+}
+
+void AppendKinematics(const TLorentzVector& p4, const TVector3& position, std::vector<double>* out) {
+    out->insert(out->end(), {p4.Px(), p4.Py(), p4.Pz(), p4.E(), position.X(), position.Y(), position.Z()});
+}
+
+void ReadKinematics(const std::vector<double>& in, std::size_t event, TLorentzVector* p4, TVector3* position) {
+    const double* k = in.data() + event * 7;
+    p4->SetPxPyPzE(k[0], k[1], k[2], k[3]);
+    position->SetXYZ(k[4], k[5], k[6]);
+}
+
+template <typename T>
+std::size_t Bytes(const std::vector<T>& column) {
+    return column.capacity() * sizeof(T);
+}
+
+// [EN] Wraps the detector-specific hit extraction. The energy threshold is lowered to -inf so the store keeps
+// every hit and each pass applies its own threshold; position/time smearing stays as in the reco classes.
+// [CN] 封装各探测器的击中提取。能量阈值降到 -inf 以保留全部击中，由每个 pass 自行施加阈值；位置/时间涂抹与重建类一致。
+class NeutronHitExtractor {
+public:
+    NeutronHitExtractor(const GeometryManager& geometry, neutron::NeutronDetectorMode mode) : fMode(mode) {
+        const double no_threshold = -std::numeric_limits<double>::infinity();
+        switch (mode) {
+            case neutron::NeutronDetectorMode::kNebula:
+                fNebula = std::make_unique<NEBULAReco>(geometry);
+                fNebula->SetEnergyThreshold(no_threshold);
+                break;
+            case neutron::NeutronDetectorMode::kNebulaPlus:
+                fNebulaPlus = std::make_unique<NEBULAPlusReco>(geometry);
+                fNebulaPlus->SetEnergyThreshold(no_threshold);
+                break;
+            case neutron::NeutronDetectorMode::kJoint:
+                fJoint = std::make_unique<NebulaJointReco>(geometry);
+                fJoint->SetEnergyThreshold(no_threshold);
+                break;
+            case neutron::NeutronDetectorMode::kAuto:
+            case neutron::NeutronDetectorMode::kNone:
+                break;
+        }
+    }
+
+    std::vector<NEBULAHit> Extract(const EventDataReader& reader) {
+        switch (fMode) {
+            case neutron::NeutronDetectorMode::kNebula:
+                fNebula->SetInput(reader.GetNEBULAHits());
+                return fNebula->CollectHits();
+            case neutron::NeutronDetectorMode::kNebulaPlus:
+                fNebulaPlus->SetInput(reader.GetNEBULAPlusHits());
+                return fNebulaPlus->CollectHits();
+            case neutron::NeutronDetectorMode::kJoint:
+                fJoint->SetInputs(reader.GetNEBULAHits(), reader.GetNEBULAPlusHits());
+                return fJoint->CollectHits();
+            case neutron::NeutronDetectorMode::kAuto:
+            case neutron::NeutronDetectorMode::kNone:
+                break;
+        }
+        return {};
+    }
+
+private:
+    neutron::NeutronDetectorMode fMode;
+    std::unique_ptr<NEBULAReco> fNebula;
+    std::unique_ptr<NEBULAPlusReco> fNebulaPlus;
+    std::unique_ptr<NebulaJointReco> fJoint;
+};
+
+}  // namespace
+
+void EventStore::Clear() {
+    *this = EventStore();
+}
+
+bool EventStore::Build(EventDataReader& reader,
+                       const GeometryManager& geometry,
+                       const EventStoreOptions& options,
+                       std::string* reason) {
+    Clear();
+    if (!reader.IsOpen()) {
+        SetReason(reason, "input file is not open");
+        return false;
+    }
+    if (options.neutron_mode == neutron::NeutronDetectorMode::kAuto) {
+        SetReason(reason, "neutron detector mode must be resolved before building the event store");
+        return false;
+    }
+    fOptions = options;
+
+    const Long64_t total = reader.GetTotalEvents();
+    const Long64_t first = std::clamp<Long64_t>(options.first_entry, 0, total);
+    const Long64_t last = options.last_entry < 0 ? total : std::clamp<Long64_t>(options.last_entry, first, total);
+    fOptions.first_entry = first;
+    fOptions.last_entry = last;
+
+    // [EN] Decompress only the branches the store keeps. / [CN] 只解压需要保存的分支。
+    EventDataReaderOptions reader_options = reader.GetOptions();
+    const neutron::NeutronDetectorMode mode = options.neutron_mode;
+    reader_options.read_fragments = options.pdc;
+    reader_options.read_beam = options.truth;
+    reader_options.read_nebula = mode == neutron::NeutronDetectorMode::kNebula ||
+                                 mode == neutron::NeutronDetectorMode::kJoint;
+    reader_options.read_nebula_plus = mode == neutron::NeutronDetectorMode::kNebulaPlus ||
+                                      mode == neutron::NeutronDetectorMode::kJoint;
+    reader.ApplyOptions(reader_options);
+
+    NeutronHitExtractor extractor(geometry, mode);
+    PDCHitClassifier classifier;
+    const std::size_t events = static_cast<std::size_t>(last - first);
+    fEntry.reserve(events);
+    fPdcBegin.reserve(events + 1);
+    fNeutronBegin.reserve(events + 1);
+    fTruthFlags.reserve(events);
+
+    for (Long64_t entry = first; entry < last; ++entry) {
+        if (!reader.GoToEvent(entry)) {
+            continue;
+        }
+        fEntry.push_back(entry);
+
+        if (TClonesArray* hits = options.pdc ? reader.GetHits() : nullptr) {
+            const int n_entries = hits->GetEntriesFast();
+            for (int i = 0; i < n_entries; ++i) {
+                const TSimData* hit = static_cast<const TSimData*>(hits->At(i));
+                signed char plane = -1;
+                signed char layer = -1;
+                if (!hit || !classifier.Classify(*hit, &plane, &layer)) continue;
+                fPdcX.push_back(hit->fPrePosition.X());
+                fPdcY.push_back(hit->fPrePosition.Y());
+                fPdcZ.push_back(hit->fPrePosition.Z());
+                fPdcEnergy.push_back(hit->fEnergyDeposit);
+                fPdcPlane.push_back(plane);
+                fPdcLayer.push_back(layer);
+            }
+        }
+        fPdcBegin.push_back(static_cast<std::uint32_t>(fPdcX.size()));
+
+        for (const NEBULAHit& hit : extractor.Extract(reader)) {
+            fNeutronModule.push_back(hit.moduleID);
+            fNeutronX.push_back(hit.position.X());
+            fNeutronY.push_back(hit.position.Y());
+            fNeutronZ.push_back(hit.position.Z());
+            fNeutronEnergy.push_back(hit.energy);
+            fNeutronTime.push_back(hit.time);
+            fNeutronQave.push_back(hit.qave);
+            fNeutronWallTag.push_back(static_cast<signed char>(hit.wall_tag));
+        }
+        fNeutronBegin.push_back(static_cast<std::uint32_t>(fNeutronModule.size()));
+
+        EventTruth truth;
+        if (const std::vector<TBeamSimData>* beam = options.truth ? reader.GetBeamData() : nullptr) {
+            for (const auto& particle : *beam) {
+                if (!truth.has_proton &&
+                    (particle.fParticleName == "proton" || (particle.fZ == 1 && particle.fA == 1))) {
+                    truth.has_proton = true;
+                    truth.proton_p4 = particle.fMomentum;
+                    truth.proton_position = particle.fPosition;
+                } else if (!truth.has_neutron &&
+                           (particle.fParticleName == "neutron" || (particle.fZ == 0 && particle.fA == 1))) {
+                    truth.has_neutron = true;
+                    truth.neutron_p4 = particle.fMomentum;
+                    truth.neutron_position = particle.fPosition;
+                }
+            }
+        }
+        fTruthFlags.push_back(static_cast<unsigned char>((truth.has_proton ? 1u : 0u) |
+                                                         (truth.has_neutron ? 2u : 0u)));
+        AppendKinematics(truth.proton_p4, truth.proton_position, &fTruthProton);
+        AppendKinematics(truth.neutron_p4, truth.neutron_position, &fTruthNeutron);
+    }
+
+    if (fPdcX.size() > std::numeric_limits<std::uint32_t>::max() ||
+        fNeutronModule.size() > std::numeric_limits<std::uint32_t>::max()) {
+        SetReason(reason, "too many hits for one event store; build it over smaller entry ranges");
+        Clear();
+        return false;
+    }
+    return true;
+}
+
+PDCHitArrays EventStore::PdcHits(std::size_t event) const {
+    const std::size_t begin = fPdcBegin[event];
+    PDCHitArrays hits;
+    hits.x = fPdcX.data() + begin;
+    hits.y = fPdcY.data() + begin;
+    hits.z = fPdcZ.data() + begin;
+    hits.energy = fPdcEnergy.data() + begin;
+    hits.plane = fPdcPlane.data() + begin;
+    hits.layer = fPdcLayer.data() + begin;
+    hits.size = fPdcBegin[event + 1] - begin;
+    return hits;
+}
+
+void EventStore::NeutronHits(std::size_t event, std::vector<NEBULAHit>* hits) const {
+    hits->clear();
+    for (std::size_t i = fNeutronBegin[event]; i < fNeutronBegin[event + 1]; ++i) {
+        NEBULAHit hit(fNeutronModule[i], TVector3(fNeutronX[i], fNeutronY[i], fNeutronZ[i]), fNeutronEnergy[i],
+                      fNeutronTime[i], fNeutronQave[i]);
+        hit.wall_tag = fNeutronWallTag[i];
+        hits->push_back(hit);
+    }
+}
+
+EventTruth EventStore::Truth(std::size_t event) const {
+    EventTruth truth;
+    truth.has_proton = (fTruthFlags[event] & 1u) != 0;
+    truth.has_neutron = (fTruthFlags[event] & 2u) != 0;
+    ReadKinematics(fTruthProton, event, &truth.proton_p4, &truth.proton_position);
+    ReadKinematics(fTruthNeutron, event, &truth.neutron_p4, &truth.neutron_position);
+    return truth;
+}
+
+std::size_t EventStore::MemoryBytes() const {
+    return Bytes(fEntry) + Bytes(fPdcBegin) + Bytes(fPdcX) + Bytes(fPdcY) + Bytes(fPdcZ) + Bytes(fPdcEnergy) +
+           Bytes(fPdcPlane) + Bytes(fPdcLayer) + Bytes(fNeutronBegin) + Bytes(fNeutronModule) +
+           Bytes(fNeutronX) + Bytes(fNeutronY) + Bytes(fNeutronZ) + Bytes(fNeutronEnergy) +
+           Bytes(fNeutronTime) + Bytes(fNeutronQave) + Bytes(fNeutronWallTag) + Bytes(fTruthFlags) +
+           Bytes(fTruthProton) + Bytes(fTruthNeutron);
+}
+
+bool RunSmearingPasses(const EventStore& store,
+                       const GeometryManager& geometry,
+                       const std::vector<SmearingPass>& passes,
+                       const PassVisitor& visitor,
+                       int threads,
+                       std::string* reason) {
+    if (!visitor) {
+        SetReason(reason, "no visitor given");
+        return false;
+    }
+    for (const SmearingPass& pass : passes) {
+        if (!(pass.pdc_sigma_u_mm >= 0.0) || !(pass.pdc_sigma_v_mm >= 0.0)) {
+            SetReason(reason, "negative PDC smearing sigma in pass '" + pass.label + "'");
+            return false;
+        }
+    }
+    const bool have_neutrons = store.GetOptions().neutron_mode != neutron::NeutronDetectorMode::kNone;
+
+    std::atomic<std::size_t> next_pass{0};
+    // [EN] First exception from any worker; once set, the remaining passes and events are skipped.
+    // [CN] 任一线程的第一个异常；一旦设置，其余 pass 与事件不再处理。
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    std::string error_label;
+    std::atomic<bool> stop{false};
+    auto worker = [&] {
+        std::size_t p = passes.size();
+        try {
+            PDCSimAna pdc_ana(geometry);
+            TRandom3 rng;
+            pdc_ana.SetRandomGenerator(&rng);
+            // [EN] Only the hit-level entry points are used, so the plain NEBULA class serves every wall mode.
+            // [CN] 只使用击中级接口，因此普通 NEBULA 类可用于所有探测器模式。
+            NEBULAReco neutron_reco(geometry);
+            neutron_reco.SetTargetPosition(geometry.GetTargetPosition());
+            RecoEvent reco_event;
+            std::vector<NEBULAHit> neutron_hits;
+
+            for (p = next_pass.fetch_add(1); p < passes.size() && !stop.load(std::memory_order_acquire);
+                 p = next_pass.fetch_add(1)) {
+                const SmearingPass& pass = passes[p];
+                pdc_ana.SetSmearing(pass.pdc_sigma_u_mm, pass.pdc_sigma_v_mm);
+                rng.SetSeed(pass.seed);
+                neutron_reco.SetTimeWindow(pass.nebula_time_window_ns);
+                neutron_reco.SetEnergyThreshold(pass.nebula_energy_threshold_mev);
+
+                for (std::size_t event = 0; event < store.GetEventCount() && !stop.load(std::memory_order_acquire);
+                     ++event) {
+                    pdc_ana.ProcessEvent(store.PdcHits(event), reco_event);
+                    if (have_neutrons && pass.reconstruct_neutrons && store.GetNeutronHitCount(event) > 0) {
+                        store.NeutronHits(event, &neutron_hits);
+                        neutron_hits.erase(std::remove_if(neutron_hits.begin(), neutron_hits.end(),
+                                                          [&](const NEBULAHit& hit) {
+                                                              return hit.energy < pass.nebula_energy_threshold_mev;
+                                                          }),
+                                           neutron_hits.end());
+                        neutron_reco.ProcessHits(neutron_hits, reco_event);
+                    }
+                    reco_event.eventID = static_cast<int>(store.GetEntry(event));
+                    visitor(p, event, reco_event);
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+                error_label = p < passes.size() ? passes[p].label : std::string();
+            }
+            stop.store(true, std::memory_order_release);
+        }
+    };
+
+    const int workers = std::max(1, std::min<int>(threads, static_cast<int>(passes.size())));
+    if (workers == 1) {
+        worker();
+    } else {
+        std::vector<std::thread> pool;
+        pool.reserve(static_cast<std::size_t>(workers));
+        for (int t = 0; t < workers; ++t) {
+            pool.emplace_back(worker);
+        }
+        for (auto& thread : pool) {
+            thread.join();
+        }
+    }
+    if (error) {
+        std::string what = "unknown exception";
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::exception& ex) {
+            what = ex.what();
+        } catch (...) {
+        }
+        SetReason(reason, "pass '" + error_label + "' failed: " + what);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace analysis::event_cache
@@ -1,3 +1,4 @@
+#define SM_LOG_MODULE "Field"
 #include "MagneticField.hh"
 #include "SMLogger.hh"
 #include "TFile.h"
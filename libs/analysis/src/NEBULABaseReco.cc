@@ -1,8 +1,9 @@
+#define SM_LOG_MODULE "NEBULA"
 #include "NEBULABaseReco.hh"
 #include "SMLogger.hh"
-#include "TRandom3.h"
 #include <algorithm>
 #include <cmath>
+#include <numeric>
 
 // 物理常数
 const double NEBULABaseReco::kLightSpeed  = 29.9792458; // cm/ns
@@ -24,13 +25,17 @@ NEBULABaseReco::NEBULABaseReco(const GeometryManager& geo)
 // ---------------------------------------------------------------------------
 
 std::vector<RecoNeutron> NEBULABaseReco::ReconstructNeutrons() {
-    auto hits = ExtractHits();
+    return ReconstructNeutrons(ExtractHits());
+}
+
+std::vector<RecoNeutron> NEBULABaseReco::ReconstructNeutrons(const std::vector<NEBULAHit>& hits) {
     std::vector<RecoNeutron> neutrons;
     if (hits.empty()) return neutrons;
 
-    auto clusters = ClusterHits(hits);
-    for (const auto& cl : clusters) {
-        RecoNeutron n = ReconstructFromCluster(cl);
+    const std::size_t nClusters = ClusterHits(hits);
+    for (std::size_t c = 0; c < nClusters; ++c) {
+        RecoNeutron n = ReconstructFromCluster(hits, fClusterMembers.data() + fClusterStart[c],
+                                               fClusterStart[c + 1] - fClusterStart[c]);
         if (n.hitMultiplicity > 0) {
             neutrons.push_back(n);
         }
@@ -40,10 +45,14 @@ std::vector<RecoNeutron> NEBULABaseReco::ReconstructNeutrons() {
 
 void NEBULABaseReco::ProcessEvent(RecoEvent& event) {
     SM_DEBUG("NEBULABaseReco::ProcessEvent 开始");
+    ProcessHits(ExtractHits(), event);
+}
 
-    std::vector<RecoNeutron> neutrons = ReconstructNeutrons();
+void NEBULABaseReco::ProcessHits(const std::vector<NEBULAHit>& hits, RecoEvent& event) {
+    std::vector<RecoNeutron> neutrons = ReconstructNeutrons(hits);
 
-    SM_INFO("重建总结: 发现 {} 个中子", neutrons.size());
+    SM_COUNT("NEBULA/events");
+    SM_DEBUG("重建总结: 发现 {} 个中子", neutrons.size());
 
     // 将中子信息添加到 RecoEvent (matches legacy ProcessEvent semantics exactly)
     event.neutrons = neutrons;
@@ -65,46 +74,107 @@ void NEBULABaseReco::ProcessEvent(RecoEvent& event) {
 // Shared algorithm steps (ported verbatim from NEBULAReco)
 // ---------------------------------------------------------------------------
 
-std::vector<std::vector<NEBULAHit>> NEBULABaseReco::ClusterHits(
-        const std::vector<NEBULAHit>& hits) {
-    std::vector<std::vector<NEBULAHit>> clusters;
-
-    // 简单的时间聚类算法 — 按时间排序后贪心分组
-    std::vector<NEBULAHit> sortedHits = hits;
-    std::sort(sortedHits.begin(), sortedHits.end(),
-              [](const NEBULAHit& a, const NEBULAHit& b) {
-                  return a.time < b.time;
-              });
+std::size_t NEBULABaseReco::ClusterHits(const std::vector<NEBULAHit>& hits) {
+    const int n = static_cast<int>(hits.size());
 
-    std::vector<bool> used(sortedHits.size(), false);
+    // 按时间排序索引（同时间保持输入顺序），不复制 hit
+    fOrder.resize(n);
+    std::iota(fOrder.begin(), fOrder.end(), 0);
+    std::sort(fOrder.begin(), fOrder.end(), [&hits](int a, int b) {
+        if (hits[a].time != hits[b].time) return hits[a].time < hits[b].time;
+        return a < b;
+    });
 
-    for (size_t i = 0; i < sortedHits.size(); ++i) {
-        if (used[i]) continue;
+    fClusterOf.assign(n, -1);
+    if (fAdjacency) {
+        ClusterByModule(hits);
+    } else {
+        ClusterByTime(hits);
+    }
 
-        std::vector<NEBULAHit> cluster;
-        cluster.push_back(sortedHits[i]);
-        used[i] = true;
+    // Counting sort by label; labels follow the earliest hit of each cluster and members stay in time order.
+    int nClusters = 0;
+    for (int h : fClusterOf) nClusters = std::max(nClusters, h + 1);
+    fClusterStart.assign(nClusters + 1, 0);
+    for (int h : fClusterOf) ++fClusterStart[h + 1];
+    std::partial_sum(fClusterStart.begin(), fClusterStart.end(), fClusterStart.begin());
+    fClusterMembers.resize(n);
+    fParent.assign(fClusterStart.begin(), fClusterStart.end() - 1);  // union-find done; reuse as write cursors
+    for (int h : fOrder) fClusterMembers[fParent[fClusterOf[h]]++] = h;
+    return static_cast<std::size_t>(nClusters);
+}
 
-        for (size_t j = i + 1; j < sortedHits.size(); ++j) {
-            if (used[j]) continue;
-            if (std::abs(sortedHits[j].time - sortedHits[i].time) <= fTimeWindow) {
-                cluster.push_back(sortedHits[j]);
-                used[j] = true;
+void NEBULABaseReco::ClusterByTime(const std::vector<NEBULAHit>& hits) {
+    // 简单的时间聚类算法 — 按时间排序后贪心分组 (legacy behaviour)
+    const int n = static_cast<int>(fOrder.size());
+    int label = 0;
+    for (int i = 0; i < n; ++i) {
+        const int seed = fOrder[i];
+        if (fClusterOf[seed] >= 0) continue;
+        fClusterOf[seed] = label;
+
+        for (int j = i + 1; j < n; ++j) {
+            const int h = fOrder[j];
+            if (fClusterOf[h] >= 0) continue;
+            if (std::abs(hits[h].time - hits[seed].time) <= fTimeWindow) {
+                fClusterOf[h] = label;
             } else {
                 break; // 时间已排序，后面的都超出窗口
             }
         }
+        ++label;
+    }
+}
 
-        clusters.push_back(cluster);
+void NEBULABaseReco::ClusterByModule(const std::vector<NEBULAHit>& hits) {
+    const int n = static_cast<int>(fOrder.size());
+    fParent.resize(n);
+    std::iota(fParent.begin(), fParent.end(), 0);
+    fModuleIndex.resize(n);
+    for (int h = 0; h < n; ++h) {
+        const int detector = (hits[h].wall_tag == 1 || hits[h].wall_tag == 2)
+            ? NEBULAModuleAdjacency::kNEBULAPlus : NEBULAModuleAdjacency::kNEBULA;
+        fModuleIndex[h] = fAdjacency->Index(detector, hits[h].moduleID);
+    }
+    const double maxDistance = fAdjacency->GetMaxNeighbourDistance();
+
+    // 时间窗内的 hit 对：相同或相邻模块则合并；未知模块退化为中心距离判据
+    for (int i = 0; i < n; ++i) {
+        const int a = fOrder[i];
+        for (int j = i + 1; j < n; ++j) {
+            const int b = fOrder[j];
+            if (hits[b].time - hits[a].time > fTimeWindow) break;
+            const bool linked = (fModuleIndex[a] >= 0 && fModuleIndex[b] >= 0)
+                ? fAdjacency->Adjacent(fModuleIndex[a], fModuleIndex[b])
+                : (hits[a].position - hits[b].position).Mag() <= maxDistance;
+            if (!linked) continue;
+            const int ra = FindRoot(a);
+            const int rb = FindRoot(b);
+            if (ra != rb) fParent[std::max(ra, rb)] = std::min(ra, rb);
+        }
     }
 
-    return clusters;
+    // Roots take labels in time order of their earliest hit; every other hit copies its root's label.
+    int label = 0;
+    for (int h : fOrder) {
+        const int r = FindRoot(h);
+        if (fClusterOf[r] < 0) fClusterOf[r] = label++;
+    }
+    for (int h = 0; h < n; ++h) fClusterOf[h] = fClusterOf[FindRoot(h)];
+}
+
+int NEBULABaseReco::FindRoot(int i) {
+    while (fParent[i] != i) {
+        fParent[i] = fParent[fParent[i]];  // path halving
+        i = fParent[i];
+    }
+    return i;
 }
 
 RecoNeutron NEBULABaseReco::ReconstructFromCluster(
-        const std::vector<NEBULAHit>& cluster) {
+        const std::vector<NEBULAHit>& hits, const int* members, std::size_t count) {
     RecoNeutron neutron;
-    if (cluster.empty()) return neutron;
+    if (count == 0) return neutron;
 
     // 计算加权质心位置
     TVector3 weightedPos(0, 0, 0);
@@ -112,7 +182,8 @@ RecoNeutron NEBULABaseReco::ReconstructFromCluster(
     double avgTime     = 0;
     double totalEnergy = 0;
 
-    for (const auto& hit : cluster) {
+    for (std::size_t k = 0; k < count; ++k) {
+        const NEBULAHit& hit = hits[members[k]];
         double weight = hit.energy;
         weightedPos += weight * hit.position;
         totalWeight += weight;
@@ -124,12 +195,12 @@ RecoNeutron NEBULABaseReco::ReconstructFromCluster(
         neutron.position = weightedPos * (1.0 / totalWeight);
         avgTime /= totalWeight;
     } else {
-        neutron.position = cluster[0].position;
-        avgTime = cluster[0].time;
+        neutron.position = hits[members[0]].position;
+        avgTime = hits[members[0]].time;
     }
 
     neutron.energy         = totalEnergy;
-    neutron.hitMultiplicity = cluster.size();
+    neutron.hitMultiplicity = count;
     neutron.timeOfFlight   = avgTime;
 
     // 计算飞行方向和距离
@@ -145,25 +216,18 @@ RecoNeutron NEBULABaseReco::ReconstructFromCluster(
     // 计算beta值
     neutron.beta = CalculateBeta(neutron.flightLength, neutron.timeOfFlight);
 
-    SM_INFO("=== NEBULA中子重建结果 ===");
-    SM_INFO("聚类包含hits数: {}", cluster.size());
-    SM_INFO("重建位置: ({:.2f}, {:.2f}, {:.2f}) mm",
-            neutron.position.X(), neutron.position.Y(), neutron.position.Z());
-    SM_INFO("飞行方向: ({:.4f}, {:.4f}, {:.4f})",
-            neutron.direction.X(), neutron.direction.Y(), neutron.direction.Z());
-    SM_INFO("飞行距离: {:.2f} mm", neutron.flightLength);
-    SM_INFO("飞行时间: {:.2f} ns", neutron.timeOfFlight);
-    SM_INFO("Beta值: {:.4f}", neutron.beta);
-    SM_INFO("总能量: {:.2f} MeV", neutron.energy);
-
-    double neutronKE = CalculateNeutronEnergy(neutron.beta);
-    SM_INFO("中子动能: {:.2f} MeV", neutronKE);
-
-    double theta = neutron.direction.Theta() * 180.0 / TMath::Pi();
-    double phi   = neutron.direction.Phi()   * 180.0 / TMath::Pi();
-    SM_INFO("极角θ: {:.2f}°", theta);
-    SM_INFO("方位角φ: {:.2f}°", phi);
-    SM_INFO("=========================");
+    // 逐中子结果：前 10 个完整输出，之后每 10000 个输出一个；总数见周期汇总 (NEBULA/neutrons)
+    SM_COUNT("NEBULA/neutrons");
+    SM_INFO_LIMITED(10, 10000,
+                    "NEBULA中子重建结果: hits={} 位置=({:.2f}, {:.2f}, {:.2f}) mm 方向=({:.4f}, {:.4f}, {:.4f}) "
+                    "飞行距离={:.2f} mm 飞行时间={:.2f} ns beta={:.4f} 总能量={:.2f} MeV 中子动能={:.2f} MeV "
+                    "θ={:.2f}° φ={:.2f}°",
+                    count, neutron.position.X(), neutron.position.Y(), neutron.position.Z(),
+                    neutron.direction.X(), neutron.direction.Y(), neutron.direction.Z(),
+                    neutron.flightLength, neutron.timeOfFlight, neutron.beta, neutron.energy,
+                    CalculateNeutronEnergy(neutron.beta),
+                    neutron.direction.Theta() * 180.0 / TMath::Pi(),
+                    neutron.direction.Phi() * 180.0 / TMath::Pi());
 
     return neutron;
 }
@@ -192,17 +256,15 @@ double NEBULABaseReco::CalculateNeutronEnergy(double beta) {
 TVector3 NEBULABaseReco::ApplyPositionSmearing(const TVector3& pos) {
     if (fPositionSmearing <= 0) return pos;
 
-    TRandom3 rand;
     TVector3 smearedPos = pos;
-    smearedPos.SetX(pos.X() + rand.Gaus(0, fPositionSmearing));
-    smearedPos.SetY(pos.Y() + rand.Gaus(0, fPositionSmearing));
-    smearedPos.SetZ(pos.Z() + rand.Gaus(0, fPositionSmearing));
+    smearedPos.SetX(pos.X() + fRandom.Gaus(0, fPositionSmearing));
+    smearedPos.SetY(pos.Y() + fRandom.Gaus(0, fPositionSmearing));
+    smearedPos.SetZ(pos.Z() + fRandom.Gaus(0, fPositionSmearing));
     return smearedPos;
 }
 
 double NEBULABaseReco::ApplyTimeSmearing(double time) {
     if (fTimeSmearing <= 0) return time;
 
-    TRandom3 rand;
-    return time + rand.Gaus(0, fTimeSmearing);
+    return time + fRandom.Gaus(0, fTimeSmearing);
 }
@@ -0,0 +1,102 @@
+#include "NEBULAModuleAdjacency.hh"
+
+#include "TNEBULAPlusSimParameter.hh"
+#include "TNEBULASimParameter.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+template <typename Parameter, typename Map>
+void AddModules(NEBULAModuleAdjacency& adjacency, int detector, const Parameter& prm, const Map& modules) {
+    for (const auto& [id, module] : modules) {
+        // [EN] Same placement as the converters: module offset plus system position, rotation ignored.
+        // [CN] 与转换器相同的放置方式：模块偏移加整体位置，不考虑转动。
+        const TVector3& size = module.fDetectorType == "Veto" ? prm.fVetoSize : prm.fNeutSize;
+        adjacency.AddModule(detector, id, module.fPosition + prm.fPosition, size);
+    }
+}
+
+}  // namespace
+
+void NEBULAModuleAdjacency::Clear() {
+    fCenters.clear();
+    fSizes.clear();
+    for (auto& table : fIndexByID) table.clear();
+    fOffsets.clear();
+    fNeighbours.clear();
+    fMaxNeighbourDistance = 0.0;
+    fBuilt = false;
+}
+
+void NEBULAModuleAdjacency::AddModule(int detector, int id, const TVector3& center, const TVector3& size) {
+    if (detector < 0 || detector >= kNDetectors || id < 0) return;
+    std::vector<int>& table = fIndexByID[detector];
+    if (static_cast<std::size_t>(id) >= table.size()) table.resize(id + 1, -1);
+    if (table[id] >= 0) {
+        fCenters[table[id]] = center;
+        fSizes[table[id]] = size;
+    } else {
+        table[id] = static_cast<int>(fCenters.size());
+        fCenters.push_back(center);
+        fSizes.push_back(size);
+    }
+    fBuilt = false;
+}
+
+void NEBULAModuleAdjacency::AddDetector(const TNEBULASimParameter& prm) {
+    AddModules(*this, kNEBULA, prm, prm.fNEBULADetectorParameterMap);
+}
+
+void NEBULAModuleAdjacency::AddDetector(const TNEBULAPlusSimParameter& prm) {
+    AddModules(*this, kNEBULAPlus, prm, prm.fNEBULAPlusDetectorParameterMap);
+}
+
+void NEBULAModuleAdjacency::Build(double gap_mm) {
+    const int n = static_cast<int>(fCenters.size());
+    std::vector<std::pair<int, int>> pairs;
+
+    // [EN] Sweep along x: once a module's left edge is past the current right edge plus the gap, no later
+    //      module can touch it, so only geometric neighbours are ever compared.
+    // [CN] 沿 x 扫描：某模块左边缘超过当前右边缘加间隙后，其后的模块都不可能相接，因此只比较几何近邻。
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    auto low_x = [&](int i) { return fCenters[i].X() - 0.5 * fSizes[i].X(); };
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return low_x(a) < low_x(b); });
+
+    fMaxNeighbourDistance = 0.0;
+    for (int i = 0; i < n; ++i) {
+        const int a = order[i];
+        const double high_x = fCenters[a].X() + 0.5 * fSizes[a].X() + gap_mm;
+        for (int j = i + 1; j < n && low_x(order[j]) <= high_x; ++j) {
+            const int b = order[j];
+            const TVector3 d = fCenters[b] - fCenters[a];
+            const TVector3 half = 0.5 * (fSizes[a] + fSizes[b]);
+            if (std::abs(d.Y()) - half.Y() > gap_mm || std::abs(d.Z()) - half.Z() > gap_mm) continue;
+            pairs.emplace_back(a, b);
+            pairs.emplace_back(b, a);
+            fMaxNeighbourDistance = std::max(fMaxNeighbourDistance, d.Mag());
+        }
+    }
+
+    std::sort(pairs.begin(), pairs.end());
+    fOffsets.assign(n + 1, 0);
+    fNeighbours.resize(pairs.size());
+    for (std::size_t k = 0; k < pairs.size(); ++k) {
+        ++fOffsets[pairs[k].first + 1];
+        fNeighbours[k] = pairs[k].second;
+    }
+    std::partial_sum(fOffsets.begin(), fOffsets.end(), fOffsets.begin());
+    fBuilt = true;
+}
+
+bool NEBULAModuleAdjacency::Adjacent(int a, int b) const {
+    if (a < 0 || b < 0) return false;
+    if (a == b) return true;
+    if (!fBuilt) return false;
+    const int* begin = fNeighbours.data() + fOffsets[a];
+    const int* end = fNeighbours.data() + fOffsets[a + 1];
+    return std::binary_search(begin, end, b);
+}
@@ -1,3 +1,4 @@
+#define SM_LOG_MODULE "NEBULA"
 #include "NEBULAPlusReco.hh"
 #include "TArtNEBULAPlusPla.hh"
 #include "SMLogger.hh"
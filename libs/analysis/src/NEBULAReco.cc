@@ -1,3 +1,4 @@
+#define SM_LOG_MODULE "NEBULA"
 #include "NEBULAReco.hh"
 #include "SMLogger.hh"
 #include "TClass.h"
@@ -28,7 +29,7 @@ std::vector<NEBULAHit> NEBULAReco::ExtractHits() {
         // 检查对象是否是TArtNEBULAPla类型
         TClass* objClass = obj->IsA();
         if (!objClass || strcmp(objClass->GetName(), "TArtNEBULAPla") != 0) {
-            SM_WARN("对象 {} 类型是 {}，不是TArtNEBULAPla，跳过...",
+            SM_WARN_LIMITED(10, 1000, "对象 {} 类型是 {}，不是TArtNEBULAPla，跳过...",
                     i, (objClass ? objClass->GetName() : "unknown"));
             continue;
         }
@@ -90,8 +91,9 @@ std::vector<NEBULAHit> NEBULAReco::ExtractHits() {
         pos  = ApplyPositionSmearing(pos);
         time = ApplyTimeSmearing(time);
 
-        // wall_tag = 0: no layer information in reflection path
-        NEBULAHit hit(i, pos, energy, time, energy);
+        // wall_tag = 0: no layer information in reflection path; moduleID is the detector ID
+        // (NEBULAModuleAdjacency key), as in NebulaJointReco.
+        NEBULAHit hit(id, pos, energy, time, energy);
         hits.push_back(hit);
     }
 
@@ -1,3 +1,4 @@
+#define SM_LOG_MODULE "NEBULA"
 #include "NebulaJointReco.hh"
 #include "TArtNEBULAPlusPla.hh"
 #include "SMLogger.hh"
@@ -69,7 +70,7 @@ std::vector<NEBULAHit> NebulaJointReco::ExtractHits() {
             // Validate that the object is TArtNEBULAPla
             TClass* objClass = obj->IsA();
             if (!objClass || strcmp(objClass->GetName(), "TArtNEBULAPla") != 0) {
-                SM_WARN("NebulaJointReco: object {} type is {}, not TArtNEBULAPla, skipping",
+                SM_WARN_LIMITED(10, 1000, "NebulaJointReco: object {} type is {}, not TArtNEBULAPla, skipping",
                         i, (objClass ? objClass->GetName() : "unknown"));
                 continue;
             }
@@ -2,15 +2,52 @@
 #include "TSimData.hh"
 #include <cmath>
 #include <iostream>
+#include <limits>
+#include <utility>
 
 #include "TMath.h"
-#include "TRandom3.h"
 
 ClassImp(PDCSimAna);
 
+namespace {
+
+// [EN] Correctly rounded sqrt(2), identical to TMath::Sqrt(2.0). / [CN] 正确舍入的 sqrt(2)，与 TMath::Sqrt(2.0) 相同。
+constexpr double kSqrt2 = 1.4142135623730951;
+constexpr std::size_t kMaxCachedNames = 16;
+
+}  // namespace
+
+bool PDCHitClassifier::Classify(const TSimData& hit, signed char* plane, signed char* layer) {
+    if (Lookup(fDetectors, hit.fDetectorName, true) < 0) return false;
+    *plane = static_cast<signed char>((hit.fID == 0 || hit.fID == 1) ? hit.fID : -1);
+    *layer = Lookup(fModules, hit.fModuleName, false);
+    return true;
+}
+
+signed char PDCHitClassifier::Lookup(std::vector<NameCode>& table, const TString& name, bool detector) {
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        if (table[i].name == name) {
+            if (i != 0) std::swap(table[0], table[i]);
+            return table[0].code;
+        }
+    }
+    signed char code = -1;
+    if (detector) {
+        code = name.Contains("PDC") ? 1 : -1;
+    } else {
+        code = name == "U" ? 0 : (name == "V" ? 1 : -1);
+    }
+    if (table.size() >= kMaxCachedNames) table.pop_back();
+    table.insert(table.begin(), NameCode{name, code});
+    return code;
+}
+
 PDCSimAna::PDCSimAna(const GeometryManager& geo_manager)
-    : fGeoManager(geo_manager), fSigmaU(0.), fSigmaV(0.) {
+    : fGeoManager(geo_manager), fSigmaU(0.), fSigmaV(0.), fRandom(nullptr),
+      fFrameAngle(std::numeric_limits<double>::quiet_NaN()),
+      fCosAngle(1.), fSinAngle(0.), fCosNegAngle(1.), fSinNegAngle(0.) {
     ClearAll();
+    UpdateFrame();
 }
 
 PDCSimAna::~PDCSimAna() {}
@@ -33,6 +70,27 @@ void PDCSimAna::ClearAll() {
     fRecoPoint2.SetXYZ(0, 0, 0);
 }
 
+void PDCSimAna::UpdateFrame() {
+    // [EN] Checked once per event; trig and rotated centers are only recomputed when the geometry changed.
+    // [CN] 每事件检查一次；仅在几何变化时重算三角函数和旋转后的中心。
+    const double angle = fGeoManager.GetAngleRad();
+    const TVector3 pdc1 = fGeoManager.GetPDC1Position();
+    const TVector3 pdc2 = fGeoManager.GetPDC2Position();
+    if (angle == fFrameAngle && pdc1 == fFramePDC1 && pdc2 == fFramePDC2) return;
+
+    fFrameAngle = angle;
+    fFramePDC1 = pdc1;
+    fFramePDC2 = pdc2;
+    fCosAngle = TMath::Cos(angle);
+    fSinAngle = TMath::Sin(angle);
+    fCosNegAngle = TMath::Cos(-angle);
+    fSinNegAngle = TMath::Sin(-angle);
+    fPDC1Rotated = pdc1;
+    fPDC1Rotated.RotateY(-angle);
+    fPDC2Rotated = pdc2;
+    fPDC2Rotated.RotateY(-angle);
+}
+
 // 新接口 - 返回值版本
 RecoEvent PDCSimAna::ProcessEvent(TClonesArray* fragSimData) {
     RecoEvent result;
@@ -46,67 +104,64 @@ void PDCSimAna::ProcessEvent(TClonesArray* fragSimData, RecoEvent& outEvent) {
     ClearAll();
     outEvent.Clear();
     if (!fragSimData) return;
-
-    const double sqrt2 = TMath::Sqrt(2.0);
-    const double angle = fGeoManager.GetAngleRad();
-    TVector3 pdc1_beforeRotation_position=fGeoManager.GetPDC1Position();
-    TVector3 pdc2_beforeRotation_position=fGeoManager.GetPDC2Position();
-    pdc1_beforeRotation_position.RotateY(-angle);
-    pdc2_beforeRotation_position.RotateY(-angle);
-    const TVector3 pos1 = pdc1_beforeRotation_position;
-    const TVector3 pos2 = pdc2_beforeRotation_position;
-
-    // std::cout << "PDC1 Position: " << pos1.X() << ", " << pos1.Y() << ", " << pos1.Z() << std::endl;
-    // std::cout << "PDC2 Position: " << pos2.X() << ", " << pos2.Y() << ", " << pos2.Z() << std::endl;
+    UpdateFrame();
 
     // 1. Sort raw hits from TClonesArray
     int n_entries = fragSimData->GetEntries();
     for (int i = 0; i < n_entries; ++i) {
         TSimData* hit = (TSimData*)fragSimData->At(i);
-        if (!hit || !hit->fDetectorName.Contains("PDC")) continue;
-
-        TVector3 pos = hit->fPrePosition;
-        if (hit->fID == 0) { // PDC1
-            TVector3 pos_rel = pos - pos1;
-            double x_rot = pos_rel.X() * TMath::Cos(-angle) - pos_rel.Z() * TMath::Sin(-angle);
-            double u_pos = (x_rot + pos.Y()) / sqrt2;
-            double v_pos = (-x_rot + pos.Y()) / sqrt2;
-            
-            // Set z-offset according to layer type
-            double z_offset = 0.0;
-            if (hit->fModuleName == "U") {
-                z_offset = -12.0; // U Layer at -12 mm
-                fU1_hits.push_back(Hit(u_pos, hit->fEnergyDeposit, z_offset));
-            }
-            if (hit->fModuleName == "V") {
-                z_offset = +12.0; // V Layer at +12 mm
-                fV1_hits.push_back(Hit(v_pos, hit->fEnergyDeposit, z_offset));
-            }
-        } else if (hit->fID == 1) { // PDC2
-            TVector3 pos_rel = pos - pos2;
-            double x_rot = pos_rel.X() * TMath::Cos(-angle) - pos_rel.Z() * TMath::Sin(-angle);
-            double u_pos = (x_rot + pos.Y()) / sqrt2;
-            double v_pos = (-x_rot + pos.Y()) / sqrt2;
-
-            
-            // Set z-offset according to layer type
-            double z_offset = 0.0;
-            if (hit->fModuleName == "U") {
-                z_offset = -12.0; // U Layer at -12 mm
-                fU2_hits.push_back(Hit(u_pos, hit->fEnergyDeposit, z_offset));
-            }
-            if (hit->fModuleName == "V") {
-                z_offset = +12.0; // V Layer at +12 mm
-                fV2_hits.push_back(Hit(v_pos, hit->fEnergyDeposit, z_offset));
-            }
-        }
+        signed char plane = -1;
+        signed char layer = -1;
+        if (!hit || !fClassifier.Classify(*hit, &plane, &layer)) continue;
+
+        AddLayerHit(plane, layer, hit->fPrePosition, hit->fEnergyDeposit);
+
+        // 添加原始击中
+        outEvent.rawHits.push_back(RecoHit(hit->fPrePosition, hit->fEnergyDeposit));
+        //没有energyDeposit 得用get preenergy--energy
+    }
+
+    SmearAndReconstruct(outEvent);
+}
+
+void PDCSimAna::ProcessEvent(const PDCHitArrays& hits, RecoEvent& outEvent) {
+    ClearAll();
+    outEvent.Clear();
+    UpdateFrame();
+
+    for (std::size_t i = 0; i < hits.size; ++i) {
+        const TVector3 pos(hits.x[i], hits.y[i], hits.z[i]);
+        AddLayerHit(hits.plane[i], hits.layer[i], pos, hits.energy[i]);
+        outEvent.rawHits.push_back(RecoHit(pos, hits.energy[i]));
+    }
+
+    SmearAndReconstruct(outEvent);
+}
+
+void PDCSimAna::AddLayerHit(int plane, int layer, const TVector3& pos, double energy) {
+    if (plane < 0 || layer < 0) return;
+
+    const TVector3& pdc_position = plane == 0 ? fPDC1Rotated : fPDC2Rotated;
+    const double rel_x = pos.X() - pdc_position.X();
+    const double rel_z = pos.Z() - pdc_position.Z();
+    double x_rot = rel_x * fCosNegAngle - rel_z * fSinNegAngle;
+    double u_pos = (x_rot + pos.Y()) / kSqrt2;
+    double v_pos = (-x_rot + pos.Y()) / kSqrt2;
+
+    // Set z-offset according to layer type: U Layer at -12 mm, V Layer at +12 mm
+    if (layer == 0) {
+        (plane == 0 ? fU1_hits : fU2_hits).push_back(Hit(u_pos, energy, -12.0));
+    } else {
+        (plane == 0 ? fV1_hits : fV2_hits).push_back(Hit(v_pos, energy, +12.0));
     }
+}
 
+void PDCSimAna::SmearAndReconstruct(RecoEvent& outEvent) {
     // 2. Perform smearing if sigma > 0
-    if (!gRandom) gRandom = new TRandom3(0);
+    TRandom* rng = fRandom ? fRandom : &fOwnRandom;
     auto smear_vector = [&](const std::vector<Hit>& in_hits, std::vector<Hit>& out_hits, double sigma) {
         for (const auto& hit : in_hits) {
-            out_hits.push_back(Hit(hit.position + gRandom->Gaus(0, sigma), hit.energy, hit.z));
+            out_hits.push_back(Hit(hit.position + rng->Gaus(0, sigma), hit.energy, hit.z));
         }
     };
 
@@ -115,27 +170,21 @@ void PDCSimAna::ProcessEvent(TClonesArray* fragSimData, RecoEvent& outEvent) {
     smear_vector(fU2_hits, fU2_hits_smeared, fSigmaU);
     smear_vector(fV2_hits, fV2_hits_smeared, fSigmaV);
 
+    // [EN] Multi-track events are fully handled by the track finder; everything else keeps the single-track path.
+    // [CN] 多径迹事件完全由寻迹器处理；其余事件保持单径迹路径。
+    if (fTrackFinder.enabled && FindTracks(outEvent)) return;
+
     // 3. Perform reconstruction using the smeared hits
-    fRecoPoint1 = ReconstructPDC(fU1_hits_smeared, fV1_hits_smeared, pos1);
-    fRecoPoint2 = ReconstructPDC(fU2_hits_smeared, fV2_hits_smeared, pos2);
-    
+    fRecoPoint1 = ReconstructPDC(fU1_hits_smeared, fV1_hits_smeared, fPDC1Rotated);
+    fRecoPoint2 = ReconstructPDC(fU2_hits_smeared, fV2_hits_smeared, fPDC2Rotated);
+
     // 4. 填充 RecoEvent 对象
-    // 添加原始击中
-    for (int i = 0; i < n_entries; ++i) {
-        TSimData* hit = (TSimData*)fragSimData->At(i);
-        if (!hit || !hit->fDetectorName.Contains("PDC")) continue;
-        
-        // outEvent.rawHits.push_back(RecoHit(hit->fPrePosition, hit->fEnergyDeposit));
-        outEvent.rawHits.push_back(RecoHit(hit->fPrePosition, hit->fEnergyDeposit));
-        //没有energyDeposit 得用get preenergy--energy
-    }
-    
     // 添加涂抹后的点（获取完整的全局位置列表）
     std::vector<TVector3> smearedPositions = GetSmearedGlobalPositions();
     for (const auto& pos : smearedPositions) {
         outEvent.smearedHits.push_back(RecoHit(pos, 1.0)); // 能量设为1.0作为权重
     }
-    
+
     // 添加重建轨迹（如果有两个点）
     if (fRecoPoint1.Mag() > 0 && fRecoPoint2.Mag() > 0) {
         outEvent.tracks.push_back(RecoTrack(fRecoPoint1, fRecoPoint2));
@@ -161,14 +210,9 @@ std::vector<TVector3> PDCSimAna::GetSmearedGlobalPositions() const {
 
     };
 
-    // Rotate PDC center positions to match the coordinate system used above
-    TVector3 pdc1_pos_rot = fGeoManager.GetPDC1Position();
-    pdc1_pos_rot.RotateY(-fGeoManager.GetAngleRad());
-    TVector3 pdc2_pos_rot = fGeoManager.GetPDC2Position();
-    pdc2_pos_rot.RotateY(-fGeoManager.GetAngleRad());
-
-    add_positions(fU1_hits_smeared, fV1_hits_smeared, pdc1_pos_rot);
-    add_positions(fU2_hits_smeared, fV2_hits_smeared, pdc2_pos_rot);
+    // PDC centers rotated into the same frame (cached by UpdateFrame())
+    add_positions(fU1_hits_smeared, fV1_hits_smeared, fPDC1Rotated);
+    add_positions(fU2_hits_smeared, fV2_hits_smeared, fPDC2Rotated);
 
     return positions;
 
@@ -184,15 +228,16 @@ TVector3 PDCSimAna::ReconstructPDC(const std::vector<Hit>& u_hits, const std::ve
     double v_com = CalculateCoM(v_hits);
     // std::cout << "V CoM: " << v_com << std::endl;
 
-    
-    const double sqrt2 = TMath::Sqrt(2.0);
-    double y_global = (u_com + v_com) / sqrt2;
-    double x_local = (u_com - v_com) / sqrt2;
+    return ToGlobal(u_com, v_com, pdc_position);
+}
+
+TVector3 PDCSimAna::ToGlobal(double u_com, double v_com, const TVector3& pdc_position) const {
+    double y_global = (u_com + v_com) / kSqrt2;
+    double x_local = (u_com - v_com) / kSqrt2;
 
     // TVector3 pdc_in_global = pdc_position;
-    const double angle = fGeoManager.GetAngleRad();
-    double x_rotatedBack = x_local * TMath::Cos(angle);
-    double z_rotatedBack = x_local * TMath::Sin(angle);
+    double x_rotatedBack = x_local * fCosAngle;
+    double z_rotatedBack = x_local * fSinAngle;
 
     double final_X = x_rotatedBack + pdc_position.X();
     double final_Y = y_global + pdc_position.Y();
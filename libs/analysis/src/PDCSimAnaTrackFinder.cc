@@ -0,0 +1,144 @@
+#include "PDCSimAna.hh"
+
+#include <algorithm>
+#include <cmath>
+
+bool PDCSimAna::BuildClusters(const std::vector<Hit>& hits, std::vector<LayerCluster>& clusters) {
+    clusters.clear();
+    if (hits.empty()) return true;
+
+    fSortScratch.assign(hits.begin(), hits.end());
+    std::sort(fSortScratch.begin(), fSortScratch.end(),
+              [](const Hit& a, const Hit& b) { return a.position < b.position; });
+
+    double weighted = 0.0;
+    double energy = 0.0;
+    double plain = 0.0;
+    std::size_t count = 0;
+    auto flush = [&]() {
+        // [EN] Energy-weighted like CalculateCoM(); a cluster without deposit falls back to the plain mean.
+        // [CN] 与 CalculateCoM() 一样按能量加权；无能量沉积的团簇退化为算术平均。
+        clusters.push_back(LayerCluster{energy > 0 ? weighted / energy : plain / count, energy});
+        weighted = energy = plain = 0.0;
+        count = 0;
+    };
+    for (std::size_t i = 0; i < fSortScratch.size(); ++i) {
+        const Hit& hit = fSortScratch[i];
+        if (count > 0 && hit.position - fSortScratch[i - 1].position > fTrackFinder.cluster_gap_mm) {
+            flush();
+            if (clusters.size() >= fTrackFinder.max_clusters_per_layer) return false;
+        }
+        weighted += hit.position * hit.energy;
+        energy += hit.energy;
+        plain += hit.position;
+        ++count;
+    }
+    flush();
+    return clusters.size() <= fTrackFinder.max_clusters_per_layer;
+}
+
+void PDCSimAna::BuildSpacePoints(const std::vector<LayerCluster>& u, const std::vector<LayerCluster>& v,
+                                 const TVector3& pdc_position, std::vector<SpacePoint>& points) const {
+    points.clear();
+    for (std::size_t i = 0; i < u.size(); ++i) {
+        for (std::size_t j = 0; j < v.size(); ++j) {
+            const double sum = u[i].energy + v[j].energy;
+            const double asymmetry = sum > 0 ? std::abs(u[i].energy - v[j].energy) / sum : 0.0;
+            if (asymmetry > fTrackFinder.max_uv_energy_asymmetry) continue;
+            points.push_back(SpacePoint{ToGlobal(u[i].position, v[j].position, pdc_position),
+                                        static_cast<int>(i), static_cast<int>(j), asymmetry});
+        }
+    }
+}
+
+bool PDCSimAna::FindTracks(RecoEvent& outEvent) {
+    if (!BuildClusters(fU1_hits_smeared, fClustersU1) || !BuildClusters(fV1_hits_smeared, fClustersV1) ||
+        !BuildClusters(fU2_hits_smeared, fClustersU2) || !BuildClusters(fV2_hits_smeared, fClustersV2)) {
+        return false;
+    }
+    // [EN] One cluster per layer (or an empty layer) is exactly what the CoM path already handles.
+    // [CN] 每层至多一个团簇（或有空层）时，质心路径已能正确处理。
+    if (fClustersU1.empty() || fClustersV1.empty() || fClustersU2.empty() || fClustersV2.empty()) return false;
+    if (fClustersU1.size() == 1 && fClustersV1.size() == 1 && fClustersU2.size() == 1 && fClustersV2.size() == 1) {
+        return false;
+    }
+
+    BuildSpacePoints(fClustersU1, fClustersV1, fPDC1Rotated, fPoints1);
+    BuildSpacePoints(fClustersU2, fClustersV2, fPDC2Rotated, fPoints2);
+    if (fPoints1.empty() || fPoints2.empty()) return false;
+
+    // [EN] Wire-plane axis and normal in the lab frame, the normal oriented from PDC1 towards PDC2.
+    // [CN] 实验室系中的丝平面轴与法向，法向取 PDC1 指向 PDC2 的方向。
+    const TVector3 axis(fCosAngle, 0.0, fSinAngle);
+    TVector3 normal(-fSinAngle, 0.0, fCosAngle);
+    if ((fPDC2Rotated - fPDC1Rotated).Dot(normal) < 0) normal = -normal;
+    const TVector3 target = fGeoManager.GetTargetPosition();
+
+    fPairs.clear();
+    for (std::size_t i = 0; i < fPoints1.size(); ++i) {
+        const TVector3& p1 = fPoints1[i].position;
+        const double lever = (p1 - target).Mag();
+        for (std::size_t j = 0; j < fPoints2.size(); ++j) {
+            const TVector3& p2 = fPoints2[j].position;
+            const TVector3 d = p2 - p1;
+            const double along_normal = d.Dot(normal);
+            if (along_normal <= 0) continue;
+            const double angle = std::atan2(std::abs(d.Dot(axis)), along_normal);
+            if (angle > fTrackFinder.max_normal_angle_rad) continue;
+
+            // [EN] The dipole field is vertical, so y grows linearly with path length from the target.
+            // [CN] 二极磁场竖直，y 随自靶点起的路径长度线性变化。
+            double residual = 0.0;
+            if (lever > 0) {
+                const double y_pred = p1.Y() + (p1.Y() - target.Y()) * d.Mag() / lever;
+                residual = p2.Y() - y_pred;
+                if (std::abs(residual) > fTrackFinder.max_y_residual_mm) continue;
+            }
+
+            const double ry = residual / fTrackFinder.max_y_residual_mm;
+            const double ra = angle / fTrackFinder.max_normal_angle_rad;
+            const double score = ry * ry + ra * ra + fPoints1[i].asymmetry * fPoints1[i].asymmetry +
+                                 fPoints2[j].asymmetry * fPoints2[j].asymmetry;
+            fPairs.push_back(TrackPair{static_cast<int>(i), static_cast<int>(j), score});
+        }
+    }
+    if (fPairs.empty()) return false;
+
+    std::sort(fPairs.begin(), fPairs.end(), [](const TrackPair& a, const TrackPair& b) {
+        if (a.score != b.score) return a.score < b.score;
+        return a.p1 != b.p1 ? a.p1 < b.p1 : a.p2 < b.p2;
+    });
+
+    // [EN] Greedy assignment: a U or V cluster belongs to at most one track, which removes the ghost
+    // combinations of already accepted tracks. / [CN] 贪心分配：每个 U/V 团簇至多属于一条径迹，从而剔除已接受径迹的鬼点组合。
+    fAccepted.clear();
+    for (const TrackPair& pair : fPairs) {
+        if (fAccepted.size() >= fTrackFinder.max_tracks) break;
+        const SpacePoint& a = fPoints1[pair.p1];
+        const SpacePoint& b = fPoints2[pair.p2];
+        bool shared = false;
+        for (const TrackPair& taken : fAccepted) {
+            const SpacePoint& ta = fPoints1[taken.p1];
+            const SpacePoint& tb = fPoints2[taken.p2];
+            if (ta.u_cluster == a.u_cluster || ta.v_cluster == a.v_cluster ||
+                tb.u_cluster == b.u_cluster || tb.v_cluster == b.v_cluster) {
+                shared = true;
+                break;
+            }
+        }
+        if (!shared) fAccepted.push_back(pair);
+    }
+
+    for (const TrackPair& pair : fAccepted) {
+        const TVector3& start = fPoints1[pair.p1].position;
+        const TVector3& end = fPoints2[pair.p2].position;
+        RecoTrack track(start, end);
+        track.chi2 = pair.score;
+        outEvent.tracks.push_back(track);
+        outEvent.smearedHits.push_back(RecoHit(start, 1.0));
+        outEvent.smearedHits.push_back(RecoHit(end, 1.0));
+    }
+    fRecoPoint1 = fPoints1[fAccepted.front().p1].position;
+    fRecoPoint2 = fPoints2[fAccepted.front().p2].position;
+    return true;
+}
@@ -1,3 +1,4 @@
+#define SM_LOG_MODULE "Trajectory"
 // 计算单位
 
 // 动量单位 MeV/C
@@ -15,7 +16,7 @@
 // Physics constants
 const double ParticleTrajectory::kSpeedOfLight = 299.792458; // mm/ns (c in natural units)
 
-ParticleTrajectory::ParticleTrajectory(MagneticField* magField)
+ParticleTrajectory::ParticleTrajectory(const MagneticField* magField)
     : fMagField(magField), fStepSize(1.0), fMaxTime(100.0), 
       fMaxDistance(5000.0), fMinMomentum(1.0)
 {
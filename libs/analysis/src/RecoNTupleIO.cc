@@ -0,0 +1,261 @@
+#include "RecoNTupleIO.hh"
+
+#include "TFile.h"
+#include "TKey.h"
+
+#include <limits>
+#include <stdexcept>
+
+#ifndef SMSIM_HAVE_RNTUPLE
+#define SMSIM_HAVE_RNTUPLE 0
+#endif
+
+#if SMSIM_HAVE_RNTUPLE
+#include "RVersion.h"
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleReader.hxx>
+#include <ROOT/RNTupleWriteOptions.hxx>
+#include <ROOT/RNTupleWriter.hxx>
+#endif
+
+namespace analysis::reco_output {
+
+#if SMSIM_HAVE_RNTUPLE
+namespace {
+
+// [EN] Model/reader/writer left ROOT::Experimental in 6.36. / [CN] 6.36 起 Model/Reader/Writer 移出 ROOT::Experimental。
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 35, 0)
+namespace rnt = ROOT;
+#else
+namespace rnt = ROOT::Experimental;
+#endif
+
+std::unique_ptr<rnt::RNTupleModel> MakeRecoModel() {
+    auto model = rnt::RNTupleModel::CreateBare();
+    model->MakeField<std::int64_t>("event_id");
+    model->MakeField<bool>("truth_has_proton");
+    model->MakeField<bool>("truth_has_neutron");
+    model->MakeField<std::array<double, 4>>("truth_proton_p4");
+    model->MakeField<std::array<double, 4>>("truth_neutron_p4");
+    model->MakeField<std::array<double, 3>>("truth_proton_pos");
+    model->MakeField<std::array<double, 3>>("truth_neutron_pos");
+    model->MakeField<std::vector<TrackRecord>>("tracks");
+    model->MakeField<std::vector<ProtonRecord>>("protons");
+    model->MakeField<std::vector<NeutronRecord>>("neutrons");
+    return model;
+}
+
+template <typename Entry>
+void BindRow(Entry& entry, RecoNTupleRow* row) {
+    entry.BindRawPtr("event_id", &row->event_id);
+    entry.BindRawPtr("truth_has_proton", &row->truth_has_proton);
+    entry.BindRawPtr("truth_has_neutron", &row->truth_has_neutron);
+    entry.BindRawPtr("truth_proton_p4", &row->truth_proton_p4);
+    entry.BindRawPtr("truth_neutron_p4", &row->truth_neutron_p4);
+    entry.BindRawPtr("truth_proton_pos", &row->truth_proton_pos);
+    entry.BindRawPtr("truth_neutron_pos", &row->truth_neutron_pos);
+    entry.BindRawPtr("tracks", &row->tracks);
+    entry.BindRawPtr("protons", &row->protons);
+    entry.BindRawPtr("neutrons", &row->neutrons);
+}
+
+}  // namespace
+#endif
+
+void RecoNTupleRow::Clear() {
+    event_id = -1;
+    truth_has_proton = false;
+    truth_has_neutron = false;
+    truth_proton_p4.fill(0.0);
+    truth_neutron_p4.fill(0.0);
+    truth_proton_pos.fill(0.0);
+    truth_neutron_pos.fill(0.0);
+    tracks.clear();
+    protons.clear();
+    neutrons.clear();
+}
+
+void RecoNTupleRow::SetTruth(bool has_proton, const TLorentzVector& proton_p4, const TVector3& proton_pos,
+                             bool has_neutron, const TLorentzVector& neutron_p4, const TVector3& neutron_pos) {
+    truth_has_proton = has_proton;
+    truth_has_neutron = has_neutron;
+    truth_proton_p4 = {proton_p4.Px(), proton_p4.Py(), proton_p4.Pz(), proton_p4.E()};
+    truth_neutron_p4 = {neutron_p4.Px(), neutron_p4.Py(), neutron_p4.Pz(), neutron_p4.E()};
+    truth_proton_pos = {proton_pos.X(), proton_pos.Y(), proton_pos.Z()};
+    truth_neutron_pos = {neutron_pos.X(), neutron_pos.Y(), neutron_pos.Z()};
+}
+
+void RecoNTupleRow::SetEvent(const RecoEvent& event) {
+    event_id = event.eventID;
+    tracks.resize(event.tracks.size());
+    for (std::size_t i = 0; i < event.tracks.size(); ++i) {
+        const RecoTrack& track = event.tracks[i];
+        TrackRecord& record = tracks[i];
+        record.start_x = track.start.X();
+        record.start_y = track.start.Y();
+        record.start_z = track.start.Z();
+        record.end_x = track.end.X();
+        record.end_y = track.end.Y();
+        record.end_z = track.end.Z();
+        record.pdg_code = track.pdgCode;
+        record.chi2 = track.chi2;
+    }
+    neutrons.resize(event.neutrons.size());
+    for (std::size_t i = 0; i < event.neutrons.size(); ++i) {
+        const RecoNeutron& neutron = event.neutrons[i];
+        NeutronRecord& record = neutrons[i];
+        record.x = neutron.position.X();
+        record.y = neutron.position.Y();
+        record.z = neutron.position.Z();
+        record.dir_x = neutron.direction.X();
+        record.dir_y = neutron.direction.Y();
+        record.dir_z = neutron.direction.Z();
+        record.energy = neutron.energy;
+        record.time_of_flight = neutron.timeOfFlight;
+        record.beta = neutron.beta;
+        record.flight_length = neutron.flightLength;
+        record.hit_multiplicity = neutron.hitMultiplicity;
+    }
+}
+
+void RecoNTupleRow::SetProtons(const LegacyProtonColumns& columns) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    auto value = [nan](const std::vector<double>& column, std::size_t i) {
+        return i < column.size() ? column[i] : nan;
+    };
+    auto int_value = [](const std::vector<int>& column, std::size_t i) {
+        return i < column.size() ? column[i] : 0;
+    };
+    const std::vector<double>* intervals[16] = {
+        &columns.px_lower68, &columns.px_upper68, &columns.px_lower95, &columns.px_upper95,
+        &columns.py_lower68, &columns.py_upper68, &columns.py_lower95, &columns.py_upper95,
+        &columns.pz_lower68, &columns.pz_upper68, &columns.pz_lower95, &columns.pz_upper95,
+        &columns.p_lower68, &columns.p_upper68, &columns.p_lower95, &columns.p_upper95,
+    };
+    protons.resize(columns.px.size());
+    for (std::size_t i = 0; i < protons.size(); ++i) {
+        ProtonRecord& record = protons[i];
+        record.px = value(columns.px, i);
+        record.py = value(columns.py, i);
+        record.pz = value(columns.pz, i);
+        record.e = value(columns.e, i);
+        record.p = value(columns.p, i);
+        record.status = int_value(columns.status, i);
+        record.method = int_value(columns.method, i);
+        record.ndf = int_value(columns.ndf, i);
+        record.iterations = int_value(columns.iterations, i);
+        record.uncertainty_valid = int_value(columns.uncertainty_valid, i) != 0;
+        record.posterior_valid = int_value(columns.posterior_valid, i) != 0;
+        record.chi2_raw = value(columns.chi2_raw, i);
+        record.chi2_reduced = value(columns.chi2_reduced, i);
+        record.sigma = {value(columns.px_sigma, i), value(columns.py_sigma, i),
+                        value(columns.pz_sigma, i), value(columns.p_sigma, i)};
+        for (std::size_t k = 0; k < record.interval.size(); ++k) {
+            record.interval[k] = value(*intervals[k], i);
+        }
+        for (std::size_t k = 0; k < record.covariance.size(); ++k) {
+            record.covariance[k] = value(columns.momentum_cov, i * 6 + k);
+        }
+    }
+}
+
+bool RNTupleAvailable() {
+    return SMSIM_HAVE_RNTUPLE != 0;
+}
+
+bool HasRecoNTuple(TFile& file) {
+    return file.GetKey(kRecoNTupleName) != nullptr;
+}
+
+#if SMSIM_HAVE_RNTUPLE
+
+struct RecoNTupleWriter::Impl {
+    RecoNTupleRow row;
+    std::unique_ptr<rnt::RNTupleWriter> writer;
+    std::unique_ptr<rnt::REntry> entry;
+};
+
+RecoNTupleWriter::RecoNTupleWriter(TFile& file, CompressionProfile compression)
+    : fImpl(std::make_unique<Impl>()) {
+    rnt::RNTupleWriteOptions options;
+    const int settings = CompressionSettings(compression);
+    options.SetCompression(settings >= 0 ? settings : file.GetCompressionSettings());
+    fImpl->writer = rnt::RNTupleWriter::Append(MakeRecoModel(), kRecoNTupleName, file, options);
+    fImpl->entry = fImpl->writer->CreateEntry();
+    BindRow(*fImpl->entry, &fImpl->row);
+}
+
+RecoNTupleWriter::~RecoNTupleWriter() = default;
+
+RecoNTupleRow& RecoNTupleWriter::Row() {
+    return fImpl->row;
+}
+
+void RecoNTupleWriter::Fill() {
+    fImpl->writer->Fill(*fImpl->entry);
+}
+
+void RecoNTupleWriter::Commit() {
+    // [EN] Destroying the writer flushes the last cluster and writes header/footer into the TFile. / [CN] 析构 writer 会写出最后的 cluster 与头/尾信息。
+    fImpl->entry.reset();
+    fImpl->writer.reset();
+}
+
+struct RecoNTupleReader::Impl {
+    RecoNTupleRow row;
+    std::unique_ptr<rnt::RNTupleReader> reader;
+    std::unique_ptr<rnt::REntry> entry;
+};
+
+RecoNTupleReader::RecoNTupleReader(const std::string& path)
+    : fImpl(std::make_unique<Impl>()) {
+    fImpl->reader = rnt::RNTupleReader::Open(kRecoNTupleName, path);
+    fImpl->entry = fImpl->reader->GetModel().CreateBareEntry();
+    BindRow(*fImpl->entry, &fImpl->row);
+}
+
+RecoNTupleReader::~RecoNTupleReader() = default;
+
+std::int64_t RecoNTupleReader::GetEntries() const {
+    return static_cast<std::int64_t>(fImpl->reader->GetNEntries());
+}
+
+void RecoNTupleReader::LoadEntry(std::int64_t entry) {
+    fImpl->reader->LoadEntry(static_cast<std::uint64_t>(entry), *fImpl->entry);
+}
+
+const RecoNTupleRow& RecoNTupleReader::Row() const {
+    return fImpl->row;
+}
+
+#else
+
+struct RecoNTupleWriter::Impl {
+    RecoNTupleRow row;
+};
+
+RecoNTupleWriter::RecoNTupleWriter(TFile&, CompressionProfile) {
+    throw std::runtime_error("RNTuple output is not available: built without WITH_RNTUPLE (needs ROOT >= 6.34)");
+}
+
+RecoNTupleWriter::~RecoNTupleWriter() = default;
+RecoNTupleRow& RecoNTupleWriter::Row() { return fImpl->row; }
+void RecoNTupleWriter::Fill() {}
+void RecoNTupleWriter::Commit() {}
+
+struct RecoNTupleReader::Impl {
+    RecoNTupleRow row;
+};
+
+RecoNTupleReader::RecoNTupleReader(const std::string&) {
+    throw std::runtime_error("RNTuple input is not available: built without WITH_RNTUPLE (needs ROOT >= 6.34)");
+}
+
+RecoNTupleReader::~RecoNTupleReader() = default;
+std::int64_t RecoNTupleReader::GetEntries() const { return 0; }
+void RecoNTupleReader::LoadEntry(std::int64_t) {}
+const RecoNTupleRow& RecoNTupleReader::Row() const { return fImpl->row; }
+
+#endif
+
+}  // namespace analysis::reco_output
@@ -0,0 +1,368 @@
+#include "RecoOutputSchema.hh"
+
+#include "Compression.h"
+#include "TFile.h"
+#include "TNamed.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <utility>
+
+namespace analysis::reco_output {
+
+namespace {
+
+std::string ToLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+template <typename T>
+void BindIfPresent(TTree& tree, const char* name, T* address) {
+    if (tree.GetBranch(name)) {
+        tree.SetBranchAddress(name, address);
+    }
+}
+
+}  // namespace
+
+OutputSchema ParseOutputSchema(const std::string& text) {
+    const std::string lowered = ToLower(text);
+    if (lowered == "legacy" || lowered == "vector") return OutputSchema::kLegacy;
+    if (lowered == "compact" || lowered == "flat") return OutputSchema::kCompact;
+    throw std::runtime_error("invalid output schema: " + text);
+}
+
+std::string OutputSchemaName(OutputSchema schema) {
+    switch (schema) {
+        case OutputSchema::kLegacy: return "legacy";
+        case OutputSchema::kCompact: return "compact";
+    }
+    return "legacy";
+}
+
+OutputBackend ParseOutputBackend(const std::string& text) {
+    const std::string lowered = ToLower(text);
+    if (lowered == "ttree" || lowered == "tree") return OutputBackend::kTTree;
+    if (lowered == "rntuple" || lowered == "ntuple") return OutputBackend::kRNTuple;
+    throw std::runtime_error("invalid output format: " + text);
+}
+
+std::string OutputBackendName(OutputBackend backend) {
+    switch (backend) {
+        case OutputBackend::kTTree: return "ttree";
+        case OutputBackend::kRNTuple: return "rntuple";
+    }
+    return "ttree";
+}
+
+CompressionProfile ParseCompressionProfile(const std::string& text) {
+    const std::string lowered = ToLower(text);
+    if (lowered == "default") return CompressionProfile::kDefault;
+    if (lowered == "fast" || lowered == "lz4") return CompressionProfile::kFast;
+    if (lowered == "balanced" || lowered == "zstd") return CompressionProfile::kBalanced;
+    if (lowered == "archive" || lowered == "lzma") return CompressionProfile::kArchive;
+    throw std::runtime_error("invalid compression profile: " + text);
+}
+
+std::string CompressionProfileName(CompressionProfile profile) {
+    switch (profile) {
+        case CompressionProfile::kDefault: return "default";
+        case CompressionProfile::kFast: return "fast";
+        case CompressionProfile::kBalanced: return "balanced";
+        case CompressionProfile::kArchive: return "archive";
+    }
+    return "default";
+}
+
+int CompressionSettings(CompressionProfile profile) {
+    using Algorithm = ROOT::RCompressionSetting::EAlgorithm;
+    switch (profile) {
+        case CompressionProfile::kDefault: return -1;
+        case CompressionProfile::kFast: return ROOT::CompressionSettings(Algorithm::kLZ4, 4);
+        case CompressionProfile::kBalanced: return ROOT::CompressionSettings(Algorithm::kZSTD, 5);
+        case CompressionProfile::kArchive: return ROOT::CompressionSettings(Algorithm::kLZMA, 8);
+    }
+    return -1;
+}
+
+void ApplyCompressionProfile(TFile& file, CompressionProfile profile) {
+    const int settings = CompressionSettings(profile);
+    if (settings >= 0) {
+        file.SetCompressionSettings(settings);
+    }
+}
+
+OutputSchema DetectOutputSchema(TFile& file, TTree& tree) {
+    if (auto* named = dynamic_cast<TNamed*>(file.Get("RecoOutputSchema"))) {
+        return ParseOutputSchema(named->GetTitle());
+    }
+    return tree.GetBranch("n_proton") ? OutputSchema::kCompact : OutputSchema::kLegacy;
+}
+
+void LegacyProtonColumns::Clear() {
+    ForEachDouble([](std::vector<double>& column) { column.clear(); });
+    ForEachInt([](std::vector<int>& column) { column.clear(); });
+}
+
+void LegacyProtonColumns::Swap(LegacyProtonColumns& other) {
+    std::swap(px, other.px);
+    std::swap(py, other.py);
+    std::swap(pz, other.pz);
+    std::swap(e, other.e);
+    std::swap(p, other.p);
+    std::swap(status, other.status);
+    std::swap(method, other.method);
+    std::swap(ndf, other.ndf);
+    std::swap(iterations, other.iterations);
+    std::swap(uncertainty_valid, other.uncertainty_valid);
+    std::swap(posterior_valid, other.posterior_valid);
+    std::swap(chi2_raw, other.chi2_raw);
+    std::swap(chi2_reduced, other.chi2_reduced);
+    std::swap(px_sigma, other.px_sigma);
+    std::swap(py_sigma, other.py_sigma);
+    std::swap(pz_sigma, other.pz_sigma);
+    std::swap(p_sigma, other.p_sigma);
+    std::swap(px_lower68, other.px_lower68);
+    std::swap(px_upper68, other.px_upper68);
+    std::swap(px_lower95, other.px_lower95);
+    std::swap(px_upper95, other.px_upper95);
+    std::swap(py_lower68, other.py_lower68);
+    std::swap(py_upper68, other.py_upper68);
+    std::swap(py_lower95, other.py_lower95);
+    std::swap(py_upper95, other.py_upper95);
+    std::swap(pz_lower68, other.pz_lower68);
+    std::swap(pz_upper68, other.pz_upper68);
+    std::swap(pz_lower95, other.pz_lower95);
+    std::swap(pz_upper95, other.pz_upper95);
+    std::swap(p_lower68, other.p_lower68);
+    std::swap(p_upper68, other.p_upper68);
+    std::swap(p_lower95, other.p_lower95);
+    std::swap(p_upper95, other.p_upper95);
+    std::swap(momentum_cov, other.momentum_cov);
+}
+
+void LegacyProtonColumns::BindForWrite(TTree& tree, bool write_errors, bool write_laplace) {
+    tree.Branch("reco_proton_px", &px);
+    tree.Branch("reco_proton_py", &py);
+    tree.Branch("reco_proton_pz", &pz);
+    tree.Branch("reco_proton_e", &e);
+    if (!write_errors) {
+        return;
+    }
+    tree.Branch("reco_proton_p", &p);
+    tree.Branch("reco_proton_status", &status);
+    tree.Branch("reco_proton_method", &method);
+    tree.Branch("reco_proton_ndf", &ndf);
+    tree.Branch("reco_proton_iterations", &iterations);
+    tree.Branch("reco_proton_uncertainty_valid", &uncertainty_valid);
+    tree.Branch("reco_proton_posterior_valid", &posterior_valid);
+    tree.Branch("reco_proton_chi2_raw", &chi2_raw);
+    tree.Branch("reco_proton_chi2_reduced", &chi2_reduced);
+    tree.Branch("reco_proton_px_sigma", &px_sigma);
+    tree.Branch("reco_proton_py_sigma", &py_sigma);
+    tree.Branch("reco_proton_pz_sigma", &pz_sigma);
+    tree.Branch("reco_proton_p_sigma", &p_sigma);
+    if (!write_laplace) {
+        return;
+    }
+    tree.Branch("reco_proton_px_lower68", &px_lower68);
+    tree.Branch("reco_proton_px_upper68", &px_upper68);
+    tree.Branch("reco_proton_px_lower95", &px_lower95);
+    tree.Branch("reco_proton_px_upper95", &px_upper95);
+    tree.Branch("reco_proton_py_lower68", &py_lower68);
+    tree.Branch("reco_proton_py_upper68", &py_upper68);
+    tree.Branch("reco_proton_py_lower95", &py_lower95);
+    tree.Branch("reco_proton_py_upper95", &py_upper95);
+    tree.Branch("reco_proton_pz_lower68", &pz_lower68);
+    tree.Branch("reco_proton_pz_upper68", &pz_upper68);
+    tree.Branch("reco_proton_pz_lower95", &pz_lower95);
+    tree.Branch("reco_proton_pz_upper95", &pz_upper95);
+    tree.Branch("reco_proton_p_lower68", &p_lower68);
+    tree.Branch("reco_proton_p_upper68", &p_upper68);
+    tree.Branch("reco_proton_p_lower95", &p_lower95);
+    tree.Branch("reco_proton_p_upper95", &p_upper95);
+}
+
+void CompactRecoRow::Clear() {
+    event_id = -1;
+    n_track = 0;
+    truth_has_proton = false;
+    truth_has_neutron = false;
+    std::fill(std::begin(truth_proton), std::end(truth_proton), 0.0f);
+    std::fill(std::begin(truth_neutron), std::end(truth_neutron), 0.0f);
+    n_proton = 0;
+    n_proton_dropped = 0;
+    n_neutron = 0;
+    n_neutron_dropped = 0;
+}
+
+void CompactRecoRow::SetTruth(bool has_proton, const TLorentzVector& proton_p4, const TVector3& proton_pos,
+                              bool has_neutron, const TLorentzVector& neutron_p4, const TVector3& neutron_pos) {
+    auto pack = [](const TLorentzVector& p4, const TVector3& pos, Float_t* out) {
+        out[0] = static_cast<Float_t>(p4.Px());
+        out[1] = static_cast<Float_t>(p4.Py());
+        out[2] = static_cast<Float_t>(p4.Pz());
+        out[3] = static_cast<Float_t>(p4.E());
+        out[4] = static_cast<Float_t>(pos.X());
+        out[5] = static_cast<Float_t>(pos.Y());
+        out[6] = static_cast<Float_t>(pos.Z());
+    };
+    truth_has_proton = has_proton;
+    truth_has_neutron = has_neutron;
+    pack(proton_p4, proton_pos, truth_proton);
+    pack(neutron_p4, neutron_pos, truth_neutron);
+}
+
+void CompactRecoRow::SetEvent(const RecoEvent& event) {
+    event_id = event.eventID;
+    n_track = static_cast<Int_t>(event.tracks.size());
+    const std::size_t total_neutrons = event.neutrons.size();
+    n_neutron = static_cast<Int_t>(std::min<std::size_t>(total_neutrons, kMaxNeutrons));
+    n_neutron_dropped = static_cast<Int_t>(total_neutrons - static_cast<std::size_t>(n_neutron));
+    for (Int_t i = 0; i < n_neutron; ++i) {
+        const RecoNeutron& neutron = event.neutrons[static_cast<std::size_t>(i)];
+        const TVector3 momentum = neutron.GetMomentum();
+        neutron_px[i] = static_cast<Float_t>(momentum.X());
+        neutron_py[i] = static_cast<Float_t>(momentum.Y());
+        neutron_pz[i] = static_cast<Float_t>(momentum.Z());
+        neutron_x[i] = static_cast<Float_t>(neutron.position.X());
+        neutron_y[i] = static_cast<Float_t>(neutron.position.Y());
+        neutron_z[i] = static_cast<Float_t>(neutron.position.Z());
+        neutron_tof[i] = static_cast<Float_t>(neutron.timeOfFlight);
+        neutron_beta[i] = static_cast<Float_t>(neutron.beta);
+        neutron_energy[i] = static_cast<Float_t>(neutron.energy);
+        neutron_multiplicity[i] = static_cast<Short_t>(neutron.hitMultiplicity);
+    }
+}
+
+void CompactRecoRow::SetProtons(const LegacyProtonColumns& columns) {
+    const std::size_t total = columns.px.size();
+    n_proton = static_cast<Int_t>(std::min<std::size_t>(total, kMaxProtons));
+    n_proton_dropped = static_cast<Int_t>(total - static_cast<std::size_t>(n_proton));
+
+    auto value = [](const std::vector<double>& column, std::size_t i) {
+        return i < column.size() ? static_cast<Float_t>(column[i]) : 0.0f;
+    };
+    auto int_value = [](const std::vector<int>& column, std::size_t i) {
+        return i < column.size() ? column[i] : 0;
+    };
+    const std::vector<double>* intervals[16] = {
+        &columns.px_lower68, &columns.px_upper68, &columns.px_lower95, &columns.px_upper95,
+        &columns.py_lower68, &columns.py_upper68, &columns.py_lower95, &columns.py_upper95,
+        &columns.pz_lower68, &columns.pz_upper68, &columns.pz_lower95, &columns.pz_upper95,
+        &columns.p_lower68, &columns.p_upper68, &columns.p_lower95, &columns.p_upper95,
+    };
+    for (Int_t n = 0; n < n_proton; ++n) {
+        const std::size_t i = static_cast<std::size_t>(n);
+        proton_px[n] = value(columns.px, i);
+        proton_py[n] = value(columns.py, i);
+        proton_pz[n] = value(columns.pz, i);
+        proton_e[n] = value(columns.e, i);
+        proton_status[n] = static_cast<Char_t>(int_value(columns.status, i));
+        proton_method[n] = static_cast<Char_t>(int_value(columns.method, i));
+        proton_flags[n] = static_cast<UChar_t>((int_value(columns.uncertainty_valid, i) ? 1 : 0) |
+                                               (int_value(columns.posterior_valid, i) ? 2 : 0));
+        proton_ndf[n] = static_cast<Short_t>(int_value(columns.ndf, i));
+        proton_iterations[n] = static_cast<Short_t>(int_value(columns.iterations, i));
+        proton_chi2_raw[n] = value(columns.chi2_raw, i);
+        proton_chi2_reduced[n] = value(columns.chi2_reduced, i);
+        proton_sigma[n][0] = value(columns.px_sigma, i);
+        proton_sigma[n][1] = value(columns.py_sigma, i);
+        proton_sigma[n][2] = value(columns.pz_sigma, i);
+        proton_sigma[n][3] = value(columns.p_sigma, i);
+        for (int k = 0; k < 16; ++k) {
+            proton_interval[n][k] = value(*intervals[k], i);
+        }
+        for (int k = 0; k < 6; ++k) {
+            proton_cov[n][k] = value(columns.momentum_cov, i * 6 + static_cast<std::size_t>(k));
+        }
+    }
+}
+
+void CompactRecoRow::BindForWrite(TTree& tree, bool write_errors, bool write_laplace, bool write_covariance) {
+    tree.Branch("event_id", &event_id, "event_id/L");
+    tree.Branch("n_track", &n_track, "n_track/I");
+    tree.Branch("truth_has_proton", &truth_has_proton, "truth_has_proton/O");
+    tree.Branch("truth_has_neutron", &truth_has_neutron, "truth_has_neutron/O");
+    tree.Branch("truth_proton", truth_proton, "truth_proton[7]/F");
+    tree.Branch("truth_neutron", truth_neutron, "truth_neutron[7]/F");
+
+    tree.Branch("n_proton", &n_proton, "n_proton/I");
+    tree.Branch("n_proton_dropped", &n_proton_dropped, "n_proton_dropped/I");
+    tree.Branch("proton_px", proton_px, "proton_px[n_proton]/F");
+    tree.Branch("proton_py", proton_py, "proton_py[n_proton]/F");
+    tree.Branch("proton_pz", proton_pz, "proton_pz[n_proton]/F");
+    tree.Branch("proton_e", proton_e, "proton_e[n_proton]/F");
+    if (write_errors) {
+        tree.Branch("proton_status", proton_status, "proton_status[n_proton]/B");
+        tree.Branch("proton_method", proton_method, "proton_method[n_proton]/B");
+        tree.Branch("proton_flags", proton_flags, "proton_flags[n_proton]/b");
+        tree.Branch("proton_ndf", proton_ndf, "proton_ndf[n_proton]/S");
+        tree.Branch("proton_iterations", proton_iterations, "proton_iterations[n_proton]/S");
+        tree.Branch("proton_chi2_raw", proton_chi2_raw, "proton_chi2_raw[n_proton]/F");
+        tree.Branch("proton_chi2_reduced", proton_chi2_reduced, "proton_chi2_reduced[n_proton]/F");
+        tree.Branch("proton_sigma", proton_sigma, "proton_sigma[n_proton][4]/F");
+        if (write_laplace) {
+            tree.Branch("proton_interval", proton_interval, "proton_interval[n_proton][16]/F");
+        }
+        if (write_covariance) {
+            tree.Branch("proton_cov", proton_cov, "proton_cov[n_proton][6]/F");
+        }
+    }
+
+    tree.Branch("n_neutron", &n_neutron, "n_neutron/I");
+    tree.Branch("n_neutron_dropped", &n_neutron_dropped, "n_neutron_dropped/I");
+    tree.Branch("neutron_px", neutron_px, "neutron_px[n_neutron]/F");
+    tree.Branch("neutron_py", neutron_py, "neutron_py[n_neutron]/F");
+    tree.Branch("neutron_pz", neutron_pz, "neutron_pz[n_neutron]/F");
+    tree.Branch("neutron_x", neutron_x, "neutron_x[n_neutron]/F");
+    tree.Branch("neutron_y", neutron_y, "neutron_y[n_neutron]/F");
+    tree.Branch("neutron_z", neutron_z, "neutron_z[n_neutron]/F");
+    tree.Branch("neutron_tof", neutron_tof, "neutron_tof[n_neutron]/F");
+    tree.Branch("neutron_beta", neutron_beta, "neutron_beta[n_neutron]/F");
+    tree.Branch("neutron_energy", neutron_energy, "neutron_energy[n_neutron]/F");
+    tree.Branch("neutron_multiplicity", neutron_multiplicity, "neutron_multiplicity[n_neutron]/S");
+}
+
+void CompactRecoRow::BindForRead(TTree& tree) {
+    BindIfPresent(tree, "event_id", &event_id);
+    BindIfPresent(tree, "n_track", &n_track);
+    BindIfPresent(tree, "truth_has_proton", &truth_has_proton);
+    BindIfPresent(tree, "truth_has_neutron", &truth_has_neutron);
+    BindIfPresent(tree, "truth_proton", truth_proton);
+    BindIfPresent(tree, "truth_neutron", truth_neutron);
+    BindIfPresent(tree, "n_proton", &n_proton);
+    BindIfPresent(tree, "n_proton_dropped", &n_proton_dropped);
+    BindIfPresent(tree, "proton_px", proton_px);
+    BindIfPresent(tree, "proton_py", proton_py);
+    BindIfPresent(tree, "proton_pz", proton_pz);
+    BindIfPresent(tree, "proton_e", proton_e);
+    BindIfPresent(tree, "proton_status", proton_status);
+    BindIfPresent(tree, "proton_method", proton_method);
+    BindIfPresent(tree, "proton_flags", proton_flags);
+    BindIfPresent(tree, "proton_ndf", proton_ndf);
+    BindIfPresent(tree, "proton_iterations", proton_iterations);
+    BindIfPresent(tree, "proton_chi2_raw", proton_chi2_raw);
+    BindIfPresent(tree, "proton_chi2_reduced", proton_chi2_reduced);
+    BindIfPresent(tree, "proton_sigma", &proton_sigma[0][0]);
+    BindIfPresent(tree, "proton_interval", &proton_interval[0][0]);
+    BindIfPresent(tree, "proton_cov", &proton_cov[0][0]);
+    BindIfPresent(tree, "n_neutron", &n_neutron);
+    BindIfPresent(tree, "n_neutron_dropped", &n_neutron_dropped);
+    BindIfPresent(tree, "neutron_px", neutron_px);
+    BindIfPresent(tree, "neutron_py", neutron_py);
+    BindIfPresent(tree, "neutron_pz", neutron_pz);
+    BindIfPresent(tree, "neutron_x", neutron_x);
+    BindIfPresent(tree, "neutron_y", neutron_y);
+    BindIfPresent(tree, "neutron_z", neutron_z);
+    BindIfPresent(tree, "neutron_tof", neutron_tof);
+    BindIfPresent(tree, "neutron_beta", neutron_beta);
+    BindIfPresent(tree, "neutron_energy", neutron_energy);
+    BindIfPresent(tree, "neutron_multiplicity", neutron_multiplicity);
+}
+
+}  // namespace analysis::reco_output
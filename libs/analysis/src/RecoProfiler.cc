@@ -0,0 +1,170 @@
+#include "RecoProfiler.hh"
+
+#include <sys/resource.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace analysis::profiling {
+
+namespace {
+
+struct CounterRegistry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadStageCounters>> counters;
+};
+
+CounterRegistry& Registry() {
+    static CounterRegistry registry;
+    return registry;
+}
+
+long ReadProcStatusKb(const std::string& key) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, key.size(), key) == 0) {
+            std::istringstream fields(line.substr(key.size()));
+            long value = -1;
+            fields >> value;
+            return value;
+        }
+    }
+    return -1;
+}
+
+}  // namespace
+
+std::atomic<bool> RecoProfiler::sEnabled{false};
+
+const char* RecoStageName(RecoStage stage) {
+    switch (stage) {
+        case RecoStage::kRead: return "read";
+        case RecoStage::kPdcAna: return "pdc_ana";
+        case RecoStage::kNebulaReco: return "nebula_reco";
+        case RecoStage::kProtonReco: return "proton_reco";
+        case RecoStage::kRkSeed: return "rk_seed";
+        case RecoStage::kRkFit: return "rk_lm_fit";
+        case RecoStage::kRkUncertainty: return "rk_uncertainty";
+        case RecoStage::kNNInference: return "nn_inference";
+        case RecoStage::kOutputPrep: return "output_prep";
+        case RecoStage::kTreeFill: return "tree_fill";
+        case RecoStage::kWrite: return "write";
+        case RecoStage::kCount: break;
+    }
+    return "unknown";
+}
+
+int RecoStageDepth(RecoStage stage) {
+    switch (stage) {
+        case RecoStage::kRkSeed:
+        case RecoStage::kRkFit:
+        case RecoStage::kNNInference:
+            return 1;
+        case RecoStage::kRkUncertainty:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+StageTotals& StageTotals::operator+=(const StageTotals& other) {
+    for (std::size_t i = 0; i < kRecoStageCount; ++i) {
+        ns[i] += other.ns[i];
+        calls[i] += other.calls[i];
+    }
+    return *this;
+}
+
+StageTotals StageTotals::operator-(const StageTotals& other) const {
+    StageTotals diff;
+    for (std::size_t i = 0; i < kRecoStageCount; ++i) {
+        diff.ns[i] = ns[i] - other.ns[i];
+        diff.calls[i] = calls[i] - other.calls[i];
+    }
+    return diff;
+}
+
+StageTotals ThreadStageCounters::Snapshot() const {
+    StageTotals totals;
+    for (std::size_t i = 0; i < kRecoStageCount; ++i) {
+        totals.ns[i] = ns[i].load(std::memory_order_relaxed);
+        totals.calls[i] = calls[i].load(std::memory_order_relaxed);
+    }
+    return totals;
+}
+
+ThreadStageCounters& RecoProfiler::ThreadCounters() {
+    thread_local ThreadStageCounters* counters = [] {
+        auto& registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.counters.push_back(std::make_unique<ThreadStageCounters>());
+        return registry.counters.back().get();
+    }();
+    return *counters;
+}
+
+StageTotals RecoProfiler::CollectTotals() {
+    auto& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    StageTotals totals;
+    for (const auto& counters : registry.counters) {
+        totals += counters->Snapshot();
+    }
+    return totals;
+}
+
+void RecoProfiler::Reset() {
+    auto& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const auto& counters : registry.counters) {
+        for (std::size_t i = 0; i < kRecoStageCount; ++i) {
+            counters->ns[i].store(0, std::memory_order_relaxed);
+            counters->calls[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::string RecoProfiler::FormatSummary(const StageTotals& totals, double wall_seconds) {
+    std::ostringstream os;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-20s %12s %12s %12s %8s\n", "stage", "calls", "total_s", "mean_us", "share");
+    os << line;
+    for (std::size_t i = 0; i < kRecoStageCount; ++i) {
+        const auto stage = static_cast<RecoStage>(i);
+        if (totals.calls[i] == 0) {
+            continue;
+        }
+        const double total_s = static_cast<double>(totals.ns[i]) * 1.0e-9;
+        const double mean_us = static_cast<double>(totals.ns[i]) * 1.0e-3 / static_cast<double>(totals.calls[i]);
+        const double share = wall_seconds > 0.0 ? 100.0 * total_s / wall_seconds : 0.0;
+        const std::string name = std::string(static_cast<std::size_t>(2 * RecoStageDepth(stage)), ' ') + RecoStageName(stage);
+        std::snprintf(line, sizeof(line), "%-20s %12llu %12.3f %12.2f %7.1f%%\n",
+                      name.c_str(),
+                      static_cast<unsigned long long>(totals.calls[i]),
+                      total_s,
+                      mean_us,
+                      share);
+        os << line;
+    }
+    return os.str();
+}
+
+MemoryUsage SampleMemoryUsage() {
+    MemoryUsage usage;
+    usage.rss_kb = ReadProcStatusKb("VmRSS:");
+    usage.peak_rss_kb = ReadProcStatusKb("VmHWM:");
+    if (usage.peak_rss_kb < 0) {
+        struct rusage self_usage {};
+        if (getrusage(RUSAGE_SELF, &self_usage) == 0) {
+            usage.peak_rss_kb = self_usage.ru_maxrss;
+        }
+    }
+    return usage;
+}
+
+}  // namespace analysis::profiling
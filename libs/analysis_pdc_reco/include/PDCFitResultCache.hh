@@ -0,0 +1,120 @@
+#ifndef ANALYSIS_PDC_FIT_RESULT_CACHE_HH
+#define ANALYSIS_PDC_FIT_RESULT_CACHE_HH
+
+#include "MagneticField.hh"
+#include "PDCNNMomentumReconstructor.hh"
+#include "PDCRecoTypes.hh"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace analysis::pdc::anaroot_like {
+
+// [EN] Content-addressed store of RecoResult entries for repeated reconstruction passes over the same input.
+// The key hashes the exact PDC hit values together with the field map, target geometry and RecoConfig
+// fingerprints (with NN enabled, also the resolved model path and the model file contents), so a change in any
+// of them is a miss and the fit runs again. Entries live in an append-only
+// binary file (one per input); the header carries the field fingerprint, and a file written for another
+// field map, format version or byte order is discarded on Open(). A torn tail from an interrupted run is
+// truncated back to the last complete record. Lookup()/Insert() are thread-safe.
+// [CN] 面向同一输入多次重建的内容寻址 RecoResult 缓存。键由 PDC 击中值、磁场图、靶几何与 RecoConfig 指纹（启用 NN 时
+// 还包括解析后的模型路径与模型文件内容）共同哈希，任一变化即未命中并重新拟合。条目存于逐输入的追加式二进制文件；文件头记录磁场指纹，磁场/格式版本/字节序不符时
+// Open() 会丢弃旧文件。中断运行留下的残缺尾部截断到最后一条完整记录。Lookup()/Insert() 线程安全。
+class PDCFitResultCache {
+public:
+    struct Stats {
+        std::uint64_t loaded = 0;      // records read back from disk
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t inserted = 0;    // new records this session
+        std::uint64_t discarded = 0;   // bytes dropped (stale header or torn tail)
+    };
+
+    // [EN] Hashes grid layout, ranges, rotation and every field sample; compute once per loaded map.
+    // [CN] 哈希网格布局、范围、旋转角与全部磁场采样；每张磁场图只需计算一次。
+    static std::uint64_t FieldMapFingerprint(const MagneticField* magnetic_field);
+    static std::uint64_t GeometryFingerprint(const TargetConstraint& target);
+    // [EN] With enable_nn, nn_model is the model the chain would use (PDCMomentumReconstructor::ResolveNNModel);
+    // its path and ContentFingerprint() are hashed, so replacing the file behind the same path invalidates old
+    // entries. nullptr (no loadable model) hashes the resolved path only. / [CN] 启用 NN 时，nn_model 为求解链
+    // 实际使用的模型；哈希其路径与 ContentFingerprint()，同一路径下替换文件会使旧条目失效。nullptr（无可用模型）
+    // 时只哈希解析后的路径。
+    static std::uint64_t ConfigFingerprint(const RecoConfig& config,
+                                           const PDCNNMomentumReconstructor* nn_model = nullptr);
+    // [EN] <cache_dir>/<input stem>.<hash of the absolute input path>[.<tag>].fitcache
+    // [CN] <cache_dir>/<输入文件名>.<输入绝对路径哈希>[.<tag>].fitcache
+    static std::string PathForInput(const std::string& cache_dir,
+                                    const std::string& input_file,
+                                    const std::string& tag = std::string());
+
+    explicit PDCFitResultCache(std::uint64_t field_fingerprint);
+    ~PDCFitResultCache();
+    PDCFitResultCache(const PDCFitResultCache&) = delete;
+    PDCFitResultCache& operator=(const PDCFitResultCache&) = delete;
+
+    // [EN] Loads the existing file (or creates it) and keeps it open for appending. / [CN] 加载已有文件（或新建）并保持追加打开。
+    bool Open(const std::string& path, std::string* reason = nullptr);
+    bool IsOpen() const { return fOpen; }
+    const std::string& GetPath() const { return fPath; }
+
+    bool Lookup(const PDCInputTrack& track,
+                const TargetConstraint& target,
+                const RecoConfig& config,
+                RecoResult* result,
+                const PDCNNMomentumReconstructor* nn_model = nullptr) const;
+    void Insert(const PDCInputTrack& track,
+                const TargetConstraint& target,
+                const RecoConfig& config,
+                const RecoResult& result,
+                const PDCNNMomentumReconstructor* nn_model = nullptr);
+    // [EN] Writes buffered records; also called every kFlushRecords inserts and on destruction.
+    // [CN] 写出缓冲记录；每 kFlushRecords 次插入及析构时也会调用。
+    bool Flush(std::string* reason = nullptr);
+
+    std::size_t Size() const;
+    Stats GetStats() const;
+
+private:
+    static constexpr std::size_t kFlushRecords = 256;
+
+    struct Entry {
+        std::array<double, 6> hits{};
+        RecoResult result;
+    };
+
+    std::uint64_t Key(const PDCInputTrack& track,
+                      const TargetConstraint& target,
+                      const RecoConfig& config,
+                      const PDCNNMomentumReconstructor* nn_model,
+                      std::array<double, 6>* hits) const;
+    bool FlushLocked(std::string* reason);
+
+    const std::uint64_t fFieldFingerprint;
+    std::string fPath;
+    bool fOpen = false;
+
+    mutable std::shared_mutex fMapMutex;
+    std::unordered_map<std::uint64_t, Entry> fEntries;
+
+    std::mutex fWriteMutex;
+    std::ofstream fOut;
+    std::vector<char> fPending;
+    std::size_t fPendingRecords = 0;
+
+    std::uint64_t fLoaded = 0;
+    std::uint64_t fDiscarded = 0;
+    mutable std::atomic<std::uint64_t> fHits{0};
+    mutable std::atomic<std::uint64_t> fMisses{0};
+    std::atomic<std::uint64_t> fInserted{0};
+};
+
+}  // namespace analysis::pdc::anaroot_like
+
+#endif  // ANALYSIS_PDC_FIT_RESULT_CACHE_HH
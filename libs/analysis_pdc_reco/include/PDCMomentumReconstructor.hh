@@ -2,17 +2,99 @@
 #define ANALYSIS_PDC_MOMENTUM_RECONSTRUCTOR_HH
 
 #include "MagneticField.hh"
+#include "PDCFitResultCache.hh"
 #include "PDCNNMomentumReconstructor.hh"
 #include "PDCRecoTypes.hh"
 
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace analysis::pdc::anaroot_like {
 
+// [EN] Immutable state shared by every thread that reconstructs with the same
+// setup: read-only field view, target geometry, solver config and preloaded NN
+// weights. Build once (PDCRecoFactory::CreateSharedState) and hand the same
+// shared_ptr to all workers. / [CN] 同一配置下所有线程共享的不可变状态：只读磁场、
+// 靶几何、求解配置和预加载的NN权重。构建一次后把同一个 shared_ptr 交给所有工作线程。
+struct PDCRecoSharedState {
+    const MagneticField* magnetic_field = nullptr;
+    TargetConstraint target;
+    RecoConfig config;
+    std::shared_ptr<const PDCNNMomentumReconstructor> nn_model;
+    std::string nn_model_path;
+    // [EN] Optional default fit cache (internally synchronized); per-input callers pass their own to
+    // Reconstruct() instead. / [CN] 可选的默认拟合缓存（内部同步）；逐输入调用方改为向 Reconstruct() 传入各自的缓存。
+    std::shared_ptr<PDCFitResultCache> fit_cache;
+};
+
+// [EN] Per-thread scratch for Reconstruct(). Never share one workspace between
+// threads; reuse it across events on the same thread. / [CN] Reconstruct() 的
+// 每线程工作区。不可跨线程共享；同一线程内跨事件复用。
+class PDCRecoWorkspace {
+public:
+    PDCRecoWorkspace() = default;
+    PDCRecoWorkspace(const PDCRecoWorkspace&) = delete;
+    PDCRecoWorkspace& operator=(const PDCRecoWorkspace&) = delete;
+    PDCRecoWorkspace(PDCRecoWorkspace&&) = default;
+    PDCRecoWorkspace& operator=(PDCRecoWorkspace&&) = default;
+
+private:
+    friend class PDCMomentumReconstructor;
+
+    PDCNNScratch fNNScratch;
+    // [EN] Fallback model when the shared state has none for the requested path
+    // (legacy lazy loading); private to this thread. / [CN] 共享状态中无对应模型时
+    // 的延迟加载回退，仅本线程可见。
+    std::shared_ptr<const PDCNNMomentumReconstructor> fNNModel;
+    std::string fNNModelPath;
+
+    // [EN] ReconstructBatch() staging, grown to the largest batch seen. / [CN] ReconstructBatch() 的暂存区，按最大批次增长。
+    std::vector<std::size_t> fBatchPending;
+    std::vector<std::size_t> fBatchRemaining;
+    std::vector<double> fBatchFeatures;
+    std::vector<double> fBatchMomenta;
+    std::vector<unsigned char> fBatchOk;
+};
+
+// [EN] Thread-safety contract: after construction the reconstructor is
+// immutable. Every const Reconstruct*() overload is reentrant; overloads that
+// take a PDCRecoWorkspace use it for all mutable scratch, overloads without one
+// fall back to a thread_local workspace. The MagneticField must not be modified
+// while reconstruction runs. / [CN] 线程安全约定：构造后对象不可变，所有 const
+// Reconstruct*() 可重入；带 workspace 的重载把可变状态放在 workspace 中，不带的
+// 使用 thread_local 工作区。重建期间不得修改磁场对象。
 class PDCMomentumReconstructor {
 public:
-    explicit PDCMomentumReconstructor(MagneticField* magnetic_field);
+    explicit PDCMomentumReconstructor(const MagneticField* magnetic_field);
+    explicit PDCMomentumReconstructor(std::shared_ptr<const PDCRecoSharedState> shared_state);
+
+    const PDCRecoSharedState& SharedState() const { return *fShared; }
+
+    // [EN] Uses target/config from the shared state. / [CN] 使用共享状态中的靶和配置。
+    RecoResult Reconstruct(
+        const PDCInputTrack& track,
+        PDCRecoWorkspace* workspace
+    ) const;
+
+    RecoResult Reconstruct(
+        const PDCInputTrack& track,
+        const TargetConstraint& target,
+        const RecoConfig& config,
+        PDCRecoWorkspace* workspace
+    ) const;
+
+    // [EN] A hit in fit_cache returns the stored result without running any solver; a miss runs the chain
+    // and records the result. nullptr disables caching for this call. / [CN] fit_cache 命中时直接返回存储结果，
+    // 不运行任何求解器；未命中则运行求解链并记录结果。传 nullptr 表示本次不使用缓存。
+    RecoResult Reconstruct(
+        const PDCInputTrack& track,
+        const TargetConstraint& target,
+        const RecoConfig& config,
+        PDCRecoWorkspace* workspace,
+        PDCFitResultCache* fit_cache
+    ) const;
 
     RecoResult Reconstruct(
         const PDCInputTrack& track,
@@ -20,6 +102,31 @@ public:
         const RecoConfig& config
     ) const;
 
+    // [EN] Batch entry point for offline passes and bindings: reads SoA measurements, writes SoA results and
+    // never builds a RecoResult per successful NN track. Cached tracks are answered first, NN-enabled configs then
+    // run one blocked forward pass over all remaining tracks, and whatever is left (NN disabled or failed) goes
+    // through the usual solver chain with the same workspace. Every written entry equals what Reconstruct() would
+    // return for that track. Returns false only for malformed input (null position columns).
+    // [CN] 面向离线批处理与语言绑定的批量入口：读取 SoA 测量、写出 SoA 结果，NN 成功的径迹不再逐条构造 RecoResult。
+    // 先用缓存应答，启用 NN 时对剩余径迹做一次分块前向，余下（未启用或 NN 失败）的径迹用同一 workspace 走常规求解链。
+    // 每条输出与 Reconstruct() 对该径迹的结果一致。仅在输入格式错误（位置列为空）时返回 false。
+    bool ReconstructBatch(
+        const PDCBatchInput& input,
+        const PDCBatchOutput& output,
+        PDCRecoWorkspace* workspace,
+        std::string* reason = nullptr
+    ) const;
+
+    bool ReconstructBatch(
+        const PDCBatchInput& input,
+        const TargetConstraint& target,
+        const RecoConfig& config,
+        const PDCBatchOutput& output,
+        PDCRecoWorkspace* workspace,
+        PDCFitResultCache* fit_cache,
+        std::string* reason = nullptr
+    ) const;
+
     RecoResult ReconstructRK(
         const PDCInputTrack& track,
         const TargetConstraint& target,
@@ -35,7 +142,8 @@ public:
     RecoResult ReconstructNN(
         const PDCInputTrack& track,
         const TargetConstraint& target,
-        const RecoConfig& config
+        const RecoConfig& config,
+        PDCRecoWorkspace* workspace = nullptr
     ) const;
 
     RecoResult ReconstructRKTwoPointBackprop(
@@ -60,6 +168,22 @@ private:
     static bool IsFinite(const TVector3& value);
     static bool IsFinite(const TLorentzVector& value);
     static double Clamp(double value, double lower, double upper);
+    static PDCRecoWorkspace& ThreadLocalWorkspace();
+
+    RecoResult ReconstructChain(
+        const PDCInputTrack& track,
+        const TargetConstraint& target,
+        const RecoConfig& config,
+        PDCRecoWorkspace* workspace
+    ) const;
+
+    // [EN] Shared preloaded model when its path matches, otherwise a lazily loaded per-workspace copy.
+    // [CN] 路径一致时返回预加载的共享模型，否则返回 workspace 中延迟加载的副本。
+    const PDCNNMomentumReconstructor* ResolveNNModel(
+        const RecoConfig& config,
+        PDCRecoWorkspace& workspace,
+        std::string* reason
+    ) const;
 
     bool ValidateInputs(
         const PDCInputTrack& track,
@@ -68,9 +192,8 @@ private:
         std::string* reason
     ) const;
 
-    MagneticField* fMagneticField = nullptr;
-    mutable std::unique_ptr<PDCNNMomentumReconstructor> fNNReconstructor;
-    mutable std::string fNNModelPath;
+    std::shared_ptr<const PDCRecoSharedState> fShared;
+    const MagneticField* fMagneticField = nullptr;
 };
 
 }  // namespace analysis::pdc::anaroot_like
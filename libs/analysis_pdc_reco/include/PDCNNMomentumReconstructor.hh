@@ -4,16 +4,38 @@
 #include "PDCRecoTypes.hh"
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace analysis::pdc::anaroot_like {
 
+// [EN] Caller-owned activation buffers for Forward(); reused across calls so
+// inference does not allocate per track. One instance per thread.
+// [CN] Forward() 的激活缓冲区，由调用方持有并跨调用复用，避免逐径迹分配；每线程一份。
+struct PDCNNScratch {
+    std::vector<double> activations;
+    std::vector<double> next;
+};
+
+// [EN] After LoadModel() the object is immutable; const Reconstruct() may be
+// called concurrently from several threads as long as each passes its own
+// scratch (or none). / [CN] LoadModel() 之后对象不可变；只要每个线程使用
+// 自己的 scratch，const Reconstruct() 可并发调用。
 class PDCNNMomentumReconstructor {
 public:
     bool LoadModel(const std::string& json_path, std::string* reason);
     bool IsLoaded() const { return fLoaded; }
     const std::string& LoadedPath() const { return fLoadedPath; }
+    // [EN] FNV-1a of the model file bytes read by LoadModel(); 0 until a model is loaded. Identifies the weights
+    // even when the file at the same path is replaced between runs. / [CN] LoadModel() 读取的模型文件字节的
+    // FNV-1a 哈希，未加载时为 0；同一路径下的文件在两次运行之间被替换时也能区分权重。
+    std::uint64_t ContentFingerprint() const { return fContentFingerprint; }
+
+    // [EN] RecoConfig::nn_model_json_path, or PDC_NN_MODEL_JSON when that is empty; empty when neither is set.
+    // [CN] RecoConfig::nn_model_json_path，为空时取 PDC_NN_MODEL_JSON；两者都未设置时返回空串。
+    static std::string ResolveModelPath(const RecoConfig& config);
 
     RecoResult Reconstruct(
         const PDCInputTrack& track,
@@ -21,6 +43,40 @@ public:
         const RecoConfig& config
     ) const;
 
+    RecoResult Reconstruct(
+        const PDCInputTrack& track,
+        const TargetConstraint& target,
+        const RecoConfig& config,
+        PDCNNScratch* scratch
+    ) const;
+
+    // [EN] Forward pass over `count` tracks at once: `features` is row-major count x 6 (pdc1 xyz, pdc2 xyz),
+    // `momenta` receives count x 3 raw predictions. Layers run as matrix x block products over up to
+    // kBatchBlock tracks, so each weight row is loaded once per block instead of once per track. ok[i] is 0
+    // wherever the single-track Forward() would have failed. / [CN] 一次对 count 条径迹做前向：features 为
+    // count x 6 行优先，momenta 写入 count x 3 原始预测。各层以“矩阵 x 块”方式处理至多 kBatchBlock 条径迹，
+    // 每行权重每块只读一次。单径迹 Forward() 会失败的位置 ok[i] 置 0。
+    void PredictBatch(
+        const double* features,
+        std::size_t count,
+        double* momenta,
+        unsigned char* ok,
+        PDCNNScratch* scratch
+    ) const;
+
+    // [EN] Momentum clamping, on-shell energy and Brho exactly as Reconstruct() applies them to a prediction.
+    // [CN] 与 Reconstruct() 相同的动量截断、在壳能量和 Brho 计算。
+    static bool FinishPrediction(
+        const std::array<double, 3>& prediction,
+        const TargetConstraint& target,
+        const RecoConfig& config,
+        TLorentzVector* p4,
+        double* brho_tm,
+        std::string* reason
+    );
+
+    static constexpr std::size_t kBatchBlock = 64;
+
 private:
     struct DenseLayer {
         int in_dim = 0;
@@ -32,12 +88,14 @@ private:
     bool Forward(
         const std::array<double, 6>& features,
         std::array<double, 3>* momentum,
+        PDCNNScratch* scratch,
         std::string* reason
     ) const;
 
     bool fLoaded = false;
     bool fUseTargetNormalization = false;
     std::string fLoadedPath;
+    std::uint64_t fContentFingerprint = 0;
     std::array<double, 6> fXMean{0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
     std::array<double, 6> fXStd{1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
     std::array<double, 3> fYMean{0.0, 0.0, 0.0};
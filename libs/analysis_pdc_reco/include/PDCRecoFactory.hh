@@ -4,12 +4,22 @@
 #include "PDCMomentumReconstructor.hh"
 
 #include <memory>
+#include <string>
 
 namespace analysis::pdc::anaroot_like {
 
 class PDCRecoFactory {
 public:
     static std::unique_ptr<PDCMomentumReconstructor> CreateDefault(MagneticField* magnetic_field);
+
+    // [EN] Builds the immutable state shared across worker threads; preloads the
+    // NN model when config.enable_nn is set. Returns nullptr (with reason) if the
+    // model cannot be loaded. / [CN] 构建跨线程共享的不可变状态；启用NN时预加载模型，
+    // 加载失败返回 nullptr 并给出原因。
+    static std::shared_ptr<const PDCRecoSharedState> CreateSharedState(const MagneticField* magnetic_field,
+                                                                       const TargetConstraint& target,
+                                                                       const RecoConfig& config,
+                                                                       std::string* reason = nullptr);
     static bool UseAnarootLikeByDefault();
 };
 
@@ -5,6 +5,7 @@
 #include "TVector3.h"
 
 #include <array>
+#include <cstddef>
 #include <limits>
 #include <string>
 #include <vector>
@@ -165,6 +166,39 @@ struct RecoResult {
     std::string message;
 };
 
+// [EN] Structure-of-arrays view of `size` PDC measurements for ReconstructBatch(); all arrays are caller-owned
+// and hold `size` entries. Optional per-track sigmas replace TargetConstraint::pdc_sigma_u/v_mm for both planes.
+// [CN] ReconstructBatch() 的 SoA 输入视图，共 size 条 PDC 测量；数组由调用方持有，长度均为 size。
+// 可选的逐径迹 sigma 会替换两层共用的 TargetConstraint::pdc_sigma_u/v_mm。
+struct PDCBatchInput {
+    std::size_t size = 0;
+    const double* pdc1_x = nullptr;
+    const double* pdc1_y = nullptr;
+    const double* pdc1_z = nullptr;
+    const double* pdc2_x = nullptr;
+    const double* pdc2_y = nullptr;
+    const double* pdc2_z = nullptr;
+    const double* pdc_sigma_u_mm = nullptr;  // optional
+    const double* pdc_sigma_v_mm = nullptr;  // optional
+};
+
+// [EN] Caller-provided SoA output buffers; every non-null column receives `size` entries (momentum_covariance
+// 9 per track, row-major). Null columns are skipped, so callers only pay for what they read.
+// [CN] 调用方提供的 SoA 输出缓冲区；非空列写入 size 条（momentum_covariance 每径迹 9 个，行优先）。空列跳过，只为所需字段付费。
+struct PDCBatchOutput {
+    int* status = nullptr;  // static_cast<int>(SolverStatus)
+    int* method = nullptr;  // static_cast<int>(SolveMethod)
+    double* px = nullptr;
+    double* py = nullptr;
+    double* pz = nullptr;
+    double* energy = nullptr;
+    double* brho_tm = nullptr;
+    double* chi2_reduced = nullptr;
+    int* ndf = nullptr;
+    int* iterations = nullptr;
+    double* momentum_covariance = nullptr;
+};
+
 // ============================================================================
 // Error Analysis Structures (Phase 1: Data Structure Foundation)
 // ============================================================================
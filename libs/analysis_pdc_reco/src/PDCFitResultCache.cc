@@ -0,0 +1,501 @@
+#include "PDCFitResultCache.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <type_traits>
+
+namespace analysis::pdc::anaroot_like {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr char kMagic[8] = {'S', 'M', 'F', 'I', 'T', 'C', 'A', 'C'};
+// [EN] Bump when the record layout or any solver changes its numerical output; old files are then discarded.
+// [CN] 记录布局或求解器数值结果变化时递增；旧文件随之作废。
+constexpr std::uint32_t kFormatVersion = 1;
+constexpr std::uint32_t kByteOrderMark = 0x01020304u;
+constexpr std::size_t kHeaderSize = sizeof(kMagic) + 2 * sizeof(std::uint32_t) + sizeof(std::uint64_t);
+// [EN] Upper bound on one record body; anything larger is treated as a torn tail. / [CN] 单条记录体上限，超出视为残缺尾部。
+constexpr std::uint32_t kMaxRecordBytes = 1u << 16;
+
+std::uint64_t Fnv1a(const char* data, std::size_t size, std::uint64_t hash = 1469598103934665603ULL) {
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// [EN] splitmix64 finalizer over (hash ^ value): cheap, and every input bit reaches every output bit.
+// [CN] 对 (hash ^ value) 做 splitmix64 末端混合：开销小且输入每一位都影响输出。
+std::uint64_t Combine(std::uint64_t hash, std::uint64_t value) {
+    std::uint64_t z = hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+std::uint64_t Bits(double value) {
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+std::uint64_t Combine(std::uint64_t hash, double value) { return Combine(hash, Bits(value)); }
+std::uint64_t Combine(std::uint64_t hash, int value) { return Combine(hash, static_cast<std::uint64_t>(value)); }
+std::uint64_t Combine(std::uint64_t hash, bool value) { return Combine(hash, static_cast<std::uint64_t>(value)); }
+std::uint64_t Combine(std::uint64_t hash, const std::string& value) {
+    return Combine(hash, Fnv1a(value.data(), value.size()));
+}
+std::uint64_t Combine(std::uint64_t hash, const TVector3& value) {
+    return Combine(Combine(Combine(hash, value.X()), value.Y()), value.Z());
+}
+
+class RecordWriter {
+public:
+    explicit RecordWriter(std::vector<char>* out) : fOut(out) {}
+
+    template <typename T>
+    void Put(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        fOut->insert(fOut->end(), bytes, bytes + sizeof(T));
+    }
+
+    void PutInterval(const IntervalEstimate& interval) {
+        Put<std::uint8_t>(interval.valid ? 1 : 0);
+        for (const double value : {interval.center, interval.sigma, interval.lower68, interval.upper68,
+                                   interval.lower95, interval.upper95}) {
+            Put(value);
+        }
+    }
+
+private:
+    std::vector<char>* fOut;
+};
+
+class RecordReader {
+public:
+    RecordReader(const char* data, std::size_t size) : fData(data), fSize(size) {}
+
+    template <typename T>
+    bool Get(T* value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (fSize - fOffset < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(value, fData + fOffset, sizeof(T));
+        fOffset += sizeof(T);
+        return true;
+    }
+
+    bool GetInterval(IntervalEstimate* interval) {
+        std::uint8_t valid = 0;
+        bool ok = Get(&valid);
+        interval->valid = valid != 0;
+        for (double* value : {&interval->center, &interval->sigma, &interval->lower68, &interval->upper68,
+                              &interval->lower95, &interval->upper95}) {
+            ok = ok && Get(value);
+        }
+        return ok;
+    }
+
+    bool GetString(std::string* value, std::uint32_t length) {
+        if (fSize - fOffset < length) {
+            return false;
+        }
+        value->assign(fData + fOffset, length);
+        fOffset += length;
+        return true;
+    }
+
+    bool AtEnd() const { return fOffset == fSize; }
+
+private:
+    const char* fData;
+    std::size_t fSize;
+    std::size_t fOffset = 0;
+};
+
+void EncodeBody(std::uint64_t key, const std::array<double, 6>& hits, const RecoResult& result,
+                std::vector<char>* body) {
+    RecordWriter writer(body);
+    writer.Put(key);
+    for (const double value : hits) {
+        writer.Put(value);
+    }
+    writer.Put(static_cast<std::int32_t>(result.status));
+    writer.Put(static_cast<std::int32_t>(result.method_used));
+    for (const double value : {result.p4_at_target.Px(), result.p4_at_target.Py(), result.p4_at_target.Pz(),
+                               result.p4_at_target.E(), result.fit_start_position.X(),
+                               result.fit_start_position.Y(), result.fit_start_position.Z(), result.chi2,
+                               result.chi2_raw, result.chi2_reduced, result.min_distance_mm,
+                               result.path_length_mm, result.brho_tm, result.normal_condition_number}) {
+        writer.Put(value);
+    }
+    writer.Put(static_cast<std::int32_t>(result.iterations));
+    writer.Put(static_cast<std::int32_t>(result.ndf));
+    const std::uint8_t flags = static_cast<std::uint8_t>((result.used_measurement_covariance ? 1u : 0u) |
+                                                         (result.uncertainty_valid ? 2u : 0u) |
+                                                         (result.posterior_valid ? 4u : 0u));
+    writer.Put(flags);
+    writer.Put(result.state_covariance);
+    writer.Put(result.momentum_covariance);
+    writer.Put(result.posterior_momentum_covariance);
+    for (const IntervalEstimate* interval : {&result.px_interval, &result.py_interval, &result.pz_interval,
+                                             &result.p_interval, &result.px_credible, &result.py_credible,
+                                             &result.pz_credible, &result.p_credible}) {
+        writer.PutInterval(*interval);
+    }
+    writer.Put(static_cast<std::uint32_t>(result.message.size()));
+    body->insert(body->end(), result.message.begin(), result.message.end());
+}
+
+bool DecodeBody(const char* data, std::size_t size, std::uint64_t* key, std::array<double, 6>* hits,
+                RecoResult* result) {
+    RecordReader reader(data, size);
+    bool ok = reader.Get(key);
+    for (double& value : *hits) {
+        ok = ok && reader.Get(&value);
+    }
+    std::int32_t status = 0;
+    std::int32_t method = 0;
+    ok = ok && reader.Get(&status) && reader.Get(&method);
+    std::array<double, 14> scalars{};
+    for (double& value : scalars) {
+        ok = ok && reader.Get(&value);
+    }
+    std::int32_t iterations = 0;
+    std::int32_t ndf = 0;
+    std::uint8_t flags = 0;
+    ok = ok && reader.Get(&iterations) && reader.Get(&ndf) && reader.Get(&flags);
+    ok = ok && reader.Get(&result->state_covariance) && reader.Get(&result->momentum_covariance) &&
+         reader.Get(&result->posterior_momentum_covariance);
+    for (IntervalEstimate* interval : {&result->px_interval, &result->py_interval, &result->pz_interval,
+                                       &result->p_interval, &result->px_credible, &result->py_credible,
+                                       &result->pz_credible, &result->p_credible}) {
+        ok = ok && reader.GetInterval(interval);
+    }
+    std::uint32_t message_length = 0;
+    ok = ok && reader.Get(&message_length) && reader.GetString(&result->message, message_length);
+    if (!ok || !reader.AtEnd()) {
+        return false;
+    }
+
+    result->status = static_cast<SolverStatus>(status);
+    result->method_used = static_cast<SolveMethod>(method);
+    result->p4_at_target.SetPxPyPzE(scalars[0], scalars[1], scalars[2], scalars[3]);
+    result->fit_start_position.SetXYZ(scalars[4], scalars[5], scalars[6]);
+    result->chi2 = scalars[7];
+    result->chi2_raw = scalars[8];
+    result->chi2_reduced = scalars[9];
+    result->min_distance_mm = scalars[10];
+    result->path_length_mm = scalars[11];
+    result->brho_tm = scalars[12];
+    result->normal_condition_number = scalars[13];
+    result->iterations = iterations;
+    result->ndf = ndf;
+    result->used_measurement_covariance = (flags & 1u) != 0;
+    result->uncertainty_valid = (flags & 2u) != 0;
+    result->posterior_valid = (flags & 4u) != 0;
+    return true;
+}
+
+std::vector<char> EncodeHeader(std::uint64_t field_fingerprint) {
+    std::vector<char> header(kMagic, kMagic + sizeof(kMagic));
+    RecordWriter writer(&header);
+    writer.Put(kFormatVersion);
+    writer.Put(kByteOrderMark);
+    writer.Put(field_fingerprint);
+    return header;
+}
+
+void SetReason(std::string* reason, const std::string& text) {
+    if (reason) {
+        *reason = text;
+    }
+}
+
+}  // namespace
+
+std::uint64_t PDCFitResultCache::FieldMapFingerprint(const MagneticField* magnetic_field) {
+    std::uint64_t hash = Combine(0, static_cast<std::uint64_t>(kFormatVersion));
+    if (!magnetic_field) {
+        return hash;
+    }
+    hash = Combine(hash, magnetic_field->GetNx());
+    hash = Combine(hash, magnetic_field->GetNy());
+    hash = Combine(hash, magnetic_field->GetNz());
+    for (const double value : {magnetic_field->GetXmin(), magnetic_field->GetXmax(), magnetic_field->GetYmin(),
+                               magnetic_field->GetYmax(), magnetic_field->GetZmin(), magnetic_field->GetZmax(),
+                               magnetic_field->GetRotationAngle()}) {
+        hash = Combine(hash, value);
+    }
+    const int total_points = magnetic_field->GetTotalPoints();
+    for (int i = 0; i < total_points; ++i) {
+        hash = Combine(hash, magnetic_field->GetBx(i));
+        hash = Combine(hash, magnetic_field->GetBy(i));
+        hash = Combine(hash, magnetic_field->GetBz(i));
+    }
+    return hash;
+}
+
+std::uint64_t PDCFitResultCache::GeometryFingerprint(const TargetConstraint& target) {
+    std::uint64_t hash = Combine(0, target.target_position);
+    for (const double value : {target.mass_mev, target.charge_e, target.target_sigma_xy_mm, target.pdc_sigma_u_mm,
+                               target.pdc_sigma_v_mm, target.pdc_uv_correlation, target.pdc_angle_deg}) {
+        hash = Combine(hash, value);
+    }
+    hash = Combine(hash, target.pdc_u_dir);
+    return Combine(hash, target.pdc_v_dir);
+}
+
+std::uint64_t PDCFitResultCache::ConfigFingerprint(const RecoConfig& config,
+                                                   const PDCNNMomentumReconstructor* nn_model) {
+    std::uint64_t hash = 0;
+    for (const double value : {config.p_min_mevc, config.p_max_mevc, config.initial_p_mevc, config.tolerance_mm,
+                               config.rk_step_mm, config.lm_lambda_init, config.lm_lambda_min,
+                               config.lm_lambda_max, config.center_brho_tm, config.momentum_prior.center_mev_c,
+                               config.momentum_prior.sigma_mev_c}) {
+        hash = Combine(hash, value);
+    }
+    hash = Combine(hash, config.max_iterations);
+    for (const bool flag : {config.enable_rk, config.enable_nn, config.enable_multi_dim,
+                            config.compute_uncertainty, config.compute_posterior_laplace,
+                            config.momentum_prior.enabled}) {
+        hash = Combine(hash, flag);
+    }
+    hash = Combine(hash, static_cast<int>(config.rk_fit_mode));
+    hash = Combine(hash, static_cast<int>(config.rk_parameterization));
+    if (!config.enable_nn) {
+        return hash;
+    }
+    if (nn_model && nn_model->IsLoaded()) {
+        hash = Combine(hash, nn_model->LoadedPath());
+        return Combine(hash, nn_model->ContentFingerprint());
+    }
+    return Combine(hash, PDCNNMomentumReconstructor::ResolveModelPath(config));
+}
+
+std::string PDCFitResultCache::PathForInput(const std::string& cache_dir,
+                                            const std::string& input_file,
+                                            const std::string& tag) {
+    std::error_code ec;
+    fs::path absolute = fs::absolute(input_file, ec);
+    if (ec) {
+        absolute = input_file;
+    }
+    const std::string normalized = absolute.lexically_normal().generic_string();
+    std::ostringstream name;
+    name << fs::path(input_file).stem().string() << '.' << std::hex << std::setw(16) << std::setfill('0')
+         << Fnv1a(normalized.data(), normalized.size());
+    if (!tag.empty()) {
+        name << '.' << tag;
+    }
+    name << ".fitcache";
+    return (fs::path(cache_dir) / name.str()).string();
+}
+
+PDCFitResultCache::PDCFitResultCache(std::uint64_t field_fingerprint)
+    : fFieldFingerprint(field_fingerprint) {}
+
+PDCFitResultCache::~PDCFitResultCache() {
+    Flush();
+}
+
+bool PDCFitResultCache::Open(const std::string& path, std::string* reason) {
+    std::lock_guard<std::mutex> write_lock(fWriteMutex);
+    std::unique_lock<std::shared_mutex> map_lock(fMapMutex);
+    if (fOpen) {
+        SetReason(reason, "fit cache already open: " + fPath);
+        return false;
+    }
+
+    std::error_code ec;
+    const fs::path file_path(path);
+    if (file_path.has_parent_path()) {
+        fs::create_directories(file_path.parent_path(), ec);
+        if (ec) {
+            SetReason(reason, "cannot create fit cache directory: " + file_path.parent_path().string());
+            return false;
+        }
+    }
+
+    const std::vector<char> header = EncodeHeader(fFieldFingerprint);
+    std::vector<char> content;
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (in) {
+            content.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+    }
+
+    std::size_t good_bytes = 0;
+    if (content.size() >= kHeaderSize && std::equal(header.begin(), header.end(), content.begin())) {
+        good_bytes = kHeaderSize;
+        std::vector<char> body;
+        while (content.size() - good_bytes >= sizeof(std::uint32_t)) {
+            std::uint32_t body_size = 0;
+            std::memcpy(&body_size, content.data() + good_bytes, sizeof(body_size));
+            const std::size_t record_size = sizeof(body_size) + body_size + sizeof(std::uint64_t);
+            if (body_size > kMaxRecordBytes || content.size() - good_bytes < record_size) {
+                break;
+            }
+            const char* body_data = content.data() + good_bytes + sizeof(body_size);
+            std::uint64_t checksum = 0;
+            std::memcpy(&checksum, body_data + body_size, sizeof(checksum));
+            if (checksum != Fnv1a(body_data, body_size)) {
+                break;
+            }
+            std::uint64_t key = 0;
+            Entry entry;
+            if (!DecodeBody(body_data, body_size, &key, &entry.hits, &entry.result)) {
+                break;
+            }
+            fEntries[key] = std::move(entry);
+            ++fLoaded;
+            good_bytes += record_size;
+        }
+    }
+    fDiscarded = content.size() - good_bytes;
+
+    if (good_bytes == 0) {
+        // [EN] Missing, foreign or stale file: start over with a fresh header. / [CN] 文件缺失、格式不符或已过期：重写文件头重新开始。
+        std::ofstream fresh(path, std::ios::binary | std::ios::trunc);
+        fresh.write(header.data(), static_cast<std::streamsize>(header.size()));
+        if (!fresh) {
+            SetReason(reason, "cannot write fit cache: " + path);
+            return false;
+        }
+    } else if (good_bytes < content.size()) {
+        fs::resize_file(file_path, good_bytes, ec);
+        if (ec) {
+            SetReason(reason, "cannot truncate torn fit cache tail: " + path);
+            return false;
+        }
+    }
+
+    fOut.open(path, std::ios::binary | std::ios::app);
+    if (!fOut) {
+        SetReason(reason, "cannot open fit cache for appending: " + path);
+        return false;
+    }
+    fPath = path;
+    fOpen = true;
+    return true;
+}
+
+std::uint64_t PDCFitResultCache::Key(const PDCInputTrack& track,
+                                     const TargetConstraint& target,
+                                     const RecoConfig& config,
+                                     const PDCNNMomentumReconstructor* nn_model,
+                                     std::array<double, 6>* hits) const {
+    *hits = {track.pdc1.X(), track.pdc1.Y(), track.pdc1.Z(), track.pdc2.X(), track.pdc2.Y(), track.pdc2.Z()};
+    std::uint64_t key = Combine(fFieldFingerprint, GeometryFingerprint(target));
+    key = Combine(key, ConfigFingerprint(config, nn_model));
+    for (const double value : *hits) {
+        key = Combine(key, value);
+    }
+    return key;
+}
+
+bool PDCFitResultCache::Lookup(const PDCInputTrack& track,
+                               const TargetConstraint& target,
+                               const RecoConfig& config,
+                               RecoResult* result,
+                               const PDCNNMomentumReconstructor* nn_model) const {
+    std::array<double, 6> hits{};
+    const std::uint64_t key = Key(track, target, config, nn_model, &hits);
+    {
+        std::shared_lock<std::shared_mutex> lock(fMapMutex);
+        const auto it = fEntries.find(key);
+        // [EN] Compare the stored hit bits too, so a 64-bit key collision can never return a foreign fit.
+        // [CN] 同时比较存储的击中位模式，避免 64 位键碰撞返回错误的拟合。
+        if (it != fEntries.end() && std::memcmp(it->second.hits.data(), hits.data(), sizeof(hits)) == 0) {
+            if (result) {
+                *result = it->second.result;
+            }
+            fHits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    fMisses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void PDCFitResultCache::Insert(const PDCInputTrack& track,
+                               const TargetConstraint& target,
+                               const RecoConfig& config,
+                               const RecoResult& result,
+                               const PDCNNMomentumReconstructor* nn_model) {
+    Entry entry;
+    const std::uint64_t key = Key(track, target, config, nn_model, &entry.hits);
+    entry.result = result;
+
+    std::vector<char> body;
+    body.reserve(1024);
+    EncodeBody(key, entry.hits, result, &body);
+    {
+        std::unique_lock<std::shared_mutex> lock(fMapMutex);
+        if (!fEntries.emplace(key, std::move(entry)).second) {
+            return;
+        }
+    }
+    fInserted.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(fWriteMutex);
+    if (!fOpen) {
+        return;
+    }
+    const std::uint32_t body_size = static_cast<std::uint32_t>(body.size());
+    const std::uint64_t checksum = Fnv1a(body.data(), body.size());
+    RecordWriter writer(&fPending);
+    writer.Put(body_size);
+    fPending.insert(fPending.end(), body.begin(), body.end());
+    writer.Put(checksum);
+    if (++fPendingRecords >= kFlushRecords) {
+        FlushLocked(nullptr);
+    }
+}
+
+bool PDCFitResultCache::Flush(std::string* reason) {
+    std::lock_guard<std::mutex> lock(fWriteMutex);
+    return FlushLocked(reason);
+}
+
+bool PDCFitResultCache::FlushLocked(std::string* reason) {
+    if (!fOpen || fPending.empty()) {
+        return true;
+    }
+    fOut.write(fPending.data(), static_cast<std::streamsize>(fPending.size()));
+    fOut.flush();
+    fPending.clear();
+    fPendingRecords = 0;
+    if (!fOut) {
+        SetReason(reason, "failed to append to fit cache: " + fPath);
+        return false;
+    }
+    return true;
+}
+
+std::size_t PDCFitResultCache::Size() const {
+    std::shared_lock<std::shared_mutex> lock(fMapMutex);
+    return fEntries.size();
+}
+
+PDCFitResultCache::Stats PDCFitResultCache::GetStats() const {
+    Stats stats;
+    stats.loaded = fLoaded;
+    stats.hits = fHits.load(std::memory_order_relaxed);
+    stats.misses = fMisses.load(std::memory_order_relaxed);
+    stats.inserted = fInserted.load(std::memory_order_relaxed);
+    stats.discarded = fDiscarded;
+    return stats;
+}
+
+}  // namespace analysis::pdc::anaroot_like
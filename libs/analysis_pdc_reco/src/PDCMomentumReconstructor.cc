@@ -3,11 +3,26 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <utility>
 
 namespace analysis::pdc::anaroot_like {
 
-PDCMomentumReconstructor::PDCMomentumReconstructor(MagneticField* magnetic_field)
-    : fMagneticField(magnetic_field) {}
+PDCMomentumReconstructor::PDCMomentumReconstructor(const MagneticField* magnetic_field)
+    : PDCMomentumReconstructor([magnetic_field] {
+          auto state = std::make_shared<PDCRecoSharedState>();
+          state->magnetic_field = magnetic_field;
+          return std::shared_ptr<const PDCRecoSharedState>(std::move(state));
+      }()) {}
+
+PDCMomentumReconstructor::PDCMomentumReconstructor(std::shared_ptr<const PDCRecoSharedState> shared_state)
+    : fShared(shared_state ? std::move(shared_state) : std::make_shared<const PDCRecoSharedState>()),
+      fMagneticField(fShared->magnetic_field) {}
+
+PDCRecoWorkspace& PDCMomentumReconstructor::ThreadLocalWorkspace() {
+    // [EN] Backs the workspace-less overloads so legacy callers stay reentrant. / [CN] 支撑不带workspace的重载，使旧调用方也可重入。
+    thread_local PDCRecoWorkspace workspace;
+    return workspace;
+}
 
 bool PDCMomentumReconstructor::IsFinite(const TVector3& value) {
     return std::isfinite(value.X()) && std::isfinite(value.Y()) && std::isfinite(value.Z());
@@ -24,10 +39,63 @@ double PDCMomentumReconstructor::Clamp(double value, double lower, double upper)
     return std::max(lower, std::min(value, upper));
 }
 
+RecoResult PDCMomentumReconstructor::Reconstruct(
+    const PDCInputTrack& track,
+    PDCRecoWorkspace* workspace
+) const {
+    return Reconstruct(track, fShared->target, fShared->config, workspace);
+}
+
 RecoResult PDCMomentumReconstructor::Reconstruct(
     const PDCInputTrack& track,
     const TargetConstraint& target,
     const RecoConfig& config
+) const {
+    return Reconstruct(track, target, config, &ThreadLocalWorkspace());
+}
+
+RecoResult PDCMomentumReconstructor::Reconstruct(
+    const PDCInputTrack& track,
+    const TargetConstraint& target,
+    const RecoConfig& config,
+    PDCRecoWorkspace* workspace
+) const {
+    return Reconstruct(track, target, config, workspace, fShared->fit_cache.get());
+}
+
+RecoResult PDCMomentumReconstructor::Reconstruct(
+    const PDCInputTrack& track,
+    const TargetConstraint& target,
+    const RecoConfig& config,
+    PDCRecoWorkspace* workspace,
+    PDCFitResultCache* fit_cache
+) const {
+    if (!fit_cache) {
+        return ReconstructChain(track, target, config, workspace);
+    }
+    // [EN] The NN model takes part in the key; resolving it is a path compare once loaded.
+    // [CN] NN 模型参与缓存键；加载后解析只需比较路径。
+    const PDCNNMomentumReconstructor* nn_model = nullptr;
+    if (config.enable_nn) {
+        nn_model = ResolveNNModel(config, workspace ? *workspace : ThreadLocalWorkspace(), nullptr);
+    }
+    RecoResult cached;
+    if (fit_cache->Lookup(track, target, config, &cached, nn_model)) {
+        return cached;
+    }
+    RecoResult result = ReconstructChain(track, target, config, workspace);
+    // [EN] Rejected inputs are cheaper to re-validate than to store. / [CN] 无效输入重新校验比存储更省。
+    if (result.status != SolverStatus::kInvalidInput) {
+        fit_cache->Insert(track, target, config, result, nn_model);
+    }
+    return result;
+}
+
+RecoResult PDCMomentumReconstructor::ReconstructChain(
+    const PDCInputTrack& track,
+    const TargetConstraint& target,
+    const RecoConfig& config,
+    PDCRecoWorkspace* workspace
 ) const {
     RecoResult best;
     best.method_used = SolveMethod::kAutoChain;
@@ -50,7 +118,7 @@ RecoResult PDCMomentumReconstructor::Reconstruct(
     };
 
     if (config.enable_nn) {
-        const RecoResult nn = ReconstructNN(track, target, config);
+        const RecoResult nn = ReconstructNN(track, target, config, workspace);
         if (nn.status == SolverStatus::kSuccess) {
             return nn;
         }
@@ -0,0 +1,186 @@
+#include "PDCMomentumReconstructor.hh"
+#include "RecoProfiler.hh"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <string>
+
+namespace analysis::pdc::anaroot_like {
+namespace {
+
+void WriteResult(const RecoResult& result, std::size_t index, const PDCBatchOutput& output) {
+    if (output.status) {
+        output.status[index] = static_cast<int>(result.status);
+    }
+    if (output.method) {
+        output.method[index] = static_cast<int>(result.method_used);
+    }
+    if (output.px) {
+        output.px[index] = result.p4_at_target.Px();
+    }
+    if (output.py) {
+        output.py[index] = result.p4_at_target.Py();
+    }
+    if (output.pz) {
+        output.pz[index] = result.p4_at_target.Pz();
+    }
+    if (output.energy) {
+        output.energy[index] = result.p4_at_target.E();
+    }
+    if (output.brho_tm) {
+        output.brho_tm[index] = result.brho_tm;
+    }
+    if (output.chi2_reduced) {
+        output.chi2_reduced[index] = result.chi2_reduced;
+    }
+    if (output.ndf) {
+        output.ndf[index] = result.ndf;
+    }
+    if (output.iterations) {
+        output.iterations[index] = result.iterations;
+    }
+    if (output.momentum_covariance) {
+        std::copy(result.momentum_covariance.begin(), result.momentum_covariance.end(),
+                  output.momentum_covariance + index * result.momentum_covariance.size());
+    }
+}
+
+// [EN] Field values PDCNNMomentumReconstructor::Reconstruct() reports on success; only p4/Brho vary per track.
+// [CN] PDCNNMomentumReconstructor::Reconstruct() 成功时的字段取值；逐径迹只有 p4/Brho 不同。
+RecoResult MakeNNSuccessTemplate() {
+    RecoResult result;
+    result.status = SolverStatus::kSuccess;
+    result.method_used = SolveMethod::kNeuralNetwork;
+    result.chi2 = std::numeric_limits<double>::quiet_NaN();
+    result.chi2_raw = std::numeric_limits<double>::quiet_NaN();
+    result.chi2_reduced = std::numeric_limits<double>::quiet_NaN();
+    result.ndf = 0;
+    result.min_distance_mm = std::numeric_limits<double>::quiet_NaN();
+    result.path_length_mm = std::numeric_limits<double>::quiet_NaN();
+    result.iterations = 1;
+    result.message = "NN inference solved target momentum";
+    return result;
+}
+
+}  // namespace
+
+bool PDCMomentumReconstructor::ReconstructBatch(
+    const PDCBatchInput& input,
+    const PDCBatchOutput& output,
+    PDCRecoWorkspace* workspace,
+    std::string* reason
+) const {
+    return ReconstructBatch(input, fShared->target, fShared->config, output, workspace,
+                            fShared->fit_cache.get(), reason);
+}
+
+bool PDCMomentumReconstructor::ReconstructBatch(
+    const PDCBatchInput& input,
+    const TargetConstraint& target,
+    const RecoConfig& config,
+    const PDCBatchOutput& output,
+    PDCRecoWorkspace* workspace,
+    PDCFitResultCache* fit_cache,
+    std::string* reason
+) const {
+    if (input.size == 0) {
+        return true;
+    }
+    if (!input.pdc1_x || !input.pdc1_y || !input.pdc1_z || !input.pdc2_x || !input.pdc2_y || !input.pdc2_z) {
+        if (reason) {
+            *reason = "batch input is missing a PDC position column";
+        }
+        return false;
+    }
+
+    PDCRecoWorkspace& ws = workspace ? *workspace : ThreadLocalWorkspace();
+    PDCInputTrack track;
+    TargetConstraint track_target = target;
+    const auto load = [&](std::size_t i) {
+        track.pdc1.SetXYZ(input.pdc1_x[i], input.pdc1_y[i], input.pdc1_z[i]);
+        track.pdc2.SetXYZ(input.pdc2_x[i], input.pdc2_y[i], input.pdc2_z[i]);
+        if (input.pdc_sigma_u_mm) {
+            track_target.pdc_sigma_u_mm = input.pdc_sigma_u_mm[i];
+        }
+        if (input.pdc_sigma_v_mm) {
+            track_target.pdc_sigma_v_mm = input.pdc_sigma_v_mm[i];
+        }
+    };
+
+    const PDCNNMomentumReconstructor* model = config.enable_nn ? ResolveNNModel(config, ws, nullptr) : nullptr;
+    std::vector<std::size_t>& pending = ws.fBatchPending;
+    pending.clear();
+    if (fit_cache) {
+        RecoResult cached;
+        for (std::size_t i = 0; i < input.size; ++i) {
+            load(i);
+            if (fit_cache->Lookup(track, track_target, config, &cached, model)) {
+                WriteResult(cached, i, output);
+            } else {
+                pending.push_back(i);
+            }
+        }
+    } else {
+        pending.resize(input.size);
+        for (std::size_t i = 0; i < input.size; ++i) {
+            pending[i] = i;
+        }
+    }
+
+    // [EN] NN stage: gather, one blocked forward pass, scatter. Tracks the NN rejects stay pending so the chain
+    // below reproduces their exact single-track status and message. / [CN] NN 阶段：收集、一次分块前向、回写。
+    // NN 拒绝的径迹留待下方求解链处理，以复现单径迹的状态与信息。
+    if (model && !pending.empty()) {
+        SM_PROFILE_STAGE(profiling::RecoStage::kNNInference);
+        const std::size_t count = pending.size();
+        ws.fBatchFeatures.resize(count * 6);
+        ws.fBatchMomenta.resize(count * 3);
+        ws.fBatchOk.resize(count);
+        for (std::size_t k = 0; k < count; ++k) {
+            const std::size_t i = pending[k];
+            double* row = ws.fBatchFeatures.data() + k * 6;
+            row[0] = input.pdc1_x[i];
+            row[1] = input.pdc1_y[i];
+            row[2] = input.pdc1_z[i];
+            row[3] = input.pdc2_x[i];
+            row[4] = input.pdc2_y[i];
+            row[5] = input.pdc2_z[i];
+        }
+        model->PredictBatch(ws.fBatchFeatures.data(), count, ws.fBatchMomenta.data(), ws.fBatchOk.data(),
+                            &ws.fNNScratch);
+
+        RecoResult solved = MakeNNSuccessTemplate();
+        std::vector<std::size_t>& remaining = ws.fBatchRemaining;
+        remaining.clear();
+        for (std::size_t k = 0; k < count; ++k) {
+            const std::size_t i = pending[k];
+            load(i);
+            const double* m = ws.fBatchMomenta.data() + k * 3;
+            if (!ws.fBatchOk[k] || !track.IsValid() ||
+                !PDCNNMomentumReconstructor::FinishPrediction({m[0], m[1], m[2]}, track_target, config,
+                                                              &solved.p4_at_target, &solved.brho_tm, nullptr)) {
+                remaining.push_back(i);
+                continue;
+            }
+            WriteResult(solved, i, output);
+            if (fit_cache) {
+                fit_cache->Insert(track, track_target, config, solved, model);
+            }
+        }
+        pending.swap(remaining);
+    }
+
+    for (const std::size_t i : pending) {
+        load(i);
+        const RecoResult result = ReconstructChain(track, track_target, config, &ws);
+        WriteResult(result, i, output);
+        // [EN] Same rule as Reconstruct(): rejected inputs are not cached. / [CN] 与 Reconstruct() 相同：无效输入不缓存。
+        if (fit_cache && result.status != SolverStatus::kInvalidInput) {
+            fit_cache->Insert(track, track_target, config, result, model);
+        }
+    }
+    return true;
+}
+
+}  // namespace analysis::pdc::anaroot_like
@@ -1,16 +1,18 @@
 #include "PDCMomentumReconstructor.hh"
+#include "RecoProfiler.hh"
 
-#include <cstdlib>
 #include <limits>
 #include <memory>
 #include <string>
+#include <utility>
 
 namespace analysis::pdc::anaroot_like {
 
 RecoResult PDCMomentumReconstructor::ReconstructNN(
     const PDCInputTrack& track,
     const TargetConstraint& target,
-    const RecoConfig& config
+    const RecoConfig& config,
+    PDCRecoWorkspace* workspace
 ) const {
     RecoResult result;
     result.method_used = SolveMethod::kNeuralNetwork;
@@ -22,33 +24,48 @@ RecoResult PDCMomentumReconstructor::ReconstructNN(
     result.path_length_mm = std::numeric_limits<double>::quiet_NaN();
     result.iterations = 1;
 
-    std::string model_path = config.nn_model_json_path;
-    if (model_path.empty()) {
-        const char* env_model = std::getenv("PDC_NN_MODEL_JSON");
-        if (env_model) {
-            model_path = env_model;
-        }
-    }
-
-    if (model_path.empty()) {
+    std::string reason;
+    PDCRecoWorkspace& ws = workspace ? *workspace : ThreadLocalWorkspace();
+    const PDCNNMomentumReconstructor* model = ResolveNNModel(config, ws, &reason);
+    if (!model) {
         result.status = SolverStatus::kNotAvailable;
-        result.message = "NN model json path is empty (set RecoConfig::nn_model_json_path or PDC_NN_MODEL_JSON)";
+        result.message = reason;
         return result;
     }
 
-    if (!fNNReconstructor || fNNModelPath != model_path || !fNNReconstructor->IsLoaded()) {
-        auto nn = std::make_unique<PDCNNMomentumReconstructor>();
-        std::string reason;
-        if (!nn->LoadModel(model_path, &reason)) {
-            result.status = SolverStatus::kNotAvailable;
-            result.message = reason;
-            return result;
+    SM_PROFILE_STAGE(profiling::RecoStage::kNNInference);
+    return model->Reconstruct(track, target, config, &ws.fNNScratch);
+}
+
+const PDCNNMomentumReconstructor* PDCMomentumReconstructor::ResolveNNModel(
+    const RecoConfig& config,
+    PDCRecoWorkspace& workspace,
+    std::string* reason
+) const {
+    const std::string model_path = PDCNNMomentumReconstructor::ResolveModelPath(config);
+
+    if (model_path.empty()) {
+        if (reason) {
+            *reason = "NN model json path is empty (set RecoConfig::nn_model_json_path or PDC_NN_MODEL_JSON)";
         }
-        fNNReconstructor = std::move(nn);
-        fNNModelPath = model_path;
+        return nullptr;
     }
 
-    return fNNReconstructor->Reconstruct(track, target, config);
+    // [EN] Prefer the preloaded shared model; only load privately into the
+    // workspace when the requested path differs. / [CN] 优先使用预加载的共享模型；
+    // 路径不一致时才在 workspace 中私有加载。
+    if (fShared->nn_model && fShared->nn_model_path == model_path) {
+        return fShared->nn_model.get();
+    }
+    if (!workspace.fNNModel || workspace.fNNModelPath != model_path || !workspace.fNNModel->IsLoaded()) {
+        auto nn = std::make_shared<PDCNNMomentumReconstructor>();
+        if (!nn->LoadModel(model_path, reason)) {
+            return nullptr;
+        }
+        workspace.fNNModel = std::move(nn);
+        workspace.fNNModelPath = model_path;
+    }
+    return workspace.fNNModel.get();
 }
 
 }  // namespace analysis::pdc::anaroot_like
@@ -1,5 +1,6 @@
 #include "PDCMomentumReconstructor.hh"
 #include "PDCRkAnalysisInternal.hh"
+#include "RecoProfiler.hh"
 
 #include <cmath>
 #include <string>
@@ -84,14 +85,24 @@ RecoResult PDCMomentumReconstructor::ReconstructRKTwoPointBackprop(
 
     detail::RkLeastSquaresAnalyzer analyzer(fMagneticField, track, target, config);
     std::string reason;
-    if (!analyzer.Initialize(&reason)) {
+    bool initialized = false;
+    {
+        SM_PROFILE_STAGE(profiling::RecoStage::kRkSeed);
+        initialized = analyzer.Initialize(&reason);
+    }
+    if (!initialized) {
         result.status = SolverStatus::kInvalidInput;
         result.message = reason;
         return result;
     }
 
     detail::RkSolveResult solve_result;
-    if (!analyzer.Solve(config.compute_uncertainty, config.compute_posterior_laplace, &solve_result)) {
+    bool solved = false;
+    {
+        SM_PROFILE_STAGE(profiling::RecoStage::kRkFit);
+        solved = analyzer.Solve(config.compute_uncertainty, config.compute_posterior_laplace, &solve_result);
+    }
+    if (!solved) {
         result.status = SolverStatus::kNotConverged;
         result.message = "RK two-point backprop evaluation failed";
         return result;
@@ -114,14 +125,24 @@ RecoResult PDCMomentumReconstructor::ReconstructRKThreePointFree(
 
     detail::RkLeastSquaresAnalyzer analyzer(fMagneticField, track, target, config);
     std::string reason;
-    if (!analyzer.Initialize(&reason)) {
+    bool initialized = false;
+    {
+        SM_PROFILE_STAGE(profiling::RecoStage::kRkSeed);
+        initialized = analyzer.Initialize(&reason);
+    }
+    if (!initialized) {
         result.status = SolverStatus::kInvalidInput;
         result.message = reason;
         return result;
     }
 
     detail::RkSolveResult solve_result;
-    if (!analyzer.Solve(config.compute_uncertainty, config.compute_posterior_laplace, &solve_result)) {
+    bool solved = false;
+    {
+        SM_PROFILE_STAGE(profiling::RecoStage::kRkFit);
+        solved = analyzer.Solve(config.compute_uncertainty, config.compute_posterior_laplace, &solve_result);
+    }
+    if (!solved) {
         result.status = SolverStatus::kNotConverged;
         result.message = "RK three-point free fit evaluation failed";
         return result;
@@ -141,14 +162,24 @@ RecoResult PDCMomentumReconstructor::ReconstructRKFixedTargetPdcOnly(
 
     detail::RkLeastSquaresAnalyzer analyzer(fMagneticField, track, target, config);
     std::string reason;
-    if (!analyzer.Initialize(&reason)) {
+    bool initialized = false;
+    {
+        SM_PROFILE_STAGE(profiling::RecoStage::kRkSeed);
+        initialized = analyzer.Initialize(&reason);
+    }
+    if (!initialized) {
         result.status = SolverStatus::kInvalidInput;
         result.message = reason;
         return result;
     }
 
     detail::RkSolveResult solve_result;
-    if (!analyzer.Solve(config.compute_uncertainty, config.compute_posterior_laplace, &solve_result)) {
+    bool solved = false;
+    {
+        SM_PROFILE_STAGE(profiling::RecoStage::kRkFit);
+        solved = analyzer.Solve(config.compute_uncertainty, config.compute_posterior_laplace, &solve_result);
+    }
+    if (!solved) {
         result.status = SolverStatus::kNotConverged;
         result.message = "initial RK evaluation failed";
         return result;
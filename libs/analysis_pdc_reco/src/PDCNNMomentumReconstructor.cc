@@ -4,7 +4,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #include <fstream>
+#include <iterator>
 #include <limits>
 #include <sstream>
 #include <string>
@@ -50,27 +52,46 @@ bool ParseFixedArray(const Json& root, const char* key, std::array<double, N>* o
     return true;
 }
 
+std::uint64_t Fnv1a(const std::string& bytes) {
+    std::uint64_t hash = 1469598103934665603ULL;
+    for (const char c : bytes) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
 }  // namespace
 
+std::string PDCNNMomentumReconstructor::ResolveModelPath(const RecoConfig& config) {
+    if (!config.nn_model_json_path.empty()) {
+        return config.nn_model_json_path;
+    }
+    const char* env_model = std::getenv("PDC_NN_MODEL_JSON");
+    return env_model ? std::string(env_model) : std::string();
+}
+
 bool PDCNNMomentumReconstructor::LoadModel(const std::string& json_path, std::string* reason) {
     fLoaded = false;
     fUseTargetNormalization = false;
     fLoadedPath.clear();
+    fContentFingerprint = 0;
     fLayers.clear();
     fYMean = {0.0, 0.0, 0.0};
     fYStd = {1.0, 1.0, 1.0};
 
-    std::ifstream fin(json_path);
+    std::ifstream fin(json_path, std::ios::binary);
     if (!fin.is_open()) {
         if (reason) {
             *reason = "failed to open model json: " + json_path;
         }
         return false;
     }
+    const std::string bytes((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
 
     Json root;
     try {
-        fin >> root;
+        root = Json::parse(bytes);
     } catch (const std::exception& ex) {
         if (reason) {
             *reason = std::string("failed to parse model json: ") + ex.what();
@@ -228,12 +249,14 @@ bool PDCNNMomentumReconstructor::LoadModel(const std::string& json_path, std::st
 
     fLoaded = true;
     fLoadedPath = json_path;
+    fContentFingerprint = Fnv1a(bytes);
     return true;
 }
 
 bool PDCNNMomentumReconstructor::Forward(
     const std::array<double, 6>& features,
     std::array<double, 3>* momentum,
+    PDCNNScratch* scratch,
     std::string* reason
 ) const {
     if (!fLoaded || fLayers.empty()) {
@@ -249,7 +272,11 @@ bool PDCNNMomentumReconstructor::Forward(
         return false;
     }
 
-    std::vector<double> activations(6, 0.0);
+    PDCNNScratch local_scratch;
+    PDCNNScratch& buffers = scratch ? *scratch : local_scratch;
+    std::vector<double>& activations = buffers.activations;
+    std::vector<double>& next = buffers.next;
+    activations.assign(features.size(), 0.0);
     for (std::size_t i = 0; i < features.size(); ++i) {
         const double x = (features[i] - fXMean[i]) / fXStd[i];
         if (!std::isfinite(x)) {
@@ -274,7 +301,7 @@ bool PDCNNMomentumReconstructor::Forward(
             return false;
         }
 
-        std::vector<double> next(static_cast<std::size_t>(layer.out_dim), 0.0);
+        next.assign(static_cast<std::size_t>(layer.out_dim), 0.0);
         for (int out = 0; out < layer.out_dim; ++out) {
             double sum = layer.bias[static_cast<std::size_t>(out)];
             const std::size_t row_offset = static_cast<std::size_t>(out * layer.in_dim);
@@ -328,6 +355,15 @@ RecoResult PDCNNMomentumReconstructor::Reconstruct(
     const PDCInputTrack& track,
     const TargetConstraint& target,
     const RecoConfig& config
+) const {
+    return Reconstruct(track, target, config, nullptr);
+}
+
+RecoResult PDCNNMomentumReconstructor::Reconstruct(
+    const PDCInputTrack& track,
+    const TargetConstraint& target,
+    const RecoConfig& config,
+    PDCNNScratch* scratch
 ) const {
     RecoResult result;
     result.method_used = SolveMethod::kNeuralNetwork;
@@ -367,19 +403,39 @@ RecoResult PDCNNMomentumReconstructor::Reconstruct(
 
     std::array<double, 3> pred{0.0, 0.0, 0.0};
     std::string reason;
-    if (!Forward(features, &pred, &reason)) {
+    if (!Forward(features, &pred, scratch, &reason)) {
         result.status = SolverStatus::kNotConverged;
         result.message = reason;
         return result;
     }
 
-    TVector3 momentum(pred[0], pred[1], pred[2]);
-    double p_mag = momentum.Mag();
-    if (!std::isfinite(p_mag) || p_mag <= 0.0) {
+    if (!FinishPrediction(pred, target, config, &result.p4_at_target, &result.brho_tm, &reason)) {
         result.status = SolverStatus::kNotConverged;
-        result.message = "NN predicted invalid momentum magnitude";
+        result.message = reason;
         return result;
     }
+    result.status = SolverStatus::kSuccess;
+    result.message = "NN inference solved target momentum";
+    return result;
+}
+
+
+bool PDCNNMomentumReconstructor::FinishPrediction(
+    const std::array<double, 3>& prediction,
+    const TargetConstraint& target,
+    const RecoConfig& config,
+    TLorentzVector* p4,
+    double* brho_tm,
+    std::string* reason
+) {
+    TVector3 momentum(prediction[0], prediction[1], prediction[2]);
+    double p_mag = momentum.Mag();
+    if (!std::isfinite(p_mag) || p_mag <= 0.0) {
+        if (reason) {
+            *reason = "NN predicted invalid momentum magnitude";
+        }
+        return false;
+    }
 
     if (std::isfinite(config.p_min_mevc) && std::isfinite(config.p_max_mevc) &&
         config.p_min_mevc > 0.0 && config.p_max_mevc > config.p_min_mevc &&
@@ -392,20 +448,110 @@ RecoResult PDCNNMomentumReconstructor::Reconstruct(
     const double mass = (std::isfinite(target.mass_mev) && target.mass_mev > 0.0) ? target.mass_mev : kDefaultMassMeV;
     const double energy = std::sqrt(momentum.Mag2() + mass * mass);
     if (!std::isfinite(energy)) {
-        result.status = SolverStatus::kNotConverged;
-        result.message = "failed to build on-shell energy from NN momentum";
-        return result;
+        if (reason) {
+            *reason = "failed to build on-shell energy from NN momentum";
+        }
+        return false;
     }
 
-    result.p4_at_target.SetPxPyPzE(momentum.X(), momentum.Y(), momentum.Z(), energy);
-    if (std::isfinite(target.charge_e) && std::abs(target.charge_e) > 1.0e-12) {
-        result.brho_tm = (p_mag / 1000.0) / (kBrhoGeVOverCPerTm * std::abs(target.charge_e));
-    } else {
-        result.brho_tm = std::numeric_limits<double>::quiet_NaN();
+    if (p4) {
+        p4->SetPxPyPzE(momentum.X(), momentum.Y(), momentum.Z(), energy);
+    }
+    if (brho_tm) {
+        if (std::isfinite(target.charge_e) && std::abs(target.charge_e) > 1.0e-12) {
+            *brho_tm = (p_mag / 1000.0) / (kBrhoGeVOverCPerTm * std::abs(target.charge_e));
+        } else {
+            *brho_tm = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+    return true;
+}
+
+void PDCNNMomentumReconstructor::PredictBatch(
+    const double* features,
+    std::size_t count,
+    double* momenta,
+    unsigned char* ok,
+    PDCNNScratch* scratch
+) const {
+    if (count == 0 || !ok) {
+        return;
+    }
+    bool model_ok = fLoaded && !fLayers.empty() && features && momenta;
+    int dim = 6;
+    for (const DenseLayer& layer : fLayers) {
+        model_ok = model_ok && layer.in_dim == dim;
+        dim = layer.out_dim;
+    }
+    if (!model_ok || dim != 3) {
+        std::fill(ok, ok + count, static_cast<unsigned char>(0));
+        return;
+    }
+
+    PDCNNScratch local_scratch;
+    PDCNNScratch& buffers = scratch ? *scratch : local_scratch;
+    std::vector<double>& activations = buffers.activations;
+    std::vector<double>& next = buffers.next;
+
+    for (std::size_t begin = 0; begin < count; begin += kBatchBlock) {
+        const std::size_t n = std::min(kBatchBlock, count - begin);
+        unsigned char* block_ok = ok + begin;
+        std::fill(block_ok, block_ok + n, static_cast<unsigned char>(1));
+
+        // [EN] Block layout is activations[neuron * n + track]: the innermost loop walks tracks contiguously (and
+        // vectorizes) while accumulating in the same order as Forward(). / [CN] 块内布局为 activations[神经元 * n + 径迹]：
+        // 最内层循环连续遍历径迹（可向量化），累加顺序与 Forward() 相同。
+        activations.assign(6 * n, 0.0);
+        for (std::size_t i = 0; i < 6; ++i) {
+            for (std::size_t t = 0; t < n; ++t) {
+                const double x = (features[(begin + t) * 6 + i] - fXMean[i]) / fXStd[i];
+                if (std::isfinite(x)) {
+                    activations[i * n + t] = x;
+                } else {
+                    block_ok[t] = 0;
+                }
+            }
+        }
+
+        for (std::size_t layer_idx = 0; layer_idx < fLayers.size(); ++layer_idx) {
+            const DenseLayer& layer = fLayers[layer_idx];
+            const bool hidden = layer_idx + 1 < fLayers.size();
+            next.assign(static_cast<std::size_t>(layer.out_dim) * n, 0.0);
+            for (int out = 0; out < layer.out_dim; ++out) {
+                double* row = next.data() + static_cast<std::size_t>(out) * n;
+                std::fill(row, row + n, layer.bias[static_cast<std::size_t>(out)]);
+                const std::size_t row_offset = static_cast<std::size_t>(out * layer.in_dim);
+                for (int in = 0; in < layer.in_dim; ++in) {
+                    const double weight = layer.weights[row_offset + static_cast<std::size_t>(in)];
+                    const double* input = activations.data() + static_cast<std::size_t>(in) * n;
+                    for (std::size_t t = 0; t < n; ++t) {
+                        row[t] += weight * input[t];
+                    }
+                }
+                for (std::size_t t = 0; t < n; ++t) {
+                    if (!std::isfinite(row[t])) {
+                        block_ok[t] = 0;
+                    } else if (hidden && row[t] < 0.0) {
+                        row[t] = 0.0;
+                    }
+                }
+            }
+            activations.swap(next);
+        }
+
+        for (std::size_t i = 0; i < 3; ++i) {
+            for (std::size_t t = 0; t < n; ++t) {
+                double value = activations[i * n + t];
+                if (fUseTargetNormalization) {
+                    value = value * fYStd[i] + fYMean[i];
+                }
+                if (!std::isfinite(value)) {
+                    block_ok[t] = 0;
+                }
+                momenta[(begin + t) * 3 + i] = value;
+            }
+        }
     }
-    result.status = SolverStatus::kSuccess;
-    result.message = "NN inference solved target momentum";
-    return result;
 }
 
 }  // namespace analysis::pdc::anaroot_like
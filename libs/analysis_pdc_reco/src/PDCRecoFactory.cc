@@ -2,6 +2,7 @@
 
 #include <cstdlib>
 #include <string>
+#include <utility>
 
 namespace analysis::pdc::anaroot_like {
 
@@ -9,6 +10,29 @@ std::unique_ptr<PDCMomentumReconstructor> PDCRecoFactory::CreateDefault(Magnetic
     return std::make_unique<PDCMomentumReconstructor>(magnetic_field);
 }
 
+std::shared_ptr<const PDCRecoSharedState> PDCRecoFactory::CreateSharedState(const MagneticField* magnetic_field,
+                                                                             const TargetConstraint& target,
+                                                                             const RecoConfig& config,
+                                                                             std::string* reason) {
+    auto state = std::make_shared<PDCRecoSharedState>();
+    state->magnetic_field = magnetic_field;
+    state->target = target;
+    state->config = config;
+
+    if (config.enable_nn) {
+        const std::string model_path = PDCNNMomentumReconstructor::ResolveModelPath(config);
+        if (!model_path.empty()) {
+            auto nn = std::make_shared<PDCNNMomentumReconstructor>();
+            if (!nn->LoadModel(model_path, reason)) {
+                return nullptr;
+            }
+            state->nn_model = std::move(nn);
+            state->nn_model_path = model_path;
+        }
+    }
+    return state;
+}
+
 bool PDCRecoFactory::UseAnarootLikeByDefault() {
     const char* backend = std::getenv("PDC_RECO_BACKEND");
     if (!backend) {
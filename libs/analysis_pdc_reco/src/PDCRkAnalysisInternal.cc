@@ -1,6 +1,7 @@
 #include "PDCRkAnalysisInternal.hh"
 
 #include "ParticleTrajectory.hh"
+#include "RecoProfiler.hh"
 
 #include "TDecompSVD.h"
 #include "TMatrixDSym.h"
@@ -222,7 +223,7 @@ IntervalEstimate BuildGaussianInterval(double center, double sigma) {
     return estimate;
 }
 
-RkLeastSquaresAnalyzer::RkLeastSquaresAnalyzer(MagneticField* magnetic_field,
+RkLeastSquaresAnalyzer::RkLeastSquaresAnalyzer(const MagneticField* magnetic_field,
                                                const PDCInputTrack& track,
                                                const TargetConstraint& target,
                                                const RecoConfig& config)
@@ -1145,6 +1146,7 @@ bool RkLeastSquaresAnalyzer::SolveImpl(const RkParameterState& raw_initial_state
     result->accepted_iterations = accepted_iterations;
 
     if (compute_uncertainty) {
+        SM_PROFILE_STAGE(profiling::RecoStage::kRkUncertainty);
         TMatrixD jacobian(fLayout.residual_count, fLayout.parameter_count);
         if (BuildResidualJacobian(state, current, &jacobian)) {
             const TMatrixD normal = BuildNormalMatrix(jacobian);
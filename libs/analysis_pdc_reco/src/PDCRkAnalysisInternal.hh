@@ -106,7 +106,7 @@ struct RkSolveResult {
 
 class RkLeastSquaresAnalyzer {
 public:
-    RkLeastSquaresAnalyzer(MagneticField* magnetic_field,
+    RkLeastSquaresAnalyzer(const MagneticField* magnetic_field,
                            const PDCInputTrack& track,
                            const TargetConstraint& target,
                            const RecoConfig& config);
@@ -183,7 +183,7 @@ private:
                    bool compute_posterior_laplace,
                    RkSolveResult* result) const;
 
-    MagneticField* fMagneticField = nullptr;
+    const MagneticField* fMagneticField = nullptr;
     PDCInputTrack fTrack;
     TargetConstraint fTarget;
     RecoConfig fConfig;
@@ -0,0 +1,390 @@
+// [EN] Python module `smsim_reco`: numpy-level access to field queries, trajectory propagation and batch PDC
+// momentum reconstruction. Inputs are accepted as float64 C-contiguous arrays and read in place (anything else is
+// converted once by numpy); results are written straight into freshly allocated numpy arrays. Every heavy loop
+// runs with the GIL released.
+// [CN] Python 模块 smsim_reco：在 numpy 层面调用磁场查询、径迹传播与批量 PDC 动量重建。float64 C 连续数组原地读取
+// （其他布局由 numpy 转换一次），结果直接写入新分配的 numpy 数组。所有重循环都释放 GIL。
+
+#include "GeometryManager.hh"
+#include "MagneticField.hh"
+#include "PDCMomentumReconstructor.hh"
+#include "PDCRecoFactory.hh"
+#include "PDCRecoRuntime.hh"
+#include "ParticleTrajectory.hh"
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace py = pybind11;
+namespace reco = analysis::pdc::anaroot_like;
+
+namespace {
+
+using DoubleArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+void RequireRows3(const DoubleArray& array, const char* name) {
+    if (array.ndim() != 2 || array.shape(1) != 3) {
+        throw py::value_error(std::string(name) + " must have shape (N, 3)");
+    }
+}
+
+const double* Column(const DoubleArray& array, py::ssize_t size, const char* name) {
+    if (array.ndim() != 1 || array.shape(0) != size) {
+        throw py::value_error(std::string(name) + " must be a 1-D array of length " + std::to_string(size));
+    }
+    return array.data();
+}
+
+std::shared_ptr<MagneticField> LoadField(const std::string& path, double rotation_deg) {
+    auto field = std::make_shared<MagneticField>();
+    if (!reco::LoadMagneticField(*field, path, rotation_deg)) {
+        throw std::runtime_error("failed to load magnetic field map: " + path);
+    }
+    return field;
+}
+
+DoubleArray FieldAt(const MagneticField& field, const DoubleArray& positions) {
+    RequireRows3(positions, "positions");
+    const py::ssize_t n = positions.shape(0);
+    DoubleArray out({n, py::ssize_t{3}});
+    const double* in = positions.data();
+    double* b = out.mutable_data();
+    {
+        py::gil_scoped_release release;
+        for (py::ssize_t i = 0; i < n; ++i) {
+            const TVector3 value = field.GetField(in[3 * i], in[3 * i + 1], in[3 * i + 2]);
+            b[3 * i] = value.X();
+            b[3 * i + 1] = value.Y();
+            b[3 * i + 2] = value.Z();
+        }
+    }
+    return out;
+}
+
+// [EN] Trajectories have data-dependent length, so all tracks are returned as one flat point list plus offsets:
+// points of track i are rows [offsets[i], offsets[i+1]). / [CN] 径迹长度随数据变化，因此所有径迹合并为一个扁平点表加偏移：
+// 第 i 条径迹的点为 [offsets[i], offsets[i+1]) 行。
+py::dict Propagate(const MagneticField& field,
+                   const DoubleArray& positions,
+                   const DoubleArray& momenta,
+                   double charge_e,
+                   double mass_mev,
+                   double step_mm,
+                   double max_distance_mm,
+                   double max_time_ns,
+                   double min_momentum_mevc) {
+    RequireRows3(positions, "positions");
+    RequireRows3(momenta, "momenta");
+    if (positions.shape(0) != momenta.shape(0)) {
+        throw py::value_error("positions and momenta must have the same number of rows");
+    }
+    const py::ssize_t n = positions.shape(0);
+    const double* pos = positions.data();
+    const double* mom = momenta.data();
+
+    std::vector<std::vector<ParticleTrajectory::TrajectoryPoint>> tracks(static_cast<std::size_t>(n));
+    {
+        py::gil_scoped_release release;
+        ParticleTrajectory tracer(&field);
+        tracer.SetStepSize(step_mm);
+        tracer.SetMaxDistance(max_distance_mm);
+        tracer.SetMaxTime(max_time_ns);
+        tracer.SetMinMomentum(min_momentum_mevc);
+        for (py::ssize_t i = 0; i < n; ++i) {
+            const TVector3 p(mom[3 * i], mom[3 * i + 1], mom[3 * i + 2]);
+            const TLorentzVector p4(p, std::sqrt(p.Mag2() + mass_mev * mass_mev));
+            tracks[static_cast<std::size_t>(i)] = tracer.CalculateTrajectory(
+                TVector3(pos[3 * i], pos[3 * i + 1], pos[3 * i + 2]), p4, charge_e, mass_mev);
+        }
+    }
+
+    py::array_t<std::int64_t> offsets(n + 1);
+    std::int64_t* offset = offsets.mutable_data();
+    offset[0] = 0;
+    for (py::ssize_t i = 0; i < n; ++i) {
+        offset[i + 1] = offset[i] + static_cast<std::int64_t>(tracks[static_cast<std::size_t>(i)].size());
+    }
+    const py::ssize_t total = static_cast<py::ssize_t>(offset[n]);
+    DoubleArray out_position({total, py::ssize_t{3}});
+    DoubleArray out_momentum({total, py::ssize_t{3}});
+    DoubleArray out_time(total);
+    double* xp = out_position.mutable_data();
+    double* xm = out_momentum.mutable_data();
+    double* xt = out_time.mutable_data();
+    std::size_t row = 0;
+    for (const auto& track : tracks) {
+        for (const auto& point : track) {
+            xp[3 * row] = point.position.X();
+            xp[3 * row + 1] = point.position.Y();
+            xp[3 * row + 2] = point.position.Z();
+            xm[3 * row] = point.momentum.X();
+            xm[3 * row + 1] = point.momentum.Y();
+            xm[3 * row + 2] = point.momentum.Z();
+            xt[row] = point.time;
+            ++row;
+        }
+    }
+
+    py::dict result;
+    result["position"] = out_position;
+    result["momentum"] = out_momentum;
+    result["time"] = out_time;
+    result["offsets"] = offsets;
+    return result;
+}
+
+// [EN] The Python side keeps the field alive (keep_alive) for as long as this object reads it.
+// [CN] Python 端通过 keep_alive 保证磁场在本对象使用期间存活。
+class PyPDCReconstructor {
+public:
+    PyPDCReconstructor(const MagneticField* field,
+                       const std::string& backend,
+                       const std::string& nn_model,
+                       const std::string& geometry_macro,
+                       std::optional<std::vector<double>> target_position,
+                       const std::string& rk_fit_mode,
+                       double pdc_sigma_u_mm,
+                       double pdc_sigma_v_mm,
+                       double target_sigma_xy_mm,
+                       bool compute_uncertainty)
+        : fField(field) {
+        reco::RuntimeOptions options;
+        options.backend = reco::ParseRuntimeBackend(backend);
+        options.nn_model_json_path = nn_model;
+        options.rk_fit_mode = reco::ParseRkFitMode(rk_fit_mode);
+        options.pdc_sigma_u_mm = pdc_sigma_u_mm;
+        options.pdc_sigma_v_mm = pdc_sigma_v_mm;
+        options.target_sigma_xy_mm = target_sigma_xy_mm;
+        options.compute_uncertainty = compute_uncertainty;
+        options.compute_posterior_laplace = compute_uncertainty;
+        if (fField) {
+            options.magnetic_field_rotation_deg = fField->GetRotationAngle();
+        }
+
+        GeometryManager geometry;
+        if (!geometry_macro.empty() && !reco::LoadGeometryFromMacro(geometry, geometry_macro)) {
+            throw std::runtime_error("failed to load geometry macro: " + geometry_macro);
+        }
+        reco::TargetConstraint target = reco::BuildTargetConstraint(geometry, options);
+        if (target_position) {
+            if (target_position->size() != 3) {
+                throw py::value_error("target_position must have 3 components");
+            }
+            target.target_position.SetXYZ((*target_position)[0], (*target_position)[1], (*target_position)[2]);
+        }
+
+        std::string reason;
+        auto shared = reco::PDCRecoFactory::CreateSharedState(
+            fField, target, reco::BuildRecoConfig(options, fField != nullptr), &reason);
+        if (!shared) {
+            throw std::runtime_error("failed to prepare PDC reconstruction: " + reason);
+        }
+        fReconstructor = std::make_unique<reco::PDCMomentumReconstructor>(std::move(shared));
+    }
+
+    py::dict ReconstructBatch(const DoubleArray& pdc1_x,
+                              const DoubleArray& pdc1_y,
+                              const DoubleArray& pdc1_z,
+                              const DoubleArray& pdc2_x,
+                              const DoubleArray& pdc2_y,
+                              const DoubleArray& pdc2_z,
+                              std::optional<DoubleArray> sigma_u_mm,
+                              std::optional<DoubleArray> sigma_v_mm,
+                              bool covariance,
+                              int threads) const {
+        const py::ssize_t n = pdc1_x.ndim() == 1 ? pdc1_x.shape(0) : -1;
+        if (n < 0) {
+            throw py::value_error("pdc1_x must be a 1-D array");
+        }
+        reco::PDCBatchInput input;
+        input.size = static_cast<std::size_t>(n);
+        input.pdc1_x = Column(pdc1_x, n, "pdc1_x");
+        input.pdc1_y = Column(pdc1_y, n, "pdc1_y");
+        input.pdc1_z = Column(pdc1_z, n, "pdc1_z");
+        input.pdc2_x = Column(pdc2_x, n, "pdc2_x");
+        input.pdc2_y = Column(pdc2_y, n, "pdc2_y");
+        input.pdc2_z = Column(pdc2_z, n, "pdc2_z");
+        if (sigma_u_mm) {
+            input.pdc_sigma_u_mm = Column(*sigma_u_mm, n, "sigma_u_mm");
+        }
+        if (sigma_v_mm) {
+            input.pdc_sigma_v_mm = Column(*sigma_v_mm, n, "sigma_v_mm");
+        }
+
+        py::array_t<int> status(n);
+        py::array_t<int> method(n);
+        DoubleArray out_px(n);
+        DoubleArray out_py(n);
+        DoubleArray out_pz(n);
+        DoubleArray energy(n);
+        DoubleArray brho(n);
+        DoubleArray chi2_reduced(n);
+        py::array_t<int> iterations(n);
+        DoubleArray cov = covariance ? DoubleArray({n, py::ssize_t{3}, py::ssize_t{3}}) : DoubleArray();
+
+        reco::PDCBatchOutput output;
+        output.status = status.mutable_data();
+        output.method = method.mutable_data();
+        output.px = out_px.mutable_data();
+        output.py = out_py.mutable_data();
+        output.pz = out_pz.mutable_data();
+        output.energy = energy.mutable_data();
+        output.brho_tm = brho.mutable_data();
+        output.chi2_reduced = chi2_reduced.mutable_data();
+        output.iterations = iterations.mutable_data();
+        output.momentum_covariance = covariance ? cov.mutable_data() : nullptr;
+
+        {
+            py::gil_scoped_release release;
+            RunSlices(input, output, threads);
+        }
+
+        py::dict result;
+        result["status"] = status;
+        result["method"] = method;
+        result["px"] = out_px;
+        result["py"] = out_py;
+        result["pz"] = out_pz;
+        result["energy"] = energy;
+        result["brho_tm"] = brho;
+        result["chi2_reduced"] = chi2_reduced;
+        result["iterations"] = iterations;
+        if (covariance) {
+            result["momentum_covariance"] = cov;
+        }
+        return result;
+    }
+
+private:
+    // [EN] Contiguous slices, one workspace per worker; the reconstructor itself is immutable and shared.
+    // [CN] 按连续区间切分，每个线程一个 workspace；重建器本身不可变、共享使用。
+    void RunSlices(const reco::PDCBatchInput& input, const reco::PDCBatchOutput& output, int threads) const {
+        // [EN] No point splitting below one NN inference block per worker. / [CN] 每线程不足一个 NN 推理块时不再切分。
+        const std::size_t blocks = input.size / reco::PDCNNMomentumReconstructor::kBatchBlock + 1;
+        const std::size_t workers = std::min(static_cast<std::size_t>(std::max(threads, 1)), blocks);
+        const auto run = [&](std::size_t begin, std::size_t end) {
+            const auto shift = [begin](auto* column, std::size_t stride = 1) {
+                return column ? column + begin * stride : column;
+            };
+            reco::PDCBatchInput slice = input;
+            slice.size = end - begin;
+            slice.pdc1_x = shift(input.pdc1_x);
+            slice.pdc1_y = shift(input.pdc1_y);
+            slice.pdc1_z = shift(input.pdc1_z);
+            slice.pdc2_x = shift(input.pdc2_x);
+            slice.pdc2_y = shift(input.pdc2_y);
+            slice.pdc2_z = shift(input.pdc2_z);
+            slice.pdc_sigma_u_mm = shift(input.pdc_sigma_u_mm);
+            slice.pdc_sigma_v_mm = shift(input.pdc_sigma_v_mm);
+            reco::PDCBatchOutput out = output;
+            out.status = shift(output.status);
+            out.method = shift(output.method);
+            out.px = shift(output.px);
+            out.py = shift(output.py);
+            out.pz = shift(output.pz);
+            out.energy = shift(output.energy);
+            out.brho_tm = shift(output.brho_tm);
+            out.chi2_reduced = shift(output.chi2_reduced);
+            out.iterations = shift(output.iterations);
+            out.momentum_covariance = shift(output.momentum_covariance, 9);
+            reco::PDCRecoWorkspace workspace;
+            std::string reason;
+            if (!fReconstructor->ReconstructBatch(slice, out, &workspace, &reason)) {
+                throw std::runtime_error("batch reconstruction failed: " + reason);
+            }
+        };
+
+        if (workers == 1) {
+            run(0, input.size);
+            return;
+        }
+        // [EN] An exception must not escape a std::thread (std::terminate); each worker parks its own and the
+        // first one is rethrown after every worker has joined, so pybind11 turns it into a Python exception.
+        // [CN] 异常不能逃出 std::thread（会 std::terminate）；每个线程保存自己的异常，全部 join 后重新抛出第一个，
+        // 由 pybind11 转为 Python 异常。
+        const std::size_t chunk = (input.size + workers - 1) / workers;
+        const std::size_t slices = (input.size + chunk - 1) / chunk;
+        std::vector<std::exception_ptr> errors(slices);
+        std::vector<std::thread> pool;
+        pool.reserve(slices);
+        for (std::size_t k = 0; k < slices; ++k) {
+            const std::size_t begin = k * chunk;
+            pool.emplace_back([&run, &error = errors[k], begin, end = std::min(input.size, begin + chunk)] {
+                try {
+                    run(begin, end);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            });
+        }
+        for (auto& worker : pool) {
+            worker.join();
+        }
+        for (const std::exception_ptr& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    const MagneticField* fField = nullptr;
+    std::unique_ptr<reco::PDCMomentumReconstructor> fReconstructor;
+};
+
+}  // namespace
+
+PYBIND11_MODULE(smsim_reco, m) {
+    m.doc() = "SMSimulator field queries, trajectory propagation and batch PDC momentum reconstruction";
+
+    py::class_<MagneticField, std::shared_ptr<MagneticField>>(m, "MagneticField")
+        .def(py::init(&LoadField), py::arg("path"), py::arg("rotation_deg") = 30.0,
+             "Load a field map (.root or text table) rotated by rotation_deg around -Y.")
+        .def("field", &FieldAt, py::arg("positions"),
+             "B field [T] at lab positions [mm]; (N, 3) -> (N, 3).")
+        .def_property_readonly("rotation_deg", &MagneticField::GetRotationAngle);
+
+    m.def("propagate", &Propagate, py::arg("field"), py::arg("positions"), py::arg("momenta"),
+          py::arg("charge_e") = 1.0, py::arg("mass_mev") = 938.2720813, py::arg("step_mm") = 5.0,
+          py::arg("max_distance_mm") = 5000.0, py::arg("max_time_ns") = 100.0, py::arg("min_momentum_mevc") = 1.0,
+          "RK4 trajectories from (N, 3) start positions [mm] and momenta [MeV/c]; returns flat "
+          "position/momentum/time arrays and int64 offsets of length N + 1.");
+
+    py::class_<PyPDCReconstructor>(m, "PDCReconstructor")
+        .def(py::init<const MagneticField*, const std::string&, const std::string&, const std::string&,
+                      std::optional<std::vector<double>>, const std::string&, double, double, double, bool>(),
+             py::arg("field") = nullptr, py::arg("backend") = "auto", py::arg("nn_model") = "",
+             py::arg("geometry_macro") = "", py::arg("target_position") = py::none(),
+             py::arg("rk_fit_mode") = "three-point-free", py::arg("pdc_sigma_u_mm") = 2.0,
+             py::arg("pdc_sigma_v_mm") = 2.0, py::arg("target_sigma_xy_mm") = 5.0,
+             py::arg("compute_uncertainty") = false, py::keep_alive<1, 2>())
+        .def("reconstruct_batch", &PyPDCReconstructor::ReconstructBatch, py::arg("pdc1_x"), py::arg("pdc1_y"),
+             py::arg("pdc1_z"), py::arg("pdc2_x"), py::arg("pdc2_y"), py::arg("pdc2_z"),
+             py::arg("sigma_u_mm") = py::none(), py::arg("sigma_v_mm") = py::none(), py::arg("covariance") = false,
+             py::arg("threads") = 1,
+             "Reconstruct target momenta from SoA PDC columns [mm]; returns a dict of numpy columns "
+             "(status, method, px, py, pz, energy, brho_tm, chi2_reduced, iterations[, momentum_covariance]).");
+
+    py::enum_<reco::SolverStatus>(m, "SolverStatus")
+        .value("kSuccess", reco::SolverStatus::kSuccess)
+        .value("kNotConverged", reco::SolverStatus::kNotConverged)
+        .value("kInvalidInput", reco::SolverStatus::kInvalidInput)
+        .value("kNotAvailable", reco::SolverStatus::kNotAvailable);
+
+    py::enum_<reco::SolveMethod>(m, "SolveMethod")
+        .value("kAutoChain", reco::SolveMethod::kAutoChain)
+        .value("kNeuralNetwork", reco::SolveMethod::kNeuralNetwork)
+        .value("kRungeKutta", reco::SolveMethod::kRungeKutta)
+        .value("kMultiDimFit", reco::SolveMethod::kMultiDimFit);
+}
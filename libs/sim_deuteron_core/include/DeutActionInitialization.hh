@@ -0,0 +1,32 @@
+#ifndef DEUTACTIONINITIALIZATION_HH
+#define DEUTACTIONINITIALIZATION_HH
+
+#include "G4VUserActionInitialization.hh"
+
+class DeutPrimaryGeneratorAction;
+
+// [EN] User actions of sim_deuteron. Build() runs once per worker thread (or once in sequential mode)
+//      and registers that thread's SimDataManager initializers/converters; BuildForMaster() sets up the
+//      master, which owns the run parameters and merges the per-thread output files at end of run.
+// [CN] sim_deuteron 的用户动作。Build() 在每个 worker 线程（单线程模式下一次）调用，为该线程的
+//      SimDataManager 注册初始化器/转换器；BuildForMaster() 配置 master，master 持有运行参数，
+//      并在运行结束时合并各线程的输出文件。
+class DeutActionInitialization : public G4VUserActionInitialization
+{
+public:
+  DeutActionInitialization();
+  virtual ~DeutActionInitialization();
+
+  void Build() const override;
+  void BuildForMaster() const override;
+
+private:
+  static void RegistSimData();
+
+  // [EN] Not registered with the master run manager; only keeps the /action/gun commands
+  //      (input file, tree/beamOn) available on the master.
+  // [CN] 不注册到 master 运行管理器；仅保证 /action/gun 命令（输入文件、tree/beamOn）在 master 上可用。
+  mutable DeutPrimaryGeneratorAction* fMasterPrimaryGeneratorAction;
+};
+
+#endif
@@ -48,6 +48,7 @@ public:
   { fModularPhysicsList = phyList; }
 
   G4VPhysicalVolume* Construct() override;
+  void ConstructSDandField() override;
 
   void SetFillAir(G4bool tf){fFillAir = tf;}
 
@@ -89,19 +90,16 @@ private:
   G4double      fDumpAngle;   // angle (clockwise) in rad
   G4ThreeVector fDumpPos;     // position at rotated coordinate in mm
 
-  G4VSensitiveDetector* fTargetSD = 0; // reserved for track reconstruction
-  G4VSensitiveDetector* fPDCSD_U = 0;
-  G4VSensitiveDetector* fPDCSD_X = 0;
-  G4VSensitiveDetector* fPDCSD_V = 0;
-  G4VSensitiveDetector* fNEBULASD = 0;
-  G4VSensitiveDetector* fNEBULAPlusSD = 0;
-  G4VSensitiveDetector* fIPSSD = 0;
+  // [EN] What Construct() placed, so ConstructSDandField() can attach each thread's sensitive detectors.
+  // [CN] Construct() 放置了哪些体积，供 ConstructSDandField() 为每个线程挂载敏感探测器。
+  G4LogicalVolume* fTargetSDLogical = 0;
+  G4bool fIPSPlaced = false;
+  G4bool fNEBULAPlaced = false;
+  G4bool fNEBULAPlusPlaced = false;
 
   ExitWindowNConstruction *fExitWindowNConstruction;  
-  G4VSensitiveDetector* fNeutronWinSD;
 
   ExitWindowC2Construction *fExitWindowC2Construction;  
-  G4VSensitiveDetector* fWindowHoleSD;
 
   VacuumDownstreamConstruction *fVacuumDownstreamConstruction;
 
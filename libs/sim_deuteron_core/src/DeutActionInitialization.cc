@@ -0,0 +1,68 @@
+#include "DeutActionInitialization.hh"
+#include "DeutPrimaryGeneratorAction.hh"
+
+#include "RunActionBasic.hh"
+#include "EventActionBasic.hh"
+#include "TrackingActionBasic.hh"
+
+#include "SimDataManager.hh"
+#include "BeamSimDataInitializer.hh"
+#include "FragSimDataInitializer.hh"
+#include "NEBULASimDataInitializer.hh"
+#include "NEBULAPlusSimDataInitializer.hh"
+#include "SimModuleDataInitializer.hh"
+
+#include "NEBULASimDataConverter_TArtNEBULAPla.hh"
+#include "NEBULAPlusSimDataConverter_TArtNEBULAPlusPla.hh"
+#include "FragSimDataConverter_Basic.hh"
+#include "EventTruthConverter.hh"
+
+//____________________________________________________________________
+DeutActionInitialization::DeutActionInitialization()
+  : G4VUserActionInitialization(), fMasterPrimaryGeneratorAction(0)
+{}
+//____________________________________________________________________
+DeutActionInitialization::~DeutActionInitialization()
+{
+  delete fMasterPrimaryGeneratorAction;
+}
+//____________________________________________________________________
+void DeutActionInitialization::RegistSimData()
+{
+  SimDataManager* simDataManager = SimDataManager::GetSimDataManager();
+  simDataManager->RegistInitializer(new BeamSimDataInitializer);
+  simDataManager->RegistInitializer(new FragSimDataInitializer);
+  simDataManager->RegistInitializer(new NEBULASimDataInitializer);
+  simDataManager->RegistInitializer(new NEBULAPlusSimDataInitializer);
+  simDataManager->RegistInitializer(new SimModuleDataInitializer("NEBULAModuleDataInitializer","NEBULA"));
+  simDataManager->RegistInitializer(new SimModuleDataInitializer("NEBULAPlusModuleDataInitializer","NEBULAPlus"));
+  simDataManager->RegistConverter(new FragSimDataConverter_Basic);
+  simDataManager->RegistConverter(new NEBULASimDataConverter_TArtNEBULAPla);
+  simDataManager->RegistConverter(new NEBULAPlusSimDataConverter_TArtNEBULAPlusPla);
+  simDataManager->RegistConverter(new EventTruthConverter);
+}
+//____________________________________________________________________
+void DeutActionInitialization::BuildForMaster() const
+{
+  RegistSimData();
+  SetUserAction(new RunActionBasic);
+
+  if (fMasterPrimaryGeneratorAction==0)
+    fMasterPrimaryGeneratorAction = new DeutPrimaryGeneratorAction;
+}
+//____________________________________________________________________
+void DeutActionInitialization::Build() const
+{
+  RegistSimData();
+
+  SetUserAction(new TrackingActionBasic);
+  SetUserAction(new RunActionBasic);
+
+  auto userPrimaryGeneratorAction = new DeutPrimaryGeneratorAction;
+  // Put the primary generator at the position and orientation of the target
+  userPrimaryGeneratorAction->SetUseTargetParameters(true);
+  SetUserAction(userPrimaryGeneratorAction);
+
+  SetUserAction(new EventActionBasic);
+}
+//____________________________________________________________________
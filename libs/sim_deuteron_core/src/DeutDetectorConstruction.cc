@@ -44,6 +44,8 @@
 #include "G4LogicalVolumeStore.hh"
 #include "G4SolidStore.hh"
 #include "G4RunManager.hh"
+#include "G4Threading.hh"
+#include "G4UImanager.hh"
 #include "G4VisAttributes.hh"
 #include "G4Colour.hh"
 
@@ -74,9 +76,7 @@ DeutDetectorConstruction::DeutDetectorConstruction()
   fNEBULAPlusConstruction = new NEBULAPlusConstruction();
   fIPSConstruction        = new IPSConstruction();
   fExitWindowNConstruction = new ExitWindowNConstruction();
-  fNeutronWinSD = 0;
   fExitWindowC2Construction = new ExitWindowC2Construction();
-  fWindowHoleSD = 0;
   fVacuumDownstreamConstruction = new VacuumDownstreamConstruction();
   fVacuumUpstreamConstruction = new VacuumUpstreamConstruction();
 }
@@ -103,6 +103,10 @@ G4VPhysicalVolume* DeutDetectorConstruction::Construct()
   G4PhysicalVolumeStore::GetInstance()->Clean();
   G4LogicalVolumeStore::GetInstance()->Clean();
   G4SolidStore::GetInstance()->Clean();
+  fTargetSDLogical = 0;
+  fIPSPlaced = false;
+  fNEBULAPlaced = false;
+  fNEBULAPlusPlaced = false;
 
   // Material List
   const auto nist = G4NistManager::Instance();
@@ -161,8 +165,6 @@ G4VPhysicalVolume* DeutDetectorConstruction::Construct()
 
   G4VPhysicalVolume* Dipole_phys = fDipoleConstruction->PutSAMURAIMagnet(expHall_log);  // 保存返回值
 
-  G4SDManager *SDMan = G4SDManager::GetSDMpointer();
-
   // prepare parameter for target and PDC positions
   auto *simDataManager = SimDataManager::GetSimDataManager();
   auto *frag_prm = (TFragSimParameter*)simDataManager \
@@ -177,11 +179,6 @@ G4VPhysicalVolume* DeutDetectorConstruction::Construct()
   fExitWindowNConstruction->ConstructSub();
   fExitWindowNConstruction->SetAngle(magAngle);
   fExitWindowNConstruction->PutExitWindow(expHall_log);
-  if (fNeutronWinSD==0){
-    fNeutronWinSD = new FragmentSD("/NeutronWindow");
-    SDMan->AddNewDetector(fNeutronWinSD);
-  }
-  fExitWindowNConstruction->GetWindowVolume()->SetSensitiveDetector(fNeutronWinSD);
 
 
   //-----exit window for charged particles
@@ -195,12 +192,6 @@ G4VPhysicalVolume* DeutDetectorConstruction::Construct()
   G4double windowAngle = -magAngle - 29.91*deg;  // 保存角度供后续使用
   fExitWindowC2Construction->SetAngle(windowAngle);  
   fExitWindowC2Construction->PutExitWindow(expHall_log);  
-    
-  if (fWindowHoleSD==0){  
-    fWindowHoleSD = new FragmentSD("/WindowHole");  
-    SDMan->AddNewDetector(fWindowHoleSD);  
-  }  
-  fExitWindowC2Construction->GetWindowHoleVolume()->SetSensitiveDetector(fWindowHoleSD);
 
   //------------------------------ Vacuum Downstream
   // [EN] The downstream pipe is physically connected to the dipole cavity,
@@ -259,12 +250,7 @@ G4VPhysicalVolume* DeutDetectorConstruction::Construct()
       G4Transform3D(target_rm, fTargetPos), LogicTarget, "Target",
       expHall_log, false, 0, true
     };
-
-    if (fTargetSD==0){
-      fTargetSD = new FragmentSD("/Target");
-      SDMan->AddNewDetector(fTargetSD);
-    }
-    LogicTargetSD->SetSensitiveDetector(fTargetSD);
+    fTargetSDLogical = LogicTargetSD;
   }
 
   frag_prm->fTargetPosition.SetXYZ(
@@ -284,12 +270,7 @@ G4VPhysicalVolume* DeutDetectorConstruction::Construct()
     const G4ThreeVector ips_center = fTargetPos + fIPSAxisOffset * ips_axis;
     // [EN] Keep the IPS barrel axis on the local beam line so the target remains on the detector symmetry axis while scanning signed axial offsets. / [CN] 保持IPS桶轴落在局部束流线上，使扫描带符号轴向偏移时靶点始终位于探测器对称轴上。
     fIPSConstruction->PlaceModules(expHall_log, G4Transform3D(ips_rm, ips_center));
-
-    if (fIPSSD == 0) {
-      fIPSSD = new FragmentSD("/IPS");
-      SDMan->AddNewDetector(fIPSSD);
-    }
-    fIPSConstruction->GetActiveLogicalVolume()->SetSensitiveDetector(fIPSSD);
+    fIPSPlaced = true;
   }
 
   auto* nebula_prm = static_cast<TNEBULASimParameter*>(
@@ -303,66 +284,20 @@ G4VPhysicalVolume* DeutDetectorConstruction::Construct()
   if (nebula_enabled) {
     fNEBULAConstruction->ConstructSub();
     fNEBULAConstruction->PutNEBULA(expHall_log);
-
-    // Sensitive Detector
-    if (fNEBULASD==0){
-      fNEBULASD = new NEBULASD("/NEBULA");
-      SDMan->AddNewDetector(fNEBULASD);
-    }
-
-    if (fNEBULAConstruction->DoesNeutExist()){
-      G4LogicalVolume *neut_log = fNEBULAConstruction->GetLogicNeut();
-      neut_log->SetSensitiveDetector(fNEBULASD);
-    }
-
-    if (fNEBULAConstruction->DoesVetoExist()){
-      G4LogicalVolume *veto_log = fNEBULAConstruction->GetLogicVeto();
-      veto_log->SetSensitiveDetector(fNEBULASD);
-    }
+    fNEBULAPlaced = true;
   }
 
   //------------------------------ NEBULA-Plus
   if (nebula_plus_enabled) {
     fNEBULAPlusConstruction->ConstructSub();
     fNEBULAPlusConstruction->PutNEBULAPlus(expHall_log);
-
-    // Sensitive Detector
-    if (fNEBULAPlusSD==0){
-      fNEBULAPlusSD = new NEBULAPlusSD("/NEBULAPlus");
-      SDMan->AddNewDetector(fNEBULAPlusSD);
-    }
-
-    if (fNEBULAPlusConstruction->DoesNeutExist()){
-      G4LogicalVolume *neut_log = fNEBULAPlusConstruction->GetLogicNeut();
-      neut_log->SetSensitiveDetector(fNEBULAPlusSD);
-    }
-
-    if (fNEBULAPlusConstruction->DoesVetoExist()){
-      G4LogicalVolume *veto_log = fNEBULAPlusConstruction->GetLogicVeto();
-      veto_log->SetSensitiveDetector(fNEBULAPlusSD);
-    }
+    fNEBULAPlusPlaced = true;
   }
 
   //------------------------------ PDCs 
   auto pdc_log = fPDCConstruction->ConstructSub();
   pdc_log->SetVisAttributes(G4Colour::Magenta());
 
-  if (fPDCSD_U==0){
-    fPDCSD_U = new FragmentSD("/PDC_U");
-    SDMan->AddNewDetector(fPDCSD_U);
-  }
-  if (fPDCSD_X==0){
-    fPDCSD_X = new FragmentSD("/PDC_X");
-    SDMan->AddNewDetector(fPDCSD_X);
-  }
-  if (fPDCSD_V==0){
-    fPDCSD_V = new FragmentSD("/PDC_V");
-    SDMan->AddNewDetector(fPDCSD_V);
-  }
-  fPDCConstruction->fLayerU->SetSensitiveDetector(fPDCSD_U);
-  fPDCConstruction->fLayerX->SetSensitiveDetector(fPDCSD_X);
-  fPDCConstruction->fLayerV->SetSensitiveDetector(fPDCSD_V);
-  
   // SAMURAI def. (clockwise)-> Geant def. (counterclockwise)
   G4double pdc_angle = -fPDCAngle;
   frag_prm->fPDCAngle = fPDCAngle;
@@ -441,6 +376,62 @@ G4VPhysicalVolume* DeutDetectorConstruction::Construct()
   return expHall_phys;
 }
 //______________________________________________________________________________
+namespace {
+// [EN] Sensitive detectors are thread-local: reuse the one this thread already registered, if any.
+// [CN] 敏感探测器为线程局部对象：若本线程已注册同名探测器则直接复用。
+template <class SD>
+G4VSensitiveDetector* GetOrCreateSD(const G4String& name)
+{
+  G4SDManager *SDMan = G4SDManager::GetSDMpointer();
+  G4VSensitiveDetector* sd = SDMan->FindSensitiveDetector(name, false);
+  if (sd==0){
+    sd = new SD(name);
+    SDMan->AddNewDetector(sd);
+  }
+  return sd;
+}
+}
+//______________________________________________________________________________
+void DeutDetectorConstruction::ConstructSDandField()
+{
+  // [EN] Called once per worker thread in MT mode (and after Construct() in sequential mode); the logical
+  //      volumes are shared, only the sensitive detectors and the field manager are per thread.
+  // [CN] MT 模式下每个 worker 线程调用一次（单线程模式在 Construct() 之后调用）；逻辑体共享，
+  //      只有敏感探测器与场管理器是每线程一份。
+  SetSensitiveDetector(fExitWindowNConstruction->GetWindowVolume(),
+                       GetOrCreateSD<FragmentSD>("/NeutronWindow"));
+  SetSensitiveDetector(fExitWindowC2Construction->GetWindowHoleVolume(),
+                       GetOrCreateSD<FragmentSD>("/WindowHole"));
+
+  if (fTargetSDLogical)
+    SetSensitiveDetector(fTargetSDLogical, GetOrCreateSD<FragmentSD>("/Target"));
+
+  if (fIPSPlaced)
+    SetSensitiveDetector(fIPSConstruction->GetActiveLogicalVolume(), GetOrCreateSD<FragmentSD>("/IPS"));
+
+  if (fNEBULAPlaced) {
+    G4VSensitiveDetector* nebulaSD = GetOrCreateSD<NEBULASD>("/NEBULA");
+    if (fNEBULAConstruction->DoesNeutExist())
+      SetSensitiveDetector(fNEBULAConstruction->GetLogicNeut(), nebulaSD);
+    if (fNEBULAConstruction->DoesVetoExist())
+      SetSensitiveDetector(fNEBULAConstruction->GetLogicVeto(), nebulaSD);
+  }
+
+  if (fNEBULAPlusPlaced) {
+    G4VSensitiveDetector* nebulaPlusSD = GetOrCreateSD<NEBULAPlusSD>("/NEBULAPlus");
+    if (fNEBULAPlusConstruction->DoesNeutExist())
+      SetSensitiveDetector(fNEBULAPlusConstruction->GetLogicNeut(), nebulaPlusSD);
+    if (fNEBULAPlusConstruction->DoesVetoExist())
+      SetSensitiveDetector(fNEBULAPlusConstruction->GetLogicVeto(), nebulaPlusSD);
+  }
+
+  SetSensitiveDetector(fPDCConstruction->fLayerU, GetOrCreateSD<FragmentSD>("/PDC_U"));
+  SetSensitiveDetector(fPDCConstruction->fLayerX, GetOrCreateSD<FragmentSD>("/PDC_X"));
+  SetSensitiveDetector(fPDCConstruction->fLayerV, GetOrCreateSD<FragmentSD>("/PDC_V"));
+
+  fDipoleConstruction->ConstructField();
+}
+//______________________________________________________________________________
 void DeutDetectorConstruction::SetTargetPos(G4ThreeVector pos)
 {
   fTargetPos = pos;
@@ -502,12 +493,26 @@ void DeutDetectorConstruction::SetDumpPos(G4ThreeVector pos)
 //______________________________________________________________________________
 void DeutDetectorConstruction::UpdateGeometry()
 {
-  G4RunManager::GetRunManager()->DefineWorldVolume(Construct());
+  if (G4Threading::IsMultithreadedApplication()) {
+    // [EN] Workers only pick up new geometry through a full reinitialisation at the next BeamOn.
+    // [CN] worker 只能在下一次 BeamOn 时通过完整重新初始化获得新几何。
+    G4UImanager::GetUIpointer()->ApplyCommand("/run/reinitializeGeometry");
+  } else {
+    G4RunManager::GetRunManager()->DefineWorldVolume(Construct());
+    ConstructSDandField();
+  }
   SM_INFO("DeutDetectorConstruction: SAMURAI Geometry is updated");
 }
 //______________________________________________________________________________
 void DeutDetectorConstruction::AutoConfigGeometry(G4String outputMacroFile)
 {
+  // [EN] Swaps user actions and reads them back after BeamOn, which only works on the sequential run manager.
+  // [CN] 需要替换用户动作并在 BeamOn 后读取其结果，只能在单线程运行管理器下使用。
+  if (G4Threading::IsMultithreadedApplication()) {
+    SM_ERROR("DeutDetectorConstruction: AutoConfig is not available in multi-threaded mode; run it with one thread");
+    return;
+  }
+
   SetTarget(true), SetFillAir(false), UpdateGeometry();
   
   G4RunManager* runManager = G4RunManager::GetRunManager();
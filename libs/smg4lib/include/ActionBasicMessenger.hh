@@ -13,7 +13,7 @@ class G4UIcmdWith3VectorAndUnit;
 class G4UIcmdWithoutParameter;
 class PrimaryGeneratorActionBasic;
 
-// singleton pattern
+// singleton pattern, one instance per thread (each Geant4 worker has its own primary generator)
 class ActionBasicMessenger : public G4UImessenger
 {
 public:
@@ -25,7 +25,7 @@ public:
   void SetNewValue(G4UIcommand*, G4String);
 
 protected:
-  static ActionBasicMessenger* fActionBasicMessenger;
+  static thread_local ActionBasicMessenger* fActionBasicMessenger;
 
   PrimaryGeneratorActionBasic* fPrimaryGeneratorActionBasic;
 
@@ -39,6 +39,12 @@ protected:
   G4UIcmdWithAString* fOverWriteCmd;
   G4UIcmdWithAString* fOutputTreeNameCmd;
   G4UIcmdWithAString* fOutputTreeTitleCmd;
+  G4UIcmdWithAString* fRetentionCmd;
+  G4UIcmdWithAString* fCompressionCmd;
+  G4UIcmdWithAnInteger* fCompressionLevelCmd;
+  G4UIcmdWithAnInteger* fBasketSizeCmd;
+  G4UIcmdWithAnInteger* fAutoFlushCmd;
+  G4UIcmdWithAnInteger* fAutoSaveCmd;
 
   G4UIcmdWithAString* fBeamTypeCmd;
   G4UIcmdWithAnInteger* fBeamACmd;
@@ -64,6 +70,8 @@ protected:
 
   G4UIcmdWithABool* fSkipLargeYAngCmd;
 
+  G4UIcmdWithABool* fCompactHitsCmd;
+
 private: // hidden
   ActionBasicMessenger();
   ActionBasicMessenger(const ActionBasicMessenger& actionMessenger);
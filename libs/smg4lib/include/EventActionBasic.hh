@@ -25,6 +25,7 @@ protected:
   TRunSimParameter* fRunSimParameter;
 
   time_t fTimeLast, fTimeStart;
+  G4int fRunID;
 };
 
 #endif
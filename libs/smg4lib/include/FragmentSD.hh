@@ -2,6 +2,9 @@
 #define FRAGMENTSD_HH
  
 #include "G4VSensitiveDetector.hh"
+#include "SimDataArrayHandle.hh"
+
+class TSimHit;
 
 class FragmentSD : public G4VSensitiveDetector
 {
@@ -13,6 +16,10 @@ public:
   void Initialize(G4HCofThisEvent* HCTE);
   G4bool ProcessHits(G4Step* aStep, G4TouchableHistory* ROhist);
   void EndOfEvent(G4HCofThisEvent* HCTE);
+
+private:
+  SimDataArrayHandle<TSimHit> fSimDataArray;// resolved in Initialize(), not per step
+  SimNameCache                fNames;
 };
 
 #endif
@@ -0,0 +1,80 @@
+#ifndef NEBULADIGITIZER_HH
+#define NEBULADIGITIZER_HH
+
+#include "Rtypes.h"
+
+#include <vector>
+
+class TRandom;
+class TNEBULASimParameter;
+class TNEBULAPlusSimParameter;
+
+// [EN] Flat-table digitization core shared by the NEBULA and NEBULA-Plus converters. Build() copies the detector
+//      parameters once per run into an array indexed by module ID (lab position, bar length, attenuation length),
+//      so the per-event work is array reads instead of std::map lookups and string comparisons. Modules are
+//      digitized in ascending ID with the same arithmetic and the same random draws (tu, then td) as the
+//      map-based converters, so with the same stream the output is identical.
+// [CN] NEBULA 与 NEBULA-Plus 转换器共用的扁平表数字化核心。Build() 每个 run 把探测器参数复制一次到按模块 ID 索引的
+//      数组（实验室系位置、棒长、衰减长度），逐事件只需数组读取，不再做 std::map 查找和字符串比较。模块按 ID 升序
+//      数字化，运算与随机数抽取（先 tu 后 td）都与基于 map 的转换器相同，同一随机流下输出完全一致。
+class NEBULADigitizer
+{
+public:
+  struct Module
+  {
+    Bool_t      valid;
+    Int_t       layer, sublayer;
+    const char* name;              // points into the parameter object, valid while it lives
+    Double_t    det_pos[3];        // module + system position (mm)
+    Double_t    module_y, system_y;// kept apart so y is summed in the converters' order
+    Double_t    ysize, att_len;
+  };
+
+  struct Output
+  {
+    Int_t         id;
+    const Module* module;
+    Double_t      t, qu, qd, q;
+    Double_t      pos[3];
+  };
+
+  void Build(const TNEBULASimParameter& prm);
+  void Build(const TNEBULAPlusSimParameter& prm);
+  const Module* GetModule(Int_t id) const
+  {
+    return (id >= 0 && id < (Int_t)fModules.size() && fModules[id].valid) ? &fModules[id] : nullptr;
+  }
+
+  // [EN] Per-step input: sums edep and light, keeps time/position of the earliest step. / [CN] 逐步输入：累加能量与光，保留最早一步的时间与位置。
+  void Add(Int_t id, Double_t edep, Double_t light, Double_t time, const Double_t pos[3]);
+  // [EN] Per-module input (TSimModuleData), replaces whatever the module had. / [CN] 逐模块输入（TSimModuleData），覆盖该模块已有内容。
+  void SetModule(Int_t id, Double_t edep, Double_t light, Double_t time, const Double_t pos[3]);
+
+  // [EN] Digitizes the modules hit since the last call, in ascending ID, then resets. IDs without parameters are
+  //      skipped without drawing random numbers and listed in GetUnknownIDs().
+  // [CN] 数字化上次调用以来被击中的模块（按 ID 升序）后清零。没有参数的 ID 不抽随机数直接跳过，并记入 GetUnknownIDs()。
+  const std::vector<Output>& Digitize(TRandom& rng, Bool_t resolution);
+  const std::vector<Int_t>& GetUnknownIDs() const {return fUnknownIDs;}
+  void Reset();
+
+private:
+  struct Sum
+  {
+    Int_t    nsteps;
+    Double_t edep, light, time, pos[3];
+  };
+
+  template <typename Parameter, typename Map>
+  void BuildTable(const Parameter& prm, const Map& modules);
+  Sum* Slot(Int_t id);
+
+  std::vector<Module> fModules;   // indexed by ID
+  std::vector<Sum>    fSums;      // indexed by ID, grows to the largest ID seen
+  std::vector<Int_t>  fTouched;   // IDs with nsteps>0
+  std::vector<Output> fOutputs;
+  std::vector<Int_t>  fUnknownIDs;
+  Double_t fTimeReso = 0;
+  Double_t fV_scinti = 1;
+};
+
+#endif
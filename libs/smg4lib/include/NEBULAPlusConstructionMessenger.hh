@@ -20,7 +20,9 @@ protected:
   G4UIcmdWithAString* fParameterFileNameCmd;
   G4UIcmdWithAString* fDetectorParameterFileNameCmd;
   G4UIcmdWithABool* fNEBULAPlusStoreStepsCmd;
+  G4UIcmdWithABool* fNEBULAPlusAccumulateModulesCmd;
   G4UIcmdWithABool* fNEBULAPlusResolutionCmd;
+  G4UIcmdWithABool* fNEBULAPlusFastDigitizerCmd;
 
 };
 
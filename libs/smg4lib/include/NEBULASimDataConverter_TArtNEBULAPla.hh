@@ -4,6 +4,8 @@
 #include "SimDataConverter.hh"
 #include "SimDataInitializer.hh"
 
+#include "RandomStreams.hh"
+#include "NEBULADigitizer.hh"
 #include "TNEBULASimParameter.hh"
 #include <map>
 
@@ -20,6 +22,8 @@ public:
   virtual int Initialize();
   virtual int DefineBranch(TTree* tree);
   virtual int ConvertSimData();
+  // [EN] Flat-table path of ConvertSimData(), same output. / [CN] ConvertSimData() 的扁平表实现，输出相同。
+  int ConvertSimDataFast();
 
   // called in EventActionBasic from SimDataManager
   virtual int ClearBuffer();
@@ -29,13 +33,25 @@ public:
 
   void SetIncludeResolution(bool tf){fIncludeResolution = tf;}
   bool SetIncludeResolution(){return fIncludeResolution;}
+  void SetFastDigitizer(bool tf){fFastDigitizer = tf;}
+  bool GetFastDigitizer(){return fFastDigitizer;}
+
+  virtual void CopySettings(SimDataConverter& master){
+    SimDataConverter::CopySettings(master);
+    fIncludeResolution = static_cast<NEBULASimDataConverter_TArtNEBULAPla&>(master).fIncludeResolution;
+    fFastDigitizer = static_cast<NEBULASimDataConverter_TArtNEBULAPla&>(master).fFastDigitizer;
+  }
 
 protected:
   bool fIncludeResolution;
   bool fDetectorEnabled;
+  bool fFastDigitizer;
+  NEBULADigitizer fDigitizer;  // module table built in Initialize() when fFastDigitizer
+  PhiloxRandom fRandom;  // attached to (run seed, event ID, "NEBULA/time") per event
 
   TNEBULASimParameter *fNEBULASimParameter;
   TClonesArray *fNEBULASimDataArray;  // Each element is a hit
+  TClonesArray *fNEBULAModuleDataArray;// Per-module sums (AccumulateModules), replaces the hits when set
   TClonesArray *fNEBULAPlaArray;      // Each element is a module with hit
 
   class tmp_data{
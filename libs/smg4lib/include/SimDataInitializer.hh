@@ -23,12 +23,17 @@ public:
 
   // called in EventActionBasic from SimDataManager
   virtual int ClearBuffer() = 0;
+  // called in SimDataManager::ConvertSimData before the converters, e.g. to fill derived output arrays
+  virtual int PrepareOutput(){return 0;}
 
   TString GetName(){return fName;}
   void SetDataStore(bool tf){fDataStore = tf;}
   bool GetDataStore(){return fDataStore;}
   TClonesArray* GetSimDataArray(){return fSimDataArray;}
 
+  // called in SimDataManager::Initialize on worker threads, from the master's instance of the same name
+  virtual void CopySettings(SimDataInitializer& master){fDataStore = master.GetDataStore();}
+
 protected:
   TString fName;
   bool    fDataStore;
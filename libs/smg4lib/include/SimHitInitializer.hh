@@ -0,0 +1,43 @@
+#ifndef SIMHITINITIALIZER_HH
+#define SIMHITINITIALIZER_HH
+
+#include "SimDataInitializer.hh"
+#include "SimHitRetention.hh"
+
+class TFile;
+class TTree;
+
+// [EN] Step data of one sensitive detector. The SD appends TSimHit to "<prefix>SimHit" (GetSimDataArray());
+//      on output either those hits are stored directly (SimDataManager::GetCompactHits()) or they are expanded
+//      into the legacy TClonesArray<TSimData> branch "<prefix>SimData". With a retention level other than "steps"
+//      (/action/file/Retention) the stored hits are first reduced into a separate array.
+// [CN] 单个灵敏探测器的步数据。SD 向 "<prefix>SimHit"（GetSimDataArray()）追加 TSimHit；输出时或直接保存这些击中
+//      （SimDataManager::GetCompactHits()），或展开为旧的 TClonesArray<TSimData> 分支 "<prefix>SimData"。
+//      保留级别不是 "steps" 时（/action/file/Retention），先把要存盘的击中精简到另一个数组。
+class SimHitInitializer : public SimDataInitializer
+{
+public:
+  SimHitInitializer(TString name, TString prefix);
+  virtual ~SimHitInitializer();
+
+  // called in RunActionBasic
+  virtual int Initialize();
+  virtual int DefineBranch(TTree* tree);
+  virtual int AddParameters(TFile* file);
+  virtual int RemoveParameters(TFile* file);
+  virtual int PrintParameters(TFile* file);
+
+  // called in EventActionBasic
+  virtual int ClearBuffer();
+  virtual int PrepareOutput();
+
+protected:
+  TString       fPrefix;
+  bool          fCompact;
+  TClonesArray *fLegacyArray;// <prefix>SimData, filled only when the legacy branch is stored
+  TClonesArray *fStoredArray;// reduced <prefix>SimHit, used unless the retention level is kSteps
+  SimHitRetention::Level fRetentionLevel;
+  SimHitRetention        fRetention;
+};
+
+#endif
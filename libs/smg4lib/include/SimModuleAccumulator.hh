@@ -0,0 +1,37 @@
+#ifndef SIMMODULEACCUMULATOR_HH
+#define SIMMODULEACCUMULATOR_HH
+
+#include "Rtypes.h"
+
+#include <vector>
+
+class TClonesArray;
+
+// [EN] Per-event sums of a segmented detector in a flat array indexed by module ID. Add() is called per step and
+//      only touches one slot; Flush() writes one TSimModuleData per hit module, in ID order, and resets those slots,
+//      so the cost per event is proportional to the number of hit modules rather than the module count.
+// [CN] 分段探测器逐事件累加量，存于按模块 ID 索引的扁平数组。每步调用 Add()，只改动一个槽；Flush() 按 ID 顺序为每个
+//      被击中模块写出一个 TSimModuleData 并清零这些槽，每事件开销与被击中模块数成正比，而非模块总数。
+class SimModuleAccumulator
+{
+public:
+  // [EN] pos in mm, time in ns; negative IDs are ignored. / [CN] pos 单位 mm，time 单位 ns；负 ID 忽略。
+  void Add(Int_t id, Double_t edep, Double_t light, Double_t time, const Double_t pos[3]);
+  // [EN] Appends to `out` and resets. / [CN] 追加到 out 并清零。
+  void Flush(TClonesArray* out);
+  void Reset();
+  Int_t GetNModules() const {return fTouched.size();}
+
+private:
+  struct Module
+  {
+    Int_t    nsteps;
+    Double_t edep, light;
+    Double_t first_time, first_pos[3];
+    Double_t light_time, light_pos[3];  // sums of light*t and light*pos
+  };
+  std::vector<Module> fModules;  // grows to the largest ID seen, then stays
+  std::vector<Int_t>  fTouched;  // IDs with nsteps>0
+};
+
+#endif
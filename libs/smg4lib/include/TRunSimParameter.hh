@@ -17,6 +17,10 @@ public:
 
   void SetTreeName(TString name){fTreeName = name;}
   void AppendHeader(TString str){fHeader += " " + str;}
+  // [EN] ROOT compression settings (algorithm*100+level) from fCompression/fCompressionLevel, -1 when both are left
+  //      at their defaults so the file keeps ROOT's own setting.
+  // [CN] 由 fCompression/fCompressionLevel 得到的 ROOT 压缩设置（算法*100+级别）；两者都为默认值时返回 -1，沿用 ROOT 默认。
+  Int_t GetCompressionSettings() const;
 
 public:
   TString fRunName;
@@ -28,7 +32,15 @@ public:
   TDatime fStartTime;
   TDatime fStopTime;
 
-  ClassDef(TRunSimParameter, 1)
+  // output policy, see /action/file/ commands
+  TString  fRetention;       // step-level hits: "steps" (all), "endpoints" (first/last per track and detector), "summary" (one per detector)
+  TString  fCompression;     // "default", "zlib", "lzma", "lz4", "zstd"
+  Int_t    fCompressionLevel;// 0-9, -1: algorithm default
+  Int_t    fBasketSize;      // bytes per branch basket, 0: ROOT default
+  Long64_t fAutoFlush;       // TTree::SetAutoFlush (>0 entries, <0 bytes), 0: ROOT default
+  Long64_t fAutoSave;        // TTree::SetAutoSave (>0 entries, <0 bytes), 0: never
+
+  ClassDef(TRunSimParameter, 2)
 };
 
 #endif
@@ -0,0 +1,69 @@
+#ifndef TSIMHIT_HH
+#define TSIMHIT_HH
+
+#include "TObject.h"
+#include "TVector3.h"
+#include "TLorentzVector.h"
+
+class TClonesArray;
+class TSimData;
+class TSimNameTable;
+
+// [EN] Compact step record written by the sensitive detectors: plain numbers only, names interned in TSimNameTable.
+//      Floating-point members are Double32_t (double in memory, float on disk). Expand() restores the full
+//      TSimData, so readers of the legacy <Name>SimData branches keep working.
+// [CN] 灵敏探测器写出的紧凑步记录：只含数值，名字存入 TSimNameTable 后以索引引用。
+//      浮点成员为 Double32_t（内存中为 double，磁盘上为 float）。Expand() 可还原完整的 TSimData，
+//      旧的 <Name>SimData 分支读取代码因此仍可使用。
+class TSimHit : public TObject
+{
+public:
+  enum { kMaxModuleDepth = 4 };
+
+  TSimHit();
+  virtual ~TSimHit();
+
+  TVector3 GetPrePosition() const {return TVector3(fPrePosition[0], fPrePosition[1], fPrePosition[2]);}
+  TVector3 GetPostPosition() const {return TVector3(fPostPosition[0], fPostPosition[1], fPostPosition[2]);}
+  TLorentzVector GetPreMomentum() const
+  {return TLorentzVector(fPreMomentum[0], fPreMomentum[1], fPreMomentum[2], fPreKineticEnergy + fMass);}
+  TLorentzVector GetPostMomentum() const
+  {return TLorentzVector(fPostMomentum[0], fPostMomentum[1], fPostMomentum[2], fPostKineticEnergy + fMass);}
+
+  // [EN] Conversion layer to the legacy record. / [CN] 转换为旧格式记录。
+  void Expand(const TSimNameTable* names, TSimData* data) const;
+  // [EN] Appends one TSimData per TSimHit of `hits` to `out`. / [CN] 为 hits 中每个 TSimHit 向 out 追加一个 TSimData。
+  static void ExpandArray(const TClonesArray* hits, const TSimNameTable* names, TClonesArray* out);
+
+public:
+  Int_t      fParentID;            // 0 for primary particle
+  Int_t      fTrackID;
+  Int_t      fStepNo;              // in chronological order
+  Int_t      fPDGCode;
+  Short_t    fZ;
+  Short_t    fA;
+  Int_t      fID;                  // copy number of the detector
+  Int_t      fParticleNameID;      // index in TSimNameTable, -1: none
+  Int_t      fDetectorNameID;      // index in TSimNameTable, -1: none
+  Int_t      fModuleNameID;        // index in TSimNameTable, -1: none
+  Int_t      fProcessNameID;       // index in TSimNameTable, -1: none
+  Int_t      fNModuleID;           // number of valid entries in fModuleID
+  Int_t      fModuleID[kMaxModuleDepth];// copy numbers, 0:self, 1:mother, ...
+  Double32_t fCharge;              // e
+  Double32_t fMass;                // MeV
+  Double32_t fPreKineticEnergy;    // MeV
+  Double32_t fPostKineticEnergy;   // MeV
+  Double32_t fEnergyDeposit;       // MeV
+  Double32_t fPreMomentum[3];      // MeV/c
+  Double32_t fPostMomentum[3];     // MeV/c
+  Double32_t fPrePosition[3];      // mm
+  Double32_t fPostPosition[3];     // mm
+  Double32_t fPreTime;             // ns
+  Double32_t fPostTime;            // ns
+  Double32_t fFlightLength;        // mm
+  Bool_t     fIsAccepted;
+
+  ClassDef(TSimHit, 1)
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef TSIMMODULEDATA_HH
+#define TSIMMODULEDATA_HH
+
+#include "TObject.h"
+#include "TVector3.h"
+
+// [EN] Per-module summary of one event, accumulated in the sensitive detector instead of storing every step
+//      (see SimModuleAccumulator). "First" is the earliest step, as used by the NEBULA converters; the light-
+//      weighted mean time/position use the quenched light of each step as weight.
+// [CN] 单个事件中每个模块的汇总，在灵敏探测器中累加，不再保存每一步（见 SimModuleAccumulator）。"First" 为最早的一步，
+//      与 NEBULA converter 的用法一致；光加权平均时间/位置以每步的淬灭光输出为权重。
+class TSimModuleData : public TObject
+{
+public:
+  TSimModuleData();
+  virtual ~TSimModuleData();
+
+  TVector3 GetFirstPosition() const {return TVector3(fFirstPosition[0], fFirstPosition[1], fFirstPosition[2]);}
+  TVector3 GetLightPosition() const {return TVector3(fLightPosition[0], fLightPosition[1], fLightPosition[2]);}
+
+public:
+  Int_t      fID;                // module copy number
+  Int_t      fNSteps;            // number of accumulated steps
+  Double32_t fEnergyDeposit;     // MeV
+  Double32_t fLight;             // MeVee
+  Double32_t fFirstTime;         // ns
+  Double32_t fFirstPosition[3];  // mm
+  Double32_t fLightTime;         // ns
+  Double32_t fLightPosition[3];  // mm
+
+  ClassDef(TSimModuleData, 1)
+};
+
+#endif
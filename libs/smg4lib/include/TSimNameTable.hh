@@ -0,0 +1,41 @@
+#ifndef TSIMNAMETABLE_HH
+#define TSIMNAMETABLE_HH
+
+#include "TNamed.h"
+
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+// [EN] Name dictionary of the compact hit records (TSimHit): particle, detector, module and process names are
+//      stored once here and referenced by index. One table per process, shared by all threads and written next to
+//      the tree at end of run; indices stay valid for the whole job.
+// [CN] 紧凑击中记录（TSimHit）的名字字典：粒子、探测器、模块和过程名只在此存一次，击中中以索引引用。
+//      整个进程一张表，所有线程共享，运行结束时与 tree 一起写出；索引在整个作业内保持有效。
+class TSimNameTable : public TNamed
+{
+public:
+  TSimNameTable(const char* name="SimNameTable");
+  virtual ~TSimNameTable();
+
+  // [EN] Thread-safe; returns the existing index for a known name. Known names only take the shared lock.
+  // [CN] 线程安全；已知名字返回已有索引，此时只取共享锁。
+  Int_t Intern(const char* name);
+  // [EN] "" for -1 or an unknown index; the pointer stays valid while the table lives. Shared lock, so the
+  //      per-hit lookups of several threads do not serialize.
+  // [CN] -1 或未知索引返回 ""；指针在表存活期间一直有效。只取共享锁，多线程逐击中查询互不串行。
+  const char* GetEntry(Int_t id) const;
+  Int_t GetEntries() const;
+  virtual void Clear(Option_t* option="");
+  virtual void Print(Option_t* option="") const;
+
+private:
+  std::deque<std::string> fNames;                //  deque: entries never move while others are appended
+  std::unordered_map<std::string,Int_t> fIndex;  //! rebuilt on demand after reading
+  mutable std::shared_mutex fMutex;              //! per table: readers share, Intern/Clear of a new name is exclusive
+
+  ClassDef(TSimNameTable, 1)
+};
+
+#endif
@@ -7,11 +7,12 @@
 #include "G4ThreeVector.hh"
 #include "TString.h"
 
+#include "RandomStreams.hh"
+
 class G4ParticleGun;
 class G4ParticleDefinition;
 class G4ParticleTable;
 
-class TRandom3;
 class TLorentzVector;
 class TFile;
 class TTree;
@@ -23,6 +24,8 @@ class BeamSimDataMessenger;
 class PrimaryGeneratorActionBasic : public G4VUserPrimaryGeneratorAction
 {
 public:
+  // [EN] seed is unused: beam smearing draws from the per-event "Beam" stream of SimDataManager::GetRandomStreams().
+  // [CN] seed 已不使用：束流展宽从 SimDataManager::GetRandomStreams() 的逐事件 "Beam" 流抽样。
   PrimaryGeneratorActionBasic(G4int seed = 128);
   virtual ~PrimaryGeneratorActionBasic();
 
@@ -64,7 +67,7 @@ public:
 protected:
   G4ParticleGun* fParticleGun;
 
-  TRandom3* fRandom;
+  PhiloxRandom fRandom;  // attached to (run seed, event ID, "Beam") per event
   G4ParticleTable* fParticleTable;
 
   TString fBeamType;
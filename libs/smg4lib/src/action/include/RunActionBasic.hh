@@ -3,6 +3,8 @@
 
 #include "G4UserRunAction.hh"
 
+#include <string>
+
 class G4Run;
 class SimDataManager;
 class TRunSimParameter;
@@ -10,6 +12,11 @@ class TFragSimParameter;
 
 class TFile;
 
+// [EN] Sequential runs write one file directly. In multi-threaded runs each worker writes
+//      <RunName>NNNN_t<thread>.root with its own tree, and the master merges them into <RunName>NNNN.root
+//      and adds the run parameters.
+// [CN] 单线程运行直接写一个文件。多线程运行时每个 worker 用自己的 tree 写 <RunName>NNNN_t<线程>.root，
+//      master 在结束时合并为 <RunName>NNNN.root 并写入运行参数。
 class RunActionBasic : public G4UserRunAction
 {
 public:
@@ -20,6 +27,10 @@ public:
   void EndOfRunAction(const G4Run*);
 
 protected:
+  void BeginOfWorkerRunAction(G4int id);
+  void EndOfWorkerRunAction();
+  TFile* MergeWorkerOutputs(const std::string& output_name);
+
   SimDataManager* fSimDataManager;
   TRunSimParameter* fRunSimParameter;
   TFragSimParameter* fFragSimParameter;
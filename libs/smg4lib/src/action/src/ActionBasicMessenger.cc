@@ -16,7 +16,7 @@
 #include "G4UIcmdWithoutParameter.hh"
 #include "G4SystemOfUnits.hh"//Geant4.10
 
-ActionBasicMessenger* ActionBasicMessenger::fActionBasicMessenger(0);
+thread_local ActionBasicMessenger* ActionBasicMessenger::fActionBasicMessenger(0);
 //____________________________________________________________________
 ActionBasicMessenger* ActionBasicMessenger::GetInstance()
 {
@@ -71,6 +71,59 @@ ActionBasicMessenger::ActionBasicMessenger()
   fOutputTreeTitleCmd->SetParameterName("treeTitle",false);
   fOutputTreeTitleCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
 
+  fRetentionCmd = new G4UIcmdWithAString("/action/file/Retention",this);
+  fRetentionCmd->SetGuidance("Step-level hits stored in <Name>SimHit/<Name>SimData");
+  fRetentionCmd->SetGuidance("  steps     : every step (default)");
+  fRetentionCmd->SetGuidance("  endpoints : first and last step of each track in each detector");
+  fRetentionCmd->SetGuidance("  summary   : one record per detector (summed energy deposit)");
+  fRetentionCmd->SetParameterName("retention",false);
+  fRetentionCmd->SetCandidates("steps endpoints summary");
+  fRetentionCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fCompressionCmd = new G4UIcmdWithAString("/action/file/Compression",this);
+  fCompressionCmd->SetGuidance("Compression algorithm of the output file");
+  fCompressionCmd->SetGuidance("  default (ROOT setting), zlib, lzma, lz4, zstd");
+  fCompressionCmd->SetParameterName("compression",false);
+  fCompressionCmd->SetCandidates("default zlib lzma lz4 zstd");
+  fCompressionCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fCompressionLevelCmd = new G4UIcmdWithAnInteger("/action/file/CompressionLevel",this);
+  fCompressionLevelCmd->SetGuidance("Compression level 0-9 (0: uncompressed), -1: algorithm default");
+  fCompressionLevelCmd->SetParameterName("level",false);
+  fCompressionLevelCmd->SetRange("level>=-1 && level<=9");
+  fCompressionLevelCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fBasketSizeCmd = new G4UIcmdWithAnInteger("/action/file/tree/BasketSize",this);
+  fBasketSizeCmd->SetGuidance("Basket size (bytes) of every output branch, 0: ROOT default");
+  fBasketSizeCmd->SetParameterName("basketSize",false);
+  fBasketSizeCmd->SetRange("basketSize>=0");
+  fBasketSizeCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fAutoFlushCmd = new G4UIcmdWithAnInteger("/action/file/tree/AutoFlush",this);
+  fAutoFlushCmd->SetGuidance("TTree::SetAutoFlush: >0 entries, <0 bytes, 0: ROOT default");
+  fAutoFlushCmd->SetParameterName("autoFlush",false);
+  fAutoFlushCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fAutoSaveCmd = new G4UIcmdWithAnInteger("/action/file/tree/AutoSave",this);
+  fAutoSaveCmd->SetGuidance("TTree::SetAutoSave: >0 entries, <0 bytes, 0: only at end of run");
+  fAutoSaveCmd->SetGuidance("  10000 (default)");
+  fAutoSaveCmd->SetParameterName("autoSave",false);
+  fAutoSaveCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  // [EN] Output settings live in the master's TRunSimParameter, which workers only read.
+  // [CN] 输出设置保存在 master 的 TRunSimParameter 中，worker 只读。
+  fRunNameCmd->SetToBeBroadcasted(false);
+  fOutputSaveDirCmd->SetToBeBroadcasted(false);
+  fOverWriteCmd->SetToBeBroadcasted(false);
+  fOutputTreeNameCmd->SetToBeBroadcasted(false);
+  fOutputTreeTitleCmd->SetToBeBroadcasted(false);
+  fRetentionCmd->SetToBeBroadcasted(false);
+  fCompressionCmd->SetToBeBroadcasted(false);
+  fCompressionLevelCmd->SetToBeBroadcasted(false);
+  fBasketSizeCmd->SetToBeBroadcasted(false);
+  fAutoFlushCmd->SetToBeBroadcasted(false);
+  fAutoSaveCmd->SetToBeBroadcasted(false);
+
   fBeamTypeCmd = new G4UIcmdWithAString("/action/gun/Type",this);
   fBeamTypeCmd->SetGuidance("Set beam type");
   fBeamTypeCmd->SetParameterName("beamType",false);
@@ -173,6 +226,9 @@ ActionBasicMessenger::ActionBasicMessenger()
   fTreeBeamOnCmd->SetParameterName("NumOfBeam",true);
   fTreeBeamOnCmd->SetDefaultValue(0);
   fTreeBeamOnCmd->AvailableForStates(G4State_Idle);
+  // [EN] Starts the run on the master; workers bind the input branch on their first Tree event.
+  // [CN] 在 master 上启动运行；worker 在第一个 Tree 事件时绑定输入分支。
+  fTreeBeamOnCmd->SetToBeBroadcasted(false);
 
   fSkipNeutronCmd = new G4UIcmdWithABool("/action/gun/SkipNeutron",this);
   fSkipNeutronCmd->SetGuidance("Skip Neutron simulation or not");
@@ -198,6 +254,15 @@ ActionBasicMessenger::ActionBasicMessenger()
   fSkipLargeYAngCmd->SetParameterName("SkipLargeYAng",true);
   fSkipLargeYAngCmd->SetDefaultValue(false);
 
+  fCompactHitsCmd = new G4UIcmdWithABool("/action/data/CompactHits",this);
+  fCompactHitsCmd->SetGuidance("Store compact TSimHit branches (<Name>SimHit) and the SimNameTable");
+  fCompactHitsCmd->SetGuidance("instead of the expanded TSimData branches (<Name>SimData)");
+  fCompactHitsCmd->SetGuidance("false (default)");
+  fCompactHitsCmd->SetParameterName("CompactHits",true);
+  fCompactHitsCmd->SetDefaultValue(false);
+  fCompactHitsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  // [EN] Workers read the flag from the master's SimDataManager. / [CN] worker 从 master 的 SimDataManager 读取该标志。
+  fCompactHitsCmd->SetToBeBroadcasted(false);
 
 }
 //____________________________________________________________________
@@ -208,6 +273,12 @@ ActionBasicMessenger::~ActionBasicMessenger()
   delete fOverWriteCmd;
   delete fOutputTreeNameCmd;
   delete fOutputTreeTitleCmd;
+  delete fRetentionCmd;
+  delete fCompressionCmd;
+  delete fCompressionLevelCmd;
+  delete fBasketSizeCmd;
+  delete fAutoFlushCmd;
+  delete fAutoSaveCmd;
   delete fBeamTypeCmd;
   delete fBeamACmd;
   delete fBeamZCmd;
@@ -227,6 +298,7 @@ ActionBasicMessenger::~ActionBasicMessenger()
   delete fSkipHeavyIonCmd;
 
   delete fSkipLargeYAngCmd;
+  delete fCompactHitsCmd;
 
   delete fActionDir;
   delete fActionFileDir;
@@ -291,6 +363,21 @@ void ActionBasicMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
     }
     prm->fTreeTitle = newValue;
 
+  }else if(command == fRetentionCmd || command == fCompressionCmd || command == fCompressionLevelCmd ||
+	   command == fBasketSizeCmd || command == fAutoFlushCmd || command == fAutoSaveCmd){
+    SimDataManager *sman = SimDataManager::GetSimDataManager();
+    TRunSimParameter *prm = (TRunSimParameter*)sman->FindParameter("RunParameter");
+    if (prm==0){
+      prm = new TRunSimParameter("RunParameter");
+      sman->AddParameter(prm);
+    }
+    if      (command == fRetentionCmd)        prm->fRetention = newValue;
+    else if (command == fCompressionCmd)      prm->fCompression = newValue;
+    else if (command == fCompressionLevelCmd) prm->fCompressionLevel = fCompressionLevelCmd->GetNewIntValue(newValue);
+    else if (command == fBasketSizeCmd)       prm->fBasketSize = fBasketSizeCmd->GetNewIntValue(newValue);
+    else if (command == fAutoFlushCmd)        prm->fAutoFlush = fAutoFlushCmd->GetNewIntValue(newValue);
+    else                                      prm->fAutoSave = fAutoSaveCmd->GetNewIntValue(newValue);
+
 
   }else if(command == fBeamTypeCmd){
     if(!fPrimaryGeneratorActionBasic->SetBeamType(newValue)) G4Exception(0, 0, FatalException, 0);
@@ -374,6 +461,9 @@ void ActionBasicMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
   }else if( command == fSkipLargeYAngCmd ){
     fPrimaryGeneratorActionBasic->SetSkipLargeYAng(fSkipLargeYAngCmd->GetNewBoolValue(newValue));
 
+  }else if( command == fCompactHitsCmd ){
+    SimDataManager::GetSimDataManager()->SetCompactHits(fCompactHitsCmd->GetNewBoolValue(newValue));
+
 
   }
 
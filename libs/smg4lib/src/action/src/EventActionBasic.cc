@@ -4,6 +4,7 @@
 #include "G4Event.hh"
 #include "G4RunManager.hh"
 #include "G4Run.hh"
+#include "G4Threading.hh"
 
 #include "SimDataManager.hh"
 #include "TRunSimParameter.hh"
@@ -18,7 +19,7 @@
 
 //____________________________________________________________________
 EventActionBasic::EventActionBasic()
-  : fTimeLast(0), fTimeStart(0)
+  : fTimeLast(0), fTimeStart(0), fRunID(-1)
 {
   fSimDataManager = SimDataManager::GetSimDataManager();
   fRunSimParameter = (TRunSimParameter*)fSimDataManager->FindParameter("RunParameter");
@@ -33,13 +34,18 @@ void EventActionBasic::BeginOfEventAction(const G4Event* anEvent)
   std::cout<<"start BeginOfEventAction"<<std::endl;
 #endif 
   // ------ counter -----
-  if(anEvent->GetEventID()==0){
+  // [EN] Reset on the first event this thread sees in a run; with worker threads that is rarely event 0.
+  //      Only one thread (the sequential master or worker 0) prints, using the global event ID.
+  // [CN] 在本线程每个运行的第一个事件时重置；多线程时该事件一般不是第 0 个。
+  //      只有一个线程（单线程的 master 或 worker 0）打印，使用全局事件号。
+  G4RunManager *RunManager = G4RunManager::GetRunManager();
+  const G4Run *Run = RunManager->GetCurrentRun();
+  if(Run->GetRunID()!=fRunID){
+    fRunID = Run->GetRunID();
     time(&fTimeStart);
     fTimeLast = time(0);
   }
-
-  G4RunManager *RunManager = G4RunManager::GetRunManager();
-  const G4Run *Run = RunManager->GetCurrentRun();
+  if(G4Threading::G4GetThreadId()>0) return;
 
   time_t timeNow = time(0);
   if(timeNow-fTimeLast>=1){
@@ -60,16 +66,13 @@ void EventActionBasic::BeginOfEventAction(const G4Event* anEvent)
 void EventActionBasic::EndOfEventAction(const G4Event* anEvent)
 {
 
+  fSimDataManager->SetEventID(anEvent->GetEventID());
   fSimDataManager->ConvertSimData();
 
-  TTree* tree;
-  gDirectory->GetObject(fRunSimParameter->fTreeName, tree);
+  TTree* tree = fSimDataManager->GetTree();
+  // periodic saving is TTree::SetAutoSave (/action/file/tree/AutoSave), set in RunActionBasic
   tree->Fill();
 
-  if((anEvent->GetEventID()+1) % 10000 == 0){
-    gFile->Write(0,TObject::kOverwrite);
-  }
-
   // ------ clear data class -----
   fSimDataManager->ClearBuffer();
 
@@ -24,7 +24,6 @@
 #include "SimDataManager.hh"
 #include "TRunSimParameter.hh"
 
-#include "TRandom3.h"
 #include "TMath.h"
 #include "TVector3.h"
 #include "TFile.h"
@@ -35,7 +34,7 @@
 #include "G4SystemOfUnits.hh"//Geant4.10
 
 //____________________________________________________________________
-PrimaryGeneratorActionBasic::PrimaryGeneratorActionBasic(G4int seed)
+PrimaryGeneratorActionBasic::PrimaryGeneratorActionBasic(G4int /*seed*/)
   : fBeamA(-9999), fBeamZ(-9999), 
     fBeamEnergy(250*MeV), fBeamBrho(-1),
     fBeamPosition(0, 0, -4*m), fBeamPositionXSigma(0), fBeamPositionYSigma(0),
@@ -46,8 +45,6 @@ PrimaryGeneratorActionBasic::PrimaryGeneratorActionBasic(G4int seed)
 {
   fParticleGun = new G4ParticleGun(1);
 
-  fRandom = new TRandom3(seed);
-
   // default property
   G4ThreeVector momentumDirection = G4ThreeVector(0, 0, 1);
   G4double kineticEnergy = fBeamEnergy;
@@ -404,12 +401,15 @@ void PrimaryGeneratorActionBasic::BeamTypeGaus(G4Event* anEvent)
   data.fIsAccepted        = kTRUE;
   data.fMomentum.SetPxPyPzE(0,0,P/MeV,E/MeV);
 
-  G4double AngX = gRandom->Gaus(fBeamAngleX/rad,fBeamAngleXSigma/rad);
-  G4double AngY = gRandom->Gaus(-fBeamAngleY/rad,fBeamAngleYSigma/rad);
+  // [EN] Per-event stream: thread-safe under Geant4 MT and independent of which worker runs the event.
+  // [CN] 逐事件随机流：Geant4 多线程下线程安全，且与处理该事件的 worker 无关。
+  SimDataManager::GetSimDataManager()->GetRandomStreams().Attach(fRandom, anEvent->GetEventID(), "Beam");
+  G4double AngX = fRandom.Gaus(fBeamAngleX/rad,fBeamAngleXSigma/rad);
+  G4double AngY = fRandom.Gaus(-fBeamAngleY/rad,fBeamAngleYSigma/rad);
   data.fMomentum.RotateY(AngX);
   data.fMomentum.RotateX(AngY);
-  G4double PosX = gRandom->Gaus(fBeamPosition.x()/mm,fBeamPositionXSigma/mm);
-  G4double PosY = gRandom->Gaus(fBeamPosition.y()/mm,fBeamPositionYSigma/mm);
+  G4double PosX = fRandom.Gaus(fBeamPosition.x()/mm,fBeamPositionXSigma/mm);
+  G4double PosY = fRandom.Gaus(fBeamPosition.y()/mm,fBeamPositionYSigma/mm);
 
   data.fPosition.SetXYZ(PosX,
 			PosY,
@@ -452,8 +452,9 @@ void PrimaryGeneratorActionBasic::BeamTypeIsotropic(G4Event* anEvent)
   data.fTime              = 0;// not implemented
   data.fIsAccepted        = kTRUE;
 
-  double costht = gRandom->Uniform(-1.0,1.0);
-  double phi    = gRandom->Uniform(0.0, 2.0*TMath::Pi());
+  SimDataManager::GetSimDataManager()->GetRandomStreams().Attach(fRandom, anEvent->GetEventID(), "Beam");
+  double costht = fRandom.Uniform(-1.0,1.0);
+  double phi    = fRandom.Uniform(0.0, 2.0*TMath::Pi());
   double sintht = sqrt(1.0-costht*costht);
 
   data.fMomentum.SetPxPyPzE(sintht*cos(phi)*P/MeV,
@@ -474,6 +475,14 @@ void PrimaryGeneratorActionBasic::BeamTypeTree(G4Event *anEvent)
 #if DEBUG
   std::cout<<"start BeamTypeTree"<<std::endl;
 #endif 
+  // [EN] Multi-threaded runs start from /action/gun/tree/beamOn on the master only, so each worker
+  //      binds the branch to its own gBeamSimDataArray here; event IDs are global, so entries line up.
+  // [CN] 多线程时 /action/gun/tree/beamOn 只在 master 上执行，worker 在此把分支绑定到自己的
+  //      gBeamSimDataArray；事件号全局唯一，因此与输入条目一一对应。
+  if (fBranchInput==0){
+    fBranchInput = fInputTree->GetBranch("TBeamSimData");
+    fBranchInput->SetAddress(&gBeamSimDataArray);
+  }
   fInputTree->GetEntry(anEvent->GetEventID());
   for(int i=0;i<(int)gBeamSimDataArray->size();++i){
     TString        name = (*gBeamSimDataArray)[i].fParticleName;
@@ -552,6 +561,7 @@ void PrimaryGeneratorActionBasic::SetInputTreeName(TString treeName)
   }
 
   fInputTreeName = treeName;
+  fBranchInput = 0;
   fRootInputFile->GetObject(fInputTreeName.Data(),fInputTree);
   if (!fInputTree){
     G4cerr<< " Tree ("
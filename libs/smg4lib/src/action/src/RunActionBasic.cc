@@ -3,9 +3,12 @@
 
 #include "G4Run.hh"
 #include "G4RunManager.hh"
+#include "G4Threading.hh"
+#include "Randomize.hh"
 #include "PrimaryGeneratorActionBasic.hh"
 
 #include "SimDataManager.hh"
+#include "TSimNameTable.hh"
 #include "NeutronDetectorSimConfig.hh"
 #include "SMLogger.hh"
 #include "TNEBULAPlusSimParameter.hh"
@@ -14,14 +17,58 @@
 #include "TFragSimParameter.hh"
 
 #include "TFile.h"
+#include "TFileMerger.h"
 #include "TNamed.h"
 #include "TTree.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <vector>
+
+namespace {
+
+// [EN] Per-thread output files of the current run, merged by the master in EndOfRunAction.
+// [CN] 当前运行各线程的输出文件，由 master 在 EndOfRunAction 中合并。
+std::mutex gWorkerOutputMutex;
+std::vector<std::string> gWorkerOutputFiles;
+
+std::string OutputFileName(const TRunSimParameter* prm, G4int run_id)
+{
+  std::ostringstream oss;
+  oss << prm->fSaveDir
+      << prm->fRunName
+      << std::setw(4) << std::setfill('0') << run_id << ".root";
+  return oss.str();
+}
+
+// [EN] Output policy from /action/file/ commands. Compression has to be set before the tree creates its branches.
+// [CN] 来自 /action/file/ 命令的输出策略。压缩设置必须在树创建分支之前生效。
+void ConfigureFile(TFile* file, const TRunSimParameter* prm)
+{
+  const Int_t compression = prm->GetCompressionSettings();
+  if (compression>=0) file->SetCompressionSettings(compression);
+}
+
+TTree* CreateTree(SimDataManager* sman, const TRunSimParameter* prm)
+{
+  // tree will be automatically added to current directory
+  TTree* tree = new TTree(prm->fTreeName, prm->fTreeTitle);
+  sman->DefineBranch(tree);
+  if (prm->fBasketSize>0) tree->SetBasketSize("*", prm->fBasketSize);
+  if (prm->fAutoFlush!=0) tree->SetAutoFlush(prm->fAutoFlush);
+  // replaces the full file Write() every 10000 entries EventActionBasic used to do
+  tree->SetAutoSave(prm->fAutoSave);
+  sman->SetTree(tree);
+  return tree;
+}
+
+}  // namespace
 //____________________________________________________________________
 RunActionBasic::RunActionBasic()
   : fFileOut(0) 
@@ -51,20 +98,27 @@ void RunActionBasic::BeginOfRunAction(const G4Run* aRun)
   std::cout<<"start BeginOfRunAction"<<std::endl;
 #endif 
 
+  G4int id = aRun->GetRunID();
+  if (!IsMaster()) {
+    BeginOfWorkerRunAction(id);
+    return;
+  }
+
   fRunSimParameter->fStartTime = TDatime();
 
-  G4int id = aRun->GetRunID();
   G4cout << "### Run " << id << " start" << G4endl;
   std::stringstream ss;
   ss<<"Run#="<<id;
   fRunSimParameter->AppendHeader(ss.str().c_str());
 
+  // [EN] Converter random streams follow the Geant4 engine seed, so /random/setSeeds reproduces the whole output.
+  // [CN] converter 随机流跟随 Geant4 引擎种子，/random/setSeeds 即可复现全部输出。
+  fSimDataManager->GetRandomStreams().SetRunSeed(
+      RandomStreams::Mix(static_cast<std::uint64_t>(CLHEP::HepRandom::getTheSeed()), static_cast<std::uint64_t>(id)));
+
   // accumulate data by ROOT
-  std::ostringstream oss;
-  oss << fRunSimParameter->fSaveDir
-      << fRunSimParameter->fRunName
-      << std::setw(4) << std::setfill('0') << id << ".root";
-  std::filesystem::path log_path(oss.str());
+  const std::string output_name = OutputFileName(fRunSimParameter, id);
+  std::filesystem::path log_path(output_name);
   log_path.replace_extension(".log");
   SMLogger::LogConfig log_config;
   log_config.async = false;
@@ -75,10 +129,10 @@ void RunActionBasic::BeginOfRunAction(const G4Run* aRun)
   SMLogger::Logger::Instance().Initialize(SMLogger::MakeLogConfigFromEnvironment(log_config));
 
   // over write warning
-  std::ifstream ifileForCheck(oss.str().c_str());
+  std::ifstream ifileForCheck(output_name.c_str());
   if(ifileForCheck){ // file exists
     if(fRunSimParameter->fOverWrite=="ask"){
-      G4cout << oss.str() << " already exists. over write[y], exit[n]>" << G4endl;    
+      G4cout << output_name << " already exists. over write[y], exit[n]>" << G4endl;    
       std::string yn;
       G4cin >> yn;
       if(!(yn == "y" || yn == "yes")){
@@ -86,17 +140,24 @@ void RunActionBasic::BeginOfRunAction(const G4Run* aRun)
 	std::abort();
       }
     }else if(fRunSimParameter->fOverWrite=="y"){
-      G4cout << oss.str() << " already exists. over write." << G4endl;    
+      G4cout << output_name << " already exists. over write." << G4endl;    
     }else{
-      G4cout << oss.str() << " already exists. exit." << G4endl;    
+      G4cout << output_name << " already exists. exit." << G4endl;    
       std::abort();
     }
   }
-  fFileOut = TFile::Open(oss.str().c_str(), "recreate");
-  if(!fFileOut || fFileOut->IsZombie()) G4Exception(0, 0, FatalException, 0);
 
-  // Initialize Output Data classes
-  fSimDataManager->Initialize();
+  // [EN] Multi-threaded: workers write their own files, the master only merges them at the end of the run.
+  // [CN] 多线程：各 worker 写各自的文件，master 只在运行结束时合并。
+  const bool merge_workers = G4Threading::IsMultithreadedApplication();
+  if (!merge_workers) {
+    fFileOut = TFile::Open(output_name.c_str(), "recreate");
+    if(!fFileOut || fFileOut->IsZombie()) G4Exception(0, 0, FatalException, 0);
+    ConfigureFile(fFileOut, fRunSimParameter);
+
+    // Initialize Output Data classes
+    fSimDataManager->Initialize();
+  }
 
   auto* nebula_prm = static_cast<TNEBULASimParameter*>(
       fSimDataManager->FindParameter("NEBULAParameter"));
@@ -119,13 +180,19 @@ void RunActionBasic::BeginOfRunAction(const G4Run* aRun)
     SM_INFO("  SimNEBULAPlusDetectorParameterFile={}", nebula_plus_prm->fDetectorParameterFileName.Data());
     SM_INFO("  SimNEBULAPlusDetectorCount={}", nebula_plus_prm->fNeutNum + nebula_plus_prm->fVetoNum);
   }
-  SM_INFO("  OutputROOT={}", oss.str());
+  SM_INFO("  OutputROOT={}", output_name);
+  SM_INFO("  OutputPolicy: Retention={} Compression={}:{} BasketSize={} AutoFlush={} AutoSave={}",
+          fRunSimParameter->fRetention.Data(), fRunSimParameter->fCompression.Data(),
+          fRunSimParameter->fCompressionLevel, fRunSimParameter->fBasketSize,
+          fRunSimParameter->fAutoFlush, fRunSimParameter->fAutoSave);
   SM_INFO("  LogFile={}", log_path.string());
+  if (merge_workers) {
+    SM_INFO("  Threads={} (per-thread files merged at end of run)", G4RunManager::GetRunManager()->GetNumberOfThreads());
+    return;
+  }
 
-  // create event data branch. tree will be automatically added to current directory
-  TTree* tree = new TTree(fRunSimParameter->fTreeName,
-			  fRunSimParameter->fTreeTitle);
-  fSimDataManager->DefineBranch(tree);
+  // create event data branch
+  CreateTree(fSimDataManager, fRunSimParameter);
 
   fFileOut->Write();
 #if DEBUG
@@ -135,9 +202,17 @@ void RunActionBasic::BeginOfRunAction(const G4Run* aRun)
 //____________________________________________________________________
 void RunActionBasic::EndOfRunAction(const G4Run* aRun)
 {
+  if (!IsMaster()) {
+    EndOfWorkerRunAction();
+    return;
+  }
+
   G4cout << "\n Event:" << aRun->GetNumberOfEvent() << std::endl;
 
   fSimDataManager = SimDataManager::GetSimDataManager();
+  if (G4Threading::IsMultithreadedApplication()) {
+    fFileOut = MergeWorkerOutputs(OutputFileName(fRunSimParameter, aRun->GetRunID()));
+  }
 
   // stop time
   fRunSimParameter->fStopTime = TDatime();
@@ -189,13 +264,16 @@ void RunActionBasic::EndOfRunAction(const G4Run* aRun)
     sim_nebula_plus_param.Write();
     sim_nebula_plus_bars.Write();
   }
+  // [EN] Names referenced by the TSimHit branches (needed to expand compact output).
+  // [CN] TSimHit 分支引用的名字表（展开紧凑输出时需要）。
+  fSimDataManager->GetNameTable()->Write(0,TObject::kOverwrite);
   fFileOut->Write(0,TObject::kOverwrite);
   std::cout<< "written to "<<fFileOut->GetName()<<std::endl;
 
   // Reset tree, parameters
-  TTree* tree;
-  gDirectory->GetObject(fRunSimParameter->fTreeName, tree);
-  tree->ResetBranchAddresses();
+  TTree* tree = fSimDataManager->GetTree();
+  if (tree) tree->ResetBranchAddresses();
+  fSimDataManager->SetTree(0);
   fSimDataManager->RemoveParameters(fFileOut);// for storing parameters
 
   // reset Header of TRunSimParameter
@@ -207,3 +285,69 @@ void RunActionBasic::EndOfRunAction(const G4Run* aRun)
   G4cout << G4endl;
 }
 //____________________________________________________________________
+void RunActionBasic::BeginOfWorkerRunAction(G4int id)
+{
+  SimDataManager* master = SimDataManager::GetMasterSimDataManager();
+  // [EN] Same run seed on every thread: converter output depends only on the event ID, not on the thread.
+  // [CN] 所有线程使用同一运行种子：converter 输出只取决于事件号，与线程无关。
+  fSimDataManager->GetRandomStreams() = master->GetRandomStreams();
+
+  std::filesystem::path path(OutputFileName(fRunSimParameter, id));
+  path.replace_filename(path.stem().string() + "_t" + std::to_string(G4Threading::G4GetThreadId()) + ".root");
+  fFileOut = TFile::Open(path.string().c_str(), "recreate");
+  if(!fFileOut || fFileOut->IsZombie()) G4Exception(0, 0, FatalException, 0);
+  ConfigureFile(fFileOut, fRunSimParameter);
+
+  fSimDataManager->Initialize();
+  CreateTree(fSimDataManager, fRunSimParameter);
+  fFileOut->Write();
+
+  std::lock_guard<std::mutex> lock(gWorkerOutputMutex);
+  gWorkerOutputFiles.push_back(path.string());
+}
+//____________________________________________________________________
+void RunActionBasic::EndOfWorkerRunAction()
+{
+  fFileOut->Write(0,TObject::kOverwrite);
+  TTree* tree = fSimDataManager->GetTree();
+  if (tree) tree->ResetBranchAddresses();
+  fSimDataManager->SetTree(0);
+  fFileOut->Close();
+
+  // [EN] The worker that ran event 0 carries the beam header. / [CN] 处理第 0 个事件的 worker 带有束流头信息。
+  if (!fSimDataManager->GetHeader().IsWhitespace()) {
+    std::lock_guard<std::mutex> lock(gWorkerOutputMutex);
+    SimDataManager::GetMasterSimDataManager()->AppendHeader(fSimDataManager->GetHeader());
+  }
+  fSimDataManager->ClearHeader();
+}
+//____________________________________________________________________
+TFile* RunActionBasic::MergeWorkerOutputs(const std::string& output_name)
+{
+  std::vector<std::string> inputs;
+  {
+    std::lock_guard<std::mutex> lock(gWorkerOutputMutex);
+    inputs.swap(gWorkerOutputFiles);
+  }
+  std::sort(inputs.begin(), inputs.end());
+
+  TFileMerger merger(kFALSE, kFALSE);
+  merger.SetPrintLevel(0);
+  const Int_t compression = fRunSimParameter->GetCompressionSettings();
+  const bool opened = compression>=0
+    ? merger.OutputFile(output_name.c_str(), "RECREATE", compression)
+    : merger.OutputFile(output_name.c_str(), "RECREATE");
+  if (!opened) G4Exception(0, 0, FatalException, 0);
+  for (const auto& input : inputs) merger.AddFile(input.c_str(), kFALSE);
+  if (!merger.Merge()) {
+    SM_ERROR("Merging {} worker files into {} failed; worker files are kept", inputs.size(), output_name);
+    G4Exception(0, 0, FatalException, 0);
+  }
+  for (const auto& input : inputs) std::filesystem::remove(input);
+  SM_INFO("Merged {} worker files into {}", inputs.size(), output_name);
+
+  TFile* file = TFile::Open(output_name.c_str(), "update");
+  if(!file || file->IsZombie()) G4Exception(0, 0, FatalException, 0);
+  return file;
+}
+//____________________________________________________________________
@@ -24,6 +24,7 @@ public:
   G4VPhysicalVolume* PutSAMURAIMagnet(G4LogicalVolume* ExpHall_log);
   G4VPhysicalVolume* PutSAMURAIMagnet(G4LogicalVolume* ExpHall_log, G4double angle);
   void SetMagField(G4String filename);
+  void ConstructField();// attach the shared field to this thread's field manager
   void SetAngle(G4double val);
   void SetMagFieldFactor(double factor);
   void PlotMagField();
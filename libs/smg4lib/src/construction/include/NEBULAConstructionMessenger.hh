@@ -20,7 +20,9 @@ protected:
   G4UIcmdWithAString* fParameterFileNameCmd;
   G4UIcmdWithAString* fDetectorParameterFileNameCmd;
   G4UIcmdWithABool* fNEBULAStoreStepsCmd;
+  G4UIcmdWithABool* fNEBULAAccumulateModulesCmd;
   G4UIcmdWithABool* fNEBULAResolutionCmd;
+  G4UIcmdWithABool* fNEBULAFastDigitizerCmd;
 
 };
 
@@ -2,6 +2,11 @@
 #define NEBULASPLUSSD_HH
 
 #include "G4VSensitiveDetector.hh"
+#include "SimDataArrayHandle.hh"
+#include "SimModuleAccumulator.hh"
+
+class TSimHit;
+class TSimModuleData;
 
 class NEBULAPlusSD : public G4VSensitiveDetector
 {
@@ -13,6 +18,15 @@ public:
   void Initialize(G4HCofThisEvent* HCTE);
   G4bool ProcessHits(G4Step* aStep, G4TouchableHistory* ROhist);
   void EndOfEvent(G4HCofThisEvent* HCTE);
+
+private:
+  SimDataArrayHandle<TSimHit> fSimDataArray;// resolved in Initialize(), not per step
+  SimNameCache                fNames;
+  // [EN] Per-module sums instead of steps, enabled by /action/data/NEBULAPlus/AccumulateModules.
+  // [CN] 以逐模块求和代替步数据，由 /action/data/NEBULAPlus/AccumulateModules 开启。
+  SimDataArrayHandle<TSimModuleData> fModuleDataArray;
+  SimModuleAccumulator        fModules;
+  bool                        fAccumulate;// resolved in Initialize()
 };
 
 #endif
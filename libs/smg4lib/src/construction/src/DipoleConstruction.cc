@@ -166,22 +166,15 @@ G4VPhysicalVolume* DipoleConstruction::PutSAMURAIMagnet(G4LogicalVolume* ExpHall
 #include "G4TransportationManager.hh"
 void DipoleConstruction::SetMagField(G4String filename)
 {
-  //apply a global uniform magnetic field along Z axis
-
-  G4FieldManager* fieldMgr
-    = G4TransportationManager::GetTransportationManager()->GetFieldManager();
-
-  if(fMagField!=0) delete fMagField;         //delete the existing magn field
-
-  fMagField = new MagField();
+  // [EN] The field map is read-only during tracking, so a single MagField is shared by every thread;
+  //      reload it in place so pointers held by worker field managers stay valid.
+  // [CN] 场图在径迹追踪中只读，所有线程共享同一个 MagField；原地重新加载，使 worker 场管理器持有的指针保持有效。
+  if(fMagField==0) fMagField = new MagField();
   fMagField->LoadMagneticField(filename);
   fMagField->SetMagAngle(fAngle);
   fMagField->SetFieldFactor(fMagFieldFactor);
 
-  fieldMgr->SetDetectorField(fMagField);
-  fieldMgr->CreateChordFinder(fMagField);
-  // step for magnetic field integration
-  fieldMgr->GetChordFinder()->SetDeltaChord(0.001*mm); // 10 micron m order accuracy
+  ConstructField();
 
   // Header information
   SimDataManager *sman = SimDataManager::GetSimDataManager();
@@ -191,6 +184,21 @@ void DipoleConstruction::SetMagField(G4String filename)
 
 }
 //______________________________________________________________________________________
+void DipoleConstruction::ConstructField()
+{
+  if(fMagField==0) return;
+
+  // [EN] Field managers and chord finders are per thread; call from ConstructSDandField() on each worker.
+  // [CN] 场管理器与 chord finder 为每线程各一份；在每个 worker 的 ConstructSDandField() 中调用。
+  G4FieldManager* fieldMgr
+    = G4TransportationManager::GetTransportationManager()->GetFieldManager();
+
+  fieldMgr->SetDetectorField(fMagField);
+  fieldMgr->CreateChordFinder(fMagField);
+  // step for magnetic field integration
+  fieldMgr->GetChordFinder()->SetDeltaChord(0.001*mm); // 10 micron m order accuracy
+}
+//______________________________________________________________________________________
 void DipoleConstruction::SetAngle(G4double val)
 {
   if (fMagField!=0) fMagField->SetMagAngle(fAngle);
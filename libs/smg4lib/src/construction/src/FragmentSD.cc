@@ -1,10 +1,11 @@
 #include "FragmentSD.hh"
 #include "SimDataManager.hh"
-#include "TSimData.hh"
+#include "TSimHit.hh"
 
 #include "G4HCofThisEvent.hh"
 #include "G4SDManager.hh"
 #include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
 #include "G4Step.hh"
 #include "G4Track.hh"
 #include "G4VTouchable.hh"
@@ -19,20 +20,21 @@
 #include "TClonesArray.h"
 #include "G4SystemOfUnits.hh"//Geant4.10
 
-FragmentSD::FragmentSD(G4String name) : G4VSensitiveDetector(name)
+FragmentSD::FragmentSD(G4String name)
+  : G4VSensitiveDetector(name), fSimDataArray("FragSimHit")
 {;}
 
 FragmentSD::~FragmentSD()
 {;}
 
 void FragmentSD::Initialize(G4HCofThisEvent* /*HCTE*/)
-{;}
+{
+  fSimDataArray.Refresh();
+}
 
 G4bool FragmentSD::ProcessHits(G4Step* aStep, G4TouchableHistory* /*ROhist*/)
 {
-  SimDataManager *sman = SimDataManager::GetSimDataManager();
-  TClonesArray *SimDataArray = sman->FindSimDataArray("FragSimData");
-  if(SimDataArray==0) return true;
+  if(!fSimDataArray) return true;
 
   G4StepPoint* preStepPoint = aStep->GetPreStepPoint();
   G4StepPoint* postStepPoint = aStep->GetPostStepPoint();
@@ -52,22 +54,19 @@ G4bool FragmentSD::ProcessHits(G4Step* aStep, G4TouchableHistory* /*ROhist*/)
   G4int trackid =  aStep->GetTrack()->GetTrackID();
   G4int stepno = aStep->GetTrack()->GetCurrentStepNumber();
   G4int pdgCode = dynamicParticle->GetPDGcode();
-  TString particleName(particleDefinition->GetParticleName().data());
 
   G4TouchableHistory* theTouchable = (G4TouchableHistory*)(preStepPoint->GetTouchable());
   
   // GetVolume(G4int depth = 0), 0 means the sensitive area, 1 means the detector itself
-  const G4String& detectorName = theTouchable->GetVolume(1)->GetLogicalVolume()->GetName();
+  const G4LogicalVolume* detectorVolume = theTouchable->GetVolume(1)->GetLogicalVolume();
   const G4int& detectorID = theTouchable->GetVolume(1)->GetCopyNo();
-  const G4String& moduleName = theTouchable->GetVolume(0)->GetLogicalVolume()->GetName();
+  const G4LogicalVolume* moduleVolume = theTouchable->GetVolume(0)->GetLogicalVolume();
   const Double_t mass_MeV = particleDefinition->GetPDGMass()/MeV;
 
   // store only primary particle with Z!=0
   if(parentid == 0 && aStep->GetTrack()->GetDefinition()->GetPDGCharge() != 0.){
 
-    Int_t nstep = SimDataArray->GetEntries();
-    new ((*SimDataArray)[nstep]) TSimData;
-    TSimData* data = (TSimData*)SimDataArray->At(nstep);
+    TSimHit* data = fSimDataArray.Append();
 
     //data->fPrimaryParticleID = trackid - 1;
     data->fParentID = parentid;
@@ -76,26 +75,20 @@ G4bool FragmentSD::ProcessHits(G4Step* aStep, G4TouchableHistory* /*ROhist*/)
     data->fZ = particleDefinition->GetAtomicNumber();
     data->fA = particleDefinition->GetAtomicMass();
     data->fPDGCode = pdgCode;
-    data->fParticleName = particleName;
-    data->fDetectorName = detectorName;
+    data->fParticleNameID = fNames.Get(particleDefinition, particleDefinition->GetParticleName().data());
+    data->fDetectorNameID = fNames.Get(detectorVolume, detectorVolume->GetName().data());
     data->fID = detectorID;
-    data->fModuleName = moduleName;
+    data->fModuleNameID = fNames.Get(moduleVolume, moduleVolume->GetName().data());
     data->fCharge = dynamicParticle->GetCharge()/eplus;
     data->fMass = mass_MeV;
-    data->fPreMomentum.SetPxPyPzE(preMomentum.x()/MeV,
-				 preMomentum.y()/MeV,
-				 preMomentum.z()/MeV,
-				 preKineticEnergy_MeV + mass_MeV);
-    data->fPostMomentum.SetPxPyPzE(postMomentum.x()/MeV,
-				  postMomentum.y()/MeV,
-				  postMomentum.z()/MeV,
-				  postKineticEnergy_MeV + mass_MeV);
-    data->fPrePosition.SetXYZ(prePosition.x()/mm,
-			     prePosition.y()/mm,
-			     prePosition.z()/mm);
-    data->fPostPosition.SetXYZ(postPosition.x()/mm,
-			      postPosition.y()/mm,
-			      postPosition.z()/mm);
+    data->fPreKineticEnergy  = preKineticEnergy_MeV;
+    data->fPostKineticEnergy = postKineticEnergy_MeV;
+    for(G4int i=0; i<3; ++i){
+      data->fPreMomentum[i]  = preMomentum[i]/MeV;
+      data->fPostMomentum[i] = postMomentum[i]/MeV;
+      data->fPrePosition[i]  = prePosition[i]/mm;
+      data->fPostPosition[i] = postPosition[i]/mm;
+    }
     data->fPreTime  = preStepPoint->GetGlobalTime()/ns;
     data->fEnergyDeposit = energyDeposit_MeV; // 能量沉积
     data->fPostTime = postStepPoint->GetGlobalTime()/ns;
@@ -105,8 +98,8 @@ G4bool FragmentSD::ProcessHits(G4Step* aStep, G4TouchableHistory* /*ROhist*/)
 
 
 #ifdef DEBUG
-    G4cout << "array_size = "<<SimDataArray->size() 
-	   << " data : " << *data << G4endl;
+    G4cout << "array_size = "<<fSimDataArray.GetArray()->GetEntriesFast() 
+	   << " particle : " << particleDefinition->GetParticleName() << G4endl;
 #endif
   }
   
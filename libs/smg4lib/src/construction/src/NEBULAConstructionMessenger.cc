@@ -6,6 +6,7 @@
 
 #include "SimDataManager.hh"
 #include "SimDataInitializer.hh"
+#include "SimModuleDataInitializer.hh"
 
 #include "G4UIdirectory.hh"
 #include "G4UIcmdWithAString.hh"
@@ -33,11 +34,25 @@ NEBULAConstructionMessenger::NEBULAConstructionMessenger()
   fNEBULAStoreStepsCmd->SetDefaultValue(false);
   fNEBULAStoreStepsCmd->SetParameterName("StoreSteps",true);
 
+  fNEBULAAccumulateModulesCmd = new G4UIcmdWithABool("/action/data/NEBULA/AccumulateModules",this);
+  fNEBULAAccumulateModulesCmd->SetGuidance("Sum light, energy and time per NEBULA module in the sensitive detector");
+  fNEBULAAccumulateModulesCmd->SetGuidance("instead of recording every step (NEBULAModuleData branch)");
+  fNEBULAAccumulateModulesCmd->SetGuidance("false (default)");
+  fNEBULAAccumulateModulesCmd->SetDefaultValue(false);
+  fNEBULAAccumulateModulesCmd->SetParameterName("AccumulateModules",true);
+
   fNEBULAResolutionCmd = new G4UIcmdWithABool("/action/data/NEBULA/Resolution",this);
   fNEBULAResolutionCmd->SetGuidance("Convolute NEBULA data by resolution or not");
   fNEBULAResolutionCmd->SetGuidance("true (default)");
   fNEBULAResolutionCmd->SetDefaultValue(true);
   fNEBULAResolutionCmd->SetParameterName("Resolution",true);
+
+  fNEBULAFastDigitizerCmd = new G4UIcmdWithABool("/action/data/NEBULA/FastDigitizer",this);
+  fNEBULAFastDigitizerCmd->SetGuidance("Digitize NEBULA from a module table built once per run");
+  fNEBULAFastDigitizerCmd->SetGuidance("instead of per-event parameter map lookups (same output)");
+  fNEBULAFastDigitizerCmd->SetGuidance("false (default)");
+  fNEBULAFastDigitizerCmd->SetDefaultValue(false);
+  fNEBULAFastDigitizerCmd->SetParameterName("FastDigitizer",true);
 }
 //____________________________________________________________________
 NEBULAConstructionMessenger::~NEBULAConstructionMessenger()
@@ -45,7 +60,9 @@ NEBULAConstructionMessenger::~NEBULAConstructionMessenger()
   delete fParameterFileNameCmd;
   delete fDetectorParameterFileNameCmd;
   delete fNEBULAStoreStepsCmd;
+  delete fNEBULAAccumulateModulesCmd;
   delete fNEBULAResolutionCmd;
+  delete fNEBULAFastDigitizerCmd;
   delete fNEBULADirectory;
 }
 //____________________________________________________________________
@@ -64,6 +81,17 @@ void NEBULAConstructionMessenger::SetNewValue(G4UIcommand* command, G4String  ne
     SimDataInitializer *initializer = sman->FindInitializer("NEBULASimDataInitializer");
     initializer->SetDataStore(fNEBULAStoreStepsCmd->GetNewBoolValue(newValue));
 
+  }else if( command == fNEBULAAccumulateModulesCmd ){
+    SimDataManager *sman = SimDataManager::GetSimDataManager();
+    SimModuleDataInitializer *initializer
+      = (SimModuleDataInitializer*)sman->FindInitializer("NEBULAModuleDataInitializer");
+    if (initializer!=0){
+      initializer->SetAccumulate(fNEBULAAccumulateModulesCmd->GetNewBoolValue(newValue));
+    }else{
+      G4cout<<__FILE__
+	    <<": NEBULAModuleDataInitializer is not defined, skip"<<G4endl;
+    }
+
   }else if( command == fNEBULAResolutionCmd ){
     SimDataManager *sman = SimDataManager::GetSimDataManager();
     NEBULASimDataConverter_TArtNEBULAPla *converter 
@@ -74,6 +102,17 @@ void NEBULAConstructionMessenger::SetNewValue(G4UIcommand* command, G4String  ne
       G4cout<<__FILE__
 	    <<": NEBULASimDataConverter_TArtNEBULAPla is not defined, skip"<<G4endl;
     }
+
+  }else if( command == fNEBULAFastDigitizerCmd ){
+    SimDataManager *sman = SimDataManager::GetSimDataManager();
+    NEBULASimDataConverter_TArtNEBULAPla *converter
+      = (NEBULASimDataConverter_TArtNEBULAPla*)sman->FindConverter("NEBULASimDataConverter_TArtNEBULAPla");
+    if (converter!=0){
+      converter->SetFastDigitizer(fNEBULAFastDigitizerCmd->GetNewBoolValue(newValue));
+    }else{
+      G4cout<<__FILE__
+	    <<": NEBULASimDataConverter_TArtNEBULAPla is not defined, skip"<<G4endl;
+    }
   }
 }
 //____________________________________________________________________
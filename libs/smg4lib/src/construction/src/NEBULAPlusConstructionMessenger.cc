@@ -6,6 +6,7 @@
 
 #include "SimDataManager.hh"
 #include "SimDataInitializer.hh"
+#include "SimModuleDataInitializer.hh"
 
 #include "G4UIdirectory.hh"
 #include "G4UIcmdWithAString.hh"
@@ -33,11 +34,25 @@ NEBULAPlusConstructionMessenger::NEBULAPlusConstructionMessenger()
   fNEBULAPlusStoreStepsCmd->SetDefaultValue(false);
   fNEBULAPlusStoreStepsCmd->SetParameterName("StoreSteps",true);
 
+  fNEBULAPlusAccumulateModulesCmd = new G4UIcmdWithABool("/action/data/NEBULAPlus/AccumulateModules",this);
+  fNEBULAPlusAccumulateModulesCmd->SetGuidance("Sum light, energy and time per NEBULAPlus module in the sensitive detector");
+  fNEBULAPlusAccumulateModulesCmd->SetGuidance("instead of recording every step (NEBULAPlusModuleData branch)");
+  fNEBULAPlusAccumulateModulesCmd->SetGuidance("false (default)");
+  fNEBULAPlusAccumulateModulesCmd->SetDefaultValue(false);
+  fNEBULAPlusAccumulateModulesCmd->SetParameterName("AccumulateModules",true);
+
   fNEBULAPlusResolutionCmd = new G4UIcmdWithABool("/action/data/NEBULAPlus/Resolution",this);
   fNEBULAPlusResolutionCmd->SetGuidance("Convolute NEBULAPlus data by resolution or not");
   fNEBULAPlusResolutionCmd->SetGuidance("true (default)");
   fNEBULAPlusResolutionCmd->SetDefaultValue(true);
   fNEBULAPlusResolutionCmd->SetParameterName("Resolution",true);
+
+  fNEBULAPlusFastDigitizerCmd = new G4UIcmdWithABool("/action/data/NEBULAPlus/FastDigitizer",this);
+  fNEBULAPlusFastDigitizerCmd->SetGuidance("Digitize NEBULAPlus from a module table built once per run");
+  fNEBULAPlusFastDigitizerCmd->SetGuidance("instead of per-event parameter map lookups (same output)");
+  fNEBULAPlusFastDigitizerCmd->SetGuidance("false (default)");
+  fNEBULAPlusFastDigitizerCmd->SetDefaultValue(false);
+  fNEBULAPlusFastDigitizerCmd->SetParameterName("FastDigitizer",true);
 }
 //____________________________________________________________________
 NEBULAPlusConstructionMessenger::~NEBULAPlusConstructionMessenger()
@@ -45,7 +60,9 @@ NEBULAPlusConstructionMessenger::~NEBULAPlusConstructionMessenger()
   delete fParameterFileNameCmd;
   delete fDetectorParameterFileNameCmd;
   delete fNEBULAPlusStoreStepsCmd;
+  delete fNEBULAPlusAccumulateModulesCmd;
   delete fNEBULAPlusResolutionCmd;
+  delete fNEBULAPlusFastDigitizerCmd;
   delete fNEBULAPlusDirectory;
 }
 //____________________________________________________________________
@@ -64,6 +81,17 @@ void NEBULAPlusConstructionMessenger::SetNewValue(G4UIcommand* command, G4String
     SimDataInitializer *initializer = sman->FindInitializer("NEBULAPlusSimDataInitializer");
     initializer->SetDataStore(fNEBULAPlusStoreStepsCmd->GetNewBoolValue(newValue));
 
+  }else if( command == fNEBULAPlusAccumulateModulesCmd ){
+    SimDataManager *sman = SimDataManager::GetSimDataManager();
+    SimModuleDataInitializer *initializer
+      = (SimModuleDataInitializer*)sman->FindInitializer("NEBULAPlusModuleDataInitializer");
+    if (initializer!=0){
+      initializer->SetAccumulate(fNEBULAPlusAccumulateModulesCmd->GetNewBoolValue(newValue));
+    }else{
+      G4cout<<__FILE__
+	    <<": NEBULAPlusModuleDataInitializer is not defined, skip"<<G4endl;
+    }
+
   }else if( command == fNEBULAPlusResolutionCmd ){
     SimDataManager *sman = SimDataManager::GetSimDataManager();
     NEBULAPlusSimDataConverter_TArtNEBULAPlusPla *converter
@@ -74,6 +102,17 @@ void NEBULAPlusConstructionMessenger::SetNewValue(G4UIcommand* command, G4String
       G4cout<<__FILE__
 	    <<": NEBULAPlusSimDataConverter_TArtNEBULAPlusPla is not defined, skip"<<G4endl;
     }
+
+  }else if( command == fNEBULAPlusFastDigitizerCmd ){
+    SimDataManager *sman = SimDataManager::GetSimDataManager();
+    NEBULAPlusSimDataConverter_TArtNEBULAPlusPla *converter
+      = (NEBULAPlusSimDataConverter_TArtNEBULAPlusPla*)sman->FindConverter("NEBULAPlusSimDataConverter_TArtNEBULAPlusPla");
+    if (converter!=0){
+      converter->SetFastDigitizer(fNEBULAPlusFastDigitizerCmd->GetNewBoolValue(newValue));
+    }else{
+      G4cout<<__FILE__
+	    <<": NEBULAPlusSimDataConverter_TArtNEBULAPlusPla is not defined, skip"<<G4endl;
+    }
   }
 }
 //____________________________________________________________________
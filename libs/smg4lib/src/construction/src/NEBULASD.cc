@@ -1,6 +1,9 @@
 #include "NEBULASD.hh"
 #include "SimDataManager.hh"
-#include "TSimData.hh"
+#include "TSimHit.hh"
+#include "TSimModuleData.hh"
+#include "SimModuleDataInitializer.hh"
+#include "NEBULAQuenching.hh"
 
 #include "G4HCofThisEvent.hh"
 #include "G4SDManager.hh"
@@ -17,22 +20,30 @@
 #include "TTree.h"
 #include "TBranch.h"
 #include "TClonesArray.h"
+#include <algorithm>
 #include "G4SystemOfUnits.hh"//Geant4.10
 //____________________________________________________________________
-NEBULASD::NEBULASD(G4String name) : G4VSensitiveDetector(name)
+NEBULASD::NEBULASD(G4String name)
+  : G4VSensitiveDetector(name), fSimDataArray("NEBULASimHit"),
+    fModuleDataArray("NEBULAModuleData"), fAccumulate(false)
 {;}
 //____________________________________________________________________
 NEBULASD::~NEBULASD()
 {;}
 //____________________________________________________________________
 void NEBULASD::Initialize(G4HCofThisEvent* /*HCTE*/)
-{;}
+{
+  fSimDataArray.Refresh();
+  fModuleDataArray.Refresh();
+  SimModuleDataInitializer* initializer = (SimModuleDataInitializer*)SimDataManager::GetSimDataManager()
+    ->FindInitializer("NEBULAModuleDataInitializer");
+  fAccumulate = fModuleDataArray && initializer && initializer->GetAccumulate();
+  fModules.Reset();
+}
 //____________________________________________________________________
 G4bool NEBULASD::ProcessHits(G4Step* aStep, G4TouchableHistory* /*ROhist*/)
 {
-  SimDataManager *sman = SimDataManager::GetSimDataManager();
-  TClonesArray *SimDataArray = sman->FindSimDataArray("NEBULASimData");
-  if(SimDataArray==0) return true;
+  if(!fSimDataArray && !fAccumulate) return true;
 
 
   G4StepPoint* preStepPoint = aStep->GetPreStepPoint();
@@ -53,24 +64,24 @@ G4bool NEBULASD::ProcessHits(G4Step* aStep, G4TouchableHistory* /*ROhist*/)
   G4int parentid = aStep->GetTrack()->GetParentID();
   G4int trackid = aStep->GetTrack()->GetTrackID();
   G4int stepno = aStep->GetTrack()->GetCurrentStepNumber();
-  TString particleName(particleDefinition->GetParticleName().data());
-  TString processName;
-  if(postProcess) processName = postProcess->GetProcessName().data();
 
   G4TouchableHistory* theTouchable = (G4TouchableHistory*)(preStepPoint->GetTouchable());
-  std::vector<Int_t> moduleID;
-  for(G4int i=0; i<theTouchable->GetHistoryDepth(); ++i){
-    G4int depth = i;//0:self, 1:mother, 2:grandmother, ....
-    moduleID.push_back(theTouchable->GetCopyNumber(depth));
-  }
   G4VPhysicalVolume* physicalVolume = theTouchable->GetVolume(0); // 0: depth
-  const G4String& moduleName = physicalVolume->GetName();
 
   if((energyDeposit_MeV>0.) && (aStep->GetTrack()->GetDefinition()->GetPDGCharge() != 0.)){
 
-    Int_t nstep = SimDataArray->GetEntriesFast();
-    new ((*SimDataArray)[nstep]) TSimData;
-    TSimData* data = (TSimData*)SimDataArray->At(nstep);
+    if(fAccumulate){
+      const Double_t preKineticEnergy_MeV = preStepPoint->GetKineticEnergy()/MeV;
+      const Double_t pos[3] = {prePosition.x()/mm, prePosition.y()/mm, prePosition.z()/mm};
+      fModules.Add(theTouchable->GetCopyNumber(0), energyDeposit_MeV,
+		   NEBULAQuenching::Light(preKineticEnergy_MeV, preKineticEnergy_MeV - energyDeposit_MeV,
+					  dynamicParticle->GetPDGcode()),
+		   preStepPoint->GetGlobalTime()/ns, pos);
+      return true;
+    }
+    if(!fSimDataArray) return true;
+
+    TSimHit* data = fSimDataArray.Append();
 
     //data->fPrimaryParticleID = parentid - 1;
     data->fParentID = parentid;
@@ -79,39 +90,34 @@ G4bool NEBULASD::ProcessHits(G4Step* aStep, G4TouchableHistory* /*ROhist*/)
     data->fZ = particleDefinition->GetAtomicNumber();
     data->fA = particleDefinition->GetAtomicMass();
     data->fPDGCode = dynamicParticle->GetPDGcode();
-    data->fModuleID = moduleID;
+    data->fNModuleID = std::min<G4int>(theTouchable->GetHistoryDepth(), TSimHit::kMaxModuleDepth);
+    for(G4int depth=0; depth<data->fNModuleID; ++depth){//0:self, 1:mother, 2:grandmother, ....
+      data->fModuleID[depth] = theTouchable->GetCopyNumber(depth);
+    }
     data->fID = theTouchable->GetCopyNumber(0);
-    data->fParticleName = particleName;
-    data->fDetectorName = SensitiveDetectorName;
-    data->fModuleName = moduleName;
-    data->fProcessName = processName;
+    data->fParticleNameID = fNames.Get(particleDefinition, particleDefinition->GetParticleName().data());
+    data->fDetectorNameID = fNames.Get(this, SensitiveDetectorName.data());
+    data->fModuleNameID = fNames.Get(physicalVolume, physicalVolume->GetName().data());
+    data->fProcessNameID = postProcess ? fNames.Get(postProcess, postProcess->GetProcessName().data()) : -1;
     data->fCharge = particleDefinition->GetPDGCharge()/eplus;
-    data->fMass = particleDefinition->GetPDGMass()/MeV;
+    data->fMass = mass_MeV;
     data->fPreKineticEnergy  = preStepPoint->GetKineticEnergy()/MeV;
     data->fPostKineticEnergy = postStepPoint->GetKineticEnergy()/MeV;
-    data->fPrePosition.SetXYZ(prePosition.x()/mm,
-			     prePosition.y()/mm,
-			     prePosition.z()/mm);
-    data->fPostPosition.SetXYZ(postPosition.x()/mm,
-			      postPosition.y()/mm,
-			      postPosition.z()/mm);
-    data->fPreMomentum.SetPxPyPzE(preMomentum.x()/MeV,
-				 preMomentum.y()/MeV,
-				 preMomentum.z()/MeV,
-				 data->fPreKineticEnergy + mass_MeV);
-    data->fPostMomentum.SetPxPyPzE(postMomentum.x()/MeV,
-				  postMomentum.y()/MeV,
-				  postMomentum.z()/MeV,
-				  data->fPostKineticEnergy + mass_MeV);
+    for(G4int i=0; i<3; ++i){
+      data->fPrePosition[i]  = prePosition[i]/mm;
+      data->fPostPosition[i] = postPosition[i]/mm;
+      data->fPreMomentum[i]  = preMomentum[i]/MeV;
+      data->fPostMomentum[i] = postMomentum[i]/MeV;
+    }
     data->fEnergyDeposit = energyDeposit_MeV;
     data->fPreTime  = preStepPoint->GetGlobalTime()/ns;
     data->fPostTime = postStepPoint->GetGlobalTime()/ns;
     data->fIsAccepted = kTRUE;
 
 #ifdef DEBUG
-    if(SimDataArray){
-      G4cout << "NEBULA_array size="<<SimDataArray->GetEntries()
-	     << " data :"  << *data << G4endl;
+    if(fSimDataArray){
+      G4cout << "NEBULA_array size="<<fSimDataArray.GetArray()->GetEntries()
+	     << " particle :"  << particleDefinition->GetParticleName() << G4endl;
     }
 #endif
   }
@@ -120,6 +126,8 @@ G4bool NEBULASD::ProcessHits(G4Step* aStep, G4TouchableHistory* /*ROhist*/)
 }
 //____________________________________________________________________
 void NEBULASD::EndOfEvent(G4HCofThisEvent* /*HCTE*/)
-{;}
+{
+  if(fAccumulate) fModules.Flush(fModuleDataArray.GetArray());
+}
 //____________________________________________________________________
 
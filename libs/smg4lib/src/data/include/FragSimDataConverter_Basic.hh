@@ -9,6 +9,7 @@ class TString;
 class TVector3;
 class TTree;
 class TClonesArray;
+class TSimNameTable;
 
 class FragSimDataConverter_Basic : public SimDataConverter
 {
@@ -23,7 +24,9 @@ public:
 
 private:
   TFragSimParameter *fFragSimParameter;
-  TClonesArray *fFragSimDataArray;
+  TClonesArray *fFragSimDataArray;// FragSimHit
+  TSimNameTable *fNameTable;
+  Int_t fTargetNameID, fPDCNameID;
 
   Double_t fTargetX, fTargetY, fTargetTheta, fTargetPhi, fTargetEnergy;
   Double_t fPDC1U, fPDC1X, fPDC1V, fPDC2U, fPDC2X, fPDC2V;
@@ -0,0 +1,22 @@
+#ifndef NEBULAQUENCHING_HH
+#define NEBULAQUENCHING_HH
+
+#include "Rtypes.h"
+
+// [EN] Light output of the NEBULA plastic scintillator, D. Fox et al., NIM A374 (1996) 63, keyed by PDG code.
+//      Same coefficients and fallbacks as the name-based NEBULASimDataConverter_TArtNEBULAPla::MeVeeRelation_FOX,
+//      but with no string comparison, so it can run per step inside the sensitive detectors.
+// [CN] NEBULA 塑料闪烁体光输出（D. Fox et al., NIM A374 (1996) 63），按 PDG 码查表。系数与兜底规则同
+//      按名字比较的 NEBULASimDataConverter_TArtNEBULAPla::MeVeeRelation_FOX，但不做字符串比较，可在灵敏探测器中逐步调用。
+class NEBULAQuenching
+{
+public:
+  // [EN] Fit coefficients a1..a4 for `pdgcode`. / [CN] pdgcode 对应的拟合系数 a1..a4。
+  static const Double_t* Coefficients(Int_t pdgcode);
+  // [EN] Electron-equivalent energy (MeVee) for kinetic energy T (MeV). / [CN] 动能 T（MeV）对应的电子等效能量（MeVee）。
+  static Double_t Relation(Double_t T, Int_t pdgcode);
+  // [EN] Light of a step from Tin to Tout (MeV), never negative. / [CN] 从 Tin 到 Tout（MeV）一步的光输出，不为负。
+  static Double_t Light(Double_t Tin, Double_t Tout, Int_t pdgcode);
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef _RANDOMSTREAMS_HH_
+#define _RANDOMSTREAMS_HH_
+
+#include "TRandom.h"
+
+#include <cstdint>
+
+// [EN] Counter-based generator (Philox4x32-10, Salmon et al., SC'11). The whole state is a 64-bit key plus a
+//      block counter, so selecting a stream is two stores instead of a Mersenne-Twister seeding pass, and
+//      streams with different keys are statistically independent. Derives from TRandom so Gaus(), Uniform()
+//      etc. work unchanged wherever a TRandom* is accepted (e.g. PDCSimAna::SetRandomGenerator()).
+// [CN] 基于计数器的随机数发生器（Philox4x32-10）。全部状态为 64 位密钥加块计数器，切换流只需两次赋值，
+//      无需梅森旋转的播种过程；不同密钥的流统计独立。继承自 TRandom，凡接受 TRandom* 之处可直接使用 Gaus()、Uniform() 等。
+class PhiloxRandom : public TRandom
+{
+public:
+  explicit PhiloxRandom(std::uint64_t key = 0);
+  ~PhiloxRandom() override;
+
+  // [EN] Selects the stream and rewinds it to its first number. / [CN] 选择流并回到该流的第一个数。
+  void SetKey(std::uint64_t key);
+  std::uint64_t GetKey() const { return fKey; }
+
+  // [EN] Next raw 32-bit word of the stream. / [CN] 流中的下一个 32 位原始值。
+  std::uint32_t NextUInt32();
+
+  // [EN] Uniform in (0, 1) with 53-bit resolution; never returns 0 or 1. / [CN] (0, 1) 内均匀分布，53 位精度，不会返回 0 或 1。
+  Double_t Rndm() override;
+  void RndmArray(Int_t n, Float_t* array) override;
+  void RndmArray(Int_t n, Double_t* array) override;
+  void SetSeed(ULong_t seed = 0) override { SetKey(seed); }
+  UInt_t GetSeed() const override { return static_cast<UInt_t>(fKey); }
+
+  // [EN] One Philox4x32-10 block; exposed for known-answer tests. / [CN] 单个 Philox4x32-10 块，供已知答案测试使用。
+  static void Block(const std::uint32_t counter[4], const std::uint32_t key[2], std::uint32_t out[4]);
+
+private:
+  std::uint64_t fKey;
+  std::uint64_t fCounter;
+  std::uint32_t fBuffer[4];
+  int fNext;
+};
+
+// [EN] Hands out reproducible streams keyed by (run seed, event ID, stream name). A given event and stream
+//      always draws the same numbers, whichever thread, chunk or processing order handles the event, and
+//      distinct names ("PDC", "NEBULA/time", ...) never share a sequence. Value type: copy it into workers.
+// [CN] 按 (运行种子, 事件号, 流名) 分配可复现的随机流。同一事件同一流总是得到相同的随机数，与处理线程、
+//      分块和处理顺序无关；不同名称（"PDC"、"NEBULA/time" 等）互不共享序列。值类型，可直接复制到各 worker。
+class RandomStreams
+{
+public:
+  explicit RandomStreams(std::uint64_t run_seed = 0) : fRunSeed(run_seed) {}
+
+  void SetRunSeed(std::uint64_t run_seed) { fRunSeed = run_seed; }
+  std::uint64_t GetRunSeed() const { return fRunSeed; }
+
+  std::uint64_t StreamKey(std::int64_t event_id, const char* stream) const;
+  void Attach(PhiloxRandom& rng, std::int64_t event_id, const char* stream) const
+  {
+    rng.SetKey(StreamKey(event_id, stream));
+  }
+
+  // [EN] Independent streams for a sub-run (e.g. one input file of a directory job) under the same run seed.
+  // [CN] 同一运行种子下子运行（如目录任务中的单个输入文件）的独立随机流。
+  RandomStreams ForSubRun(std::uint64_t sub_run) const;
+
+  // [EN] splitmix64 finaliser; also used to fold foreign seeds (CLHEP, run IDs) into a run seed.
+  // [CN] splitmix64 终混函数，也用于把外部种子（CLHEP、运行号）折叠为运行种子。
+  static std::uint64_t Mix(std::uint64_t a, std::uint64_t b);
+  static std::uint64_t HashName(const char* name);
+
+private:
+  std::uint64_t fRunSeed;
+};
+
+#endif
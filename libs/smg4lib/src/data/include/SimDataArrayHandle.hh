@@ -0,0 +1,69 @@
+#ifndef SIMDATAARRAYHANDLE_HH
+#define SIMDATAARRAYHANDLE_HH
+
+#include "SimDataManager.hh"
+
+#include "TSimNameTable.hh"
+
+#include "TClonesArray.h"
+#include "TString.h"
+
+#include <unordered_map>
+
+// [EN] Cached, typed handle of one simulation-data array of this thread's SimDataManager. Refresh() once per
+//      event (e.g. in G4VSensitiveDetector::Initialize) re-resolves the array only when SimDataManager::Initialize()
+//      has run since the last lookup, so ProcessHits() appends without any name lookup.
+// [CN] 本线程 SimDataManager 中某个模拟数据数组的缓存句柄（带元素类型）。每个事件调用一次 Refresh()
+//      （如在 G4VSensitiveDetector::Initialize 中），仅当上次查找后 SimDataManager::Initialize() 运行过时才重新按名查找，
+//      ProcessHits() 追加数据时不再做名字查找。
+template <class T>
+class SimDataArrayHandle
+{
+public:
+  explicit SimDataArrayHandle(TString name)
+    : fName(name), fArray(0), fGeneration(0)
+  {;}
+
+  void Refresh()
+  {
+    SimDataManager *sman = SimDataManager::GetSimDataManager();
+    if (fGeneration==sman->GetSimDataArrayGeneration()) return;
+    fArray = sman->FindSimDataArray(fName);
+    fGeneration = sman->GetSimDataArrayGeneration();
+  }
+
+  explicit operator bool() const {return fArray!=0;}
+  TClonesArray* GetArray() const {return fArray;}
+  const TString& GetName() const {return fName;}
+
+  // [EN] Constructs a new element at the end of the array. / [CN] 在数组末尾构造一个新元素。
+  T* Append(){return new ((*fArray)[fArray->GetEntriesFast()]) T;}
+
+private:
+  TString       fName;
+  TClonesArray* fArray;
+  unsigned long fGeneration;
+};
+
+// [EN] Per-SD cache from a Geant4 object (particle definition, volume, process) to its ID in the
+//      TSimNameTable, so each name is interned once instead of being copied into every hit. The table only
+//      grows during a job, so cached IDs stay valid across runs.
+// [CN] 每个 SD 的缓存：Geant4 对象（粒子定义、体积、过程）到 TSimNameTable 中 ID 的映射，
+//      每个名字只登记一次，而不是复制到每个击中里。名字表在整个作业中只增不减，缓存的 ID 跨 run 有效。
+class SimNameCache
+{
+public:
+  Int_t Get(const void* key, const char* name)
+  {
+    std::unordered_map<const void*,Int_t>::const_iterator it = fIDs.find(key);
+    if (it!=fIDs.end()) return it->second;
+    Int_t id = SimDataManager::GetSimDataManager()->GetNameTable()->Intern(name);
+    fIDs[key] = id;
+    return id;
+  }
+
+private:
+  std::unordered_map<const void*,Int_t> fIDs;
+};
+
+#endif
@@ -28,6 +28,9 @@ public:
   void SetDataStore(bool tf){fDataStore = tf;}
   bool GetDataStore(){return fDataStore;}
 
+  // called in SimDataManager::Initialize on worker threads, from the master's instance of the same name
+  virtual void CopySettings(SimDataConverter& master){fDataStore = master.GetDataStore();}
+
 protected:
   TString fName;
   bool fDataStore;
@@ -4,6 +4,7 @@
 #include <vector>
 #include <map>
 #include "TString.h"
+#include "RandomStreams.hh"
 
 class SimDataInitializer;
 class SimDataConverter;
@@ -11,16 +12,27 @@ class TSimParameter;
 class TFile;
 class TTree;
 class TClonesArray;
+class TSimNameTable;
 
+// [EN] One instance per thread. The first instance (created on the main / Geant4 master thread) is the
+//      master: it owns the parameters set by macros, and worker instances fall back to it in FindParameter().
+//      Workers register their own initializers/converters, so sensitive-detector arrays and trees are per thread.
+// [CN] 每个线程一个实例。第一个实例（在主线程 / Geant4 master 线程上创建）为 master：持有宏命令设置的参数，
+//      worker 实例在 FindParameter() 中回退到 master。worker 注册各自的 initializer/converter，
+//      因此灵敏探测器数组和 tree 都按线程独立。
 class SimDataManager
 {
 public:
-  static SimDataManager* GetSimDataManager();// singleton
+  static SimDataManager* GetSimDataManager();// singleton per thread
+  static SimDataManager* GetMasterSimDataManager(){return fMasterSimDataManager;}
+  bool IsMaster() const {return this==fMasterSimDataManager;}
   virtual ~SimDataManager();
 
   void RegistInitializer(SimDataInitializer* initializer);
   void RegistConverter(SimDataConverter* converter);
   int  Initialize();
+  // [EN] Writes "event_id" (G4 event number, set per event by EventActionBasic) plus every initializer and converter branch.
+  // [CN] 写出 "event_id"（G4 事件号，由 EventActionBasic 逐事件设置）以及全部 initializer 与 converter 的分支。
   int  DefineBranch(TTree *tree);
   int  RemoveParameters(TFile* file);
   int  ClearBuffer();
@@ -30,10 +42,15 @@ public:
 
   void AddParameter(TSimParameter* prm);
   void AddParameters(TFile *file);
+  // [EN] Looks up this thread's parameters first, then the master's (read-only during a run).
+  // [CN] 先查本线程参数，再查 master 的参数（运行期间只读）。
   TSimParameter* FindParameter(TString name);
   SimDataInitializer* FindInitializer(TString name);
   SimDataConverter* FindConverter(TString name);
   TClonesArray* FindSimDataArray(TString name);
+  // [EN] Bumped by every Initialize(); SimDataArrayHandle re-resolves its array when this changes.
+  // [CN] 每次 Initialize() 都会递增；SimDataArrayHandle 在其变化时重新查找数组。
+  unsigned long GetSimDataArrayGeneration() const {return fSimDataArrayGeneration;}
   void  PrintParameters();
   void  PrintInitializers();
   void  PrintConverters();
@@ -42,14 +59,42 @@ public:
   TString GetHeader(){return fHeader;}
   void ClearHeader(){fHeader=" ";}
 
+  // [EN] Per-event random streams for converters: EventActionBasic sets the event ID before ConvertSimData(),
+  //      RunActionBasic sets the run seed, and converters draw from GetRandomStreams().Attach(rng, GetEventID(), name).
+  // [CN] 供 converter 使用的逐事件随机流：EventActionBasic 在 ConvertSimData() 前设置事件号，RunActionBasic 设置运行种子，
+  //      converter 通过 GetRandomStreams().Attach(rng, GetEventID(), name) 取数。
+  RandomStreams& GetRandomStreams(){return fRandomStreams;}
+  void SetEventID(Long64_t id){fEventID = id;}
+  Long64_t GetEventID() const {return fEventID;}
+
+  // [EN] Output tree of this thread, created by RunActionBasic and filled by EventActionBasic.
+  // [CN] 本线程的输出 tree，由 RunActionBasic 创建、EventActionBasic 填充。
+  void SetTree(TTree* tree){fTree = tree;}
+  TTree* GetTree(){return fTree;}
+
+  // [EN] Names referenced by TSimHit; a single table owned by the master and shared by every thread.
+  // [CN] TSimHit 引用的名字表；由 master 持有、所有线程共享的同一张表。
+  TSimNameTable* GetNameTable();
+  // [EN] true: store TSimHit + SimNameTable instead of expanding hits into the legacy TSimData branches.
+  // [CN] true：直接保存 TSimHit 与 SimNameTable，不再展开为旧的 TSimData 分支。
+  void SetCompactHits(bool tf){fCompactHits = tf;}
+  bool GetCompactHits() const;
+
 protected:
-  static SimDataManager* fSimDataManager;
+  static thread_local SimDataManager* fSimDataManager;
+  static SimDataManager* fMasterSimDataManager;
   std::vector<SimDataInitializer*> fInitializerArray;
   std::vector<SimDataConverter*> fConverterArray;
   std::map<TString,TSimParameter*> fParameterMap;
   std::map<TString,TClonesArray*> fSimDataArrayPointers;
+  unsigned long fSimDataArrayGeneration;
 
   TString fHeader;
+  RandomStreams fRandomStreams;
+  Long64_t fEventID;
+  TTree* fTree;
+  TSimNameTable* fNameTable;
+  bool fCompactHits;
 
 private:
   SimDataManager();
@@ -0,0 +1,37 @@
+#ifndef SIMHITRETENTION_HH
+#define SIMHITRETENTION_HH
+
+#include "Rtypes.h"
+
+#include <vector>
+
+class TClonesArray;
+
+// [EN] How much of the step-level TSimHit data is written (TRunSimParameter::fRetention). Only the stored branch is
+//      reduced: converters run before and always see every step.
+//        kSteps     every step (default)
+//        kEndpoints first and last step of each track in each detector copy (detector name, module name, fID and
+//                   the fModuleID chain, so e.g. the U/X/V layers of a PDC stay separate)
+//        kSummary   one record per detector copy: pre-step state of the earliest step, post-step state of the
+//                   latest, energy deposit and flight length summed
+// [CN] 步级 TSimHit 数据的保留程度（TRunSimParameter::fRetention）。只精简存盘分支，converter 在此之前运行，始终看到全部步。
+//        kSteps     全部步（默认）
+//        kEndpoints 每条径迹在每个探测器拷贝（探测器名、模块名、fID 与 fModuleID 链，如 PDC 的 U/X/V 层各自独立）中的首末两步
+//        kSummary   每个探测器拷贝一条记录：最早一步的步前状态、最晚一步的步后状态，能量沉积与飞行长度求和
+class SimHitRetention
+{
+public:
+  enum Level { kSteps = 0, kEndpoints = 1, kSummary = 2 };
+
+  // [EN] "steps", "endpoints" or "summary"; anything else is kSteps. / [CN] "steps"、"endpoints" 或 "summary"，其他值视为 kSteps。
+  static Level Parse(const char* name);
+  static const char* Name(Level level);
+
+  // [EN] Appends the retained hits of `hits` to `out`, keeping their original order. / [CN] 将 hits 中保留的击中按原顺序追加到 out。
+  void Reduce(const TClonesArray* hits, Level level, TClonesArray* out);
+
+private:
+  std::vector<Int_t> fOrder;  // scratch, reused between events
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef SIMMODULEDATAINITIALIZER_HH
+#define SIMMODULEDATAINITIALIZER_HH
+
+#include "SimDataInitializer.hh"
+
+class TFile;
+class TTree;
+
+// [EN] Optional per-module accumulation of a segmented detector ("<prefix>ModuleData", TClonesArray<TSimModuleData>).
+//      When SetAccumulate(true), the sensitive detector sums each module in a SimModuleAccumulator and stores no
+//      steps; the converters then read the module summaries instead of "<prefix>SimHit".
+// [CN] 分段探测器可选的逐模块累加（"<prefix>ModuleData"，TClonesArray<TSimModuleData>）。SetAccumulate(true) 时
+//      灵敏探测器在 SimModuleAccumulator 中按模块求和、不保存步数据；converter 改为读取模块汇总而非 "<prefix>SimHit"。
+class SimModuleDataInitializer : public SimDataInitializer
+{
+public:
+  SimModuleDataInitializer(TString name, TString prefix);
+  virtual ~SimModuleDataInitializer();
+
+  // called in RunActionBasic
+  virtual int Initialize();
+  virtual int DefineBranch(TTree* tree);
+  virtual int AddParameters(TFile* file);
+  virtual int RemoveParameters(TFile* file);
+  virtual int PrintParameters(TFile* file);
+
+  // called in EventActionBasic
+  virtual int ClearBuffer();
+
+  void SetAccumulate(bool tf){fAccumulate = tf;}
+  bool GetAccumulate() const {return fAccumulate;}
+
+  virtual void CopySettings(SimDataInitializer& master){
+    SimDataInitializer::CopySettings(master);
+    fAccumulate = static_cast<SimModuleDataInitializer&>(master).fAccumulate;
+  }
+
+protected:
+  TString fPrefix;
+  bool    fAccumulate;
+};
+
+#endif
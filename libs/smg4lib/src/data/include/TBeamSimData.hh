@@ -9,7 +9,8 @@
 
 class TBeamSimData;
 typedef std::vector<TBeamSimData> TBeamSimDataArray;
-extern TBeamSimDataArray* gBeamSimDataArray;
+// [EN] Per thread: each Geant4 worker generates and stores its own primaries. / [CN] 按线程：每个 Geant4 worker 各自生成并保存初级粒子。
+extern thread_local TBeamSimDataArray* gBeamSimDataArray;
 
 class TBeamSimData : public TObject
 {
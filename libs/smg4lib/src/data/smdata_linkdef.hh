@@ -11,5 +11,8 @@
 #pragma link C++ class TArtNEBULAPlusPla+;
 #pragma link C++ class TRunSimParameter+;
 #pragma link C++ class TSimData+;
+#pragma link C++ class TSimHit+;
+#pragma link C++ class TSimModuleData+;
+#pragma link C++ class TSimNameTable+;
 #pragma link C++ class TSimParameter+;
 #endif
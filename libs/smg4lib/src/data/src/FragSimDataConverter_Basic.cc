@@ -1,7 +1,8 @@
 #include "FragSimDataConverter_Basic.hh"
 
 #include "SimDataManager.hh"
-#include "TSimData.hh"
+#include "TSimHit.hh"
+#include "TSimNameTable.hh"
 
 #include "TTree.h"
 #include "TClonesArray.h"
@@ -32,13 +33,17 @@ int FragSimDataConverter_Basic::Initialize()
     return 1;
   }
 
-  fFragSimDataArray = sman->FindSimDataArray("FragSimData");
+  fFragSimDataArray = sman->FindSimDataArray("FragSimHit");
   if (fFragSimDataArray==0){
-    std::cout<<"FragSimDataConveter_Basic : FragSimDataArray is not found."
+    std::cout<<"FragSimDataConveter_Basic : FragSimHitArray is not found."
 	     <<std::endl;
     return 1;
   }
 
+  fNameTable = sman->GetNameTable();
+  fTargetNameID = fNameTable->Intern("Target");
+  fPDCNameID = fNameTable->Intern("PDC");
+
   return 0;
 }
 //____________________________________________________________________
@@ -93,22 +98,22 @@ int FragSimDataConverter_Basic::ConvertSimData()
   set<Int_t> trackIDs;
 
   for (int i=0;i<ndata;++i){
-    auto data = (TSimData*)fFragSimDataArray->At(i);
+    auto data = (TSimHit*)fFragSimDataArray->At(i);
 
-    if (data->fDetectorName=="Target"){
+    if (data->fDetectorNameID==fTargetNameID){
 
       if (stepno_target_in == -1 || data->fStepNo < stepno_target_in){
         stepno_target_in = data->fStepNo;
-        pos_target_in = data->fPrePosition - pos_target;
-        mom_target_in = data->fPreMomentum;
+        pos_target_in = data->GetPrePosition() - pos_target;
+        mom_target_in = data->GetPreMomentum();
         pos_target_in.RotateY(ang_target); // Change to target frame
         mom_target_in.RotateY(ang_target);
       }
     }
-    else if (data->fDetectorName=="PDC"){
+    else if (data->fDetectorNameID==fPDCNameID){
 
       trackIDs.insert(data->fTrackID);
-      TString layer = data->fModuleName;        // "U", "X" or "V"
+      TString layer = fNameTable->GetEntry(data->fModuleNameID);// "U", "X" or "V"
       auto& stepNo = stepNos[data->fID][layer]; // fID: 0 for PDC1, 1 for PDC2
       auto& position = positions[data->fID][layer];
 
@@ -116,15 +121,15 @@ int FragSimDataConverter_Basic::ConvertSimData()
       // Note: if `layer` was not hit, `stepNo` would be initialized as {0,0}.
       if (stepNo[0] == 0 && stepNo[1] == 0) {
         stepNo = {data->fStepNo, data->fStepNo};
-        position = {data->fPrePosition, data->fPostPosition};
+        position = {data->GetPrePosition(), data->GetPostPosition()};
       }
       else if (data->fStepNo < stepNo[0]) {
         stepNo[0] = data->fStepNo;
-        position[0] = data->fPrePosition;
+        position[0] = data->GetPrePosition();
       }
       else if (data->fStepNo > stepNo[1]) {
         stepNo[1] = data->fStepNo;
-        position[1] = data->fPostPosition;
+        position[1] = data->GetPostPosition();
       }
     }
   }
@@ -0,0 +1,139 @@
+#include "NEBULADigitizer.hh"
+
+#include "TNEBULASimParameter.hh"
+#include "TNEBULAPlusSimParameter.hh"
+#include "TDetectorSimParameter.hh"
+
+#include "TRandom.h"
+
+#include <algorithm>
+#include <cmath>
+
+//____________________________________________________________________
+template <typename Parameter, typename Map>
+void NEBULADigitizer::BuildTable(const Parameter& prm, const Map& modules)
+{
+  fModules.clear();
+  if (!modules.empty()) fModules.resize(std::max(0, modules.rbegin()->first) + 1, Module());
+
+  for (const auto& [id, det] : modules){
+    if (id < 0) continue;
+    Module& m = fModules[id];
+    m.valid = true;
+    m.layer = det.fLayer;
+    m.sublayer = det.fSubLayer;
+    m.name = det.GetName();
+    m.det_pos[0] = det.fPosition.x() + prm.fPosition.x();
+    m.det_pos[1] = det.fPosition.y() + prm.fPosition.y();
+    m.det_pos[2] = det.fPosition.z() + prm.fPosition.z();
+    m.module_y = det.fPosition.y();
+    m.system_y = prm.fPosition.y();
+    // anything but "Veto" is a neutron bar; the converters left such types undefined
+    const Bool_t veto = det.fDetectorType == "Veto";
+    m.ysize = veto ? prm.fVetoSize.y() : prm.fNeutSize.y();
+    m.att_len = veto ? prm.fAttLen_Veto : prm.fAttLen_Neut;
+  }
+  fTimeReso = prm.fTimeReso;
+  fV_scinti = prm.fV_scinti;
+  Reset();
+}
+//____________________________________________________________________
+void NEBULADigitizer::Build(const TNEBULASimParameter& prm)
+{
+  BuildTable(prm, prm.fNEBULADetectorParameterMap);
+}
+//____________________________________________________________________
+void NEBULADigitizer::Build(const TNEBULAPlusSimParameter& prm)
+{
+  BuildTable(prm, prm.fNEBULAPlusDetectorParameterMap);
+}
+//____________________________________________________________________
+NEBULADigitizer::Sum* NEBULADigitizer::Slot(Int_t id)
+{
+  if (id < 0) return nullptr;
+  if (id >= (Int_t)fSums.size()) fSums.resize(id+1, Sum());
+  Sum* s = &fSums[id];
+  if (s->nsteps==0) fTouched.push_back(id);
+  return s;
+}
+//____________________________________________________________________
+void NEBULADigitizer::Add(Int_t id, Double_t edep, Double_t light, Double_t time, const Double_t pos[3])
+{
+  Sum* s = Slot(id);
+  if (!s) return;
+  if (s->nsteps==0 || time < s->time){
+    s->time = time;
+    for (int i=0;i<3;++i) s->pos[i] = pos[i];
+  }
+  ++s->nsteps;
+  s->edep += edep;
+  s->light += light;
+}
+//____________________________________________________________________
+void NEBULADigitizer::SetModule(Int_t id, Double_t edep, Double_t light, Double_t time, const Double_t pos[3])
+{
+  Sum* s = Slot(id);
+  if (!s) return;
+  s->nsteps = 1;
+  s->edep = edep;
+  s->light = light;
+  s->time = time;
+  for (int i=0;i<3;++i) s->pos[i] = pos[i];
+}
+//____________________________________________________________________
+const std::vector<NEBULADigitizer::Output>& NEBULADigitizer::Digitize(TRandom& rng, Bool_t resolution)
+{
+  fOutputs.clear();
+  fUnknownIDs.clear();
+  std::sort(fTouched.begin(), fTouched.end());
+
+  for (Int_t id : fTouched){
+    const Sum& s = fSums[id];
+    const Module* m = GetModule(id);
+    if (!m){
+      fUnknownIDs.push_back(id);
+      continue;
+    }
+
+    fOutputs.push_back(Output());
+    Output& out = fOutputs.back();
+    out.id = id;
+    out.module = m;
+
+    if (resolution){
+      // Same expressions, in the same order, as the map-based converters
+      const Double_t Ysiz = m->ysize;
+      const Double_t V_scinti = fV_scinti;
+      Double_t y_at_detec = s.pos[1] - m->det_pos[1];
+      Double_t dy_u = 0.5 * Ysiz - y_at_detec;
+      Double_t dy_d = 0.5 * Ysiz + y_at_detec;
+
+      Double_t tu = s.time + dy_u / V_scinti;
+      Double_t td = s.time + dy_d / V_scinti;
+      tu += rng.Gaus(0, fTimeReso);
+      td += rng.Gaus(0, fTimeReso);
+      Double_t dt = td - tu;
+
+      out.t  = 0.5 * (tu + td) - 0.5 * Ysiz / V_scinti;
+      out.qu = s.light * exp(-dy_u / m->att_len);
+      out.qd = s.light * exp(-dy_d / m->att_len);
+      out.q  = sqrt(out.qu * out.qd) * exp(0.5 * Ysiz / m->att_len);
+      out.pos[0] = m->det_pos[0];
+      out.pos[1] = 0.5 * dt * V_scinti + m->module_y + m->system_y;
+      out.pos[2] = m->det_pos[2];
+    }else{
+      out.t  = s.time;
+      out.qu = out.qd = out.q = s.edep;
+      for (int i=0;i<3;++i) out.pos[i] = s.pos[i];
+    }
+  }
+  Reset();
+  return fOutputs;
+}
+//____________________________________________________________________
+void NEBULADigitizer::Reset()
+{
+  for (Int_t id : fTouched) fSums[id] = Sum();
+  fTouched.clear();
+}
+//____________________________________________________________________
@@ -1,8 +1,13 @@
+#define SM_LOG_MODULE "NEBULAPlus"
 #include "NEBULAPlusSimDataConverter_TArtNEBULAPlusPla.hh"
 
 //#include "TNEBULAPlusSimData.hh"
 #include "NeutronDetectorSimConfig.hh"
-#include "TSimData.hh"
+#include "TSimHit.hh"
+#include "TSimNameTable.hh"
+#include "TSimModuleData.hh"
+#include "NEBULAQuenching.hh"
+#include "SimModuleDataInitializer.hh"
 #include "TNEBULAPlusSimParameter.hh"
 #include "SimDataManager.hh"
 #include "SimDataInitializer.hh"
@@ -12,16 +17,20 @@
 
 #include "TTree.h"
 #include "TClonesArray.h"
-#include "TRandom.h"
 
 #include <iostream>
+
+#include "SMLogger.hh"
+
 //____________________________________________________________________
 NEBULAPlusSimDataConverter_TArtNEBULAPlusPla::NEBULAPlusSimDataConverter_TArtNEBULAPlusPla(TString name)
     : SimDataConverter(name),
       fIncludeResolution(true),
       fDetectorEnabled(false),
+      fFastDigitizer(false),
       fNEBULAPlusSimParameter(nullptr),
       fNEBULAPlusSimDataArray(nullptr),
+      fNEBULAPlusModuleDataArray(nullptr),
       fNEBULAPlusPlaArray(nullptr)
 {
 }
@@ -53,7 +62,7 @@ int NEBULAPlusSimDataConverter_TArtNEBULAPlusPla::Initialize()
 
   Int_t NumOfDetector = fNEBULAPlusSimParameter->fNeutNum + fNEBULAPlusSimParameter->fVetoNum;
 
-  fNEBULAPlusSimDataArray = sman->FindSimDataArray("NEBULAPlusSimData");
+  fNEBULAPlusSimDataArray = sman->FindSimDataArray("NEBULAPlusSimHit");
   if (fNEBULAPlusSimDataArray == 0)
   {
     std::cout << "NEBULAPlusSimDataConveter_TArtNEBULAPlusPla : NEBULAPlusSimDataArray is not found."
@@ -61,9 +70,16 @@ int NEBULAPlusSimDataConverter_TArtNEBULAPlusPla::Initialize()
     return 1;
   }
 
+  SimModuleDataInitializer *moduleInitializer
+    = (SimModuleDataInitializer*)sman->FindInitializer("NEBULAPlusModuleDataInitializer");
+  fNEBULAPlusModuleDataArray = (moduleInitializer && moduleInitializer->GetAccumulate())
+    ? sman->FindSimDataArray("NEBULAPlusModuleData") : nullptr;
+
   fNEBULAPlusPlaArray = new TClonesArray("TArtNEBULAPlusPla", NumOfDetector);
   fNEBULAPlusPlaArray->SetOwner();
   fNEBULAPlusPlaArray->SetName("NEBULAPlusPla");
+
+  if (fFastDigitizer) fDigitizer.Build(*fNEBULAPlusSimParameter);
   return 0;
 }
 //____________________________________________________________________
@@ -77,24 +93,43 @@ int NEBULAPlusSimDataConverter_TArtNEBULAPlusPla::DefineBranch(TTree *tree)
 int NEBULAPlusSimDataConverter_TArtNEBULAPlusPla::ConvertSimData()
 {
   if (!fDetectorEnabled) return 0;
+  if (fFastDigitizer) return ConvertSimDataFast();
   fDataBufferMap.clear();
 
+  const TSimNameTable* names = SimDataManager::GetSimDataManager()->GetNameTable();
   std::map<int,tmp_data>::iterator it;
-  for (auto&& hit: *fNEBULAPlusSimDataArray)
+  // [EN] Module sums already hold what the step loop below computes. / [CN] 模块汇总已包含下面逐步循环计算的量。
+  if (fNEBULAPlusModuleDataArray)
   {
-    auto simdata = (TSimData*)hit;
-    tmp_data* data = &fDataBufferMap[simdata->fID];
-    data->q += simdata->fEnergyDeposit;
-    data->light += MeVtoMeVee(
-        simdata->fPreKineticEnergy,
-        simdata->fPreKineticEnergy - simdata->fEnergyDeposit,
-        simdata->fParticleName.Data(),
-        simdata->fPDGCode);
-    if (data->id == 0 || simdata->fPreTime < data->t)
-    { // find the earliest hit in each module
-      data->id = simdata->fID;
-      data->t = simdata->fPreTime;
-      data->pos = simdata->fPrePosition;
+    for (auto&& obj: *fNEBULAPlusModuleDataArray)
+    {
+      auto module = (TSimModuleData*)obj;
+      tmp_data* data = &fDataBufferMap[module->fID];
+      data->id = module->fID;
+      data->q = module->fEnergyDeposit;
+      data->light = module->fLight;
+      data->t = module->fFirstTime;
+      data->pos = module->GetFirstPosition();
+    }
+  }
+  else
+  {
+    for (auto&& hit: *fNEBULAPlusSimDataArray)
+    {
+      auto simdata = (TSimHit*)hit;
+      tmp_data* data = &fDataBufferMap[simdata->fID];
+      data->q += simdata->fEnergyDeposit;
+      data->light += MeVtoMeVee(
+          simdata->fPreKineticEnergy,
+          simdata->fPreKineticEnergy - simdata->fEnergyDeposit,
+          names->GetEntry(simdata->fParticleNameID),
+          simdata->fPDGCode);
+      if (data->id == 0 || simdata->fPreTime < data->t)
+      { // find the earliest hit in each module
+        data->id = simdata->fID;
+        data->t = simdata->fPreTime;
+        data->pos = simdata->GetPrePosition();
+      }
     }
   }
 
@@ -105,13 +140,16 @@ int NEBULAPlusSimDataConverter_TArtNEBULAPlusPla::ConvertSimData()
     std::cerr << "NEBULAPlusSimDataConverter_TArtNEBULAPlusPla: NEBULAPlusParameter not found at ConvertSimData(), aborting conversion." << std::endl;
     return 1;
   }
+  // [EN] Same event-keyed stream scheme as the NEBULA converter. / [CN] 与 NEBULA converter 相同的按事件取流方式。
+  sman->GetRandomStreams().Attach(fRandom, sman->GetEventID(), "NEBULAPlus/time");
 
   for (auto&& [ID,data]: fDataBufferMap)
   {
     TDetectorSimParameter *prm = NEBULAPlusParameter->FindDetectorSimParameter(ID);
     if (!prm) {
-      std::cerr << "NEBULAPlusSimDataConverter_TArtNEBULAPlusPla: WARNING - detector parameter for ID=" << ID
-                << " not found. Skipping this ID." << std::endl;
+      // [EN] Repeats every event for the same ID, so only the first few occurrences are printed.
+      // [CN] 同一 ID 每个事件都会重复，只打印前几次。
+      SM_WARN_LIMITED(5, 10000, "NEBULAPlusSimDataConverter_TArtNEBULAPlusPla: detector parameter for ID={} not found. Skipping this ID.", ID);
       // do not attempt to fill pla with invalid prm; continue to next ID
       continue;
     }
@@ -152,8 +190,8 @@ int NEBULAPlusSimDataConverter_TArtNEBULAPlusPla::ConvertSimData()
 
       Double_t tu = data.t + dy_u / V_scinti;
       Double_t td = data.t + dy_d / V_scinti;
-      tu += gRandom->Gaus(0, NEBULAPlusParameter->fTimeReso);
-      td += gRandom->Gaus(0, NEBULAPlusParameter->fTimeReso);
+      tu += fRandom.Gaus(0, NEBULAPlusParameter->fTimeReso);
+      td += fRandom.Gaus(0, NEBULAPlusParameter->fTimeReso);
       Double_t t = 0.5 * (tu + td) - 0.5 * Ysiz / V_scinti;
       Double_t dt = td - tu;
 
@@ -187,9 +225,59 @@ int NEBULAPlusSimDataConverter_TArtNEBULAPlusPla::ConvertSimData()
   return 0;
 }
 //____________________________________________________________________
+int NEBULAPlusSimDataConverter_TArtNEBULAPlusPla::ConvertSimDataFast()
+{
+  SimDataManager *sman = SimDataManager::GetSimDataManager();
+  if (fNEBULAPlusModuleDataArray)
+  {
+    for (auto&& obj: *fNEBULAPlusModuleDataArray)
+    {
+      auto module = (TSimModuleData*)obj;
+      fDigitizer.SetModule(module->fID, module->fEnergyDeposit, module->fLight,
+                           module->fFirstTime, module->fFirstPosition);
+    }
+  }
+  else
+  {
+    // [EN] Light from the PDG code, no name-table lookup. / [CN] 由 PDG 码计算光输出，不查名字表。
+    for (auto&& hit: *fNEBULAPlusSimDataArray)
+    {
+      auto simdata = (TSimHit*)hit;
+      Double_t light = NEBULAQuenching::Light(simdata->fPreKineticEnergy,
+                                              simdata->fPreKineticEnergy - simdata->fEnergyDeposit,
+                                              simdata->fPDGCode);
+      fDigitizer.Add(simdata->fID, simdata->fEnergyDeposit, light, simdata->fPreTime, simdata->fPrePosition);
+    }
+  }
+
+  sman->GetRandomStreams().Attach(fRandom, sman->GetEventID(), "NEBULAPlus/time");
+  const std::vector<NEBULADigitizer::Output>& outputs = fDigitizer.Digitize(fRandom, fIncludeResolution);
+  for (Int_t ID: fDigitizer.GetUnknownIDs())
+    SM_WARN_LIMITED(5, 10000, "NEBULAPlusSimDataConverter_TArtNEBULAPlusPla: detector parameter for ID={} not found. Skipping this ID.", ID);
+
+  for (size_t i=0; i<outputs.size(); ++i)
+  {
+    const NEBULADigitizer::Output& out = outputs[i];
+    TArtNEBULAPlusPla *pla = (TArtNEBULAPlusPla*)fNEBULAPlusPlaArray->ConstructedAt(i);
+    pla->fID       = out.id;
+    pla->fLayer    = out.module->layer;
+    pla->fSubLayer = out.module->sublayer;
+    pla->fPos.SetXYZ(out.pos[0], out.pos[1], out.pos[2]);
+    pla->fTime = out.t;
+    pla->fQU   = out.qu;
+    pla->fQD   = out.qd;
+    pla->fEdep = out.q;
+  }
+  return 0;
+}
+//____________________________________________________________________
 int NEBULAPlusSimDataConverter_TArtNEBULAPlusPla::ClearBuffer()
 {
-  if (fNEBULAPlusPlaArray) fNEBULAPlusPlaArray->Delete();
+  if (fNEBULAPlusPlaArray){
+    // [EN] The fast path reuses the objects through ConstructedAt(). / [CN] 快速路径通过 ConstructedAt() 复用对象。
+    if (fFastDigitizer) fNEBULAPlusPlaArray->Clear("C");
+    else fNEBULAPlusPlaArray->Delete();
+  }
   return 0;
 }
 //____________________________________________________________________
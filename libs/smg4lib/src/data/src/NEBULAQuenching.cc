@@ -0,0 +1,53 @@
+#include "NEBULAQuenching.hh"
+
+#include <cmath>
+
+namespace {
+
+const Double_t kLepton[4]   = {1, 0, 0, 0};
+const Double_t kProton[4]   = {0.902713, 7.55009, 0.0990013, 0.736281};
+const Double_t kDeuteron[4] = {0.891575, 12.2122, 0.0702262, 0.782977};
+const Double_t kTriton[4]   = {0.881489, 15.9064, 0.0564987, 0.811916};
+const Double_t kHe3[4]      = {0.803919, 34.4153, 0.0254322, 0.894859};
+const Double_t kAlpha[4]    = {0.781501, 39.3133, 0.0217115, 0.910333};
+const Double_t kLi7[4]      = {0.613491, 57.1372, 0.0115948, 0.951875};
+const Double_t kBe9[4]      = {0.435772, 45.538, 0.0104221, 0.916373};
+const Double_t kB11[4]      = {0.350273, 34.4664, 0.0112395, 0.912711};
+const Double_t kC12[4]      = {0.298394, 25.5679, 0.0130345, 0.908512};
+
+}  // namespace
+
+//____________________________________________________________________
+const Double_t* NEBULAQuenching::Coefficients(Int_t pdgcode)
+{
+  switch (pdgcode){
+  case 11: case -11: case 13: case -13: return kLepton;
+  case 2212:       return kProton;
+  case 1000010020: return kDeuteron;
+  case 1000010030: return kTriton;
+  case 1000020030: return kHe3;
+  case 1000020040: return kAlpha;
+  default: break;
+  }
+  // other ions by Z (excited states included); everything else falls back to C12
+  switch ((pdgcode - 1000000000)/10000){
+  case 3:  return kLi7;
+  case 4:  return kBe9;
+  case 5:  return kB11;
+  default: return kC12;
+  }
+}
+//____________________________________________________________________
+Double_t NEBULAQuenching::Relation(Double_t T, Int_t pdgcode)
+{
+  const Double_t* a = Coefficients(pdgcode);
+  return a[0]*T - a[1]*(1 - exp(-a[2]*pow(T, a[3])));
+}
+//____________________________________________________________________
+Double_t NEBULAQuenching::Light(Double_t Tin, Double_t Tout, Int_t pdgcode)
+{
+  if (Tout < 0) Tout = 0;
+  Double_t dTe = Relation(Tin, pdgcode) - Relation(Tout, pdgcode);
+  return dTe < 0 ? 0 : dTe;
+}
+//____________________________________________________________________
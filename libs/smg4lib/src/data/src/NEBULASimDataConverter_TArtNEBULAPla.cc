@@ -1,8 +1,13 @@
+#define SM_LOG_MODULE "NEBULA"
 #include "NEBULASimDataConverter_TArtNEBULAPla.hh"
 
 //#include "TNEBULASimData.hh"
 #include "NeutronDetectorSimConfig.hh"
-#include "TSimData.hh"
+#include "TSimHit.hh"
+#include "TSimNameTable.hh"
+#include "TSimModuleData.hh"
+#include "NEBULAQuenching.hh"
+#include "SimModuleDataInitializer.hh"
 #include "TNEBULASimParameter.hh"
 #include "SimDataManager.hh"
 #include "SimDataInitializer.hh"
@@ -12,16 +17,20 @@
 
 #include "TTree.h"
 #include "TClonesArray.h"
-#include "TRandom.h"
 
 #include <iostream>
+
+#include "SMLogger.hh"
+
 //____________________________________________________________________
 NEBULASimDataConverter_TArtNEBULAPla::NEBULASimDataConverter_TArtNEBULAPla(TString name)
     : SimDataConverter(name),
       fIncludeResolution(true),
       fDetectorEnabled(false),
+      fFastDigitizer(false),
       fNEBULASimParameter(nullptr),
       fNEBULASimDataArray(nullptr),
+      fNEBULAModuleDataArray(nullptr),
       fNEBULAPlaArray(nullptr)
 {
 }
@@ -53,7 +62,7 @@ int NEBULASimDataConverter_TArtNEBULAPla::Initialize()
 
   Int_t NumOfDetector = fNEBULASimParameter->fNeutNum + fNEBULASimParameter->fVetoNum;
 
-  fNEBULASimDataArray = sman->FindSimDataArray("NEBULASimData");
+  fNEBULASimDataArray = sman->FindSimDataArray("NEBULASimHit");
   if (fNEBULASimDataArray == 0)
   {
     std::cout << "NEBULASimDataConveter_TArtNEBULAPla : NEBULASimDataArray is not found."
@@ -61,9 +70,16 @@ int NEBULASimDataConverter_TArtNEBULAPla::Initialize()
     return 1;
   }
 
+  SimModuleDataInitializer *moduleInitializer
+    = (SimModuleDataInitializer*)sman->FindInitializer("NEBULAModuleDataInitializer");
+  fNEBULAModuleDataArray = (moduleInitializer && moduleInitializer->GetAccumulate())
+    ? sman->FindSimDataArray("NEBULAModuleData") : nullptr;
+
   fNEBULAPlaArray = new TClonesArray("TArtNEBULAPla", NumOfDetector);
   fNEBULAPlaArray->SetOwner();
   fNEBULAPlaArray->SetName("NEBULAPla");
+
+  if (fFastDigitizer) fDigitizer.Build(*fNEBULASimParameter);
   return 0;
 }
 //____________________________________________________________________
@@ -77,24 +93,43 @@ int NEBULASimDataConverter_TArtNEBULAPla::DefineBranch(TTree *tree)
 int NEBULASimDataConverter_TArtNEBULAPla::ConvertSimData()
 {
   if (!fDetectorEnabled) return 0;
+  if (fFastDigitizer) return ConvertSimDataFast();
   fDataBufferMap.clear();
 
+  const TSimNameTable* names = SimDataManager::GetSimDataManager()->GetNameTable();
   std::map<int,tmp_data>::iterator it;
-  for (auto&& hit: *fNEBULASimDataArray)
+  // [EN] Module sums already hold what the step loop below computes. / [CN] 模块汇总已包含下面逐步循环计算的量。
+  if (fNEBULAModuleDataArray)
   {
-    auto simdata = (TSimData*)hit;
-    tmp_data* data = &fDataBufferMap[simdata->fID];
-    data->q += simdata->fEnergyDeposit;
-    data->light += MeVtoMeVee(
-        simdata->fPreKineticEnergy,
-        simdata->fPreKineticEnergy - simdata->fEnergyDeposit,
-        simdata->fParticleName.Data(),
-        simdata->fPDGCode);
-    if (data->id == 0 || simdata->fPreTime < data->t)
-    { // find the earliest hit in each module
-      data->id = simdata->fID;
-      data->t = simdata->fPreTime;
-      data->pos = simdata->fPrePosition;
+    for (auto&& obj: *fNEBULAModuleDataArray)
+    {
+      auto module = (TSimModuleData*)obj;
+      tmp_data* data = &fDataBufferMap[module->fID];
+      data->id = module->fID;
+      data->q = module->fEnergyDeposit;
+      data->light = module->fLight;
+      data->t = module->fFirstTime;
+      data->pos = module->GetFirstPosition();
+    }
+  }
+  else
+  {
+    for (auto&& hit: *fNEBULASimDataArray)
+    {
+      auto simdata = (TSimHit*)hit;
+      tmp_data* data = &fDataBufferMap[simdata->fID];
+      data->q += simdata->fEnergyDeposit;
+      data->light += MeVtoMeVee(
+          simdata->fPreKineticEnergy,
+          simdata->fPreKineticEnergy - simdata->fEnergyDeposit,
+          names->GetEntry(simdata->fParticleNameID),
+          simdata->fPDGCode);
+      if (data->id == 0 || simdata->fPreTime < data->t)
+      { // find the earliest hit in each module
+        data->id = simdata->fID;
+        data->t = simdata->fPreTime;
+        data->pos = simdata->GetPrePosition();
+      }
     }
   }
 
@@ -105,13 +140,17 @@ int NEBULASimDataConverter_TArtNEBULAPla::ConvertSimData()
     std::cerr << "NEBULASimDataConverter_TArtNEBULAPla: NEBULAParameter not found at ConvertSimData(), aborting conversion." << std::endl;
     return 1;
   }
+  // [EN] Event-keyed stream: timing smearing no longer depends on how many numbers other code drew from gRandom.
+  // [CN] 按事件取流：时间涂抹不再依赖其他代码从 gRandom 取过多少随机数。
+  sman->GetRandomStreams().Attach(fRandom, sman->GetEventID(), "NEBULA/time");
 
   for (auto&& [ID,data]: fDataBufferMap)
   {
     TDetectorSimParameter *prm = NEBULAParameter->FindDetectorSimParameter(ID);
     if (!prm) {
-      std::cerr << "NEBULASimDataConverter_TArtNEBULAPla: WARNING - detector parameter for ID=" << ID
-                << " not found. Skipping this ID." << std::endl;
+      // [EN] Repeats every event for the same ID, so only the first few occurrences are printed.
+      // [CN] 同一 ID 每个事件都会重复，只打印前几次。
+      SM_WARN_LIMITED(5, 10000, "NEBULASimDataConverter_TArtNEBULAPla: detector parameter for ID={} not found. Skipping this ID.", ID);
       // do not attempt to fill pla with invalid prm; continue to next ID
       continue;
     }
@@ -156,8 +195,8 @@ int NEBULASimDataConverter_TArtNEBULAPla::ConvertSimData()
 
       Double_t tu = data.t + dy_u / V_scinti;
       Double_t td = data.t + dy_d / V_scinti;
-      tu += gRandom->Gaus(0, NEBULAParameter->fTimeReso);
-      td += gRandom->Gaus(0, NEBULAParameter->fTimeReso);
+      tu += fRandom.Gaus(0, NEBULAParameter->fTimeReso);
+      td += fRandom.Gaus(0, NEBULAParameter->fTimeReso);
       Double_t t = 0.5 * (tu + td) - 0.5 * Ysiz / V_scinti;
       Double_t dt = td - tu;
 
@@ -195,9 +234,62 @@ int NEBULASimDataConverter_TArtNEBULAPla::ConvertSimData()
   return 0;
 }
 //____________________________________________________________________
+int NEBULASimDataConverter_TArtNEBULAPla::ConvertSimDataFast()
+{
+  SimDataManager *sman = SimDataManager::GetSimDataManager();
+  if (fNEBULAModuleDataArray)
+  {
+    for (auto&& obj: *fNEBULAModuleDataArray)
+    {
+      auto module = (TSimModuleData*)obj;
+      fDigitizer.SetModule(module->fID, module->fEnergyDeposit, module->fLight,
+                           module->fFirstTime, module->fFirstPosition);
+    }
+  }
+  else
+  {
+    // [EN] Light from the PDG code, no name-table lookup. / [CN] 由 PDG 码计算光输出，不查名字表。
+    for (auto&& hit: *fNEBULASimDataArray)
+    {
+      auto simdata = (TSimHit*)hit;
+      Double_t light = NEBULAQuenching::Light(simdata->fPreKineticEnergy,
+                                              simdata->fPreKineticEnergy - simdata->fEnergyDeposit,
+                                              simdata->fPDGCode);
+      fDigitizer.Add(simdata->fID, simdata->fEnergyDeposit, light, simdata->fPreTime, simdata->fPrePosition);
+    }
+  }
+
+  sman->GetRandomStreams().Attach(fRandom, sman->GetEventID(), "NEBULA/time");
+  const std::vector<NEBULADigitizer::Output>& outputs = fDigitizer.Digitize(fRandom, fIncludeResolution);
+  for (Int_t ID: fDigitizer.GetUnknownIDs())
+    SM_WARN_LIMITED(5, 10000, "NEBULASimDataConverter_TArtNEBULAPla: detector parameter for ID={} not found. Skipping this ID.", ID);
+
+  for (size_t i=0; i<outputs.size(); ++i)
+  {
+    const NEBULADigitizer::Output& out = outputs[i];
+    const NEBULADigitizer::Module* module = out.module;
+    TArtNEBULAPla *pla = (TArtNEBULAPla*)fNEBULAPlaArray->ConstructedAt(i);
+    pla->SetID(out.id);
+    pla->SetLayer(module->layer);
+    pla->SetSubLayer(module->sublayer);
+    pla->SetDetectorName(module->name);
+    for (int k=0; k<3; ++k) pla->SetDetPos(module->det_pos[k], k);
+    for (int k=0; k<3; ++k) pla->SetPos(out.pos[k], k);
+    pla->SetTAveCal(out.t);
+    pla->SetQUCal(out.qu);
+    pla->SetQDCal(out.qd);
+    pla->SetQAveCal(out.q);
+  }
+  return 0;
+}
+//____________________________________________________________________
 int NEBULASimDataConverter_TArtNEBULAPla::ClearBuffer()
 {
-  if (fNEBULAPlaArray) fNEBULAPlaArray->Delete();
+  if (fNEBULAPlaArray){
+    // [EN] The fast path reuses the objects through ConstructedAt(). / [CN] 快速路径通过 ConstructedAt() 复用对象。
+    if (fFastDigitizer) fNEBULAPlaArray->Clear("C");
+    else fNEBULAPlaArray->Delete();
+  }
   return 0;
 }
 //____________________________________________________________________
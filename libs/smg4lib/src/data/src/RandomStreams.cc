@@ -0,0 +1,123 @@
+#include "RandomStreams.hh"
+
+namespace {
+
+constexpr std::uint32_t kPhiloxM0 = 0xD2511F53u;
+constexpr std::uint32_t kPhiloxM1 = 0xCD9E8D57u;
+constexpr std::uint32_t kPhiloxW0 = 0x9E3779B9u;
+constexpr std::uint32_t kPhiloxW1 = 0xBB67AE85u;
+constexpr int kPhiloxRounds = 10;
+
+// 2^-53
+constexpr double kInv53 = 1.0 / 9007199254740992.0;
+
+inline void MulHiLo(std::uint32_t a, std::uint32_t b, std::uint32_t* hi, std::uint32_t* lo)
+{
+  const std::uint64_t product = static_cast<std::uint64_t>(a) * b;
+  *hi = static_cast<std::uint32_t>(product >> 32);
+  *lo = static_cast<std::uint32_t>(product);
+}
+
+}  // namespace
+
+//____________________________________________________________________
+PhiloxRandom::PhiloxRandom(std::uint64_t key)
+  : TRandom(0), fKey(0), fCounter(0), fBuffer{0, 0, 0, 0}, fNext(4)
+{
+  SetName("PhiloxRandom");
+  SetTitle("Philox4x32-10 counter-based generator");
+  SetKey(key);
+}
+//____________________________________________________________________
+PhiloxRandom::~PhiloxRandom()
+{;}
+//____________________________________________________________________
+void PhiloxRandom::SetKey(std::uint64_t key)
+{
+  fKey = key;
+  fCounter = 0;
+  fNext = 4;
+}
+//____________________________________________________________________
+void PhiloxRandom::Block(const std::uint32_t counter[4], const std::uint32_t key[2], std::uint32_t out[4])
+{
+  std::uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+  std::uint32_t k0 = key[0], k1 = key[1];
+  for (int round = 0; round < kPhiloxRounds; ++round) {
+    if (round > 0) {
+      k0 += kPhiloxW0;
+      k1 += kPhiloxW1;
+    }
+    std::uint32_t hi0, lo0, hi1, lo1;
+    MulHiLo(kPhiloxM0, c0, &hi0, &lo0);
+    MulHiLo(kPhiloxM1, c2, &hi1, &lo1);
+    c0 = hi1 ^ c1 ^ k0;
+    c1 = lo1;
+    c2 = hi0 ^ c3 ^ k1;
+    c3 = lo0;
+  }
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+//____________________________________________________________________
+std::uint32_t PhiloxRandom::NextUInt32()
+{
+  if (fNext >= 4) {
+    const std::uint32_t counter[4] = {static_cast<std::uint32_t>(fCounter),
+                                      static_cast<std::uint32_t>(fCounter >> 32), 0u, 0u};
+    const std::uint32_t key[2] = {static_cast<std::uint32_t>(fKey), static_cast<std::uint32_t>(fKey >> 32)};
+    Block(counter, key, fBuffer);
+    ++fCounter;
+    fNext = 0;
+  }
+  return fBuffer[fNext++];
+}
+//____________________________________________________________________
+Double_t PhiloxRandom::Rndm()
+{
+  const std::uint64_t a = NextUInt32() >> 5;
+  const std::uint64_t b = NextUInt32() >> 6;
+  return (static_cast<double>((a << 26) | b) + 0.5) * kInv53;
+}
+//____________________________________________________________________
+void PhiloxRandom::RndmArray(Int_t n, Float_t* array)
+{
+  for (Int_t i = 0; i < n; ++i) array[i] = static_cast<Float_t>(Rndm());
+}
+//____________________________________________________________________
+void PhiloxRandom::RndmArray(Int_t n, Double_t* array)
+{
+  for (Int_t i = 0; i < n; ++i) array[i] = Rndm();
+}
+
+//____________________________________________________________________
+std::uint64_t RandomStreams::Mix(std::uint64_t a, std::uint64_t b)
+{
+  std::uint64_t z = a + 0x9E3779B97F4A7C15ull * (b + 1);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+//____________________________________________________________________
+std::uint64_t RandomStreams::HashName(const char* name)
+{
+  // FNV-1a
+  std::uint64_t hash = 0xCBF29CE484222325ull;
+  for (const char* p = name; p && *p; ++p) {
+    hash ^= static_cast<unsigned char>(*p);
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+//____________________________________________________________________
+std::uint64_t RandomStreams::StreamKey(std::int64_t event_id, const char* stream) const
+{
+  return Mix(Mix(fRunSeed, static_cast<std::uint64_t>(event_id)), HashName(stream));
+}
+//____________________________________________________________________
+RandomStreams RandomStreams::ForSubRun(std::uint64_t sub_run) const
+{
+  return RandomStreams(Mix(fRunSeed ^ 0x5DEECE66Dull, sub_run));
+}
@@ -4,6 +4,7 @@
 #include "SimDataInitializer.hh"
 #include "SimDataConverter.hh"
 #include "TSimData.hh"
+#include "TSimNameTable.hh"
 
 #include "TFile.h"
 #include "TTree.h"
@@ -11,7 +12,8 @@
 
 #include <iostream>
 //____________________________________________________________________
-SimDataManager* SimDataManager::fSimDataManager(0);
+thread_local SimDataManager* SimDataManager::fSimDataManager(0);
+SimDataManager* SimDataManager::fMasterSimDataManager(0);
 //____________________________________________________________________
 SimDataManager* SimDataManager::GetSimDataManager()
 {
@@ -23,6 +25,8 @@ SimDataManager::~SimDataManager()
 {
   RemoveAllInitializer();
   RemoveAllConverter();
+  delete fNameTable;
+  if (fMasterSimDataManager==this) fMasterSimDataManager = 0;
   fSimDataManager = 0;
 }
 //____________________________________________________________________
@@ -42,6 +46,12 @@ int SimDataManager::Initialize()
   int n=fInitializerArray.size();
   for (int i=0;i<n;++i){
     SimDataInitializer *initializer = fInitializerArray[i];
+    // [EN] Macro commands (StoreSteps, Resolution, ...) only reach the master's instances; copy them over.
+    // [CN] 宏命令（StoreSteps、Resolution 等）只作用于 master 的实例，这里复制过来。
+    if (!IsMaster() && fMasterSimDataManager){
+      SimDataInitializer *master = fMasterSimDataManager->FindInitializer(initializer->GetName());
+      if (master) initializer->CopySettings(*master);
+    }
     if (initializer->Initialize()!=0) ierr=1;
     else {
       TClonesArray *arr = initializer->GetSimDataArray();
@@ -53,15 +63,23 @@ int SimDataManager::Initialize()
   int n_con=fConverterArray.size();
   for (int i=0;i<n_con;++i){
     SimDataConverter *converter = fConverterArray[i];
+    if (!IsMaster() && fMasterSimDataManager){
+      SimDataConverter *master = fMasterSimDataManager->FindConverter(converter->GetName());
+      if (master) converter->CopySettings(*master);
+    }
     if (converter->Initialize()!=0) ierr=1;
   }
 
+  ++fSimDataArrayGeneration;
   return ierr;
 }
 //____________________________________________________________________
 int SimDataManager::DefineBranch(TTree* tree)
 {
   int ierr=0;
+  // G4 event number; the multi-threaded merge keeps per-thread blocks, so this is the only ordering key
+  if (!tree->Branch("event_id", &fEventID, "event_id/L")) ierr=1;
+
   int n=fInitializerArray.size();
   for (int i=0;i<n;++i){
     SimDataInitializer *initializer = fInitializerArray[i];
@@ -109,6 +127,12 @@ int SimDataManager::ClearBuffer()
 int SimDataManager::ConvertSimData()
 {
   int ierr=0;
+  int n_ini=fInitializerArray.size();
+  for (int i=0;i<n_ini;++i){
+    SimDataInitializer *initializer = fInitializerArray[i];
+    if (initializer->PrepareOutput()!=0) ierr=1;
+  }
+
   int n_con=fConverterArray.size();
   for (int i=0;i<n_con;++i){
     SimDataConverter *converter = fConverterArray[i];
@@ -160,7 +184,8 @@ TSimParameter* SimDataManager::FindParameter(TString prmName)
   std::map<TString,TSimParameter*>::iterator it;
   it = fParameterMap.find(prmName);
   if (it!=fParameterMap.end()) return it->second;
-  else                         return 0;
+  if (!IsMaster() && fMasterSimDataManager) return fMasterSimDataManager->FindParameter(prmName);
+  return 0;
 }
 //____________________________________________________________________
 SimDataInitializer* SimDataManager::FindInitializer(TString name)
@@ -190,6 +215,18 @@ TClonesArray* SimDataManager::FindSimDataArray(TString name)
   return 0;
 }
 //____________________________________________________________________
+TSimNameTable* SimDataManager::GetNameTable()
+{
+  if (!IsMaster() && fMasterSimDataManager) return fMasterSimDataManager->GetNameTable();
+  return fNameTable;
+}
+//____________________________________________________________________
+bool SimDataManager::GetCompactHits() const
+{
+  if (!IsMaster() && fMasterSimDataManager) return fMasterSimDataManager->GetCompactHits();
+  return fCompactHits;
+}
+//____________________________________________________________________
 void SimDataManager::PrintParameters()
 {
   std::map<TString,TSimParameter*>::iterator it = fParameterMap.begin();
@@ -220,8 +257,12 @@ void SimDataManager::PrintConverters()
 //____________________________________________________________________
 //____________________________________________________________________
 SimDataManager::SimDataManager()
-  : fHeader("")
+  : fSimDataArrayGeneration(1), fHeader(""), fEventID(0), fTree(0),
+    fNameTable(0), fCompactHits(false)
 {
+  if (fMasterSimDataManager==0) fMasterSimDataManager = this;
+  // [EN] Created up front so workers never race on it. / [CN] 预先创建，避免 worker 并发创建。
+  if (IsMaster()) fNameTable = new TSimNameTable;
   std::cout<<"SimDataManager"<<std::endl;
 
   fInitializerArray.clear();
@@ -0,0 +1,97 @@
+#include "SimHitInitializer.hh"
+#include "SimDataManager.hh"
+#include "TSimData.hh"
+#include "TSimHit.hh"
+#include "TRunSimParameter.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+
+//____________________________________________________________________
+SimHitInitializer::SimHitInitializer(TString name, TString prefix)
+  : SimDataInitializer(name), fPrefix(prefix), fCompact(false), fLegacyArray(0), fStoredArray(0),
+    fRetentionLevel(SimHitRetention::kSteps)
+{
+  fSimDataArray = 0;
+}
+//____________________________________________________________________
+SimHitInitializer::~SimHitInitializer()
+{;}
+//____________________________________________________________________
+int SimHitInitializer::Initialize()
+{
+  SimDataManager *sman = SimDataManager::GetSimDataManager();
+  fCompact = sman->GetCompactHits();
+  TRunSimParameter *run = (TRunSimParameter*)sman->FindParameter("RunParameter");
+  fRetentionLevel = SimHitRetention::Parse(run ? run->fRetention.Data() : 0);
+
+  fSimDataArray = sman->FindSimDataArray(fPrefix+"SimHit");
+  if (fSimDataArray==0){
+    fSimDataArray = new TClonesArray("TSimHit",256);
+    fSimDataArray->SetName(fPrefix+"SimHit");
+    fSimDataArray->SetOwner();
+  }
+
+  if (fLegacyArray==0){
+    fLegacyArray = new TClonesArray("TSimData",256);
+    fLegacyArray->SetName(fPrefix+"SimData");
+    fLegacyArray->SetOwner();
+  }
+
+  if (fRetentionLevel!=SimHitRetention::kSteps && fStoredArray==0){
+    fStoredArray = new TClonesArray("TSimHit",256);
+    fStoredArray->SetName(fPrefix+"SimHit");
+    fStoredArray->SetOwner();
+  }
+
+  return 0;
+}
+//____________________________________________________________________
+int SimHitInitializer::DefineBranch(TTree* tree)
+{
+  if (!fDataStore) return 0;
+  if (!fCompact) tree->Branch(fLegacyArray->GetName(),&fLegacyArray);
+  else if (fRetentionLevel==SimHitRetention::kSteps) tree->Branch(fSimDataArray->GetName(),&fSimDataArray);
+  else tree->Branch(fStoredArray->GetName(),&fStoredArray);
+  return 0;
+}
+//____________________________________________________________________
+int SimHitInitializer::AddParameters(TFile* /*file*/)
+{
+  return 0;
+}
+//____________________________________________________________________
+int SimHitInitializer::RemoveParameters(TFile* /*file*/)
+{
+  return 0;
+}
+//____________________________________________________________________
+int SimHitInitializer::PrintParameters(TFile* /*file*/)
+{
+  return 0;
+}
+//____________________________________________________________________
+int SimHitInitializer::ClearBuffer()
+{
+  // TSimHit owns no heap memory, so the slots are reused without calling destructors
+  fSimDataArray->Clear();
+  fLegacyArray->Delete();
+  if (fStoredArray) fStoredArray->Clear();
+  return 0;
+}
+//____________________________________________________________________
+int SimHitInitializer::PrepareOutput()
+{
+  if (!fDataStore) return 0;
+  // the live array is left untouched, converters still need every step
+  TClonesArray *hits = fSimDataArray;
+  if (fRetentionLevel!=SimHitRetention::kSteps){
+    fRetention.Reduce(fSimDataArray, fRetentionLevel, fStoredArray);
+    hits = fStoredArray;
+  }
+  if (fCompact) return 0;
+  SimDataManager *sman = SimDataManager::GetSimDataManager();
+  TSimHit::ExpandArray(hits, sman->GetNameTable(), fLegacyArray);
+  return 0;
+}
+//____________________________________________________________________
@@ -0,0 +1,117 @@
+#include "SimHitRetention.hh"
+#include "TSimHit.hh"
+
+#include "TClonesArray.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace {
+
+const TSimHit* HitAt(const TClonesArray* hits, Int_t i)
+{
+  return static_cast<const TSimHit*>(hits->UncheckedAt(i));
+}
+
+TSimHit* Append(TClonesArray* out, const TSimHit* hit)
+{
+  return new ((*out)[out->GetEntriesFast()]) TSimHit(*hit);
+}
+
+struct Summary
+{
+  Int_t    first, earliest, latest;// indices in the input
+  Double_t edep, flight;
+};
+
+}  // namespace
+//____________________________________________________________________
+SimHitRetention::Level SimHitRetention::Parse(const char* name)
+{
+  if (name && strcmp(name, "endpoints")==0) return kEndpoints;
+  if (name && strcmp(name, "summary")==0)   return kSummary;
+  return kSteps;
+}
+//____________________________________________________________________
+const char* SimHitRetention::Name(Level level)
+{
+  switch (level){
+  case kEndpoints: return "endpoints";
+  case kSummary:   return "summary";
+  default:         return "steps";
+  }
+}
+//____________________________________________________________________
+void SimHitRetention::Reduce(const TClonesArray* hits, Level level, TClonesArray* out)
+{
+  const Int_t n = hits->GetEntriesFast();
+  if (level==kSteps){
+    for (Int_t i=0;i<n;++i) Append(out, HitAt(hits, i));
+    return;
+  }
+
+  // group by (detector, module, copy numbers[, track]); the stable sort keeps each group in step order.
+  // The module name and the copy-number chain are needed to keep e.g. the U/X/V layers of one PDC apart.
+  fOrder.resize(n);
+  std::iota(fOrder.begin(), fOrder.end(), 0);
+  const bool by_track = level==kEndpoints;
+  auto less = [&](Int_t a, Int_t b){
+    const TSimHit* ha = HitAt(hits, a);
+    const TSimHit* hb = HitAt(hits, b);
+    if (ha->fDetectorNameID!=hb->fDetectorNameID) return ha->fDetectorNameID < hb->fDetectorNameID;
+    if (ha->fModuleNameID!=hb->fModuleNameID) return ha->fModuleNameID < hb->fModuleNameID;
+    if (ha->fID!=hb->fID) return ha->fID < hb->fID;
+    if (ha->fNModuleID!=hb->fNModuleID) return ha->fNModuleID < hb->fNModuleID;
+    for (Int_t i=0;i<ha->fNModuleID && i<TSimHit::kMaxModuleDepth;++i)
+      if (ha->fModuleID[i]!=hb->fModuleID[i]) return ha->fModuleID[i] < hb->fModuleID[i];
+    return by_track && ha->fTrackID < hb->fTrackID;
+  };
+  std::stable_sort(fOrder.begin(), fOrder.end(), less);
+
+  std::vector<Summary> groups;
+  for (Int_t b=0;b<n;){
+    Int_t e = b+1;
+    while (e<n && !less(fOrder[b], fOrder[e])) ++e;
+
+    Summary g{fOrder[b], fOrder[b], fOrder[e-1], 0, 0};
+    if (level==kSummary){
+      for (Int_t k=b;k<e;++k){
+        const TSimHit* hit = HitAt(hits, fOrder[k]);
+        if (hit->fPreTime < HitAt(hits, g.earliest)->fPreTime) g.earliest = fOrder[k];
+        if (hit->fPostTime >= HitAt(hits, g.latest)->fPostTime) g.latest = fOrder[k];
+        g.edep += hit->fEnergyDeposit;
+        g.flight += hit->fFlightLength;
+      }
+    }
+    groups.push_back(g);
+    b = e;
+  }
+
+  if (level==kEndpoints){
+    // both endpoints, in input order
+    fOrder.clear();
+    for (const Summary& g : groups){
+      fOrder.push_back(g.earliest);
+      if (g.latest!=g.earliest) fOrder.push_back(g.latest);
+    }
+    std::sort(fOrder.begin(), fOrder.end());
+    for (Int_t i : fOrder) Append(out, HitAt(hits, i));
+    return;
+  }
+
+  std::sort(groups.begin(), groups.end(), [](const Summary& a, const Summary& b){return a.first < b.first;});
+  for (const Summary& g : groups){
+    TSimHit* hit = Append(out, HitAt(hits, g.earliest));
+    const TSimHit* last = HitAt(hits, g.latest);
+    hit->fPostKineticEnergy = last->fPostKineticEnergy;
+    for (int i=0;i<3;++i){
+      hit->fPostMomentum[i] = last->fPostMomentum[i];
+      hit->fPostPosition[i] = last->fPostPosition[i];
+    }
+    hit->fPostTime = last->fPostTime;
+    hit->fEnergyDeposit = g.edep;
+    hit->fFlightLength = g.flight;
+  }
+}
+//____________________________________________________________________
@@ -0,0 +1,56 @@
+#include "SimModuleAccumulator.hh"
+#include "TSimModuleData.hh"
+
+#include "TClonesArray.h"
+
+#include <algorithm>
+
+//____________________________________________________________________
+void SimModuleAccumulator::Add(Int_t id, Double_t edep, Double_t light, Double_t time, const Double_t pos[3])
+{
+  if (id < 0) return;
+  if (id >= (Int_t)fModules.size()) fModules.resize(id+1, Module());
+
+  Module& m = fModules[id];
+  if (m.nsteps==0) fTouched.push_back(id);
+  // earliest step, ties keep the first one (same rule as the NEBULA converters)
+  if (m.nsteps==0 || time < m.first_time){
+    m.first_time = time;
+    for (int i=0;i<3;++i) m.first_pos[i] = pos[i];
+  }
+  ++m.nsteps;
+  m.edep += edep;
+  m.light += light;
+  m.light_time += light*time;
+  for (int i=0;i<3;++i) m.light_pos[i] += light*pos[i];
+}
+//____________________________________________________________________
+void SimModuleAccumulator::Flush(TClonesArray* out)
+{
+  std::sort(fTouched.begin(), fTouched.end());
+  for (Int_t id : fTouched){
+    const Module& m = fModules[id];
+    TSimModuleData* data = new ((*out)[out->GetEntriesFast()]) TSimModuleData;
+    data->fID = id;
+    data->fNSteps = m.nsteps;
+    data->fEnergyDeposit = m.edep;
+    data->fLight = m.light;
+    data->fFirstTime = m.first_time;
+    for (int i=0;i<3;++i) data->fFirstPosition[i] = m.first_pos[i];
+    if (m.light > 0){
+      data->fLightTime = m.light_time/m.light;
+      for (int i=0;i<3;++i) data->fLightPosition[i] = m.light_pos[i]/m.light;
+    }else{
+      data->fLightTime = m.first_time;
+      for (int i=0;i<3;++i) data->fLightPosition[i] = m.first_pos[i];
+    }
+  }
+  Reset();
+}
+//____________________________________________________________________
+void SimModuleAccumulator::Reset()
+{
+  for (Int_t id : fTouched) fModules[id] = Module();
+  fTouched.clear();
+}
+//____________________________________________________________________
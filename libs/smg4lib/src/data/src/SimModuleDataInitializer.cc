@@ -0,0 +1,57 @@
+#include "SimModuleDataInitializer.hh"
+#include "SimDataManager.hh"
+#include "TSimModuleData.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+
+//____________________________________________________________________
+SimModuleDataInitializer::SimModuleDataInitializer(TString name, TString prefix)
+  : SimDataInitializer(name), fPrefix(prefix), fAccumulate(false)
+{
+  fSimDataArray = 0;
+}
+//____________________________________________________________________
+SimModuleDataInitializer::~SimModuleDataInitializer()
+{;}
+//____________________________________________________________________
+int SimModuleDataInitializer::Initialize()
+{
+  SimDataManager *sman = SimDataManager::GetSimDataManager();
+  fSimDataArray = sman->FindSimDataArray(fPrefix+"ModuleData");
+  if (fSimDataArray==0){
+    fSimDataArray = new TClonesArray("TSimModuleData",64);
+    fSimDataArray->SetName(fPrefix+"ModuleData");
+    fSimDataArray->SetOwner();
+  }
+  return 0;
+}
+//____________________________________________________________________
+int SimModuleDataInitializer::DefineBranch(TTree* tree)
+{
+  if (fAccumulate && fDataStore) tree->Branch(fSimDataArray->GetName(),&fSimDataArray);
+  return 0;
+}
+//____________________________________________________________________
+int SimModuleDataInitializer::AddParameters(TFile* /*file*/)
+{
+  return 0;
+}
+//____________________________________________________________________
+int SimModuleDataInitializer::RemoveParameters(TFile* /*file*/)
+{
+  return 0;
+}
+//____________________________________________________________________
+int SimModuleDataInitializer::PrintParameters(TFile* /*file*/)
+{
+  return 0;
+}
+//____________________________________________________________________
+int SimModuleDataInitializer::ClearBuffer()
+{
+  // TSimModuleData owns no heap memory
+  fSimDataArray->Clear();
+  return 0;
+}
+//____________________________________________________________________
@@ -5,7 +5,7 @@
 #include <iterator>
 
 ClassImp(TBeamSimData)
-TBeamSimDataArray* gBeamSimDataArray = 0;
+thread_local TBeamSimDataArray* gBeamSimDataArray = 0;
 //____________________________________________________________________
 std::ostream& operator<<(std::ostream& out, const TBeamSimData& data)
 {
@@ -1,12 +1,16 @@
 #include "TRunSimParameter.hh"
 
+#include "Compression.h"
+
 #include <iostream>
 
 ClassImp(TRunSimParameter)
 //____________________________________________________________________
 TRunSimParameter::TRunSimParameter(TString name)
 : TSimParameter(name), fRunName("run"), fSaveDir("root/"), fOverWrite("ask"),
-  fHeader(""), fTreeName("tree"), fTreeTitle("")
+  fHeader(""), fTreeName("tree"), fTreeTitle(""),
+  fRetention("steps"), fCompression("default"), fCompressionLevel(-1),
+  fBasketSize(0), fAutoFlush(0), fAutoSave(10000)
 {;}
 //____________________________________________________________________
 TRunSimParameter::~TRunSimParameter()
@@ -21,6 +25,24 @@ void TRunSimParameter::Print(Option_t*) const
 	    << " Header=" << fHeader.Data() << " "
 	    << " TreeName=" << fTreeName.Data() << " "
 	    << " TreeTitle=" << fTreeTitle.Data() << " "
+	    << " Retention=" << fRetention.Data() << " "
+	    << " Compression=" << fCompression.Data() << ":" << fCompressionLevel << " "
+	    << " BasketSize=" << fBasketSize << " "
+	    << " AutoFlush=" << fAutoFlush << " "
+	    << " AutoSave=" << fAutoSave << " "
 	    << std::endl;
 }
 //____________________________________________________________________
+Int_t TRunSimParameter::GetCompressionSettings() const
+{
+  typedef ROOT::RCompressionSetting::EAlgorithm Algorithm;
+
+  // unset level: same defaults as the reconstruction output profiles
+  Int_t level = fCompressionLevel;
+  if      (fCompression=="zlib") return ROOT::CompressionSettings(Algorithm::kZLIB, level<0 ? 1 : level);
+  else if (fCompression=="lzma") return ROOT::CompressionSettings(Algorithm::kLZMA, level<0 ? 8 : level);
+  else if (fCompression=="lz4")  return ROOT::CompressionSettings(Algorithm::kLZ4,  level<0 ? 4 : level);
+  else if (fCompression=="zstd") return ROOT::CompressionSettings(Algorithm::kZSTD, level<0 ? 5 : level);
+  return level<0 ? -1 : ROOT::CompressionSettings(Algorithm::kUseGlobal, level);
+}
+//____________________________________________________________________
@@ -0,0 +1,61 @@
+#include "TSimHit.hh"
+#include "TSimData.hh"
+#include "TSimNameTable.hh"
+
+#include "TClonesArray.h"
+
+ClassImp(TSimHit)
+//____________________________________________________________________
+TSimHit::TSimHit()
+  : TObject(),
+    fParentID(0), fTrackID(0), fStepNo(0), fPDGCode(0), fZ(-9999), fA(-9999), fID(0),
+    fParticleNameID(-1), fDetectorNameID(-1), fModuleNameID(-1), fProcessNameID(-1),
+    fNModuleID(0), fModuleID{0, 0, 0, 0},
+    fCharge(-9999), fMass(-9999), fPreKineticEnergy(0), fPostKineticEnergy(0), fEnergyDeposit(0),
+    fPreMomentum{0, 0, 0}, fPostMomentum{0, 0, 0}, fPrePosition{0, 0, 0}, fPostPosition{0, 0, 0},
+    fPreTime(0), fPostTime(0), fFlightLength(0), fIsAccepted(true)
+{;}
+//____________________________________________________________________
+TSimHit::~TSimHit()
+{;}
+//____________________________________________________________________
+void TSimHit::Expand(const TSimNameTable* names, TSimData* data) const
+{
+  data->fParentID = fParentID;
+  data->fTrackID = fTrackID;
+  data->fStepNo = fStepNo;
+  data->fZ = fZ;
+  data->fA = fA;
+  data->fPDGCode = fPDGCode;
+  data->fModuleID.assign(fModuleID, fModuleID + fNModuleID);
+  data->fID = fID;
+  if (names){
+    data->fParticleName = names->GetEntry(fParticleNameID);
+    data->fDetectorName = names->GetEntry(fDetectorNameID);
+    data->fModuleName = names->GetEntry(fModuleNameID);
+    data->fProcessName = names->GetEntry(fProcessNameID);
+  }
+  data->fCharge = fCharge;
+  data->fMass = fMass;
+  data->fPreKineticEnergy = fPreKineticEnergy;
+  data->fPostKineticEnergy = fPostKineticEnergy;
+  data->fEnergyDeposit = fEnergyDeposit;
+  data->fPreMomentum = GetPreMomentum();
+  data->fPostMomentum = GetPostMomentum();
+  data->fPrePosition = GetPrePosition();
+  data->fPostPosition = GetPostPosition();
+  data->fPreTime = fPreTime;
+  data->fPostTime = fPostTime;
+  data->fFlightLength = fFlightLength;
+  data->fIsAccepted = fIsAccepted;
+}
+//____________________________________________________________________
+void TSimHit::ExpandArray(const TClonesArray* hits, const TSimNameTable* names, TClonesArray* out)
+{
+  const Int_t n = hits->GetEntriesFast();
+  for (Int_t i=0;i<n;++i){
+    TSimData* data = new ((*out)[out->GetEntriesFast()]) TSimData;
+    static_cast<const TSimHit*>(hits->UncheckedAt(i))->Expand(names, data);
+  }
+}
+//____________________________________________________________________
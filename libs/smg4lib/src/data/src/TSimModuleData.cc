@@ -0,0 +1,12 @@
+#include "TSimModuleData.hh"
+
+ClassImp(TSimModuleData)
+//____________________________________________________________________
+TSimModuleData::TSimModuleData()
+  : TObject(), fID(0), fNSteps(0), fEnergyDeposit(0), fLight(0),
+    fFirstTime(0), fFirstPosition{0, 0, 0}, fLightTime(0), fLightPosition{0, 0, 0}
+{;}
+//____________________________________________________________________
+TSimModuleData::~TSimModuleData()
+{;}
+//____________________________________________________________________
@@ -0,0 +1,68 @@
+#include "TSimNameTable.hh"
+
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+
+ClassImp(TSimNameTable)
+//____________________________________________________________________
+TSimNameTable::TSimNameTable(const char* name)
+  : TNamed(name, "names referenced by TSimHit")
+{;}
+//____________________________________________________________________
+TSimNameTable::~TSimNameTable()
+{;}
+//____________________________________________________________________
+Int_t TSimNameTable::Intern(const char* name)
+{
+  {
+    std::shared_lock<std::shared_mutex> lock(fMutex);
+    if (fIndex.size()==fNames.size()){
+      auto it = fIndex.find(name);
+      if (it!=fIndex.end()) return it->second;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(fMutex);
+  if (fIndex.size()!=fNames.size()){
+    fIndex.clear();
+    for (Int_t i=0;i<(Int_t)fNames.size();++i) fIndex.emplace(fNames[i], i);
+  }
+  // another thread may have added it between the two locks
+  auto it = fIndex.find(name);
+  if (it!=fIndex.end()) return it->second;
+
+  const Int_t id = fNames.size();
+  fNames.emplace_back(name);
+  fIndex.emplace(fNames.back(), id);
+  return id;
+}
+//____________________________________________________________________
+const char* TSimNameTable::GetEntry(Int_t id) const
+{
+  std::shared_lock<std::shared_mutex> lock(fMutex);
+  if (id<0 || id>=(Int_t)fNames.size()) return "";
+  return fNames[id].c_str();
+}
+//____________________________________________________________________
+Int_t TSimNameTable::GetEntries() const
+{
+  std::shared_lock<std::shared_mutex> lock(fMutex);
+  return fNames.size();
+}
+//____________________________________________________________________
+void TSimNameTable::Clear(Option_t* /*option*/)
+{
+  std::unique_lock<std::shared_mutex> lock(fMutex);
+  fNames.clear();
+  fIndex.clear();
+}
+//____________________________________________________________________
+void TSimNameTable::Print(Option_t* /*option*/) const
+{
+  std::shared_lock<std::shared_mutex> lock(fMutex);
+  std::cout<<GetName()<<" : "<<fNames.size()<<" names"<<std::endl;
+  for (Int_t i=0;i<(Int_t)fNames.size();++i)
+    std::cout<<"  "<<i<<" "<<fNames[i]<<std::endl;
+}
+//____________________________________________________________________
@@ -1,11 +1,28 @@
 #ifndef SMLOGGER_HH
 #define SMLOGGER_HH
 
+#include <atomic>
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 #include <spdlog/spdlog.h>
 #include <spdlog/async.h>
 
+// 编译期日志级别下限：低于该级别的 SM_* 调用在编译期整体消除（参数也不求值）。
+// 由 CMake 选项 SMLOGGER_ACTIVE_LEVEL 设置；0 = TRACE（全部保留）… 6 = OFF。
+#ifndef SM_LOG_ACTIVE_LEVEL
+#define SM_LOG_ACTIVE_LEVEL 0
+#endif
+
+// 日志模块名：在 .cc 中于使用宏之前 #define SM_LOG_MODULE "NEBULA"，该文件的日志即走
+// 名为 NEBULA 的 logger，可单独设置级别（SetModuleLevel / SM_LOG_MODULES 环境变量）。
+#ifndef SM_LOG_MODULE
+#define SM_LOG_MODULE "SMSimulator"
+#endif
+
 namespace SMLogger {
 
 // 日志级别
@@ -30,10 +47,63 @@ struct LogConfig {
     size_t max_files = 3;           // 滚动文件数
     bool color = true;              // 彩色输出
     std::string pattern = "[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] [%n] %v";
+    std::map<std::string, LogLevel> module_levels;  // 模块级别覆盖，如 {"NEBULA", DEBUG}
+    double summary_interval_s = 60.0;  // SM_COUNT 计数器的周期汇总间隔（秒），<= 0 时只在 Shutdown 时汇总
 };
 
+// SM_LOG_LEVEL=INFO, SM_LOG_FILE=path, SM_LOG_MODULES="NEBULA=DEBUG,PDC=WARN"
 LogConfig MakeLogConfigFromEnvironment(LogConfig config);
 
+constexpr spdlog::level::level_enum ToSpdlogLevel(LogLevel level) {
+    return static_cast<spdlog::level::level_enum>(static_cast<int>(level));
+}
+
+// 调用点级别的限流：前 first_n 条全部输出，之后每 every_m 条输出一条（every_m = 0 表示不再输出）。
+// 计数为原子操作，多线程共享同一调用点也安全；被抑制的条数在 Shutdown 的汇总中列出。
+class RateLimiter {
+public:
+    RateLimiter(const char* file, int line, std::uint64_t first_n, std::uint64_t every_m);
+    ~RateLimiter();
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    bool Allow() {
+        const std::uint64_t n = m_count.fetch_add(1, std::memory_order_relaxed) + 1;
+        return n <= m_first_n || (m_every_m > 0 && (n - m_first_n) % m_every_m == 0);
+    }
+    std::uint64_t Count() const { return m_count.load(std::memory_order_relaxed); }
+    std::uint64_t Suppressed() const;
+    const char* File() const { return m_file; }
+    int Line() const { return m_line; }
+
+private:
+    const char* m_file;
+    int m_line;
+    std::uint64_t m_first_n;
+    std::uint64_t m_every_m;
+    std::atomic<std::uint64_t> m_count{0};
+};
+
+// 聚合计数器：事件循环里用 SM_COUNT 代替逐事件日志，按 LogConfig::summary_interval_s 周期
+// 输出一行汇总（同名计数器合并），Shutdown 时输出最终汇总。
+class LogCounter {
+public:
+    explicit LogCounter(const char* name);
+    ~LogCounter();
+    LogCounter(const LogCounter&) = delete;
+    LogCounter& operator=(const LogCounter&) = delete;
+
+    void Add(std::uint64_t n = 1);
+    std::uint64_t Value() const { return m_value.load(std::memory_order_relaxed); }
+    const char* Name() const { return m_name; }
+
+private:
+    friend class Logger;
+    const char* m_name;
+    std::atomic<std::uint64_t> m_value{0};
+    std::uint64_t m_reported = 0;  // 上次汇总时的值，由 Logger 在锁内维护
+};
+
 // 日志管理器（单例）
 class Logger {
 public:
@@ -49,30 +119,78 @@ public:
     // 设置日志级别
     void SetLevel(LogLevel level);
     
+    // 设置单个模块的日志级别（覆盖全局级别）
+    void SetModuleLevel(const std::string& module, LogLevel level);
+    
     // 获取底层 spdlog logger
     std::shared_ptr<spdlog::logger> GetLogger(const std::string& name = "SMSimulator");
     
     // 刷新日志缓冲
     void Flush();
 
+    // 输出计数器汇总（周期汇总只列出有变化的计数器；最终汇总另列出被限流抑制的调用点）
+    void EmitSummary(bool final_summary = false);
+    // 同名计数器的当前总和
+    std::uint64_t GetCounterTotal(const std::string& name);
+
+    // 宏使用的快速路径：每个调用点只查一次模块槽位，之后每次日志只是一次原子读取裸指针，
+    // 不再构造 std::string、不再拷贝 shared_ptr。槽位 0 为默认 logger。
+    // 返回的裸指针在进程退出前一直有效（Shutdown 不会释放 logger 对象）。
+    static constexpr int kMaxModules = 64;
+    static int ModuleSlot(const char* module);
+    static spdlog::logger* Get(int slot) {
+        spdlog::logger* logger = s_loggers[slot].load(std::memory_order_acquire);
+        return logger ? logger : Instance().Resolve(slot);
+    }
+
 private:
-    Logger() = default;
+    Logger();
     ~Logger();
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
+
+    friend class RateLimiter;
+    friend class LogCounter;
+
+    spdlog::logger* Resolve(int slot);
+    void ApplyLevel(spdlog::logger& logger, const std::string& module) const;
+    void MaybeEmitSummary();
     
-    bool m_initialized = false;
+    std::atomic<bool> m_initialized{false};               // 宏快速路径与 MaybeEmitSummary 会无锁读取
     LogConfig m_config;
     std::shared_ptr<spdlog::logger> m_default_logger;
+
+    std::mutex m_mutex;                                   // 保护模块表
+    std::vector<std::string> m_module_names;              // 下标即槽位，Shutdown 后保留
+    std::shared_ptr<spdlog::logger> m_module_loggers[kMaxModules];
+    static std::atomic<spdlog::logger*> s_loggers[kMaxModules];
+    // Shutdown 只撤下 s_loggers，不释放 logger：其他线程可能仍持有刚读到的裸指针，
+    // 因此已发布过的 logger 保留到进程退出（每次 Initialize/Shutdown 至多 kMaxModules 个）
+    std::vector<std::shared_ptr<spdlog::logger>> m_retired_loggers;  // 受 m_mutex 保护
+
+    std::vector<RateLimiter*> m_limiters;                 // 受 m_mutex 保护
+    std::vector<LogCounter*> m_counters;                  // 受 m_mutex 保护
+    std::atomic<std::int64_t> m_last_summary_ns{0};
 };
 
 // 便捷宏定义
-#define SM_TRACE(...)    SMLogger::Logger::Instance().GetLogger()->trace(__VA_ARGS__)
-#define SM_DEBUG(...)    SMLogger::Logger::Instance().GetLogger()->debug(__VA_ARGS__)
-#define SM_INFO(...)     SMLogger::Logger::Instance().GetLogger()->info(__VA_ARGS__)
-#define SM_WARN(...)     SMLogger::Logger::Instance().GetLogger()->warn(__VA_ARGS__)
-#define SM_ERROR(...)    SMLogger::Logger::Instance().GetLogger()->error(__VA_ARGS__)
-#define SM_CRITICAL(...) SMLogger::Logger::Instance().GetLogger()->critical(__VA_ARGS__)
+// 级别低于 SM_LOG_ACTIVE_LEVEL 时编译期消除；否则先内联判断级别，再格式化参数。
+#define SM_LOG_AT(level, ...) \
+    do { \
+        if constexpr (static_cast<int>(level) >= SM_LOG_ACTIVE_LEVEL) { \
+            static const int sm_log_slot_ = ::SMLogger::Logger::ModuleSlot(SM_LOG_MODULE); \
+            ::spdlog::logger* sm_log_ptr_ = ::SMLogger::Logger::Get(sm_log_slot_); \
+            if (sm_log_ptr_ && sm_log_ptr_->should_log(::SMLogger::ToSpdlogLevel(level))) \
+                sm_log_ptr_->log(::SMLogger::ToSpdlogLevel(level), __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define SM_TRACE(...)    SM_LOG_AT(::SMLogger::LogLevel::TRACE, __VA_ARGS__)
+#define SM_DEBUG(...)    SM_LOG_AT(::SMLogger::LogLevel::DEBUG, __VA_ARGS__)
+#define SM_INFO(...)     SM_LOG_AT(::SMLogger::LogLevel::INFO, __VA_ARGS__)
+#define SM_WARN(...)     SM_LOG_AT(::SMLogger::LogLevel::WARN, __VA_ARGS__)
+#define SM_ERROR(...)    SM_LOG_AT(::SMLogger::LogLevel::ERROR, __VA_ARGS__)
+#define SM_CRITICAL(...) SM_LOG_AT(::SMLogger::LogLevel::CRITICAL, __VA_ARGS__)
 
 // 带名字的日志宏
 #define SM_LOGGER(name) SMLogger::Logger::Instance().GetLogger(name)
@@ -82,12 +200,35 @@ private:
 #define SM_WARN_IF(cond, ...) if(cond) SM_WARN(__VA_ARGS__)
 #define SM_ERROR_IF(cond, ...) if(cond) SM_ERROR(__VA_ARGS__)
 
-// 定时日志（避免日志轰炸）
-#define SM_INFO_EVERY_N(n, ...) \
+// 限流日志：前 first_n 条全部输出，之后每 every_m 条输出一条。级别未开启时不计数。
+#define SM_LOG_LIMITED(level, first_n, every_m, ...) \
+    do { \
+        if constexpr (static_cast<int>(level) >= SM_LOG_ACTIVE_LEVEL) { \
+            static const int sm_log_slot_ = ::SMLogger::Logger::ModuleSlot(SM_LOG_MODULE); \
+            ::spdlog::logger* sm_log_ptr_ = ::SMLogger::Logger::Get(sm_log_slot_); \
+            if (sm_log_ptr_ && sm_log_ptr_->should_log(::SMLogger::ToSpdlogLevel(level))) { \
+                static ::SMLogger::RateLimiter sm_log_limiter_(__FILE__, __LINE__, (first_n), (every_m)); \
+                if (sm_log_limiter_.Allow()) \
+                    sm_log_ptr_->log(::SMLogger::ToSpdlogLevel(level), __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+#define SM_DEBUG_LIMITED(first_n, every_m, ...) SM_LOG_LIMITED(::SMLogger::LogLevel::DEBUG, first_n, every_m, __VA_ARGS__)
+#define SM_INFO_LIMITED(first_n, every_m, ...)  SM_LOG_LIMITED(::SMLogger::LogLevel::INFO, first_n, every_m, __VA_ARGS__)
+#define SM_WARN_LIMITED(first_n, every_m, ...)  SM_LOG_LIMITED(::SMLogger::LogLevel::WARN, first_n, every_m, __VA_ARGS__)
+#define SM_ERROR_LIMITED(first_n, every_m, ...) SM_LOG_LIMITED(::SMLogger::LogLevel::ERROR, first_n, every_m, __VA_ARGS__)
+
+// 定时日志（避免日志轰炸）：第 n、2n、3n… 次输出
+#define SM_INFO_EVERY_N(n, ...) SM_INFO_LIMITED(0, n, __VA_ARGS__)
+
+// 聚合计数：代替逐事件日志，周期/最终汇总里按名字输出总数与增量
+#define SM_COUNT_ADD(name, n) \
     do { \
-        static int _log_count = 0; \
-        if (++_log_count % (n) == 0) SM_INFO(__VA_ARGS__); \
-    } while(0)
+        static ::SMLogger::LogCounter sm_log_counter_(name); \
+        sm_log_counter_.Add(n); \
+    } while (0)
+#define SM_COUNT(name) SM_COUNT_ADD(name, 1)
 
 } // namespace SMLogger
 
@@ -8,7 +8,10 @@
 
 #include <algorithm>
 #include <cctype>
+#include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <sstream>
 
 namespace SMLogger {
 namespace {
@@ -32,6 +35,16 @@ bool ParseLogLevel(const char* value, LogLevel* level) {
     return false;
 }
 
+std::int64_t SteadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* BaseName(const char* path) {
+    const char* slash = std::strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
 }  // namespace
 
 LogConfig MakeLogConfigFromEnvironment(LogConfig config) {
@@ -40,6 +53,20 @@ LogConfig MakeLogConfigFromEnvironment(LogConfig config) {
         config.level = level;
     }
 
+    // SM_LOG_MODULES="NEBULA=DEBUG,PDC=WARN"
+    if (const char* modules = std::getenv("SM_LOG_MODULES")) {
+        std::stringstream list(modules);
+        std::string item;
+        while (std::getline(list, item, ',')) {
+            const std::size_t eq = item.find('=');
+            if (eq == std::string::npos || eq == 0) continue;
+            LogLevel module_level;
+            if (ParseLogLevel(item.c_str() + eq + 1, &module_level)) {
+                config.module_levels[item.substr(0, eq)] = module_level;
+            }
+        }
+    }
+
     const char* log_file = std::getenv("SM_LOG_FILE");
     if (log_file && log_file[0] != '\0') {
         config.file = true;
@@ -49,17 +76,21 @@ LogConfig MakeLogConfigFromEnvironment(LogConfig config) {
     return config;
 }
 
+std::atomic<spdlog::logger*> Logger::s_loggers[Logger::kMaxModules] = {};
+
 Logger& Logger::Instance() {
     static Logger instance;
     return instance;
 }
 
+Logger::Logger() : m_module_names{"SMSimulator"} {}
+
 Logger::~Logger() {
     Shutdown();
 }
 
 void Logger::Initialize(const LogConfig& config) {
-    if (m_initialized) {
+    if (m_initialized.load(std::memory_order_acquire)) {
         spdlog::warn("Logger already initialized, reinitializing...");
         Shutdown();
     }
@@ -107,15 +138,7 @@ void Logger::Initialize(const LogConfig& config) {
         }
         
         // 设置日志级别
-        switch (config.level) {
-            case LogLevel::TRACE:    m_default_logger->set_level(spdlog::level::trace); break;
-            case LogLevel::DEBUG:    m_default_logger->set_level(spdlog::level::debug); break;
-            case LogLevel::INFO:     m_default_logger->set_level(spdlog::level::info); break;
-            case LogLevel::WARN:     m_default_logger->set_level(spdlog::level::warn); break;
-            case LogLevel::ERROR:    m_default_logger->set_level(spdlog::level::err); break;
-            case LogLevel::CRITICAL: m_default_logger->set_level(spdlog::level::critical); break;
-            case LogLevel::OFF:      m_default_logger->set_level(spdlog::level::off); break;
-        }
+        m_default_logger->set_level(ToSpdlogLevel(config.level));
         
         // 注册为默认 logger
         spdlog::set_default_logger(m_default_logger);
@@ -123,7 +146,10 @@ void Logger::Initialize(const LogConfig& config) {
         // 设置刷新策略（警告级别及以上立即刷新）
         m_default_logger->flush_on(spdlog::level::warn);
         
-        m_initialized = true;
+        // 发布默认 logger 的裸指针；模块 logger 在首次使用时从它克隆
+        s_loggers[0].store(m_default_logger.get(), std::memory_order_release);
+        m_last_summary_ns.store(SteadyNowNs(), std::memory_order_relaxed);
+        m_initialized.store(true, std::memory_order_release);
         
         SM_INFO("SMSimulator Logger initialized");
         SM_INFO("  Mode: {}", config.async ? "Async" : "Sync");
@@ -136,71 +162,261 @@ void Logger::Initialize(const LogConfig& config) {
         
     } catch (const spdlog::spdlog_ex& ex) {
         fprintf(stderr, "Logger initialization failed: %s\n", ex.what());
-        m_initialized = false;
+        m_initialized.store(false, std::memory_order_release);
     }
 }
 
 void Logger::Shutdown() {
-    if (m_initialized) {
+    if (m_initialized.load(std::memory_order_acquire)) {
         // 避免在关闭 spdlog 线程池前再向异步 logger 提交日志（可能会抛出
         // "thread pool doesn't exist anymore" 异常或引起竞态）。
         // 使用直接输出到 stderr 代替 SM_INFO，以保证不会调用 spdlog 的异步机制。
         fprintf(stderr, "SMSimulator: Shutting down logger...\n");
         
-        // 先刷新所有待处理的日志
-        if (m_default_logger) {
-            m_default_logger->flush();
+        // 计数器与限流的最终汇总（此时 logger 仍可用）
+        EmitSummary(true);
+        
+        // 撤下宏使用的裸指针。其他线程可能刚读到旧指针、仍在写日志，所以 logger 对象
+        // 移入 m_retired_loggers 保留到进程退出，而不是在这里释放（否则是 use-after-free）。
+        std::shared_ptr<spdlog::logger> default_logger;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (int slot = 0; slot < kMaxModules; ++slot) {
+                s_loggers[slot].store(nullptr, std::memory_order_release);
+                if (m_module_loggers[slot]) {
+                    m_retired_loggers.push_back(std::move(m_module_loggers[slot]));
+                }
+            }
+            // 重置默认logger指针，之后的调用点会重新经过 Resolve
+            default_logger = std::move(m_default_logger);
+            if (default_logger) {
+                m_retired_loggers.push_back(default_logger);
+            }
         }
         
-        // 重置默认logger指针，防止在shutdown后还有代码试图使用它
-        m_default_logger.reset();
+        // 刷新所有待处理的日志
+        if (default_logger) {
+            default_logger->flush();
+        }
         
         // 关闭spdlog（会清理线程池）
         spdlog::shutdown();
         
-        m_initialized = false;
+        m_initialized.store(false, std::memory_order_release);
     }
 }
 
 void Logger::SetLevel(LogLevel level) {
-    if (!m_initialized) {
+    if (!m_initialized.load(std::memory_order_acquire)) {
         Initialize();
     }
+    if (!m_default_logger) {
+        return;
+    }
     
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_config.level = level;
-    switch (level) {
-        case LogLevel::TRACE:    m_default_logger->set_level(spdlog::level::trace); break;
-        case LogLevel::DEBUG:    m_default_logger->set_level(spdlog::level::debug); break;
-        case LogLevel::INFO:     m_default_logger->set_level(spdlog::level::info); break;
-        case LogLevel::WARN:     m_default_logger->set_level(spdlog::level::warn); break;
-        case LogLevel::ERROR:    m_default_logger->set_level(spdlog::level::err); break;
-        case LogLevel::CRITICAL: m_default_logger->set_level(spdlog::level::critical); break;
-        case LogLevel::OFF:      m_default_logger->set_level(spdlog::level::off); break;
+    m_default_logger->set_level(ToSpdlogLevel(level));
+    for (int slot = 1; slot < kMaxModules; ++slot) {
+        if (m_module_loggers[slot]) {
+            ApplyLevel(*m_module_loggers[slot], m_module_names[slot]);
+        }
+    }
+}
+
+void Logger::SetModuleLevel(const std::string& module, LogLevel level) {
+    const int slot = ModuleSlot(module.c_str());
+    if (slot == 0) {
+        SetLevel(level);
+        return;
+    }
+    Get(slot);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config.module_levels[module] = level;
+    if (m_module_loggers[slot]) {
+        ApplyLevel(*m_module_loggers[slot], module);
     }
 }
 
 std::shared_ptr<spdlog::logger> Logger::GetLogger(const std::string& name) {
-    if (!m_initialized) {
+    const int slot = ModuleSlot(name.c_str());
+    Get(slot);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return slot == 0 ? m_default_logger : m_module_loggers[slot];
+}
+
+int Logger::ModuleSlot(const char* module) {
+    if (!module || module[0] == '\0' || std::strcmp(module, "SMSimulator") == 0) {
+        return 0;
+    }
+    Logger& self = Instance();
+    std::lock_guard<std::mutex> lock(self.m_mutex);
+    const int count = static_cast<int>(self.m_module_names.size());
+    for (int slot = 1; slot < count; ++slot) {
+        if (self.m_module_names[slot] == module) {
+            return slot;
+        }
+    }
+    if (count >= kMaxModules) {
+        // 模块表已满：退回默认 logger（仍可输出，只是不能单独调级别）
+        return 0;
+    }
+    self.m_module_names.emplace_back(module);
+    return count;
+}
+
+spdlog::logger* Logger::Resolve(int slot) {
+    if (!m_initialized.load(std::memory_order_acquire)) {
         Initialize();
     }
     
-    if (name == "SMSimulator" || name.empty()) {
-        return m_default_logger;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (spdlog::logger* logger = s_loggers[slot].load(std::memory_order_acquire)) {
+        return logger;
+    }
+    if (!m_default_logger) {
+        return nullptr;
+    }
+    if (slot == 0) {
+        s_loggers[0].store(m_default_logger.get(), std::memory_order_release);
+        return m_default_logger.get();
     }
     
-    // 获取或创建命名 logger
+    // 获取或创建命名 logger（与默认 logger 共享 sink）
+    const std::string& name = m_module_names[slot];
     auto logger = spdlog::get(name);
     if (!logger) {
         logger = m_default_logger->clone(name);
         spdlog::register_logger(logger);
     }
-    return logger;
+    ApplyLevel(*logger, name);
+    m_module_loggers[slot] = logger;
+    s_loggers[slot].store(logger.get(), std::memory_order_release);
+    return logger.get();
+}
+
+void Logger::ApplyLevel(spdlog::logger& logger, const std::string& module) const {
+    const auto it = m_config.module_levels.find(module);
+    logger.set_level(ToSpdlogLevel(it != m_config.module_levels.end() ? it->second : m_config.level));
+}
+
+void Logger::MaybeEmitSummary() {
+    if (!m_initialized.load(std::memory_order_acquire) || m_config.summary_interval_s <= 0) {
+        return;
+    }
+    const std::int64_t now = SteadyNowNs();
+    std::int64_t last = m_last_summary_ns.load(std::memory_order_relaxed);
+    if (now - last < static_cast<std::int64_t>(m_config.summary_interval_s * 1e9)) {
+        return;
+    }
+    // 只让一个线程输出本周期的汇总
+    if (m_last_summary_ns.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        EmitSummary(false);
+    }
+}
+
+void Logger::EmitSummary(bool final_summary) {
+    std::shared_ptr<spdlog::logger> logger;
+    std::string text;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        logger = m_default_logger;
+        if (!logger) {
+            return;
+        }
+        
+        // 同名计数器（不同调用点）合并：名字 → (总数, 增量)
+        std::map<std::string, std::pair<std::uint64_t, std::uint64_t>> totals;
+        for (LogCounter* counter : m_counters) {
+            const std::uint64_t value = counter->Value();
+            auto& entry = totals[counter->Name()];
+            entry.first += value;
+            entry.second += value - counter->m_reported;
+            counter->m_reported = value;
+        }
+        for (const auto& [name, entry] : totals) {
+            if (!final_summary && entry.second == 0) continue;
+            text += fmt::format(" {}={} (+{})", name, entry.first, entry.second);
+        }
+        
+        if (final_summary) {
+            std::string suppressed;
+            for (const RateLimiter* limiter : m_limiters) {
+                if (limiter->Suppressed() > 0) {
+                    suppressed += fmt::format(" {}:{}={}/{}", BaseName(limiter->File()), limiter->Line(),
+                                              limiter->Suppressed(), limiter->Count());
+                }
+            }
+            if (!suppressed.empty()) {
+                text += " | suppressed (call site=suppressed/total):" + suppressed;
+            }
+        }
+    }
+    if (!text.empty()) {
+        logger->info("{}{}", final_summary ? "Log summary (final):" : "Log summary:", text);
+    }
+}
+
+std::uint64_t Logger::GetCounterTotal(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::uint64_t total = 0;
+    for (const LogCounter* counter : m_counters) {
+        if (name == counter->Name()) {
+            total += counter->Value();
+        }
+    }
+    return total;
 }
 
 void Logger::Flush() {
-    if (m_initialized && m_default_logger) {
+    if (m_initialized.load(std::memory_order_acquire) && m_default_logger) {
         m_default_logger->flush();
     }
 }
 
+RateLimiter::RateLimiter(const char* file, int line, std::uint64_t first_n, std::uint64_t every_m)
+    : m_file(file), m_line(line), m_first_n(first_n), m_every_m(every_m) {
+    Logger& logger = Logger::Instance();
+    std::lock_guard<std::mutex> lock(logger.m_mutex);
+    logger.m_limiters.push_back(this);
+}
+
+RateLimiter::~RateLimiter() {
+    // 调用点静态对象先于 Logger 单例析构（构造时 Logger 已存在），此时注销是安全的
+    Logger& logger = Logger::Instance();
+    std::lock_guard<std::mutex> lock(logger.m_mutex);
+    logger.m_limiters.erase(std::remove(logger.m_limiters.begin(), logger.m_limiters.end(), this),
+                            logger.m_limiters.end());
+}
+
+std::uint64_t RateLimiter::Suppressed() const {
+    const std::uint64_t n = Count();
+    std::uint64_t emitted = std::min(n, m_first_n);
+    if (m_every_m > 0 && n > m_first_n) {
+        emitted += (n - m_first_n) / m_every_m;
+    }
+    return n - emitted;
+}
+
+LogCounter::LogCounter(const char* name) : m_name(name) {
+    Logger& logger = Logger::Instance();
+    std::lock_guard<std::mutex> lock(logger.m_mutex);
+    logger.m_counters.push_back(this);
+}
+
+LogCounter::~LogCounter() {
+    Logger& logger = Logger::Instance();
+    std::lock_guard<std::mutex> lock(logger.m_mutex);
+    logger.m_counters.erase(std::remove(logger.m_counters.begin(), logger.m_counters.end(), this),
+                            logger.m_counters.end());
+}
+
+void LogCounter::Add(std::uint64_t n) {
+    const std::uint64_t before = m_value.fetch_add(n, std::memory_order_relaxed);
+    // 每跨过 64 次才看一次时钟，计数本身只是一次原子加
+    if (((before + n) >> 6) != (before >> 6)) {
+        Logger::Instance().MaybeEmitSummary();
+    }
+}
+
 } // namespace SMLogger
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include "ChainedEventDataReader.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void WriteSimLikeFile(const fs::path& path, int entries) {
+    TFile file(path.c_str(), "RECREATE");
+    TTree tree("tree", "index test");
+    int value = 0;
+    tree.Branch("value", &value);
+    for (int i = 0; i < entries; ++i) {
+        value = i;
+        tree.Fill();
+    }
+    tree.Write();
+    file.Close();
+}
+
+class ChainedEventDataReaderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        fDir = fs::temp_directory_path() /
+               ("smsim_chain_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        fs::remove_all(fDir);
+        fs::create_directories(fDir / "sub");
+        WriteSimLikeFile(fDir / "a.root", 5);
+        WriteSimLikeFile(fDir / "b.root", 0);
+        WriteSimLikeFile(fDir / "sub" / "c.root", 7);
+        WriteSimLikeFile(fDir / "a_reco.root", 3);
+    }
+    void TearDown() override { fs::remove_all(fDir); }
+
+    fs::path fDir;
+};
+
+TEST_F(ChainedEventDataReaderTest, ExpandsDirectoriesAndGlobs) {
+    const auto from_dir = ChainedEventDataReader::ExpandInputs(fDir.string());
+    ASSERT_EQ(3u, from_dir.size());
+    EXPECT_EQ((fDir / "a.root").string(), from_dir[0]);
+
+    const auto from_glob = ChainedEventDataReader::ExpandInputs((fDir / "?.root").string());
+    ASSERT_EQ(2u, from_glob.size());
+    EXPECT_EQ((fDir / "b.root").string(), from_glob[1]);
+}
+
+TEST_F(ChainedEventDataReaderTest, MapsGlobalEntriesAcrossFiles) {
+    ChainedEventDataReader chain(ChainedEventDataReader::ExpandInputs(fDir.string()));
+    ASSERT_TRUE(chain.BuildIndex(std::string()));
+    EXPECT_EQ(12, chain.GetTotalEvents());
+
+    ChainedEventDataReader::Location location;
+    ASSERT_TRUE(chain.Locate(4, &location));
+    EXPECT_EQ(0u, location.file_index);
+    EXPECT_EQ(4, location.local_entry);
+    // [EN] The empty file owns no entries, so entry 5 lands on the first entry of c.root. / [CN] 空文件不占编号，第 5 条落在 c.root 的第 0 条。
+    ASSERT_TRUE(chain.Locate(5, &location));
+    EXPECT_EQ(2u, location.file_index);
+    EXPECT_EQ(0, location.local_entry);
+    EXPECT_FALSE(chain.Locate(12, &location));
+    EXPECT_EQ(11, chain.ToGlobalEntry(2, 6));
+
+    Long64_t covered = 0;
+    for (int p = 0; p < 5; ++p) {
+        const auto range = chain.PartitionRange(p, 5);
+        EXPECT_EQ(covered, range.first);
+        covered = range.second;
+    }
+    EXPECT_EQ(chain.GetTotalEvents(), covered);
+}
+
+TEST_F(ChainedEventDataReaderTest, ReusesCacheAndRescansChangedFiles) {
+    const auto files = ChainedEventDataReader::ExpandInputs(fDir.string());
+    const std::string cache = ChainedEventDataReader::DefaultIndexCachePath(files);
+    EXPECT_EQ((fDir / ".smsim_event_index.tsv").string(), cache);
+
+    ChainedEventDataReader first(files);
+    ASSERT_TRUE(first.BuildIndex(cache));
+    EXPECT_EQ(3u, first.GetScannedFileCount());
+    ASSERT_TRUE(fs::exists(cache));
+
+    ChainedEventDataReader second(files);
+    ASSERT_TRUE(second.BuildIndex(cache));
+    EXPECT_EQ(0u, second.GetScannedFileCount());
+    EXPECT_EQ(12, second.GetTotalEvents());
+
+    WriteSimLikeFile(fDir / "b.root", 4);
+    ChainedEventDataReader third(files);
+    ASSERT_TRUE(third.BuildIndex(cache));
+    EXPECT_EQ(1u, third.GetScannedFileCount());
+    EXPECT_EQ(16, third.GetTotalEvents());
+}
+
+}  // namespace
@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+
+#include "EventDataReader.hh"
+#include "TBeamSimData.hh"
+#include "TSimData.hh"
+
+#include "TClonesArray.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int kEntries = 600;
+// [EN] Small clusters so a full pass crosses many cluster boundaries and exercises the prefetcher.
+// [CN] cluster 取小值，使一次完整读取跨越多个 cluster 边界，从而覆盖预读逻辑。
+constexpr int kEntriesPerCluster = 50;
+constexpr Long64_t kCacheBytes = 4 * 1024 * 1024;
+
+void AddHit(TClonesArray& hits, const char* detector, int id, double edep) {
+    auto* hit = new (hits[hits.GetEntriesFast()]) TSimData();
+    hit->fDetectorName = detector;
+    hit->fID = id;
+    hit->fEnergyDeposit = edep;
+}
+
+// [EN] The reader treats NEBULAPla/NEBULAPlusPla as opaque TClonesArrays, so TSimData stands in for the bar classes.
+// [CN] 读取器把 NEBULAPla/NEBULAPlusPla 当作普通 TClonesArray，因此用 TSimData 代替探测条类。
+void WriteSimFile(const fs::path& path) {
+    TFile file(path.c_str(), "RECREATE");
+    TTree tree("tree", "event data reader test");
+    tree.SetAutoFlush(kEntriesPerCluster);
+    TClonesArray* frag = new TClonesArray("TSimData", 8);
+    TClonesArray* nebula = new TClonesArray("TSimData", 8);
+    TClonesArray* nebula_plus = new TClonesArray("TSimData", 8);
+    std::vector<TBeamSimData>* beam = new std::vector<TBeamSimData>();
+    tree.Branch("FragSimData", &frag);
+    tree.Branch("NEBULAPla", &nebula);
+    tree.Branch("NEBULAPlusPla", &nebula_plus);
+    tree.Branch("beam", &beam);
+    for (int i = 0; i < kEntries; ++i) {
+        frag->Clear("C");
+        nebula->Clear("C");
+        nebula_plus->Clear("C");
+        beam->clear();
+        for (int k = 0; k <= i % 3; ++k) {
+            AddHit(*frag, "PDC", k, 1.0 + i);
+        }
+        AddHit(*nebula, "NEBULA", i % 120, 2.0 + i);
+        AddHit(*nebula_plus, "NEBULAPlus", i % 60, 3.0 + i);
+        AddHit(*nebula_plus, "NEBULAPlus", i % 60 + 1, 4.0 + i);
+        beam->emplace_back(TString("proton"), TLorentzVector(0.0, 0.0, 600.0 + i, 1130.0), TVector3(0.0, 0.0, -1.0));
+        tree.Fill();
+    }
+    tree.Write();
+    file.Close();
+    delete frag;
+    delete nebula;
+    delete nebula_plus;
+    delete beam;
+}
+
+double FirstEnergy(const TClonesArray* hits) {
+    if (!hits || hits->GetEntriesFast() == 0) {
+        return -1.0;
+    }
+    return static_cast<const TSimData*>(hits->At(0))->fEnergyDeposit;
+}
+
+// [EN] Per-entry fingerprint of everything the reader exposes. / [CN] 读取器所暴露内容的逐条目指纹。
+struct EntrySummary {
+    int frag_hits = -1;
+    double frag_edep = -1.0;
+    int nebula_hits = -1;
+    double nebula_edep = -1.0;
+    int nebula_plus_hits = -1;
+    double beam_pz = -1.0;
+
+    bool operator==(const EntrySummary& other) const {
+        return frag_hits == other.frag_hits && frag_edep == other.frag_edep && nebula_hits == other.nebula_hits &&
+               nebula_edep == other.nebula_edep && nebula_plus_hits == other.nebula_plus_hits &&
+               beam_pz == other.beam_pz;
+    }
+};
+
+EntrySummary Summarize(const EventDataReader& reader) {
+    EntrySummary summary;
+    if (const TClonesArray* hits = reader.GetHits()) {
+        summary.frag_hits = hits->GetEntriesFast();
+        summary.frag_edep = FirstEnergy(hits);
+    }
+    if (const TClonesArray* hits = reader.GetNEBULAHits()) {
+        summary.nebula_hits = hits->GetEntriesFast();
+        summary.nebula_edep = FirstEnergy(hits);
+    }
+    if (const TClonesArray* hits = reader.GetNEBULAPlusHits()) {
+        summary.nebula_plus_hits = hits->GetEntriesFast();
+    }
+    if (const std::vector<TBeamSimData>* beam = reader.GetBeamData(); beam && !beam->empty()) {
+        summary.beam_pz = beam->front().fMomentum.Pz();
+    }
+    return summary;
+}
+
+std::vector<EntrySummary> ReadAll(EventDataReader& reader) {
+    std::vector<EntrySummary> entries;
+    while (reader.NextEvent()) {
+        entries.push_back(Summarize(reader));
+    }
+    return entries;
+}
+
+class EventDataReaderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        fPath = fs::temp_directory_path() /
+                ("smsim_event_data_reader_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) +
+                 ".root");
+        WriteSimFile(fPath);
+    }
+    void TearDown() override { fs::remove(fPath); }
+
+    fs::path fPath;
+};
+
+TEST_F(EventDataReaderTest, DefaultsReadEveryBranch) {
+    EventDataReader reader(fPath.c_str());
+    ASSERT_TRUE(reader.IsOpen());
+    EXPECT_EQ(kEntries, reader.GetTotalEvents());
+    for (const char* branch : {"FragSimData", "NEBULAPla", "NEBULAPlusPla", "beam"}) {
+        EXPECT_TRUE(reader.IsBranchRead(branch)) << branch;
+    }
+
+    ASSERT_TRUE(reader.GoToEvent(7));
+    const EntrySummary summary = Summarize(reader);
+    EXPECT_EQ(2, summary.frag_hits);
+    EXPECT_DOUBLE_EQ(8.0, summary.frag_edep);
+    EXPECT_EQ(1, summary.nebula_hits);
+    EXPECT_DOUBLE_EQ(9.0, summary.nebula_edep);
+    EXPECT_EQ(2, summary.nebula_plus_hits);
+    EXPECT_DOUBLE_EQ(607.0, summary.beam_pz);
+}
+
+TEST_F(EventDataReaderTest, EachFlagDisablesOnlyItsBranch) {
+    struct Case {
+        const char* branch;
+        bool EventDataReaderOptions::*flag;
+    };
+    const std::vector<Case> cases = {
+        {"FragSimData", &EventDataReaderOptions::read_fragments},
+        {"NEBULAPla", &EventDataReaderOptions::read_nebula},
+        {"NEBULAPlusPla", &EventDataReaderOptions::read_nebula_plus},
+        {"beam", &EventDataReaderOptions::read_beam},
+    };
+    for (const Case& off : cases) {
+        SCOPED_TRACE(off.branch);
+        EventDataReaderOptions options;
+        options.*off.flag = false;
+        EventDataReader reader(fPath.c_str(), options);
+        ASSERT_TRUE(reader.IsOpen());
+        ASSERT_TRUE(reader.GoToEvent(7));
+
+        for (const Case& other : cases) {
+            EXPECT_EQ(other.branch != off.branch, reader.IsBranchRead(other.branch)) << other.branch;
+        }
+        const bool fragments = options.read_fragments;
+        const bool nebula = options.read_nebula;
+        const bool nebula_plus = options.read_nebula_plus;
+        const bool beam = options.read_beam;
+        EXPECT_EQ(fragments, reader.GetHits() != nullptr);
+        EXPECT_EQ(nebula, reader.GetNEBULAHits() != nullptr);
+        EXPECT_EQ(nebula_plus, reader.GetNEBULAPlusHits() != nullptr);
+        EXPECT_EQ(beam, reader.GetBeamData() != nullptr);
+        if (!beam) {
+            EXPECT_EQ(0, reader.GetBeamParticleCount());
+        }
+
+        // [EN] The branches still read must be unaffected by the disabled one. / [CN] 仍在读取的分支不应受被关闭分支影响。
+        const EntrySummary summary = Summarize(reader);
+        EXPECT_EQ(fragments ? 2 : -1, summary.frag_hits);
+        EXPECT_EQ(nebula ? 1 : -1, summary.nebula_hits);
+        EXPECT_EQ(nebula_plus ? 2 : -1, summary.nebula_plus_hits);
+        EXPECT_DOUBLE_EQ(beam ? 607.0 : -1.0, summary.beam_pz);
+    }
+}
+
+TEST_F(EventDataReaderTest, ApplyOptionsReenablesBranches) {
+    EventDataReaderOptions options;
+    options.read_nebula = false;
+    options.read_beam = false;
+    EventDataReader reader(fPath.c_str(), options);
+    ASSERT_TRUE(reader.IsOpen());
+    EXPECT_FALSE(reader.IsBranchRead("NEBULAPla"));
+
+    reader.ApplyOptions(EventDataReaderOptions());
+    EXPECT_TRUE(reader.IsBranchRead("NEBULAPla"));
+    EXPECT_TRUE(reader.IsBranchRead("beam"));
+    ASSERT_TRUE(reader.GoToEvent(11));
+    ASSERT_NE(nullptr, reader.GetNEBULAHits());
+    EXPECT_DOUBLE_EQ(13.0, FirstEnergy(reader.GetNEBULAHits()));
+    ASSERT_NE(nullptr, reader.GetBeamData());
+    EXPECT_DOUBLE_EQ(611.0, reader.GetBeamData()->front().fMomentum.Pz());
+}
+
+TEST_F(EventDataReaderTest, CacheSizeIsAppliedToTheTree) {
+    EventDataReaderOptions options;
+    options.cache_size_bytes = 0;
+    EventDataReader uncached(fPath.c_str(), options);
+    ASSERT_TRUE(uncached.IsOpen());
+    EXPECT_EQ(0, uncached.GetCacheSize());
+
+    options.cache_size_bytes = kCacheBytes;
+    EventDataReader cached(fPath.c_str(), options);
+    ASSERT_TRUE(cached.IsOpen());
+    EXPECT_EQ(kCacheBytes, cached.GetCacheSize());
+
+    cached.ApplyOptions(EventDataReaderOptions{});
+    EXPECT_GT(cached.GetCacheSize(), 0);
+    options.cache_size_bytes = 0;
+    cached.ApplyOptions(options);
+    EXPECT_EQ(0, cached.GetCacheSize());
+}
+
+TEST_F(EventDataReaderTest, PrefetchReadsTheSameEntries) {
+    EventDataReaderOptions options;
+    options.cache_size_bytes = kCacheBytes;
+    EventDataReader plain(fPath.c_str(), options);
+    ASSERT_TRUE(plain.IsOpen());
+    EXPECT_FALSE(plain.IsPrefetching());
+    const std::vector<EntrySummary> expected = ReadAll(plain);
+    ASSERT_EQ(static_cast<size_t>(kEntries), expected.size());
+
+    options.prefetch_clusters = true;
+    EventDataReader prefetched(fPath.c_str(), options);
+    ASSERT_TRUE(prefetched.IsOpen());
+    EXPECT_TRUE(prefetched.IsPrefetching());
+    EXPECT_EQ(kCacheBytes, prefetched.GetCacheSize());
+    const std::vector<EntrySummary> actual = ReadAll(prefetched);
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_TRUE(expected[i] == actual[i]) << "entry " << i;
+    }
+
+    // [EN] Random access across clusters must also agree with the sequential pass. / [CN] 跨 cluster 的随机访问也须与顺序读取一致。
+    for (const Long64_t entry : {Long64_t{520}, Long64_t{3}, Long64_t{260}, Long64_t{599}}) {
+        ASSERT_TRUE(prefetched.GoToEvent(entry));
+        EXPECT_TRUE(expected[entry] == Summarize(prefetched)) << "entry " << entry;
+    }
+}
+
+}  // namespace
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+
+#include "EventDataReader.hh"
+#include "EventStore.hh"
+#include "GeometryManager.hh"
+#include "PDCSimAna.hh"
+#include "TBeamSimData.hh"
+#include "TSimData.hh"
+
+#include "TClonesArray.h"
+#include "TFile.h"
+#include "TRandom3.h"
+#include "TTree.h"
+
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+namespace event_cache = analysis::event_cache;
+
+namespace {
+
+constexpr int kEntries = 12;
+
+void AddPdcHit(TClonesArray& hits, int plane, const char* layer, double x, double y, double z, double edep) {
+    auto* hit = new (hits[hits.GetEntriesFast()]) TSimData();
+    hit->fDetectorName = "PDC";
+    hit->fModuleName = layer;
+    hit->fID = plane;
+    hit->fPrePosition.SetXYZ(x, y, z);
+    hit->fEnergyDeposit = edep;
+}
+
+void WriteSimFile(const fs::path& path) {
+    TFile file(path.c_str(), "RECREATE");
+    TTree tree("tree", "event store test");
+    TClonesArray* hits = new TClonesArray("TSimData", 8);
+    std::vector<TBeamSimData>* beam = new std::vector<TBeamSimData>();
+    tree.Branch("FragSimData", &hits);
+    tree.Branch("beam", &beam);
+    for (int i = 0; i < kEntries; ++i) {
+        hits->Clear("C");
+        beam->clear();
+        if (i % 4 != 3) {
+            AddPdcHit(*hits, 0, "U", 100.0 + i, 5.0, 2000.0, 1.0);
+            AddPdcHit(*hits, 0, "V", 101.0 + i, 6.0, 2000.0, 0.5);
+            AddPdcHit(*hits, 1, "U", 300.0 + i, 8.0, 3000.0, 1.0);
+            AddPdcHit(*hits, 1, "V", 302.0 + i, 9.0, 3000.0, 2.0);
+        }
+        AddPdcHit(*hits, 2, "X", 0.0, 0.0, 0.0, 0.1);
+        beam->emplace_back(TString("proton"), TLorentzVector(10.0, 0.0, 600.0 + i, 1130.0),
+                           TVector3(0.0, 0.0, -1.0));
+        tree.Fill();
+    }
+    tree.Write();
+    file.Close();
+    delete hits;
+    delete beam;
+}
+
+class EventStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        fPath = fs::temp_directory_path() / "smsim_event_store_test.root";
+        WriteSimFile(fPath);
+    }
+    void TearDown() override { fs::remove(fPath); }
+
+    fs::path fPath;
+    GeometryManager fGeometry;
+};
+
+TEST_F(EventStoreTest, StoresPdcHitsAndTruthOnce) {
+    EventDataReader reader(fPath.c_str());
+    ASSERT_TRUE(reader.IsOpen());
+    event_cache::EventStore store;
+    std::string reason;
+    ASSERT_TRUE(store.Build(reader, fGeometry, event_cache::EventStoreOptions{}, &reason)) << reason;
+
+    ASSERT_EQ(static_cast<std::size_t>(kEntries), store.GetEventCount());
+    EXPECT_EQ(9u * 5u + 3u, store.GetPdcHitCount());
+    const PDCHitArrays first = store.PdcHits(0);
+    ASSERT_EQ(5u, first.size);
+    EXPECT_EQ(1, first.plane[2]);
+    EXPECT_EQ(0, first.layer[2]);
+    EXPECT_EQ(-1, first.plane[4]);
+    EXPECT_EQ(-1, first.layer[4]);
+    EXPECT_DOUBLE_EQ(300.0, first.x[2]);
+
+    const event_cache::EventTruth truth = store.Truth(5);
+    EXPECT_TRUE(truth.has_proton);
+    EXPECT_FALSE(truth.has_neutron);
+    EXPECT_DOUBLE_EQ(605.0, truth.proton_p4.Pz());
+    EXPECT_DOUBLE_EQ(-1.0, truth.proton_position.Z());
+
+    event_cache::EventStoreOptions auto_mode;
+    auto_mode.neutron_mode = analysis::neutron::NeutronDetectorMode::kAuto;
+    EXPECT_FALSE(store.Build(reader, fGeometry, auto_mode, &reason));
+}
+
+TEST_F(EventStoreTest, PassesMatchDirectProcessingAndIgnoreThreadCount) {
+    const std::vector<double> sigmas{0.0, 0.5, 2.0};
+    std::vector<event_cache::SmearingPass> passes;
+    for (std::size_t p = 0; p < sigmas.size(); ++p) {
+        event_cache::SmearingPass pass;
+        pass.pdc_sigma_u_mm = sigmas[p];
+        pass.pdc_sigma_v_mm = sigmas[p];
+        pass.seed = static_cast<unsigned int>(17 + p);
+        passes.push_back(pass);
+    }
+
+    // [EN] Reference: a fresh read of the file per configuration, exactly as before the store existed.
+    // [CN] 参照：每组配置重新读取文件，与引入缓存之前的做法相同。
+    std::vector<std::vector<RecoEvent>> direct(passes.size());
+    for (std::size_t p = 0; p < passes.size(); ++p) {
+        EventDataReader reader(fPath.c_str());
+        PDCSimAna pdc_ana(fGeometry);
+        TRandom3 rng(passes[p].seed);
+        pdc_ana.SetRandomGenerator(&rng);
+        pdc_ana.SetSmearing(passes[p].pdc_sigma_u_mm, passes[p].pdc_sigma_v_mm);
+        for (Long64_t entry = 0; entry < kEntries; ++entry) {
+            ASSERT_TRUE(reader.GoToEvent(entry));
+            direct[p].push_back(pdc_ana.ProcessEvent(reader.GetHits()));
+        }
+    }
+
+    EventDataReader reader(fPath.c_str());
+    event_cache::EventStore store;
+    ASSERT_TRUE(store.Build(reader, fGeometry, event_cache::EventStoreOptions{}));
+
+    for (const int threads : {1, 3}) {
+        std::mutex mutex;
+        std::vector<std::vector<RecoEvent>> cached(passes.size(), std::vector<RecoEvent>(store.GetEventCount()));
+        std::string reason;
+        ASSERT_TRUE(event_cache::RunSmearingPasses(
+            store, fGeometry, passes,
+            [&](std::size_t pass, std::size_t event, const RecoEvent& reco_event) {
+                std::lock_guard<std::mutex> lock(mutex);
+                cached[pass][event] = reco_event;
+            },
+            threads, &reason))
+            << reason;
+
+        for (std::size_t p = 0; p < passes.size(); ++p) {
+            for (std::size_t e = 0; e < store.GetEventCount(); ++e) {
+                const RecoEvent& a = direct[p][e];
+                const RecoEvent& b = cached[p][e];
+                ASSERT_EQ(a.rawHits.size(), b.rawHits.size());
+                ASSERT_EQ(a.smearedHits.size(), b.smearedHits.size());
+                ASSERT_EQ(a.tracks.size(), b.tracks.size()) << "pass " << p << " event " << e;
+                for (std::size_t t = 0; t < a.tracks.size(); ++t) {
+                    EXPECT_DOUBLE_EQ(a.tracks[t].start.X(), b.tracks[t].start.X());
+                    EXPECT_DOUBLE_EQ(a.tracks[t].start.Y(), b.tracks[t].start.Y());
+                    EXPECT_DOUBLE_EQ(a.tracks[t].end.X(), b.tracks[t].end.X());
+                    EXPECT_DOUBLE_EQ(a.tracks[t].end.Z(), b.tracks[t].end.Z());
+                }
+            }
+        }
+    }
+}
+
+TEST_F(EventStoreTest, ThrowingPassFailsTheRunInsteadOfTerminating) {
+    std::vector<event_cache::SmearingPass> passes(6);
+    for (std::size_t p = 0; p < passes.size(); ++p) {
+        passes[p].label = "pass" + std::to_string(p);
+    }
+
+    EventDataReader reader(fPath.c_str());
+    event_cache::EventStore store;
+    ASSERT_TRUE(store.Build(reader, fGeometry, event_cache::EventStoreOptions{}));
+
+    for (const int threads : {1, 3}) {
+        std::string reason;
+        EXPECT_FALSE(event_cache::RunSmearingPasses(
+            store, fGeometry, passes,
+            [](std::size_t pass, std::size_t event, const RecoEvent&) {
+                if (pass == 2 && event == 4) {
+                    throw std::runtime_error("visitor failed");
+                }
+            },
+            threads, &reason));
+        EXPECT_EQ("pass 'pass2' failed: visitor failed", reason) << "threads " << threads;
+    }
+}
+
+}  // namespace
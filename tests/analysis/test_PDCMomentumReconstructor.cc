@@ -1,18 +1,26 @@
 #include <gtest/gtest.h>
 
 #include "ParticleTrajectory.hh"
+#include "PDCFitResultCache.hh"
 #include "PDCMomentumReconstructor.hh"
+#include "PDCRecoFactory.hh"
 #include "PDCRecoRuntime.hh"
 
 #include <array>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
+using analysis::pdc::anaroot_like::PDCFitResultCache;
 using analysis::pdc::anaroot_like::PDCInputTrack;
 using analysis::pdc::anaroot_like::PDCMomentumReconstructor;
+using analysis::pdc::anaroot_like::PDCNNMomentumReconstructor;
+using analysis::pdc::anaroot_like::PDCRecoWorkspace;
 using analysis::pdc::anaroot_like::RecoConfig;
 using analysis::pdc::anaroot_like::RecoResult;
 using analysis::pdc::anaroot_like::RkFitMode;
@@ -97,6 +105,14 @@ RecoConfig MakeNnOnlyConfig(const std::string& model_path) {
     return config;
 }
 
+// [EN] Single linear layer: p = (x1, y1, pz_bias). / [CN] 单层线性模型：p = (x1, y1, pz_bias)。
+void WriteLinearModel(const std::string& path, double pz_bias) {
+    std::ofstream fout(path, std::ios::trunc);
+    ASSERT_TRUE(fout.is_open());
+    fout << "{\"x_mean\": [0,0,0,0,0,0], \"x_std\": [1,1,1,1,1,1], \"layers\": [{\"in_dim\": 6, \"out_dim\": 3, "
+         << "\"weights\": [1,0,0,0,0,0, 0,1,0,0,0,0, 0,0,0,0,0,0], \"bias\": [0,0," << pz_bias << "]}]}\n";
+}
+
 RecoConfig MakeRkOnlyConfig(double initial_p_mevc, RkFitMode mode = RkFitMode::kThreePointFree) {
     RecoConfig config;
     config.enable_rk = true;
@@ -324,3 +340,325 @@ TEST(PDCMomentumReconstructorTest, RKFixedTargetPdcOnlySupportsAnisotropicWireSi
     EXPECT_NEAR(result.fit_start_position.Y(), target_pos.Y(), 1.0e-9);
     EXPECT_NEAR(result.fit_start_position.Z(), target_pos.Z(), 1.0e-9);
 }
+
+TEST(PDCMomentumReconstructorTest, SharedStateReconstructsConcurrentlyWithPerThreadWorkspaces) {
+    // [EN] One immutable shared state + one workspace per thread must reproduce the serial result bit-for-bit. / [CN] 一个共享不可变状态 + 每线程一个工作区，结果须与串行逐位一致。
+    const std::string field_path = WriteConstantFieldMap("pdc_constant_field_rk_threads", 0.6);
+
+    MagneticField mag_field;
+    ASSERT_TRUE(mag_field.LoadFieldMap(field_path));
+    mag_field.SetRotationAngle(0.0);
+
+    const TVector3 target_pos(0.0, 0.0, 0.0);
+    const std::vector<TVector3> truth_momenta{
+        TVector3(120.0, 25.0, 700.0),
+        TVector3(90.0, -10.0, 650.0),
+        TVector3(140.0, 5.0, 720.0),
+        TVector3(100.0, 15.0, 680.0)
+    };
+    std::vector<PDCInputTrack> tracks;
+    for (const auto& p : truth_momenta) {
+        tracks.push_back(MakeSyntheticCurvedTrack(&mag_field, target_pos, p));
+    }
+
+    TargetConstraint target = MakeConstraint();
+    const RecoConfig config = MakeRkOnlyConfig(680.0, RkFitMode::kFixedTargetPdcOnly);
+
+    std::string reason;
+    const auto shared = analysis::pdc::anaroot_like::PDCRecoFactory::CreateSharedState(
+        &mag_field, target, config, &reason);
+    ASSERT_NE(shared, nullptr) << reason;
+    const PDCMomentumReconstructor reconstructor(shared);
+
+    std::vector<RecoResult> serial(tracks.size());
+    {
+        analysis::pdc::anaroot_like::PDCRecoWorkspace workspace;
+        for (std::size_t i = 0; i < tracks.size(); ++i) {
+            serial[i] = reconstructor.Reconstruct(tracks[i], &workspace);
+        }
+    }
+
+    std::vector<RecoResult> parallel(tracks.size());
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < tracks.size(); ++i) {
+        workers.emplace_back([&, i] {
+            analysis::pdc::anaroot_like::PDCRecoWorkspace workspace;
+            parallel[i] = reconstructor.Reconstruct(tracks[i], &workspace);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (std::size_t i = 0; i < tracks.size(); ++i) {
+        EXPECT_EQ(parallel[i].status, serial[i].status);
+        EXPECT_EQ(parallel[i].iterations, serial[i].iterations);
+        EXPECT_DOUBLE_EQ(parallel[i].p4_at_target.Px(), serial[i].p4_at_target.Px());
+        EXPECT_DOUBLE_EQ(parallel[i].p4_at_target.Py(), serial[i].p4_at_target.Py());
+        EXPECT_DOUBLE_EQ(parallel[i].p4_at_target.Pz(), serial[i].p4_at_target.Pz());
+    }
+}
+
+TEST(PDCMomentumReconstructorTest, FitCacheHitReturnsStoredResultAcrossSessions) {
+    const std::string field_path = WriteConstantFieldMap("pdc_constant_field_fit_cache", 0.6);
+    MagneticField mag_field;
+    ASSERT_TRUE(mag_field.LoadFieldMap(field_path));
+    mag_field.SetRotationAngle(0.0);
+
+    const TVector3 target_pos(0.0, 0.0, 0.0);
+    const PDCInputTrack track = MakeSyntheticCurvedTrack(&mag_field, target_pos, TVector3(120.0, 25.0, 700.0));
+    const TargetConstraint target = MakeConstraint();
+    const RecoConfig config = MakeRkOnlyConfig(680.0, RkFitMode::kFixedTargetPdcOnly);
+    const PDCMomentumReconstructor reconstructor(&mag_field);
+
+    const std::string cache_path = "/tmp/pdc_fit_cache_sessions.fitcache";
+    std::remove(cache_path.c_str());
+    const std::uint64_t field_fingerprint = PDCFitResultCache::FieldMapFingerprint(&mag_field);
+
+    RecoResult fitted;
+    {
+        PDCFitResultCache cache(field_fingerprint);
+        std::string reason;
+        ASSERT_TRUE(cache.Open(cache_path, &reason)) << reason;
+        fitted = reconstructor.Reconstruct(track, target, config, nullptr, &cache);
+        ASSERT_EQ(fitted.status, SolverStatus::kSuccess) << fitted.message;
+        EXPECT_EQ(cache.GetStats().misses, 1U);
+        EXPECT_EQ(cache.GetStats().inserted, 1U);
+    }
+
+    // [EN] A second pass reads the record back from disk and never reaches a solver. / [CN] 第二次运行从磁盘读回记录，不进入求解器。
+    PDCFitResultCache cache(field_fingerprint);
+    ASSERT_TRUE(cache.Open(cache_path));
+    EXPECT_EQ(cache.GetStats().loaded, 1U);
+    const RecoResult cached = reconstructor.Reconstruct(track, target, config, nullptr, &cache);
+    EXPECT_EQ(cache.GetStats().hits, 1U);
+    EXPECT_EQ(cache.GetStats().inserted, 0U);
+    EXPECT_EQ(cached.status, fitted.status);
+    EXPECT_EQ(cached.method_used, fitted.method_used);
+    EXPECT_EQ(cached.iterations, fitted.iterations);
+    EXPECT_EQ(cached.ndf, fitted.ndf);
+    EXPECT_EQ(cached.uncertainty_valid, fitted.uncertainty_valid);
+    EXPECT_EQ(cached.posterior_valid, fitted.posterior_valid);
+    EXPECT_DOUBLE_EQ(cached.p4_at_target.Px(), fitted.p4_at_target.Px());
+    EXPECT_DOUBLE_EQ(cached.p4_at_target.Pz(), fitted.p4_at_target.Pz());
+    EXPECT_DOUBLE_EQ(cached.p4_at_target.E(), fitted.p4_at_target.E());
+    EXPECT_DOUBLE_EQ(cached.chi2_reduced, fitted.chi2_reduced);
+    EXPECT_DOUBLE_EQ(cached.momentum_covariance[8], fitted.momentum_covariance[8]);
+    EXPECT_DOUBLE_EQ(cached.p_interval.upper95, fitted.p_interval.upper95);
+    EXPECT_EQ(cached.message, fitted.message);
+}
+
+TEST(PDCMomentumReconstructorTest, FitCacheInvalidatesOnKeyedInputChanges) {
+    const std::string cache_path = "/tmp/pdc_fit_cache_invalidation.fitcache";
+    std::remove(cache_path.c_str());
+
+    const PDCInputTrack track = MakeSimpleTrack();
+    const TargetConstraint target = MakeConstraint();
+    const RecoConfig config = MakeRkOnlyConfig(680.0);
+    RecoResult stored;
+    stored.status = SolverStatus::kSuccess;
+    stored.method_used = SolveMethod::kRungeKutta;
+    stored.p4_at_target.SetPxPyPzE(10.0, 20.0, 700.0, 1170.0);
+    stored.message = "stored";
+
+    {
+        PDCFitResultCache cache(/*field_fingerprint=*/1);
+        ASSERT_TRUE(cache.Open(cache_path));
+        cache.Insert(track, target, config, stored);
+        RecoResult out;
+        EXPECT_TRUE(cache.Lookup(track, target, config, &out));
+        EXPECT_EQ(out.message, "stored");
+
+        PDCInputTrack moved = track;
+        moved.pdc2.SetX(moved.pdc2.X() + 1.0e-9);
+        EXPECT_FALSE(cache.Lookup(moved, target, config, &out));
+        TargetConstraint shifted = target;
+        shifted.target_position.SetZ(1.0);
+        EXPECT_FALSE(cache.Lookup(track, shifted, config, &out));
+        RecoConfig retuned = config;
+        retuned.tolerance_mm *= 2.0;
+        EXPECT_FALSE(cache.Lookup(track, target, retuned, &out));
+    }
+
+    // [EN] A torn tail is cut back to the last complete record. / [CN] 残缺尾部截断到最后一条完整记录。
+    {
+        std::ofstream torn(cache_path, std::ios::binary | std::ios::app);
+        torn << "partial";
+    }
+    {
+        PDCFitResultCache cache(1);
+        ASSERT_TRUE(cache.Open(cache_path));
+        EXPECT_EQ(cache.GetStats().loaded, 1U);
+        EXPECT_EQ(cache.GetStats().discarded, 7U);
+        EXPECT_TRUE(cache.Lookup(track, target, config, nullptr));
+    }
+
+    // [EN] A different field map discards the whole file. / [CN] 磁场图变化时整个文件作废。
+    PDCFitResultCache cache(2);
+    ASSERT_TRUE(cache.Open(cache_path));
+    EXPECT_EQ(cache.GetStats().loaded, 0U);
+    EXPECT_GT(cache.GetStats().discarded, 0U);
+    EXPECT_FALSE(cache.Lookup(track, target, config, nullptr));
+}
+
+TEST(PDCMomentumReconstructorTest, FitCacheMissesAfterNNModelFileIsReplaced) {
+    // [EN] Same path and RecoConfig, new weights: the stored NN result must not be served. / [CN] 路径与 RecoConfig
+    // 不变而权重改变时，不得返回已存储的 NN 结果。
+    const std::string model_path = "/tmp/pdc_nn_model_test_cache_swap.json";
+    const std::string cache_path = "/tmp/pdc_fit_cache_model_swap.fitcache";
+    std::remove(cache_path.c_str());
+    const PDCInputTrack track = MakeSimpleTrack();
+    const TargetConstraint target = MakeConstraint();
+    const RecoConfig config = MakeNnOnlyConfig(model_path);
+    const PDCMomentumReconstructor reconstructor(nullptr);
+
+    WriteLinearModel(model_path, 600.0);
+    PDCNNMomentumReconstructor first;
+    ASSERT_TRUE(first.LoadModel(model_path, nullptr));
+    {
+        PDCRecoWorkspace workspace;
+        PDCFitResultCache cache(/*field_fingerprint=*/1);
+        ASSERT_TRUE(cache.Open(cache_path));
+        const RecoResult result = reconstructor.Reconstruct(track, target, config, &workspace, &cache);
+        ASSERT_EQ(result.status, SolverStatus::kSuccess) << result.message;
+        EXPECT_NEAR(result.p4_at_target.Pz(), 600.0, 1.0e-9);
+        EXPECT_EQ(cache.GetStats().inserted, 1U);
+    }
+
+    WriteLinearModel(model_path, 900.0);
+    PDCNNMomentumReconstructor second;
+    ASSERT_TRUE(second.LoadModel(model_path, nullptr));
+    EXPECT_NE(first.ContentFingerprint(), second.ContentFingerprint());
+    EXPECT_NE(PDCFitResultCache::ConfigFingerprint(config, &first),
+              PDCFitResultCache::ConfigFingerprint(config, &second));
+
+    PDCRecoWorkspace workspace;
+    PDCFitResultCache cache(1);
+    ASSERT_TRUE(cache.Open(cache_path));
+    EXPECT_EQ(cache.GetStats().loaded, 1U);
+    const RecoResult result = reconstructor.Reconstruct(track, target, config, &workspace, &cache);
+    EXPECT_EQ(cache.GetStats().hits, 0U);
+    EXPECT_EQ(cache.GetStats().inserted, 1U);
+    EXPECT_NEAR(result.p4_at_target.Pz(), 900.0, 1.0e-9);
+    EXPECT_TRUE(cache.Lookup(track, target, config, nullptr, &second));
+    EXPECT_TRUE(cache.Lookup(track, target, config, nullptr, &first));
+}
+
+TEST(PDCMomentumReconstructorTest, FitCacheKeysOnTheResolvedNNModelPath) {
+    // [EN] An empty nn_model_json_path falls back to PDC_NN_MODEL_JSON, which must then reach the key.
+    // [CN] nn_model_json_path 为空时回退到 PDC_NN_MODEL_JSON，该路径必须进入缓存键。
+    RecoConfig config = MakeNnOnlyConfig("");
+    ASSERT_EQ(setenv("PDC_NN_MODEL_JSON", "/tmp/model_a.json", 1), 0);
+    EXPECT_EQ(PDCNNMomentumReconstructor::ResolveModelPath(config), "/tmp/model_a.json");
+    const std::uint64_t env_a = PDCFitResultCache::ConfigFingerprint(config);
+    ASSERT_EQ(setenv("PDC_NN_MODEL_JSON", "/tmp/model_b.json", 1), 0);
+    const std::uint64_t env_b = PDCFitResultCache::ConfigFingerprint(config);
+    EXPECT_NE(env_a, env_b);
+    config.nn_model_json_path = "/tmp/model_b.json";
+    EXPECT_EQ(PDCFitResultCache::ConfigFingerprint(config), env_b);
+    unsetenv("PDC_NN_MODEL_JSON");
+
+    // [EN] Without NN the model path does not matter. / [CN] 未启用 NN 时模型路径不影响缓存键。
+    RecoConfig rk = MakeRkOnlyConfig(680.0);
+    const std::uint64_t rk_plain = PDCFitResultCache::ConfigFingerprint(rk);
+    rk.nn_model_json_path = "/tmp/model_a.json";
+    EXPECT_EQ(PDCFitResultCache::ConfigFingerprint(rk), rk_plain);
+}
+
+TEST(PDCMomentumReconstructorTest, ReconstructBatchMatchesPerTrackReconstruct) {
+    // [EN] Two-layer model with a ReLU hidden layer; more tracks than one inference block, plus tracks the NN
+    // rejects so the chain fallback is exercised. / [CN] 含 ReLU 隐藏层的两层模型；径迹数超过一个推理块，
+    // 并包含 NN 拒绝的径迹以覆盖求解链回退。
+    const std::string model_path = "/tmp/pdc_nn_model_test_batch.json";
+    {
+        std::ofstream fout(model_path);
+        ASSERT_TRUE(fout.is_open());
+        fout << "{\n";
+        fout << "  \"format\": \"smsimulator_pdc_mlp_v1\",\n";
+        fout << "  \"x_mean\": [10,0,1000,20,0,2000],\n";
+        fout << "  \"x_std\": [5,5,100,5,5,100],\n";
+        fout << "  \"layers\": [\n";
+        fout << "    {\"in_dim\": 6, \"out_dim\": 4,\n";
+        fout << "     \"weights\": [1,0.5,0,-1,0,0.2, -0.3,1,0.1,0,0.4,0, 0,0,1,0.5,-0.5,1, 0.7,-0.2,0,0.3,1,-1],\n";
+        fout << "     \"bias\": [0.1,-0.2,0.3,0]},\n";
+        fout << "    {\"in_dim\": 4, \"out_dim\": 3,\n";
+        fout << "     \"weights\": [20,-5,3,1, 2,15,-4,6, 10,8,40,-7],\n";
+        fout << "     \"bias\": [0,0,600]}\n";
+        fout << "  ]\n";
+        fout << "}\n";
+    }
+
+    constexpr std::size_t kTracks = 150;
+    std::vector<double> x1(kTracks), y1(kTracks), z1(kTracks), x2(kTracks), y2(kTracks), z2(kTracks);
+    for (std::size_t i = 0; i < kTracks; ++i) {
+        const double s = static_cast<double>(i);
+        x1[i] = 10.0 + 0.37 * s - 0.002 * s * s;
+        y1[i] = std::sin(0.3 * s) * 8.0;
+        z1[i] = 1000.0 + 3.0 * s;
+        x2[i] = 20.0 + 0.11 * s;
+        y2[i] = std::cos(0.2 * s) * 6.0;
+        z2[i] = 2000.0 - 2.0 * s;
+    }
+    x2[7] = x1[7];
+    y2[7] = y1[7];
+    z2[7] = z1[7];
+    y1[80] = std::nan("");
+
+    PDCMomentumReconstructor reconstructor(nullptr);
+    const TargetConstraint target = MakeConstraint();
+    const RecoConfig config = MakeNnOnlyConfig(model_path);
+
+    analysis::pdc::anaroot_like::PDCBatchInput input;
+    input.size = kTracks;
+    input.pdc1_x = x1.data();
+    input.pdc1_y = y1.data();
+    input.pdc1_z = z1.data();
+    input.pdc2_x = x2.data();
+    input.pdc2_y = y2.data();
+    input.pdc2_z = z2.data();
+
+    std::vector<int> status(kTracks, -1), method(kTracks, -1), iterations(kTracks, -1);
+    std::vector<double> px(kTracks), py(kTracks), pz(kTracks), energy(kTracks), brho(kTracks);
+    analysis::pdc::anaroot_like::PDCBatchOutput output;
+    output.status = status.data();
+    output.method = method.data();
+    output.iterations = iterations.data();
+    output.px = px.data();
+    output.py = py.data();
+    output.pz = pz.data();
+    output.energy = energy.data();
+    output.brho_tm = brho.data();
+
+    analysis::pdc::anaroot_like::PDCRecoWorkspace workspace;
+    std::string reason;
+    ASSERT_TRUE(reconstructor.ReconstructBatch(input, target, config, output, &workspace, nullptr, &reason))
+        << reason;
+
+    std::size_t successes = 0;
+    for (std::size_t i = 0; i < kTracks; ++i) {
+        PDCInputTrack track;
+        track.pdc1.SetXYZ(x1[i], y1[i], z1[i]);
+        track.pdc2.SetXYZ(x2[i], y2[i], z2[i]);
+        const RecoResult single = reconstructor.Reconstruct(track, target, config, &workspace, nullptr);
+        ASSERT_EQ(status[i], static_cast<int>(single.status)) << "track " << i;
+        EXPECT_EQ(method[i], static_cast<int>(single.method_used));
+        EXPECT_EQ(iterations[i], single.iterations);
+        if (single.status != SolverStatus::kSuccess) {
+            continue;
+        }
+        ++successes;
+        // [EN] Same accumulation order, but the compiler may contract the blocked loop into FMAs differently.
+        // [CN] 累加顺序相同，但编译器对分块循环的 FMA 收缩可能不同。
+        EXPECT_NEAR(px[i], single.p4_at_target.Px(), 1.0e-9) << "track " << i;
+        EXPECT_NEAR(py[i], single.p4_at_target.Py(), 1.0e-9);
+        EXPECT_NEAR(pz[i], single.p4_at_target.Pz(), 1.0e-9);
+        EXPECT_NEAR(energy[i], single.p4_at_target.E(), 1.0e-9);
+        EXPECT_NEAR(brho[i], single.brho_tm, 1.0e-12);
+    }
+    EXPECT_EQ(status[7], static_cast<int>(SolverStatus::kInvalidInput));
+    EXPECT_EQ(status[80], static_cast<int>(SolverStatus::kInvalidInput));
+    EXPECT_EQ(successes, kTracks - 2);
+
+    input.pdc2_z = nullptr;
+    EXPECT_FALSE(reconstructor.ReconstructBatch(input, output, &workspace, &reason));
+}
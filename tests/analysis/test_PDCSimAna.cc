@@ -0,0 +1,349 @@
+#include <gtest/gtest.h>
+
+#include "GeometryManager.hh"
+#include "PDCSimAna.hh"
+#include "TSimData.hh"
+
+#include "TClonesArray.h"
+#include "TMath.h"
+#include "TRandom3.h"
+#include "TVector3.h"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// [EN] Hits in struct-of-arrays form, as EventStore hands them to PDCSimAna. / [CN] 以 SoA 形式组织的击中，与 EventStore 交给 PDCSimAna 的格式一致。
+struct HitColumns {
+    std::vector<double> x, y, z, energy;
+    std::vector<signed char> plane, layer;
+
+    void Add(int p, int l, const TVector3& pos, double e) {
+        x.push_back(pos.X());
+        y.push_back(pos.Y());
+        z.push_back(pos.Z());
+        energy.push_back(e);
+        plane.push_back(static_cast<signed char>(p));
+        layer.push_back(static_cast<signed char>(l));
+    }
+
+    PDCHitArrays View() const {
+        PDCHitArrays view;
+        view.x = x.data();
+        view.y = y.data();
+        view.z = z.data();
+        view.energy = energy.data();
+        view.plane = plane.data();
+        view.layer = layer.data();
+        view.size = x.size();
+        return view;
+    }
+};
+
+class PDCSimAnaTrackFinderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        fMacro = fs::temp_directory_path() / "smsim_pdc_track_finder_geometry.mac";
+        std::ofstream macro(fMacro);
+        macro << "/samurai/geometry/PDC/Angle 60\n"
+              << "/samurai/geometry/PDC/Position1 0 0 4000 mm\n"
+              << "/samurai/geometry/PDC/Position2 0 0 5000 mm\n"
+              << "/samurai/geometry/Target/Position 0 0 0 mm\n";
+        macro.close();
+        ASSERT_TRUE(fGeometry.LoadGeometry(fMacro.string()));
+    }
+    void TearDown() override { fs::remove(fMacro); }
+
+    // [EN] Lab-frame point at wire-plane coordinate s (along the U/V plane axis) and height y on a PDC.
+    // [CN] PDC 上丝平面坐标 s（沿 U/V 平面轴）与高度 y 对应的实验室系坐标。
+    TVector3 PointOn(int plane, double s, double y) const {
+        const double angle = fGeometry.GetAngleRad();
+        TVector3 center = plane == 0 ? fGeometry.GetPDC1Position() : fGeometry.GetPDC2Position();
+        center.RotateY(-angle);
+        return center + TVector3(s * std::cos(angle), y, s * std::sin(angle));
+    }
+
+    // [EN] One U and one V hit on each PDC; y2 follows the straight vertical line from the target.
+    // [CN] 每个 PDC 各一个 U、V 击中；y2 沿自靶点出发的竖直直线外推。
+    void AddTrack(HitColumns& hits, double s1, double y1, double s2, double energy) const {
+        const TVector3 p1 = PointOn(0, s1, y1);
+        TVector3 p2 = PointOn(1, s2, 0.0);
+        p2.SetY(y1 + y1 * (p2 - p1).Mag() / p1.Mag());
+        for (int layer = 0; layer < 2; ++layer) {
+            hits.Add(0, layer, p1, energy);
+            hits.Add(1, layer, p2, energy);
+        }
+    }
+
+    fs::path fMacro;
+    GeometryManager fGeometry;
+};
+
+TEST_F(PDCSimAnaTrackFinderTest, ResolvesTwoSeparatedTracks) {
+    HitColumns hits;
+    AddTrack(hits, -200.0, 50.0, -230.0, 1.0);
+    AddTrack(hits, 300.0, -80.0, 360.0, 3.0);
+
+    PDCSimAna legacy(fGeometry);
+    RecoEvent legacy_event;
+    legacy.ProcessEvent(hits.View(), legacy_event);
+    EXPECT_EQ(1u, legacy_event.tracks.size());
+
+    PDCSimAna pdc_ana(fGeometry);
+    PDCTrackFinderConfig config;
+    config.enabled = true;
+    pdc_ana.SetTrackFinder(config);
+    RecoEvent event;
+    pdc_ana.ProcessEvent(hits.View(), event);
+
+    // [EN] Ghost U/V combinations share clusters with the real tracks and must not survive the assignment.
+    // [CN] 鬼点 U/V 组合与真实径迹共用团簇，不应通过分配。
+    ASSERT_EQ(2u, event.tracks.size());
+    EXPECT_EQ(4u, event.smearedHits.size());
+    for (const RecoTrack& track : event.tracks) {
+        const bool first = track.start.Y() > 0;
+        const TVector3 expected1 = first ? PointOn(0, -200.0, 50.0) : PointOn(0, 300.0, -80.0);
+        EXPECT_NEAR(expected1.X(), track.start.X(), 1e-6);
+        EXPECT_NEAR(expected1.Y(), track.start.Y(), 1e-6);
+        EXPECT_NEAR(expected1.Z(), track.start.Z(), 1e-6);
+        EXPECT_LT(track.chi2, 0.05);
+    }
+    EXPECT_DOUBLE_EQ(event.tracks.front().start.X(), pdc_ana.GetRecoPoint1().X());
+}
+
+TEST_F(PDCSimAnaTrackFinderTest, SingleTrackEventsKeepLegacyOutput) {
+    HitColumns hits;
+    AddTrack(hits, 120.0, 30.0, 140.0, 1.0);
+
+    PDCSimAna legacy(fGeometry);
+    PDCSimAna finder(fGeometry);
+    PDCTrackFinderConfig config;
+    config.enabled = true;
+    finder.SetTrackFinder(config);
+    TRandom3 legacy_rng(7);
+    TRandom3 finder_rng(7);
+    legacy.SetRandomGenerator(&legacy_rng);
+    finder.SetRandomGenerator(&finder_rng);
+    legacy.SetSmearing(0.5, 0.5);
+    finder.SetSmearing(0.5, 0.5);
+
+    for (int event_index = 0; event_index < 5; ++event_index) {
+        RecoEvent a;
+        RecoEvent b;
+        legacy.ProcessEvent(hits.View(), a);
+        finder.ProcessEvent(hits.View(), b);
+        ASSERT_EQ(1u, a.tracks.size());
+        ASSERT_EQ(a.tracks.size(), b.tracks.size());
+        ASSERT_EQ(a.smearedHits.size(), b.smearedHits.size());
+        EXPECT_EQ(a.tracks[0].start, b.tracks[0].start);
+        EXPECT_EQ(a.tracks[0].end, b.tracks[0].end);
+    }
+}
+
+// [EN] Writes a PDC geometry macro and loads it into `geometry` (later loads override earlier values).
+// [CN] 写出 PDC 几何宏并载入 geometry（后载入的值覆盖先前的值）。
+void LoadPDCGeometry(GeometryManager& geometry, const fs::path& macro_path, double angle_deg, const TVector3& pdc1,
+                     const TVector3& pdc2) {
+    std::ofstream macro(macro_path);
+    macro << "/samurai/geometry/PDC/Angle " << angle_deg << "\n"
+          << "/samurai/geometry/PDC/Position1 " << pdc1.X() << " " << pdc1.Y() << " " << pdc1.Z() << " mm\n"
+          << "/samurai/geometry/PDC/Position2 " << pdc2.X() << " " << pdc2.Y() << " " << pdc2.Z() << " mm\n"
+          << "/samurai/geometry/Target/Position 0 0 0 mm\n";
+    macro.close();
+    ASSERT_TRUE(geometry.LoadGeometry(macro_path.string()));
+}
+
+// [EN] Fixed mixed hit set: PDC1/PDC2 U, V and X layers, an out-of-range PDC copy and non-PDC detectors.
+// [CN] 固定的混合击中集：PDC1/PDC2 的 U、V、X 层，超出范围的 PDC 拷贝号以及非 PDC 探测器。
+void FillMixedHits(TClonesArray& hits, const GeometryManager& geometry) {
+    struct Spec {
+        const char* detector;
+        const char* module;
+        int id;
+    };
+    const Spec specs[] = {
+        {"PDC", "U", 0}, {"PDC", "V", 0}, {"PDC", "X", 0}, {"PDC", "U", 1},      {"PDC", "V", 1},
+        {"PDC", "X", 1}, {"PDC", "U", 2}, {"NEBULA", "U", 0}, {"Target", "V", 1},
+    };
+    TRandom3 rng(2024);
+    hits.Clear("C");
+    for (int repeat = 0; repeat < 3; ++repeat) {
+        for (const Spec& spec : specs) {
+            auto* hit = new (hits[hits.GetEntriesFast()]) TSimData();
+            hit->fDetectorName = spec.detector;
+            hit->fModuleName = spec.module;
+            hit->fID = spec.id;
+            hit->fEnergyDeposit = rng.Uniform(0.1, 2.0);
+            const TVector3 center = spec.id == 1 ? geometry.GetPDC2Position() : geometry.GetPDC1Position();
+            hit->fPrePosition = center + TVector3(rng.Uniform(-300, 300), rng.Uniform(-200, 200), rng.Uniform(-20, 20));
+        }
+    }
+}
+
+// [EN] The name-matching, per-hit trigonometry path PDCSimAna used before PDCHitClassifier and the frame cache.
+// Without smearing it must give the same two reconstructed points.
+// [CN] PDCSimAna 在引入 PDCHitClassifier 与坐标系缓存之前的路径：逐击中字符串匹配与三角计算。
+// 不涂抹时两个重建点必须一致。
+void ReferenceReconstruct(const GeometryManager& geometry, const TClonesArray& hits, TVector3* reco1, TVector3* reco2) {
+    const double sqrt2 = TMath::Sqrt(2.0);
+    const double angle = geometry.GetAngleRad();
+    std::vector<Hit> u_hits[2];
+    std::vector<Hit> v_hits[2];
+    TVector3 centers[2] = {geometry.GetPDC1Position(), geometry.GetPDC2Position()};
+    centers[0].RotateY(-angle);
+    centers[1].RotateY(-angle);
+    for (int i = 0; i < hits.GetEntriesFast(); ++i) {
+        const auto* hit = static_cast<const TSimData*>(hits.At(i));
+        if (!hit->fDetectorName.Contains("PDC")) continue;
+        const int plane = (hit->fID == 0 || hit->fID == 1) ? hit->fID : -1;
+        const int layer = hit->fModuleName == "U" ? 0 : (hit->fModuleName == "V" ? 1 : -1);
+        if (plane < 0 || layer < 0) continue;
+
+        const TVector3& pos = hit->fPrePosition;
+        const TVector3 rel = pos - centers[plane];
+        const double x_rot = rel.X() * TMath::Cos(-angle) - rel.Z() * TMath::Sin(-angle);
+        if (layer == 0) {
+            u_hits[plane].push_back(Hit((x_rot + pos.Y()) / sqrt2, hit->fEnergyDeposit, -12.0));
+        } else {
+            v_hits[plane].push_back(Hit((-x_rot + pos.Y()) / sqrt2, hit->fEnergyDeposit, +12.0));
+        }
+    }
+
+    const auto com = [](const std::vector<Hit>& layer_hits) {
+        double sum = 0.0;
+        double energy = 0.0;
+        for (const Hit& hit : layer_hits) {
+            sum += hit.position * hit.energy;
+            energy += hit.energy;
+        }
+        return energy > 0 ? sum / energy : 0.0;
+    };
+    TVector3* out[2] = {reco1, reco2};
+    for (int plane = 0; plane < 2; ++plane) {
+        if (u_hits[plane].empty() || v_hits[plane].empty()) {
+            out[plane]->SetXYZ(0, 0, 0);
+            continue;
+        }
+        const double u = com(u_hits[plane]);
+        const double v = com(v_hits[plane]);
+        const double x_local = (u - v) / sqrt2;
+        out[plane]->SetXYZ(x_local * TMath::Cos(angle) + centers[plane].X(), (u + v) / sqrt2 + centers[plane].Y(),
+                           x_local * TMath::Sin(angle) + centers[plane].Z());
+    }
+}
+
+void ExpectSameVector(const TVector3& expected, const TVector3& actual) {
+    EXPECT_DOUBLE_EQ(expected.X(), actual.X());
+    EXPECT_DOUBLE_EQ(expected.Y(), actual.Y());
+    EXPECT_DOUBLE_EQ(expected.Z(), actual.Z());
+}
+
+TEST(PDCHitClassifierTest, MapsPDCNamesToPlaneAndLayerCodes) {
+    PDCHitClassifier classifier;
+    TSimData hit;
+    signed char plane = 0;
+    signed char layer = 0;
+    const auto classify = [&](const std::string& detector, const std::string& module, int id) {
+        hit.fDetectorName = detector.c_str();
+        hit.fModuleName = module.c_str();
+        hit.fID = id;
+        plane = 99;
+        layer = 99;
+        return classifier.Classify(hit, &plane, &layer);
+    };
+    const auto expect_codes = [&]() {
+        ASSERT_TRUE(classify("PDC", "U", 0));
+        EXPECT_EQ(0, plane);
+        EXPECT_EQ(0, layer);
+        ASSERT_TRUE(classify("PDC", "V", 1));
+        EXPECT_EQ(1, plane);
+        EXPECT_EQ(1, layer);
+        ASSERT_TRUE(classify("PDC", "X", 0));
+        EXPECT_EQ(0, plane);
+        EXPECT_EQ(-1, layer);
+        ASSERT_TRUE(classify("PDC2", "U", 2));
+        EXPECT_EQ(-1, plane);
+        EXPECT_EQ(0, layer);
+        EXPECT_FALSE(classify("NEBULA", "U", 0));
+        EXPECT_FALSE(classify("Target", "V", 1));
+    };
+    expect_codes();
+
+    // [EN] Far more distinct names than the classifier caches: evicted names must be matched again, not misread.
+    // [CN] 远多于分类器缓存容量的不同名字：被淘汰的名字必须重新匹配，不能读错。
+    for (int i = 0; i < 40; ++i) {
+        ASSERT_TRUE(classify("PDC_copy" + std::to_string(i), "Layer" + std::to_string(i), 1));
+        EXPECT_EQ(1, plane);
+        EXPECT_EQ(-1, layer);
+        EXPECT_FALSE(classify("Det" + std::to_string(i), "U", 0));
+    }
+    expect_codes();
+}
+
+class PDCSimAnaReferenceTest : public ::testing::Test {
+protected:
+    void SetUp() override { fMacro = fs::temp_directory_path() / "smsim_pdc_sim_ana_reference.mac"; }
+    void TearDown() override { fs::remove(fMacro); }
+
+    void ExpectMatchesReference(PDCSimAna& pdc_ana, const GeometryManager& geometry) {
+        TClonesArray hits("TSimData", 32);
+        FillMixedHits(hits, geometry);
+        TVector3 ref1;
+        TVector3 ref2;
+        ReferenceReconstruct(geometry, hits, &ref1, &ref2);
+        ASSERT_GT(ref1.Mag(), 0.0);
+        ASSERT_GT(ref2.Mag(), 0.0);
+
+        RecoEvent event;
+        pdc_ana.ProcessEvent(&hits, event);
+        ExpectSameVector(ref1, pdc_ana.GetRecoPoint1());
+        ExpectSameVector(ref2, pdc_ana.GetRecoPoint2());
+        // [EN] X layers, PDC copy 2 and non-PDC detectors do not enter the reconstruction; only PDC hits are raw hits.
+        // [CN] X 层、PDC 拷贝 2 与非 PDC 探测器不参与重建；只有 PDC 击中计入原始击中。
+        EXPECT_EQ(21u, event.rawHits.size());
+        ASSERT_EQ(1u, event.tracks.size());
+        ExpectSameVector(ref1, event.tracks[0].start);
+        ExpectSameVector(ref2, event.tracks[0].end);
+    }
+
+    fs::path fMacro;
+};
+
+TEST_F(PDCSimAnaReferenceTest, MatchesTheStringAndTrigPathOnAFixedHitSet) {
+    GeometryManager geometry;
+    LoadPDCGeometry(geometry, fMacro, 59.5, TVector3(20.0, -5.0, 4000.0), TVector3(35.0, 3.0, 5100.0));
+    PDCSimAna pdc_ana(geometry);
+    ExpectMatchesReference(pdc_ana, geometry);
+}
+
+TEST_F(PDCSimAnaReferenceTest, FrameCacheFollowsGeometryChanges) {
+    GeometryManager geometry;
+    LoadPDCGeometry(geometry, fMacro, 60.0, TVector3(0.0, 0.0, 4000.0), TVector3(0.0, 0.0, 5000.0));
+    PDCSimAna pdc_ana(geometry);
+    ExpectMatchesReference(pdc_ana, geometry);
+
+    // [EN] Same instance after an angle change, then after a position-only change. / [CN] 同一实例：先改角度，再只改位置。
+    LoadPDCGeometry(geometry, fMacro, 45.0, TVector3(0.0, 0.0, 4000.0), TVector3(0.0, 0.0, 5000.0));
+    ExpectMatchesReference(pdc_ana, geometry);
+    LoadPDCGeometry(geometry, fMacro, 45.0, TVector3(-150.0, 10.0, 4200.0), TVector3(-220.0, 10.0, 5300.0));
+    ExpectMatchesReference(pdc_ana, geometry);
+
+    // [EN] And agrees with an instance built directly on the final geometry. / [CN] 并与直接基于最终几何构造的实例一致。
+    PDCSimAna fresh(geometry);
+    TClonesArray hits("TSimData", 32);
+    FillMixedHits(hits, geometry);
+    RecoEvent a;
+    RecoEvent b;
+    pdc_ana.ProcessEvent(&hits, a);
+    fresh.ProcessEvent(&hits, b);
+    EXPECT_EQ(pdc_ana.GetRecoPoint1(), fresh.GetRecoPoint1());
+    EXPECT_EQ(pdc_ana.GetRecoPoint2(), fresh.GetRecoPoint2());
+}
+
+}  // namespace
@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+
+#include "RecoNTupleIO.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace fs = std::filesystem;
+using namespace analysis::reco_output;
+
+namespace {
+
+// [EN] Synthetic event close to the production mix: one proton with full errors, 0-2 neutrons. / [CN] 接近实际分布的合成事件：一个带完整误差的质子，0-2 个中子。
+void MakeEvent(int index, RecoEvent* event, LegacyProtonColumns* protons) {
+    event->Clear();
+    event->eventID = index;
+    event->tracks.emplace_back(TVector3(0.1 * index, 2.0, -90.0), TVector3(400.0, 3.0, 2100.0 + index % 7));
+    for (int n = 0; n < index % 3; ++n) {
+        RecoNeutron neutron;
+        neutron.position.SetXYZ(10.0 * n, -5.0, 11000.0);
+        neutron.direction.SetXYZ(0.0, 0.0, 1.0);
+        neutron.energy = 200.0 + n;
+        neutron.timeOfFlight = 60.0 + 0.01 * index;
+        neutron.beta = 0.55;
+        neutron.hitMultiplicity = 1 + n;
+        event->neutrons.push_back(neutron);
+    }
+    protons->Clear();
+    protons->px.push_back(100.0 + 0.001 * index);
+    protons->py.push_back(-3.0);
+    protons->pz.push_back(620.0 + 0.002 * index);
+    protons->e.push_back(1150.0);
+    protons->p.push_back(628.0);
+    protons->status.push_back(0);
+    protons->method.push_back(2);
+    protons->ndf.push_back(3);
+    protons->iterations.push_back(5 + index % 4);
+    protons->uncertainty_valid.push_back(1);
+    protons->posterior_valid.push_back(index % 2);
+    protons->chi2_raw.push_back(1.5);
+    protons->chi2_reduced.push_back(0.5);
+    protons->ForEachDouble([](std::vector<double>& column) {
+        if (column.empty()) {
+            column.push_back(1.25);
+        }
+    });
+    protons->momentum_cov.assign({4.0, 0.1, 0.2, 5.0, 0.3, 6.0});
+}
+
+std::uintmax_t FileSize(const fs::path& path) {
+    std::error_code ec;
+    const auto size = fs::file_size(path, ec);
+    return ec ? 0 : size;
+}
+
+}  // namespace
+
+TEST(RecoNTupleIOTest, RowCopiesEventAndPadsMissingProtonColumns) {
+    RecoEvent event;
+    LegacyProtonColumns protons;
+    MakeEvent(2, &event, &protons);
+    protons.p_upper95.clear();
+
+    RecoNTupleRow row;
+    row.SetEvent(event);
+    row.SetTruth(true, TLorentzVector(1.0, 2.0, 3.0, 4.0), TVector3(5.0, 6.0, 7.0),
+                 false, TLorentzVector(), TVector3());
+    row.SetProtons(protons);
+
+    EXPECT_EQ(row.event_id, 2);
+    ASSERT_EQ(row.tracks.size(), 1u);
+    EXPECT_DOUBLE_EQ(row.tracks[0].end_x, 400.0);
+    ASSERT_EQ(row.neutrons.size(), 2u);
+    EXPECT_EQ(row.neutrons[1].hit_multiplicity, 2);
+    ASSERT_EQ(row.protons.size(), 1u);
+    EXPECT_DOUBLE_EQ(row.protons[0].pz, 620.004);
+    EXPECT_FALSE(row.protons[0].posterior_valid);
+    EXPECT_TRUE(std::isnan(row.protons[0].interval[15]));
+    EXPECT_DOUBLE_EQ(row.protons[0].covariance[3], 5.0);
+    EXPECT_DOUBLE_EQ(row.truth_proton_pos[2], 7.0);
+}
+
+TEST(RecoNTupleIOTest, RoundTripThroughTFile) {
+    if (!RNTupleAvailable()) {
+        GTEST_SKIP() << "built without WITH_RNTUPLE";
+    }
+    const fs::path path = fs::temp_directory_path() / "smsim_reco_ntuple_roundtrip.root";
+    {
+        TFile file(path.c_str(), "RECREATE");
+        RecoNTupleWriter writer(file, CompressionProfile::kBalanced);
+        RecoEvent event;
+        LegacyProtonColumns protons;
+        for (int i = 0; i < 10; ++i) {
+            MakeEvent(i, &event, &protons);
+            writer.Row().Clear();
+            writer.Row().SetEvent(event);
+            writer.Row().SetProtons(protons);
+            writer.Fill();
+        }
+        writer.Commit();
+        file.Close();
+    }
+    {
+        TFile file(path.c_str(), "READ");
+        EXPECT_TRUE(HasRecoNTuple(file));
+    }
+    RecoNTupleReader reader(path.string());
+    ASSERT_EQ(reader.GetEntries(), 10);
+    reader.LoadEntry(5);
+    EXPECT_EQ(reader.Row().event_id, 5);
+    EXPECT_EQ(reader.Row().neutrons.size(), 2u);
+    ASSERT_EQ(reader.Row().protons.size(), 1u);
+    EXPECT_DOUBLE_EQ(reader.Row().protons[0].px, 100.005);
+    fs::remove(path);
+}
+
+// [EN] Same events through the legacy TTree branches and through RNTuple; prints write time, size and read time. / [CN] 同一批事件分别写入旧布局 TTree 与 RNTuple，输出写入时间、文件大小与读取时间。
+TEST(RecoNTupleIOTest, TTreeVsRNTupleBenchmark) {
+    if (!RNTupleAvailable()) {
+        GTEST_SKIP() << "built without WITH_RNTUPLE";
+    }
+    constexpr int kEvents = 20000;
+    const fs::path tree_path = fs::temp_directory_path() / "smsim_reco_bench_ttree.root";
+    const fs::path ntuple_path = fs::temp_directory_path() / "smsim_reco_bench_rntuple.root";
+    using Clock = std::chrono::steady_clock;
+    auto seconds_since = [](Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    RecoEvent event;
+    LegacyProtonColumns protons;
+
+    auto start = Clock::now();
+    {
+        TFile file(tree_path.c_str(), "RECREATE");
+        ApplyCompressionProfile(file, CompressionProfile::kBalanced);
+        TTree tree("recoTree", "benchmark");
+        RecoEvent* event_ptr = &event;
+        tree.Branch("recoEvent", &event_ptr);
+        protons.BindForWrite(tree, true, true);
+        for (int i = 0; i < kEvents; ++i) {
+            MakeEvent(i, &event, &protons);
+            tree.Fill();
+        }
+        tree.Write();
+        file.Close();
+    }
+    const double tree_write = seconds_since(start);
+
+    start = Clock::now();
+    {
+        TFile file(ntuple_path.c_str(), "RECREATE");
+        RecoNTupleWriter writer(file, CompressionProfile::kBalanced);
+        for (int i = 0; i < kEvents; ++i) {
+            MakeEvent(i, &event, &protons);
+            writer.Row().SetEvent(event);
+            writer.Row().SetProtons(protons);
+            writer.Fill();
+        }
+        writer.Commit();
+        file.Close();
+    }
+    const double ntuple_write = seconds_since(start);
+
+    start = Clock::now();
+    {
+        TFile file(tree_path.c_str(), "READ");
+        TTree* tree = nullptr;
+        file.GetObject("recoTree", tree);
+        ASSERT_NE(tree, nullptr);
+        for (Long64_t i = 0; i < tree->GetEntries(); ++i) {
+            tree->GetEntry(i);
+        }
+    }
+    const double tree_read = seconds_since(start);
+
+    start = Clock::now();
+    {
+        RecoNTupleReader reader(ntuple_path.string());
+        ASSERT_EQ(reader.GetEntries(), kEvents);
+        for (std::int64_t i = 0; i < reader.GetEntries(); ++i) {
+            reader.LoadEntry(i);
+        }
+    }
+    const double ntuple_read = seconds_since(start);
+
+    std::cout << "\n=== Reco output backend benchmark (" << kEvents << " events, zstd-5) ===\n"
+              << "TTree   write " << tree_write << " s, size " << FileSize(tree_path) << " B, read " << tree_read
+              << " s\n"
+              << "RNTuple write " << ntuple_write << " s, size " << FileSize(ntuple_path) << " B, read "
+              << ntuple_read << " s" << std::endl;
+    RecordProperty("ttree_bytes", std::to_string(FileSize(tree_path)));
+    RecordProperty("rntuple_bytes", std::to_string(FileSize(ntuple_path)));
+    fs::remove(tree_path);
+    fs::remove(ntuple_path);
+}
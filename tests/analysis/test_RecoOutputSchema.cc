@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include "RecoOutputSchema.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+using namespace analysis::reco_output;
+
+TEST(RecoOutputSchemaTest, ParsesSchemaAndCompressionNames) {
+    EXPECT_EQ(ParseOutputSchema("compact"), OutputSchema::kCompact);
+    EXPECT_EQ(ParseOutputSchema("LEGACY"), OutputSchema::kLegacy);
+    EXPECT_THROW(ParseOutputSchema("columnar"), std::runtime_error);
+    EXPECT_EQ(ParseCompressionProfile("fast"), CompressionProfile::kFast);
+    EXPECT_EQ(ParseCompressionProfile("zstd"), CompressionProfile::kBalanced);
+    EXPECT_THROW(ParseCompressionProfile("gzip"), std::runtime_error);
+    for (auto profile : {CompressionProfile::kDefault, CompressionProfile::kFast,
+                         CompressionProfile::kBalanced, CompressionProfile::kArchive}) {
+        EXPECT_EQ(ParseCompressionProfile(CompressionProfileName(profile)), profile);
+    }
+}
+
+TEST(RecoOutputSchemaTest, CompressionSettingsUseAlgorithmTimesHundredPlusLevel) {
+    EXPECT_EQ(CompressionSettings(CompressionProfile::kDefault), -1);
+    EXPECT_EQ(CompressionSettings(CompressionProfile::kFast), 404);
+    EXPECT_EQ(CompressionSettings(CompressionProfile::kBalanced), 505);
+    EXPECT_EQ(CompressionSettings(CompressionProfile::kArchive), 208);
+}
+
+TEST(RecoOutputSchemaTest, CompactRowClampsProtonsAndPacksColumns) {
+    LegacyProtonColumns columns;
+    const int total = CompactRecoRow::kMaxProtons + 3;
+    for (int i = 0; i < total; ++i) {
+        columns.px.push_back(i);
+        columns.py.push_back(-i);
+        columns.pz.push_back(600.0 + i);
+        columns.e.push_back(1200.0 + i);
+        columns.uncertainty_valid.push_back(1);
+        columns.posterior_valid.push_back(i % 2);
+        columns.px_sigma.push_back(0.5);
+        columns.px_lower68.push_back(i - 1.0);
+        for (int k = 0; k < 6; ++k) {
+            columns.momentum_cov.push_back(10.0 * i + k);
+        }
+    }
+
+    auto row = std::make_unique<CompactRecoRow>();
+    row->SetProtons(columns);
+    EXPECT_EQ(row->n_proton, CompactRecoRow::kMaxProtons);
+    EXPECT_EQ(row->n_proton_dropped, 3);
+    EXPECT_FLOAT_EQ(row->proton_pz[2], 602.0f);
+    EXPECT_EQ(row->proton_flags[1], 3);
+    EXPECT_EQ(row->proton_flags[2], 1);
+    EXPECT_FLOAT_EQ(row->proton_sigma[4][0], 0.5f);
+    EXPECT_FLOAT_EQ(row->proton_interval[4][0], 3.0f);
+    // [EN] Columns that were never filled (no Laplace) read back as zero. / [CN] 未填写的列读回为 0。
+    EXPECT_FLOAT_EQ(row->proton_interval[4][15], 0.0f);
+    EXPECT_FLOAT_EQ(row->proton_cov[3][5], 35.0f);
+}
+
+TEST(RecoOutputSchemaTest, CompactRowCountsDroppedNeutrons) {
+    RecoEvent event;
+    event.eventID = 42;
+    const int total = CompactRecoRow::kMaxNeutrons + 5;
+    for (int i = 0; i < total; ++i) {
+        RecoNeutron neutron;
+        neutron.position.SetXYZ(i, 0.0, 11000.0);
+        neutron.beta = 0.5;
+        neutron.energy = 150.0 + i;
+        neutron.hitMultiplicity = 1 + i % 3;
+        event.neutrons.push_back(neutron);
+    }
+
+    auto row = std::make_unique<CompactRecoRow>();
+    row->SetEvent(event);
+    EXPECT_EQ(row->n_neutron, CompactRecoRow::kMaxNeutrons);
+    EXPECT_EQ(row->n_neutron_dropped, 5);
+    EXPECT_FLOAT_EQ(row->neutron_x[CompactRecoRow::kMaxNeutrons - 1], CompactRecoRow::kMaxNeutrons - 1.0f);
+    EXPECT_FLOAT_EQ(row->neutron_energy[3], 153.0f);
+
+    event.neutrons.resize(2);
+    row->SetEvent(event);
+    EXPECT_EQ(row->n_neutron, 2);
+    EXPECT_EQ(row->n_neutron_dropped, 0);
+    row->n_neutron_dropped = 7;
+    row->Clear();
+    EXPECT_EQ(row->n_neutron_dropped, 0);
+}
+
+TEST(RecoOutputSchemaTest, CompactTreeRoundTrip) {
+    const fs::path path = fs::temp_directory_path() / "smsim_reco_output_schema_test.root";
+    {
+        TFile file(path.c_str(), "RECREATE");
+        ApplyCompressionProfile(file, CompressionProfile::kBalanced);
+        TTree tree("recoTree", "schema test");
+        auto row = std::make_unique<CompactRecoRow>();
+        row->BindForWrite(tree, true, false, true);
+        for (int event = 0; event < 5; ++event) {
+            LegacyProtonColumns columns;
+            for (int i = 0; i < event; ++i) {
+                columns.px.push_back(event + 0.25 * i);
+                columns.py.push_back(0.0);
+                columns.pz.push_back(700.0);
+                columns.e.push_back(1100.0);
+            }
+            row->Clear();
+            row->event_id = 100 + event;
+            row->n_neutron_dropped = event;
+            row->SetProtons(columns);
+            tree.Fill();
+        }
+        tree.Write();
+        file.Close();
+    }
+
+    TFile file(path.c_str(), "READ");
+    TTree* tree = nullptr;
+    file.GetObject("recoTree", tree);
+    ASSERT_NE(tree, nullptr);
+    EXPECT_EQ(DetectOutputSchema(file, *tree), OutputSchema::kCompact);
+    EXPECT_EQ(tree->GetBranch("proton_interval"), nullptr);
+    auto row = std::make_unique<CompactRecoRow>();
+    row->BindForRead(*tree);
+    tree->GetEntry(3);
+    EXPECT_EQ(row->event_id, 103);
+    EXPECT_EQ(row->n_neutron_dropped, 3);
+    ASSERT_EQ(row->n_proton, 3);
+    EXPECT_FLOAT_EQ(row->proton_px[2], 3.5f);
+    tree->ResetBranchAddresses();
+    file.Close();
+    fs::remove(path);
+}
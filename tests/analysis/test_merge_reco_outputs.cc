@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include "TFile.h"
+#include "TNamed.h"
+#include "TTree.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr Long64_t kInputEntries = 10;
+
+struct Shard {
+    int index = 0;
+    Long64_t first = 0;
+    Long64_t last = 0;
+    std::vector<Long64_t> event_ids;
+    std::string backend = "nn";
+};
+
+// [EN] Compact-schema shard: recoTree with an event_id leaf plus the metadata run_reconstruction writes.
+// [CN] 紧凑布局分片：含 event_id 叶的 recoTree，以及 run_reconstruction 写出的元数据。
+void WriteShard(const fs::path& path, const Shard& shard, int shard_count) {
+    TFile file(path.c_str(), "RECREATE");
+    TTree tree("recoTree", "merge test shard");
+    Long64_t event_id = -1;
+    tree.Branch("event_id", &event_id, "event_id/L");
+    for (const Long64_t id : shard.event_ids) {
+        event_id = id;
+        tree.Fill();
+    }
+    tree.Write();
+
+    const std::vector<std::pair<std::string, std::string>> metadata = {
+        {"InputFile", "/data/sim/run0000.root"},
+        {"ProtonRecoBackend", shard.backend},
+        {"RkErrorBranches", "false"},
+        {"RkLaplaceBranches", "false"},
+        {"RecoNeutronEffectiveMode", "none"},
+        {"RecoOutputSchema", "compact"},
+        {"ProcessedEvents", std::to_string(shard.event_ids.size())},
+        {"ShardIndex", std::to_string(shard.index)},
+        {"ShardCount", std::to_string(shard_count)},
+        {"ShardFirstEntry", std::to_string(shard.first)},
+        {"ShardLastEntry", std::to_string(shard.last)},
+        {"InputTotalEntries", std::to_string(kInputEntries)},
+    };
+    for (const auto& [key, value] : metadata) {
+        TNamed info(key.c_str(), value.c_str());
+        info.Write();
+    }
+    file.Close();
+}
+
+std::vector<Long64_t> Range(Long64_t first, Long64_t last) {
+    std::vector<Long64_t> ids;
+    for (Long64_t id = first; id < last; ++id) {
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+class MergeRecoOutputsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        fDir = fs::temp_directory_path() /
+               ("smsim_merge_test_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        fs::remove_all(fDir);
+        fs::create_directories(fDir);
+        fOutput = fDir / "merged.root";
+    }
+    void TearDown() override { fs::remove_all(fDir); }
+
+    // [EN] Writes the shards and runs the tool on them in reverse order; returns the exit status.
+    // [CN] 写出分片并以逆序交给工具合并，返回退出状态。
+    int Merge(const std::vector<Shard>& shards, const std::string& extra_args = std::string()) {
+        std::string command = std::string(SMSIM_MERGE_RECO_OUTPUTS_BIN) + " --output-file " + fOutput.string();
+        if (!extra_args.empty()) {
+            command += " " + extra_args;
+        }
+        for (auto it = shards.rbegin(); it != shards.rend(); ++it) {
+            const fs::path path = fDir / ("shard" + std::to_string(it->index) + ".root");
+            WriteShard(path, *it, 3);
+            command += " " + path.string();
+        }
+        return std::system(command.c_str());
+    }
+
+    std::vector<Shard> CleanShards() const {
+        return {
+            {0, 0, 4, Range(0, 4)},
+            {1, 4, 7, Range(4, 7)},
+            {2, 7, kInputEntries, Range(7, kInputEntries)},
+        };
+    }
+
+    fs::path fDir;
+    fs::path fOutput;
+};
+
+TEST_F(MergeRecoOutputsTest, CleanShardsMergeInEventOrder) {
+    ASSERT_EQ(0, Merge(CleanShards()));
+    ASSERT_TRUE(fs::exists(fOutput));
+
+    TFile file(fOutput.c_str(), "READ");
+    TTree* tree = nullptr;
+    file.GetObject("recoTree", tree);
+    ASSERT_NE(nullptr, tree);
+    ASSERT_EQ(kInputEntries, tree->GetEntries());
+    Long64_t event_id = -1;
+    tree->SetBranchAddress("event_id", &event_id);
+    for (Long64_t i = 0; i < tree->GetEntries(); ++i) {
+        tree->GetEntry(i);
+        EXPECT_EQ(i, event_id);
+    }
+
+    auto* processed = dynamic_cast<TNamed*>(file.Get("ProcessedEvents"));
+    ASSERT_NE(nullptr, processed);
+    EXPECT_STREQ("10", processed->GetTitle());
+    auto* shard_count = dynamic_cast<TNamed*>(file.Get("ShardCount"));
+    ASSERT_NE(nullptr, shard_count);
+    EXPECT_STREQ("1", shard_count->GetTitle());
+}
+
+TEST_F(MergeRecoOutputsTest, DuplicatedEventIDsAreRejected) {
+    std::vector<Shard> shards = CleanShards();
+    shards[1].event_ids = {4, 5, 5};
+    EXPECT_NE(0, Merge(shards));
+    EXPECT_FALSE(fs::exists(fOutput));
+}
+
+TEST_F(MergeRecoOutputsTest, MissingShardRangeIsRejected) {
+    std::vector<Shard> shards = CleanShards();
+    shards.erase(shards.begin() + 1);
+    EXPECT_NE(0, Merge(shards));
+    EXPECT_FALSE(fs::exists(fOutput));
+}
+
+TEST_F(MergeRecoOutputsTest, MismatchedMetadataIsRejectedUnlessForced) {
+    std::vector<Shard> shards = CleanShards();
+    shards[2].backend = "rk";
+    EXPECT_NE(0, Merge(shards));
+    EXPECT_FALSE(fs::exists(fOutput));
+
+    EXPECT_EQ(0, Merge(shards, "--force"));
+    EXPECT_TRUE(fs::exists(fOutput));
+}
+
+}  // namespace
@@ -0,0 +1,124 @@
+#!/bin/bash
+# [EN] Integration test for the directory-mode manifest: a second --resume run after truncating one output must redo
+#      only that input, and resuming with a changed reconstruction option must be refused.
+# [CN] 目录模式清单的集成测试：截断一个输出后用 --resume 再跑，只应重做该输入；改变重建选项后续跑应被拒绝。
+#
+# Runs AFTER the E2E tests have written the simulation output under build/test_output/pdc_target_momentum_scan/.
+#
+# Usage: test_reco_manifest_resume.sh <reco_bin> <geometry_macro> <field_map> <nn_model> <sim_dir> <output_dir>
+#
+# Exit codes:
+#   0 = all checks passed
+#   1 = reconstruction failed or input missing
+#   2 = output file missing
+#   3 = resume behaviour wrong
+
+set -euo pipefail
+
+RECO_BIN="${1:?Usage: $0 <reco_bin> <geometry_macro> <field_map> <nn_model> <sim_dir> <output_dir>}"
+GEOMETRY_MACRO="${2:?}"
+FIELD_MAP="${3:?}"
+NN_MODEL="${4:?}"
+SIM_DIR="${5:?}"
+OUTPUT_DIR="${6:?}"
+
+echo "=== Reconstruction manifest/resume test ==="
+echo "  reco_bin:   ${RECO_BIN}"
+echo "  sim_dir:    ${SIM_DIR}"
+echo "  output_dir: ${OUTPUT_DIR}"
+
+# ── Step 1: Check prerequisites, build a three-file input directory ─
+if [ ! -x "${RECO_BIN}" ]; then
+    echo "FAIL: reconstruction binary not found or not executable: ${RECO_BIN}"
+    exit 1
+fi
+SIM_ROOT=$(ls "${SIM_DIR}"/*.root 2>/dev/null | grep -v "_reco.root" | head -1 || true)
+if [ -z "${SIM_ROOT}" ]; then
+    echo "FAIL: no simulation ROOT file under ${SIM_DIR}"
+    exit 1
+fi
+
+INPUT_DIR="${OUTPUT_DIR}/input"
+RECO_DIR="${OUTPUT_DIR}/reco"
+rm -rf "${OUTPUT_DIR}"
+mkdir -p "${INPUT_DIR}" "${RECO_DIR}"
+for name in a b c; do
+    cp "${SIM_ROOT}" "${INPUT_DIR}/${name}.root"
+done
+MANIFEST="${RECO_DIR}/manifest.tsv"
+
+run_reco() {
+    local log="$1"
+    shift
+    "${RECO_BIN}" \
+        --backend nn \
+        --input-dir "${INPUT_DIR}" \
+        --output-dir "${RECO_DIR}" \
+        --geometry-macro "${GEOMETRY_MACRO}" \
+        --magnetic-field-map "${FIELD_MAP}" \
+        --nn-model-json "${NN_MODEL}" \
+        --manifest "${MANIFEST}" \
+        "$@" > "${OUTPUT_DIR}/${log}" 2>&1
+}
+
+# [EN] Number of "started" lines the manifest holds for one input. / [CN] 清单中某输入的 "started" 行数。
+started_count() {
+    awk -F'\t' -v input="${INPUT_DIR}/$1.root" '$1 == "started" && $2 == input { n++ } END { print n + 0 }' "${MANIFEST}"
+}
+
+# ── Step 2: First full run ──────────────────────────────────────────
+if ! run_reco first.log; then
+    echo "FAIL: first run exited with non-zero status"
+    tail -20 "${OUTPUT_DIR}/first.log"
+    exit 1
+fi
+for name in a b c; do
+    if [ ! -f "${RECO_DIR}/${name}_reco.root" ]; then
+        echo "FAIL: output missing after first run: ${RECO_DIR}/${name}_reco.root"
+        exit 2
+    fi
+done
+FULL_SIZE=$(stat -c %s "${RECO_DIR}/b_reco.root")
+
+# ── Step 3: Truncate one output, resume ─────────────────────────────
+truncate -s $((FULL_SIZE / 2)) "${RECO_DIR}/b_reco.root"
+if ! run_reco resume.log --resume; then
+    echo "FAIL: resume run exited with non-zero status"
+    tail -20 "${OUTPUT_DIR}/resume.log"
+    exit 1
+fi
+
+FAIL=0
+for name in a c; do
+    if [ "$(started_count ${name})" -ne 1 ]; then
+        echo "  FAIL ${name}.root was reprocessed on --resume"
+        FAIL=1
+    fi
+done
+if [ "$(started_count b)" -ne 2 ]; then
+    echo "  FAIL truncated b_reco.root was not redone on --resume"
+    FAIL=1
+fi
+if [ "$(stat -c %s "${RECO_DIR}/b_reco.root")" -le $((FULL_SIZE / 2)) ]; then
+    echo "  FAIL b_reco.root is still truncated"
+    FAIL=1
+fi
+if [ "${FAIL}" -ne 0 ]; then
+    exit 3
+fi
+echo "  OK  only the truncated output was redone"
+
+# ── Step 4: A changed option must not resume from this manifest ─────
+if run_reco changed.log --resume --pdc-sigma-u-mm 3.0; then
+    echo "  FAIL --resume with a changed option was accepted"
+    exit 3
+fi
+if ! grep -q "different reconstruction options" "${OUTPUT_DIR}/changed.log"; then
+    echo "  FAIL --resume with a changed option failed for another reason"
+    tail -20 "${OUTPUT_DIR}/changed.log"
+    exit 3
+fi
+echo "  OK  manifest with different options rejected"
+
+echo "PASS: manifest resume redoes only changed outputs and pins the reconstruction options"
+exit 0
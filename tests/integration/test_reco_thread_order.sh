@@ -0,0 +1,99 @@
+#!/bin/bash
+# [EN] Integration test: reconstruct the same E2E simulation file with --threads 1 and --threads 4 and check
+#      that recoTree has the same entries in the same order (the ordered event pipeline must not reorder).
+# [CN] 集成测试：对同一 E2E 模拟文件分别以 --threads 1 和 --threads 4 重建，检查 recoTree 的条目及顺序一致
+#      （有序事件流水线不得改变顺序）。
+#
+# Runs AFTER the E2E tests have written the simulation output under build/test_output/pdc_target_momentum_scan/.
+#
+# Usage: test_reco_thread_order.sh <reco_bin> <geometry_macro> <field_map> <nn_model> <sim_dir> <output_dir>
+#
+# Exit codes:
+#   0 = all checks passed
+#   1 = reconstruction failed or input missing
+#   2 = output file missing
+#   3 = entry order differs
+
+set -euo pipefail
+
+RECO_BIN="${1:?Usage: $0 <reco_bin> <geometry_macro> <field_map> <nn_model> <sim_dir> <output_dir>}"
+GEOMETRY_MACRO="${2:?}"
+FIELD_MAP="${3:?}"
+NN_MODEL="${4:?}"
+SIM_DIR="${5:?}"
+OUTPUT_DIR="${6:?}"
+
+echo "=== Reconstruction thread-order test ==="
+echo "  reco_bin:   ${RECO_BIN}"
+echo "  sim_dir:    ${SIM_DIR}"
+echo "  output_dir: ${OUTPUT_DIR}"
+
+# ── Step 1: Check prerequisites ─────────────────────────────────────
+if [ ! -x "${RECO_BIN}" ]; then
+    echo "FAIL: reconstruction binary not found or not executable: ${RECO_BIN}"
+    exit 1
+fi
+SIM_ROOT=$(ls "${SIM_DIR}"/*.root 2>/dev/null | grep -v "_reco.root" | head -1 || true)
+if [ -z "${SIM_ROOT}" ]; then
+    echo "FAIL: no simulation ROOT file under ${SIM_DIR}"
+    exit 1
+fi
+echo "  sim_root:   ${SIM_ROOT}"
+
+mkdir -p "${OUTPUT_DIR}"
+
+# ── Step 2: Reconstruct with 1 and 4 threads ────────────────────────
+run_reco() {
+    local threads="$1"
+    local out="${OUTPUT_DIR}/threads${threads}_reco.root"
+    rm -f "${out}"
+    if ! "${RECO_BIN}" \
+        --backend nn \
+        --input-file "${SIM_ROOT}" \
+        --output-file "${out}" \
+        --geometry-macro "${GEOMETRY_MACRO}" \
+        --magnetic-field-map "${FIELD_MAP}" \
+        --nn-model-json "${NN_MODEL}" \
+        --threads "${threads}" > "${OUTPUT_DIR}/threads${threads}.log" 2>&1; then
+        echo "FAIL: reconstruction with --threads ${threads} exited with non-zero status"
+        tail -20 "${OUTPUT_DIR}/threads${threads}.log"
+        exit 1
+    fi
+    if [ ! -f "${out}" ]; then
+        echo "FAIL: output missing: ${out}"
+        exit 2
+    fi
+}
+
+run_reco 1
+run_reco 4
+
+# ── Step 3: Compare the per-entry event IDs and proton momenta ──────
+dump_entries() {
+    root -b -l -q "$1" -e "
+        auto* t = (TTree*)gFile->Get(\"recoTree\");
+        t->SetEstimate(t->GetEntries() + 1);
+        const Long64_t n = t->Draw(\"recoEvent.eventID\", \"\", \"goff\");
+        std::cout << \"ENTRIES:\" << t->GetEntries() << std::endl;
+        for (Long64_t i = 0; i < n; ++i) {
+            std::cout << \"ID:\" << static_cast<Long64_t>(t->GetV1()[i]) << std::endl;
+        }
+    " 2>/dev/null | grep -E "^(ENTRIES|ID):"
+}
+
+SINGLE=$(dump_entries "${OUTPUT_DIR}/threads1_reco.root")
+MULTI=$(dump_entries "${OUTPUT_DIR}/threads4_reco.root")
+ENTRIES=$(echo "${SINGLE}" | grep "^ENTRIES:" | cut -d: -f2)
+
+if [ -z "${ENTRIES}" ] || [ "${ENTRIES}" -eq 0 ]; then
+    echo "FAIL: --threads 1 output has no recoTree entries"
+    exit 3
+fi
+if [ "${SINGLE}" != "${MULTI}" ]; then
+    echo "FAIL: recoTree entry order differs between --threads 1 and --threads 4"
+    diff <(echo "${SINGLE}") <(echo "${MULTI}") | head -20 || true
+    exit 3
+fi
+
+echo "PASS: ${ENTRIES} recoTree entries in the same order with --threads 1 and --threads 4"
+exit 0
@@ -0,0 +1,142 @@
+#!/usr/bin/env bash
+# tests/integration/test_sim_deuteron_mt.sh
+# [EN] Runs the NEBULA-Plus smoke macro with -t 1 and -t 2 and checks the multi-threaded
+#      output path: the per-worker <run>_t<tid>.root files are merged into <run>.root and
+#      removed, the merged tree has as many entries as the sequential run, and every
+#      event_id appears exactly once.
+# [CN] 用 NEBULA-Plus 烟雾宏分别以 -t 1 和 -t 2 运行，检查多线程输出路径：各 worker 的
+#      <run>_t<tid>.root 合并为 <run>.root 后被删除，合并树的条目数与单线程一致，
+#      且每个 event_id 恰好出现一次。
+set -euo pipefail
+
+# Resolve project root from this script's location
+SMSIMDIR="$(cd "$(dirname "${BASH_SOURCE[0]}")"/../.. && pwd)"
+export SMSIMDIR
+cd "${SMSIMDIR}"
+
+SIM_BIN="${SMSIMDIR}/build/bin/sim_deuteron"
+SMOKE_MAC="${SMSIMDIR}/configs/simulation/macros/test_nebula_plus.mac"
+OUT_DIR="data/simulation/output_tree"
+N_EVENTS=20
+WORK_DIR="$(mktemp -d /tmp/sim_mt_smoke_XXXXXX)"
+trap 'rm -rf "${WORK_DIR}"' EXIT
+
+echo "=== sim_deuteron multi-thread integration test ==="
+echo "  SMSIMDIR:  ${SMSIMDIR}"
+echo "  sim_bin:   ${SIM_BIN}"
+echo "  events:    ${N_EVENTS}"
+
+# ── Step 0: prerequisite checks ─────────────────────────────────────────────
+if [ ! -x "${SIM_BIN}" ]; then
+    echo "FAIL: sim_deuteron binary not found or not executable: ${SIM_BIN}"
+    exit 1
+fi
+if [ ! -f "${SMOKE_MAC}" ]; then
+    echo "FAIL: smoke macro not found: ${SMOKE_MAC}"
+    exit 1
+fi
+
+# ── Step 1: run the same macro with 1 and 2 threads ─────────────────────────
+# [EN] Only the run name and the event count differ from the smoke macro.
+# [CN] 与烟雾宏相比只改变运行名与事件数。
+run_sim() {
+    local threads="$1"
+    local run_name="mt_smoke_t${threads}_"
+    local macro="${WORK_DIR}/${run_name}.mac"
+    sed -e "s|^/action/file/RunName .*|/action/file/RunName ${run_name}|" \
+        -e "s|^/run/beamOn .*|/run/beamOn ${N_EVENTS}|" \
+        "${SMOKE_MAC}" > "${macro}"
+    rm -f "${OUT_DIR}/${run_name}"*.root
+    if ! "${SIM_BIN}" -t "${threads}" "${macro}" > "${WORK_DIR}/${run_name}.log" 2>&1; then
+        echo "FAIL: sim_deuteron -t ${threads} exited with non-zero status"
+        echo "--- last 30 lines of sim log ---"
+        tail -30 "${WORK_DIR}/${run_name}.log"
+        exit 1
+    fi
+}
+
+run_sim 1
+run_sim 2
+
+# ── Step 2: merged output exists, worker files are gone ─────────────────────
+FAIL=0
+MERGED="${OUT_DIR}/mt_smoke_t2_0000.root"
+SEQUENTIAL="${OUT_DIR}/mt_smoke_t1_0000.root"
+for f in "${SEQUENTIAL}" "${MERGED}"; do
+    if [ -f "${f}" ]; then
+        echo "  OK  output: ${f}"
+    else
+        echo "  FAIL output missing: ${f}"
+        FAIL=1
+    fi
+done
+LEFTOVER=$(ls "${OUT_DIR}/mt_smoke_t2_0000_t"*.root 2>/dev/null || true)
+if [ -n "${LEFTOVER}" ]; then
+    echo "  FAIL worker files not removed: ${LEFTOVER}"
+    FAIL=1
+else
+    echo "  OK  worker files removed"
+fi
+if [ "${FAIL}" -ne 0 ]; then
+    exit 1
+fi
+
+# ── Step 3: entry counts and event_id uniqueness ────────────────────────────
+# [EN] Prints ENTRIES:<n> and DUPLICATES:<n>, plus MISSING:<n> for IDs outside 0..n-1.
+# [CN] 输出 ENTRIES:<n>、DUPLICATES:<n>，以及不在 0..n-1 内的 MISSING:<n>。
+inspect() {
+    root -b -l -q "$1" -e "
+        auto* t = (TTree*)gFile->Get(\"tree\");
+        Long64_t id = -1;
+        t->SetBranchAddress(\"event_id\", &id);
+        std::set<Long64_t> seen;
+        Long64_t duplicates = 0;
+        for (Long64_t i = 0; i < t->GetEntries(); ++i) {
+            t->GetEntry(i);
+            if (!seen.insert(id).second) ++duplicates;
+        }
+        Long64_t missing = 0;
+        for (Long64_t i = 0; i < t->GetEntries(); ++i) {
+            if (!seen.count(i)) ++missing;
+        }
+        std::cout << \"ENTRIES:\" << t->GetEntries() << std::endl;
+        std::cout << \"DUPLICATES:\" << duplicates << std::endl;
+        std::cout << \"MISSING:\" << missing << std::endl;
+    " 2>/dev/null
+}
+
+field() {
+    echo "$1" | grep "^$2:" | head -1 | cut -d: -f2
+}
+
+SEQ_OUT=$(inspect "${SEQUENTIAL}")
+MT_OUT=$(inspect "${MERGED}")
+SEQ_ENTRIES=$(field "${SEQ_OUT}" ENTRIES)
+MT_ENTRIES=$(field "${MT_OUT}" ENTRIES)
+
+echo ""
+echo "--- Assertions ---"
+if [ -n "${MT_ENTRIES}" ] && [ "${MT_ENTRIES}" = "${SEQ_ENTRIES}" ] && [ "${MT_ENTRIES}" -eq "${N_EVENTS}" ]; then
+    echo "  OK  entries: -t 1 ${SEQ_ENTRIES}, -t 2 ${MT_ENTRIES}"
+else
+    echo "  FAIL entries: -t 1 '${SEQ_ENTRIES}', -t 2 '${MT_ENTRIES}', expected ${N_EVENTS}"
+    FAIL=1
+fi
+if [ "$(field "${MT_OUT}" DUPLICATES)" = "0" ] && [ "$(field "${MT_OUT}" MISSING)" = "0" ]; then
+    echo "  OK  every event_id appears exactly once"
+else
+    echo "  FAIL event_id: duplicates=$(field "${MT_OUT}" DUPLICATES) missing=$(field "${MT_OUT}" MISSING)"
+    FAIL=1
+fi
+
+rm -f "${OUT_DIR}/mt_smoke_t1_"*.root "${OUT_DIR}/mt_smoke_t2_"*.root
+
+# ── Final verdict ────────────────────────────────────────────────────────────
+echo ""
+if [ "${FAIL}" -ne 0 ]; then
+    echo "FAIL: one or more assertions failed (see above)"
+    exit 1
+fi
+
+echo "PASS: multi-threaded run merged into one file with every event exactly once"
+exit 0
@@ -0,0 +1,120 @@
+"""Smoke test for the smsim_reco Python module (-DWITH_PYTHON_BINDINGS=ON).
+
+[EN] Field queries on a constant table map, and NN batch reconstruction checked against the closed-form output of a
+linear model and across thread counts. Runs under pytest or directly as a script (ctest).
+[CN] 在常量磁场表上做场查询；NN 批量重建与线性模型的解析结果比对，并比较不同线程数的结果。可用 pytest 或直接作为脚本（ctest）运行。
+"""
+
+import json
+import os
+import sys
+import tempfile
+
+import numpy as np
+
+import smsim_reco
+
+BY_TESLA = 1.15
+PZ_BIAS = 600.0
+PROTON_MASS = 938.2720813
+
+
+def write_constant_field_map(path, by_tesla):
+    xs = (0.0, 1000.0, 2000.0)
+    ys = (-500.0, 0.0, 500.0)
+    zs = (0.0, 500.0, 1000.0, 1500.0)
+    with open(path, "w") as out:
+        out.write("3 3 4 2\n")
+        for i in range(6):
+            out.write(f"# header {i + 1}\n")
+        out.write("0\n")
+        for x in xs:
+            for y in ys:
+                for z in zs:
+                    out.write(f"{x} {y} {z} 0 {by_tesla} 0\n")
+
+
+def write_linear_model(path, pz_bias):
+    # p = (pdc1_x, pdc1_y, pz_bias)
+    model = {
+        "x_mean": [0, 0, 0, 0, 0, 0],
+        "x_std": [1, 1, 1, 1, 1, 1],
+        "layers": [{
+            "in_dim": 6,
+            "out_dim": 3,
+            "weights": [1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0],
+            "bias": [0, 0, pz_bias],
+        }],
+    }
+    with open(path, "w") as out:
+        json.dump(model, out)
+
+
+def make_tracks(n, seed=11):
+    rng = np.random.default_rng(seed)
+    pdc1 = np.column_stack([rng.uniform(-50, 50, n), rng.uniform(-50, 50, n), np.full(n, 1000.0)])
+    pdc2 = pdc1 + np.column_stack([rng.uniform(5, 20, n), np.zeros(n), np.full(n, 1000.0)])
+    return pdc1, pdc2
+
+
+def reconstruct(reconstructor, pdc1, pdc2, threads):
+    return reconstructor.reconstruct_batch(pdc1[:, 0].copy(), pdc1[:, 1].copy(), pdc1[:, 2].copy(),
+                                           pdc2[:, 0].copy(), pdc2[:, 1].copy(), pdc2[:, 2].copy(),
+                                           threads=threads)
+
+
+def test_field_query_on_constant_map():
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "constant.table")
+        write_constant_field_map(path, BY_TESLA)
+        field = smsim_reco.MagneticField(path, rotation_deg=0.0)
+        assert field.rotation_deg == 0.0
+        b = field.field(np.array([[500.0, 0.0, 400.0], [1500.0, 250.0, 1200.0]]))
+        assert b.shape == (2, 3)
+        np.testing.assert_allclose(b[:, 1], BY_TESLA, rtol=1e-9)
+        np.testing.assert_allclose(b[:, [0, 2]], 0.0, atol=1e-12)
+
+
+def test_nn_batch_matches_model_and_is_thread_count_independent():
+    with tempfile.TemporaryDirectory() as tmp:
+        model_path = os.path.join(tmp, "linear_model.json")
+        write_linear_model(model_path, PZ_BIAS)
+        reconstructor = smsim_reco.PDCReconstructor(backend="nn", nn_model=model_path,
+                                                    target_position=[0.0, 0.0, 0.0])
+
+        # [EN] Several NN blocks per worker, so threads=4 really splits the batch. / [CN] 每个线程多于一个 NN 块，threads=4 确实会切分。
+        pdc1, pdc2 = make_tracks(1000)
+        single = reconstruct(reconstructor, pdc1, pdc2, threads=1)
+        assert np.all(single["status"] == int(smsim_reco.SolverStatus.kSuccess))
+        assert np.all(single["method"] == int(smsim_reco.SolveMethod.kNeuralNetwork))
+        np.testing.assert_allclose(single["px"], pdc1[:, 0], rtol=1e-12)
+        np.testing.assert_allclose(single["py"], pdc1[:, 1], rtol=1e-12)
+        np.testing.assert_allclose(single["pz"], PZ_BIAS, rtol=1e-12)
+        p2 = pdc1[:, 0] ** 2 + pdc1[:, 1] ** 2 + PZ_BIAS ** 2
+        np.testing.assert_allclose(single["energy"], np.sqrt(p2 + PROTON_MASS ** 2), rtol=1e-12)
+
+        threaded = reconstruct(reconstructor, pdc1, pdc2, threads=4)
+        for key in ("status", "method", "px", "py", "pz", "energy", "brho_tm", "iterations"):
+            np.testing.assert_array_equal(single[key], threaded[key], err_msg=key)
+
+
+def test_mismatched_columns_raise():
+    with tempfile.TemporaryDirectory() as tmp:
+        model_path = os.path.join(tmp, "linear_model.json")
+        write_linear_model(model_path, PZ_BIAS)
+        reconstructor = smsim_reco.PDCReconstructor(backend="nn", nn_model=model_path)
+        pdc1, pdc2 = make_tracks(8)
+        try:
+            reconstructor.reconstruct_batch(pdc1[:, 0].copy(), pdc1[:5, 1].copy(), pdc1[:, 2].copy(),
+                                            pdc2[:, 0].copy(), pdc2[:, 1].copy(), pdc2[:, 2].copy())
+        except ValueError:
+            return
+        raise AssertionError("length mismatch was not rejected")
+
+
+if __name__ == "__main__":
+    tests = [value for name, value in sorted(globals().items()) if name.startswith("test_") and callable(value)]
+    for test in tests:
+        test()
+        print(f"PASS {test.__name__}")
+    sys.exit(0)
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include "NEBULAPlusSimDataConverter_TArtNEBULAPlusPla.hh"
+#include "NEBULAPlusSimDataInitializer.hh"
+#include "RandomStreams.hh"
+#include "SimDataManager.hh"
+#include "TArtNEBULAPlusPla.hh"
+#include "TNEBULAPlusSimParameter.hh"
+#include "TSimHit.hh"
+#include "TSimNameTable.hh"
+
+#include "TClonesArray.h"
+#include "TString.h"
+
+namespace {
+
+// [EN] Exposes the output array of the converter under test. / [CN] 暴露被测转换器的输出数组。
+class ProbeConverter : public NEBULAPlusSimDataConverter_TArtNEBULAPlusPla {
+public:
+    ProbeConverter(const char* name, bool fast) : NEBULAPlusSimDataConverter_TArtNEBULAPlusPla(name) {
+        SetFastDigitizer(fast);
+    }
+    TClonesArray* Output() { return fNEBULAPlusPlaArray; }
+};
+
+struct Particle {
+    const char* name;
+    Int_t pdg;
+};
+
+const Particle kParticles[] = {
+    {"proton", 2212}, {"e-", 11}, {"deuteron", 1000010020}, {"alpha", 1000020040}, {"C12", 1000060120},
+};
+
+TNEBULAPlusSimParameter* MakeParameter() {
+    auto prm = new TNEBULAPlusSimParameter("NEBULAPlusParameter");
+    prm->fIsLoaded = true;
+    prm->fPosition.SetXYZ(10.0, -5.0, 11000.0);
+    prm->fNeutSize.SetXYZ(120.0, 1800.0, 120.0);
+    prm->fVetoSize.SetXYZ(320.0, 1900.0, 10.0);
+    prm->fTimeReso = 0.2;
+    prm->fV_scinti = 136.0;
+    prm->fAttLen_Neut = 2000.0;
+    prm->fAttLen_Veto = 1500.0;
+    prm->fNeutNum = 6;
+    prm->fVetoNum = 2;
+    for (Int_t id = 1; id <= 8; ++id) {
+        TDetectorSimParameter& det = prm->fNEBULAPlusDetectorParameterMap[id];
+        det.SetName(Form("NP%02d", id));
+        det.fID = id;
+        det.fLayer = id <= 6 ? 1 : 0;
+        det.fSubLayer = id <= 6 ? (id - 1) / 3 + 1 : 0;
+        det.fDetectorType = id <= 6 ? "Neut" : "Veto";
+        det.fPosition.SetXYZ(130.0 * ((id - 1) % 3), 0.0, id <= 6 ? 130.0 * ((id - 1) / 3) : -500.0);
+    }
+    return prm;
+}
+
+// [EN] A few hits per event, including repeats in one module and an ID (20) without parameters.
+// [CN] 每事件若干击中，包括同一模块的多次击中和一个没有参数的 ID（20）。
+void FillHits(TClonesArray* hits, TSimNameTable* names, PhiloxRandom& rng) {
+    hits->Clear("C");
+    const int n = 1 + static_cast<int>(rng.Rndm() * 12);
+    for (int i = 0; i < n; ++i) {
+        TSimHit* hit = static_cast<TSimHit*>(hits->ConstructedAt(i));
+        const Particle& p = kParticles[static_cast<int>(rng.Rndm() * 5)];
+        hit->fID = rng.Rndm() < 0.05 ? 20 : 1 + static_cast<int>(rng.Rndm() * 8);
+        hit->fPDGCode = p.pdg;
+        hit->fParticleNameID = names->Intern(p.name);
+        hit->fPreKineticEnergy = 200.0 * rng.Rndm();
+        hit->fEnergyDeposit = hit->fPreKineticEnergy * rng.Rndm();
+        hit->fPreTime = 40.0 + 5.0 * rng.Rndm();
+        hit->fPrePosition[0] = 100.0 * rng.Rndm();
+        hit->fPrePosition[1] = -900.0 + 1800.0 * rng.Rndm();
+        hit->fPrePosition[2] = 11000.0 + 200.0 * rng.Rndm();
+    }
+}
+
+TEST(NEBULADigitizerTest, FastPathMatchesTheMapBasedConverter) {
+    SimDataManager* sman = SimDataManager::GetSimDataManager();
+    sman->GetRandomStreams().SetRunSeed(20241018u);
+    sman->AddParameter(MakeParameter());
+    sman->RegistInitializer(new NEBULAPlusSimDataInitializer);
+    auto legacy = new ProbeConverter("Legacy", false);
+    auto fast = new ProbeConverter("Fast", true);
+    sman->RegistConverter(legacy);
+    sman->RegistConverter(fast);
+    ASSERT_EQ(0, sman->Initialize());
+
+    TClonesArray* hits = sman->FindSimDataArray("NEBULAPlusSimHit");
+    ASSERT_NE(nullptr, hits);
+    PhiloxRandom rng(7u);
+
+    for (bool resolution : {true, false}) {
+        legacy->SetIncludeResolution(resolution);
+        fast->SetIncludeResolution(resolution);
+        for (Long64_t event = 0; event < 200; ++event) {
+            FillHits(hits, sman->GetNameTable(), rng);
+            sman->SetEventID(event);
+            legacy->ClearBuffer();
+            fast->ClearBuffer();
+            ASSERT_EQ(0, legacy->ConvertSimData());
+            ASSERT_EQ(0, fast->ConvertSimData());
+
+            // [EN] Same random draws in the same order, so equal up to rounding. / [CN] 随机数抽取及顺序相同，结果在舍入误差内一致。
+            TClonesArray* a = legacy->Output();
+            TClonesArray* b = fast->Output();
+            ASSERT_EQ(a->GetEntriesFast(), b->GetEntriesFast()) << "event " << event;
+            for (int i = 0; i < a->GetEntriesFast(); ++i) {
+                const auto* x = static_cast<const TArtNEBULAPlusPla*>(a->At(i));
+                const auto* y = static_cast<const TArtNEBULAPlusPla*>(b->At(i));
+                EXPECT_EQ(x->fID, y->fID);
+                EXPECT_EQ(x->fLayer, y->fLayer);
+                EXPECT_EQ(x->fSubLayer, y->fSubLayer);
+                EXPECT_DOUBLE_EQ(x->fTime, y->fTime);
+                EXPECT_DOUBLE_EQ(x->fEdep, y->fEdep);
+                EXPECT_DOUBLE_EQ(x->fQU, y->fQU);
+                EXPECT_DOUBLE_EQ(x->fQD, y->fQD);
+                EXPECT_DOUBLE_EQ(x->fPos.X(), y->fPos.X());
+                EXPECT_DOUBLE_EQ(x->fPos.Y(), y->fPos.Y());
+                EXPECT_DOUBLE_EQ(x->fPos.Z(), y->fPos.Z());
+            }
+        }
+    }
+}
+
+TEST(NEBULADigitizerTest, SkipsUnknownModulesWithoutDrawing) {
+    TNEBULAPlusSimParameter* prm = MakeParameter();
+    NEBULADigitizer digitizer;
+    digitizer.Build(*prm);
+    EXPECT_EQ(nullptr, digitizer.GetModule(0));
+    EXPECT_EQ(nullptr, digitizer.GetModule(20));
+    ASSERT_NE(nullptr, digitizer.GetModule(7));
+    EXPECT_DOUBLE_EQ(1900.0, digitizer.GetModule(7)->ysize);
+
+    const Double_t pos[3] = {0.0, 100.0, 11000.0};
+    digitizer.Add(20, 1.0, 1.0, 40.0, pos);
+    digitizer.Add(3, 2.0, 1.5, 41.0, pos);
+    digitizer.Add(3, 1.0, 0.5, 40.5, pos);
+
+    PhiloxRandom a(3u);
+    PhiloxRandom b(3u);
+    const auto& out = digitizer.Digitize(a, true);
+    ASSERT_EQ(1u, out.size());
+    EXPECT_EQ(3, out[0].id);
+    ASSERT_EQ(1u, digitizer.GetUnknownIDs().size());
+    EXPECT_EQ(20, digitizer.GetUnknownIDs()[0]);
+
+    // [EN] One module, two Gaussian draws. / [CN] 一个模块，两次高斯抽样。
+    b.Gaus(0, prm->fTimeReso);
+    b.Gaus(0, prm->fTimeReso);
+    EXPECT_EQ(b.Rndm(), a.Rndm());
+
+    // [EN] Digitize() resets the sums. / [CN] Digitize() 会清零累加量。
+    EXPECT_TRUE(digitizer.Digitize(a, true).empty());
+    delete prm;
+}
+
+}  // namespace
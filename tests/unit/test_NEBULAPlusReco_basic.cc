@@ -3,7 +3,8 @@
 // Basic NEBULAPlusReco unit tests using hand-crafted TArtNEBULAPlusPla input.
 // Covers: (a) two close-in-time hits cluster into one neutron,
 // (b) below-threshold hits are dropped,
-// (c) veto bars are skipped.
+// (c) veto bars are skipped,
+// (d) module adjacency separates simultaneous hits in distant bars.
 
 #include <gtest/gtest.h>
 #include <TClonesArray.h>
@@ -11,6 +12,7 @@
 #include "NEBULAPlusReco.hh"
 #include "TArtNEBULAPlusPla.hh"
 #include "GeometryManager.hh"
+#include "NEBULAModuleAdjacency.hh"
 
 namespace {
 
@@ -78,4 +80,66 @@ TEST(NEBULAPlusRecoBasic, SkipsVetoBars) {
     EXPECT_EQ(0u, cands.size()) << "veto bars should not produce neutrons";
 }
 
+// Wall-A, one sub-layer: 120 mm bars at 120 mm pitch (ID 101..110) plus the
+// sub-layer behind it (ID 201..210) at z + 120 mm.
+NEBULAModuleAdjacency MakeWallA() {
+    NEBULAModuleAdjacency adjacency;
+    const TVector3 bar(120.0, 1800.0, 120.0);
+    for (int k = 0; k < 10; ++k) {
+        adjacency.AddModule(NEBULAModuleAdjacency::kNEBULAPlus, 101 + k, TVector3(120.0 * k, 0, 8089.0), bar);
+        adjacency.AddModule(NEBULAModuleAdjacency::kNEBULAPlus, 201 + k, TVector3(120.0 * k, 0, 8209.0), bar);
+    }
+    adjacency.Build(10.0);
+    return adjacency;
+}
+
+NEBULAHit MakeHit(int id, double x, double z, double t, double e) {
+    NEBULAHit h(id, TVector3(x, 0.0, z), e, t, e);
+    h.wall_tag = 1;
+    return h;
+}
+
+TEST(NEBULAPlusRecoBasic, ModuleAdjacencyLinksTouchingBarsOnly) {
+    const NEBULAModuleAdjacency adjacency = MakeWallA();
+    const int a = adjacency.Index(NEBULAModuleAdjacency::kNEBULAPlus, 101);
+    const int right = adjacency.Index(NEBULAModuleAdjacency::kNEBULAPlus, 102);
+    const int behind = adjacency.Index(NEBULAModuleAdjacency::kNEBULAPlus, 202);
+    const int far = adjacency.Index(NEBULAModuleAdjacency::kNEBULAPlus, 104);
+    ASSERT_GE(a, 0);
+    EXPECT_TRUE(adjacency.Adjacent(a, right));
+    EXPECT_TRUE(adjacency.Adjacent(a, behind));   // diagonal neighbour in the next sub-layer
+    EXPECT_FALSE(adjacency.Adjacent(a, far));
+    EXPECT_EQ(-1, adjacency.Index(NEBULAModuleAdjacency::kNEBULA, 101));
+    // 9 in-row pairs per sub-layer, 10 straight + 18 diagonal pairs between them.
+    EXPECT_EQ(2u * 9u + 10u + 18u, adjacency.GetNNeighbourPairs());
+}
+
+TEST(NEBULAPlusRecoBasic, AdjacencySeparatesSimultaneousNeutrons) {
+    // Neutron 1 fires bars 101 and 202, neutron 2 fires bar 108, all within 1 ns.
+    std::vector<NEBULAHit> hits = {
+        MakeHit(108, 840.0, 8089.0, 60.4, 5.0),
+        MakeHit(101, 0.0, 8089.0, 60.0, 8.0),
+        MakeHit(202, 120.0, 8209.0, 60.8, 6.0),
+    };
+
+    GeometryManager geo;
+    NEBULAPlusReco reco(geo);
+    reco.SetTargetPosition({0, 0, 0});
+    EXPECT_EQ(1u, reco.ReconstructNeutrons(hits).size()) << "time-only clustering merges both neutrons";
+
+    const NEBULAModuleAdjacency adjacency = MakeWallA();
+    reco.SetModuleAdjacency(&adjacency);
+    auto cands = reco.ReconstructNeutrons(hits);
+    ASSERT_EQ(2u, cands.size());
+    // Clusters are ordered by their earliest hit.
+    EXPECT_EQ(2, cands[0].hitMultiplicity);
+    EXPECT_NEAR((8.0 * 0.0 + 6.0 * 120.0) / 14.0, cands[0].position.X(), 1e-9);
+    EXPECT_EQ(1, cands[1].hitMultiplicity);
+    EXPECT_DOUBLE_EQ(840.0, cands[1].position.X());
+
+    // Same bars, but the second sub-layer hit is out of time: it forms its own cluster.
+    hits[2].time = 90.0;
+    EXPECT_EQ(3u, reco.ReconstructNeutrons(hits).size());
+}
+
 }  // namespace
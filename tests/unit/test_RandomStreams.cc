@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include "RandomStreams.hh"
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace {
+
+TEST(RandomStreamsTest, PhiloxMatchesReferenceVectors) {
+    // [EN] Known-answer vectors of the Random123 reference implementation (kat_vectors, philox4x32_10).
+    // [CN] Random123 参考实现的已知答案向量（kat_vectors，philox4x32_10）。
+    std::uint32_t out[4];
+    const std::uint32_t zero_counter[4] = {0u, 0u, 0u, 0u};
+    const std::uint32_t zero_key[2] = {0u, 0u};
+    PhiloxRandom::Block(zero_counter, zero_key, out);
+    EXPECT_EQ(0x6627e8d5u, out[0]);
+    EXPECT_EQ(0xe169c58du, out[1]);
+    EXPECT_EQ(0xbc57ac4cu, out[2]);
+    EXPECT_EQ(0x9b00dbd8u, out[3]);
+
+    const std::uint32_t ones_counter[4] = {0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu};
+    const std::uint32_t ones_key[2] = {0xffffffffu, 0xffffffffu};
+    PhiloxRandom::Block(ones_counter, ones_key, out);
+    EXPECT_EQ(0x408f276du, out[0]);
+    EXPECT_EQ(0x41c83b0eu, out[1]);
+    EXPECT_EQ(0xa20bc7c6u, out[2]);
+    EXPECT_EQ(0x6d5451fdu, out[3]);
+}
+
+TEST(RandomStreamsTest, StreamsDependOnlyOnRunEventAndName) {
+    const RandomStreams streams(20240601u);
+    PhiloxRandom a;
+    PhiloxRandom b;
+
+    // [EN] Visiting events in a different order must not change any event's numbers.
+    // [CN] 以不同顺序访问事件不应改变任何事件的随机数。
+    std::vector<double> forward;
+    for (std::int64_t event = 0; event < 4; ++event) {
+        streams.Attach(a, event, "PDC");
+        forward.push_back(a.Rndm());
+        forward.push_back(a.Rndm());
+    }
+    for (std::int64_t event = 3; event >= 0; --event) {
+        streams.Attach(b, event, "PDC");
+        EXPECT_EQ(forward[2 * event], b.Rndm());
+        EXPECT_EQ(forward[2 * event + 1], b.Rndm());
+    }
+
+    std::set<std::uint64_t> keys;
+    keys.insert(streams.StreamKey(0, "PDC"));
+    keys.insert(streams.StreamKey(0, "NEBULA/time"));
+    keys.insert(streams.StreamKey(1, "PDC"));
+    keys.insert(RandomStreams(20240602u).StreamKey(0, "PDC"));
+    keys.insert(streams.ForSubRun(1).StreamKey(0, "PDC"));
+    EXPECT_EQ(5u, keys.size());
+}
+
+TEST(RandomStreamsTest, UniformStaysInsideOpenInterval) {
+    PhiloxRandom rng(7u);
+    double sum = 0.0;
+    const int n = 200000;
+    for (int i = 0; i < n; ++i) {
+        const double u = rng.Rndm();
+        ASSERT_GT(u, 0.0);
+        ASSERT_LT(u, 1.0);
+        sum += u;
+    }
+    EXPECT_NEAR(0.5, sum / n, 0.005);
+}
+
+}  // namespace
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include "RecoProfiler.hh"
+
+#include <string>
+#include <thread>
+
+namespace {
+
+using analysis::profiling::RecoProfiler;
+using analysis::profiling::RecoStage;
+using analysis::profiling::StageTotals;
+
+constexpr std::size_t Index(RecoStage stage) {
+    return static_cast<std::size_t>(stage);
+}
+
+class RecoProfilerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        RecoProfiler::Reset();
+        RecoProfiler::SetEnabled(true);
+    }
+    void TearDown() override {
+        RecoProfiler::SetEnabled(false);
+        RecoProfiler::Reset();
+    }
+};
+
+TEST_F(RecoProfilerTest, DisabledTimersRecordNothing) {
+    RecoProfiler::SetEnabled(false);
+    {
+        SM_PROFILE_STAGE(RecoStage::kPdcAna);
+    }
+    EXPECT_EQ(0u, RecoProfiler::CollectTotals().calls[Index(RecoStage::kPdcAna)]);
+}
+
+TEST_F(RecoProfilerTest, CollectsCountsFromFinishedThreads) {
+    if (!SMSIM_RECO_PROFILING) {
+        GTEST_SKIP() << "stage timers compiled out";
+    }
+    auto work = [] {
+        for (int i = 0; i < 10; ++i) {
+            SM_PROFILE_STAGE(RecoStage::kRkFit);
+        }
+    };
+    std::thread a(work);
+    std::thread b(work);
+    a.join();
+    b.join();
+    {
+        SM_PROFILE_STAGE(RecoStage::kRead);
+    }
+
+    const StageTotals totals = RecoProfiler::CollectTotals();
+    EXPECT_EQ(20u, totals.calls[Index(RecoStage::kRkFit)]);
+    EXPECT_EQ(1u, totals.calls[Index(RecoStage::kRead)]);
+    EXPECT_EQ(0u, totals.calls[Index(RecoStage::kNNInference)]);
+}
+
+TEST_F(RecoProfilerTest, SnapshotDeltaIsolatesOneEvent) {
+    if (!SMSIM_RECO_PROFILING) {
+        GTEST_SKIP() << "stage timers compiled out";
+    }
+    {
+        SM_PROFILE_STAGE(RecoStage::kProtonReco);
+    }
+    const StageTotals before = RecoProfiler::ThreadCounters().Snapshot();
+    {
+        SM_PROFILE_STAGE(RecoStage::kProtonReco);
+        SM_PROFILE_STAGE(RecoStage::kRkSeed);
+    }
+    const StageTotals delta = RecoProfiler::ThreadCounters().Snapshot() - before;
+    EXPECT_EQ(1u, delta.calls[Index(RecoStage::kProtonReco)]);
+    EXPECT_EQ(1u, delta.calls[Index(RecoStage::kRkSeed)]);
+    EXPECT_GE(delta.ns[Index(RecoStage::kProtonReco)], delta.ns[Index(RecoStage::kRkSeed)]);
+}
+
+TEST_F(RecoProfilerTest, SummaryListsOnlyVisitedStages) {
+    StageTotals totals;
+    totals.ns[Index(RecoStage::kTreeFill)] = 2000000;
+    totals.calls[Index(RecoStage::kTreeFill)] = 4;
+    const std::string summary = RecoProfiler::FormatSummary(totals, 0.004);
+    EXPECT_NE(std::string::npos, summary.find("tree_fill"));
+    EXPECT_NE(std::string::npos, summary.find("50.0%"));
+    EXPECT_EQ(std::string::npos, summary.find("nn_inference"));
+}
+
+TEST(RecoProfilerMemory, ReportsPeakResidentSetSize) {
+    const auto usage = analysis::profiling::SampleMemoryUsage();
+    EXPECT_GT(usage.peak_rss_kb, 0);
+}
+
+}  // namespace
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include "SMLogger.hh"
+
+#include <atomic>
+#include <thread>
+
+namespace {
+
+int g_evaluations = 0;
+
+int Evaluated() { return ++g_evaluations; }
+
+class SMLoggerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        SMLogger::LogConfig config;
+        config.async = false;
+        config.console = false;
+        config.level = SMLogger::LogLevel::INFO;
+        config.module_levels["LoggerTestQuiet"] = SMLogger::LogLevel::ERROR;
+        SMLogger::Logger::Instance().Initialize(config);
+        g_evaluations = 0;
+    }
+    void TearDown() override { SMLogger::Logger::Instance().Shutdown(); }
+};
+
+TEST_F(SMLoggerTest, ArgumentsAreOnlyEvaluatedWhenLevelIsEnabled) {
+    SM_DEBUG("debug {}", Evaluated());
+    EXPECT_EQ(0, g_evaluations);
+    SM_INFO("info {}", Evaluated());
+    EXPECT_EQ(1, g_evaluations);
+
+    SMLogger::Logger::Instance().SetLevel(SMLogger::LogLevel::DEBUG);
+    SM_DEBUG("debug {}", Evaluated());
+    EXPECT_EQ(2, g_evaluations);
+}
+
+TEST_F(SMLoggerTest, ModuleLevelsOverrideTheGlobalLevel) {
+#undef SM_LOG_MODULE
+#define SM_LOG_MODULE "LoggerTestQuiet"
+    SM_WARN("suppressed {}", Evaluated());
+    SM_ERROR("kept {}", Evaluated());
+    EXPECT_EQ(1, g_evaluations);
+    EXPECT_EQ(spdlog::level::err, SMLogger::Logger::Instance().GetLogger("LoggerTestQuiet")->level());
+
+    // [EN] A global level change leaves modules with their own level alone. / [CN] 全局级别变化不影响单独设置了级别的模块。
+    SMLogger::Logger::Instance().SetLevel(SMLogger::LogLevel::TRACE);
+    SM_WARN("still suppressed {}", Evaluated());
+    EXPECT_EQ(1, g_evaluations);
+
+    SMLogger::Logger::Instance().SetModuleLevel("LoggerTestQuiet", SMLogger::LogLevel::DEBUG);
+    SM_DEBUG("now kept {}", Evaluated());
+    EXPECT_EQ(2, g_evaluations);
+#undef SM_LOG_MODULE
+#define SM_LOG_MODULE "SMSimulator"
+    EXPECT_EQ(spdlog::level::trace, SMLogger::Logger::Instance().GetLogger()->level());
+}
+
+TEST_F(SMLoggerTest, CallSitesSurviveReinitialisation) {
+    for (int i = 0; i < 2; ++i) {
+        // [EN] The same call site must pick up the new logger (WARN on the second pass) after Shutdown()/Initialize().
+        // [CN] Shutdown()/Initialize() 之后同一调用点必须取到新的 logger（第二轮为 WARN）。
+        SM_INFO("iteration {}", Evaluated());
+        SMLogger::Logger::Instance().Shutdown();
+        SMLogger::LogConfig config;
+        config.async = false;
+        config.console = false;
+        config.level = i == 0 ? SMLogger::LogLevel::WARN : SMLogger::LogLevel::INFO;
+        SMLogger::Logger::Instance().Initialize(config);
+    }
+    EXPECT_EQ(1, g_evaluations);
+    SM_INFO("after {}", Evaluated());
+    EXPECT_EQ(2, g_evaluations);
+}
+
+TEST_F(SMLoggerTest, ShutdownKeepsLoggersAliveForOtherThreads) {
+    // [EN] A raw pointer taken before Shutdown() must stay usable; the object is retired, not freed.
+    // [CN] Shutdown() 之前取得的裸指针必须仍可使用：logger 只是被撤下，而非释放。
+    const int slot = SMLogger::Logger::ModuleSlot("LoggerTestWorker");
+    spdlog::logger* before = SMLogger::Logger::Get(slot);
+    ASSERT_NE(nullptr, before);
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> written{0};
+    // [EN] The worker keeps using the pointer it loaded, as a call site does between its slot read and log().
+    // [CN] 工作线程持续使用已读到的指针，相当于调用点在读取槽位与 log() 之间被打断。
+    std::thread worker([&] {
+        while (!stop.load(std::memory_order_acquire)) {
+            before->info("worker {}", written.fetch_add(1, std::memory_order_relaxed));
+        }
+    });
+    while (written.load(std::memory_order_relaxed) == 0) {
+        std::this_thread::yield();
+    }
+    SMLogger::LogConfig config;
+    config.async = false;
+    config.console = false;
+    for (int i = 0; i < 20; ++i) {
+        SMLogger::Logger::Instance().Shutdown();
+        SMLogger::Logger::Instance().Initialize(config);
+    }
+    stop.store(true, std::memory_order_release);
+    worker.join();
+
+    EXPECT_GT(written.load(), 0);
+    EXPECT_EQ("LoggerTestWorker", before->name());
+    EXPECT_NE(before, SMLogger::Logger::Get(slot));
+}
+
+TEST_F(SMLoggerTest, LevelsBelowTheCompileTimeThresholdAreElided) {
+    SMLogger::Logger::Instance().SetLevel(SMLogger::LogLevel::TRACE);
+#undef SM_LOG_ACTIVE_LEVEL
+#define SM_LOG_ACTIVE_LEVEL 3
+    SM_INFO("elided {}", Evaluated());
+    SM_WARN("kept {}", Evaluated());
+    EXPECT_EQ(1, g_evaluations);
+#undef SM_LOG_ACTIVE_LEVEL
+#define SM_LOG_ACTIVE_LEVEL 0
+}
+
+TEST_F(SMLoggerTest, RateLimitedCallSitesLogFirstNThenEveryM) {
+    for (int i = 0; i < 20; ++i) {
+        SM_INFO_LIMITED(3, 5, "limited {}", Evaluated());
+    }
+    // [EN] Calls 1-3, then 8, 13 and 18. / [CN] 第 1-3 次，然后第 8、13、18 次。
+    EXPECT_EQ(6, g_evaluations);
+
+    // [EN] A disabled level is rejected before the limiter, so it neither counts nor evaluates.
+    // [CN] 被禁用的级别在限流器之前即被拒绝，既不计数也不求值。
+    for (int i = 0; i < 5; ++i) {
+        SM_DEBUG_LIMITED(1, 1, "disabled {}", Evaluated());
+    }
+    EXPECT_EQ(6, g_evaluations);
+}
+
+TEST_F(SMLoggerTest, CountersAggregateAcrossCallSites) {
+    for (int i = 0; i < 100; ++i) SM_COUNT("LoggerTest/events");
+    SM_COUNT_ADD("LoggerTest/events", 5);
+    SM_COUNT_ADD("LoggerTest/hits", 7);
+    EXPECT_EQ(105u, SMLogger::Logger::Instance().GetCounterTotal("LoggerTest/events"));
+    EXPECT_EQ(7u, SMLogger::Logger::Instance().GetCounterTotal("LoggerTest/hits"));
+    EXPECT_EQ(0u, SMLogger::Logger::Instance().GetCounterTotal("LoggerTest/unknown"));
+    SMLogger::Logger::Instance().EmitSummary(false);
+}
+
+}  // namespace
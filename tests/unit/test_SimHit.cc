@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include "TSimData.hh"
+#include "TSimHit.hh"
+#include "TSimNameTable.hh"
+
+#include "TClonesArray.h"
+
+namespace {
+
+TEST(SimHitTest, NameTableInternsEachNameOnce) {
+    TSimNameTable names;
+    const Int_t proton = names.Intern("proton");
+    const Int_t pdc = names.Intern("PDC");
+    EXPECT_NE(proton, pdc);
+    EXPECT_EQ(proton, names.Intern("proton"));
+    EXPECT_EQ(2, names.GetEntries());
+    EXPECT_STREQ("PDC", names.GetEntry(pdc));
+    EXPECT_STREQ("", names.GetEntry(-1));
+    EXPECT_STREQ("", names.GetEntry(42));
+}
+
+TEST(SimHitTest, ExpandRestoresTheLegacyRecord) {
+    TSimNameTable names;
+    TSimHit hit;
+    hit.fTrackID = 3;
+    hit.fStepNo = 7;
+    hit.fPDGCode = 2212;
+    hit.fID = 1;
+    hit.fParticleNameID = names.Intern("proton");
+    hit.fDetectorNameID = names.Intern("PDC");
+    hit.fModuleNameID = names.Intern("X");
+    hit.fNModuleID = 2;
+    hit.fModuleID[0] = 5;
+    hit.fModuleID[1] = 1;
+    hit.fMass = 938.272;
+    hit.fPreKineticEnergy = 200.0;
+    hit.fPreMomentum[2] = 644.4;
+    hit.fPrePosition[0] = 12.5;
+    hit.fEnergyDeposit = 0.25;
+
+    TClonesArray hits("TSimHit");
+    new (hits[0]) TSimHit(hit);
+    TClonesArray out("TSimData");
+    TSimHit::ExpandArray(&hits, &names, &out);
+    ASSERT_EQ(1, out.GetEntriesFast());
+
+    const TSimData* data = static_cast<const TSimData*>(out.At(0));
+    EXPECT_EQ(3, data->fTrackID);
+    EXPECT_EQ(7, data->fStepNo);
+    EXPECT_EQ(2212, data->fPDGCode);
+    EXPECT_EQ("proton", data->fParticleName);
+    EXPECT_EQ("PDC", data->fDetectorName);
+    EXPECT_EQ("X", data->fModuleName);
+    EXPECT_EQ("", data->fProcessName);
+    ASSERT_EQ(2u, data->fModuleID.size());
+    EXPECT_EQ(5, data->fModuleID[0]);
+    EXPECT_DOUBLE_EQ(12.5, data->fPrePosition.X());
+    EXPECT_DOUBLE_EQ(644.4, data->fPreMomentum.Pz());
+    EXPECT_NEAR(1138.272, data->fPreMomentum.E(), 1e-9);
+    EXPECT_DOUBLE_EQ(0.25, data->fEnergyDeposit);
+}
+
+}  // namespace
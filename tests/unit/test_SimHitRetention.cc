@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include "SimHitRetention.hh"
+#include "TRunSimParameter.hh"
+#include "TSimHit.hh"
+
+#include "Compression.h"
+#include "TClonesArray.h"
+
+namespace {
+
+// [EN] Two tracks crossing detector copy 1, one of them continuing into copy 2. / [CN] 两条径迹穿过探测器拷贝 1，其中一条继续进入拷贝 2。
+void FillSteps(TClonesArray& hits) {
+    struct Step {
+        Int_t track, id;
+        Double_t t, edep;
+    };
+    const Step steps[] = {
+        {1, 1, 1.0, 0.5}, {1, 1, 2.0, 0.25}, {2, 1, 0.5, 1.0}, {1, 1, 3.0, 0.125},
+        {1, 2, 4.0, 2.0}, {2, 1, 1.5, 0.5},  {1, 2, 5.0, 1.0},
+    };
+    for (const Step& s : steps) {
+        TSimHit* hit = new (hits[hits.GetEntriesFast()]) TSimHit;
+        hit->fTrackID = s.track;
+        hit->fDetectorNameID = 0;
+        hit->fID = s.id;
+        hit->fPreTime = s.t;
+        hit->fPostTime = s.t + 0.5;
+        hit->fEnergyDeposit = s.edep;
+        hit->fFlightLength = 1.0;
+    }
+}
+
+const TSimHit* At(const TClonesArray& hits, int i) { return static_cast<const TSimHit*>(hits.At(i)); }
+
+TEST(SimHitRetentionTest, ParsesLevelNames) {
+    EXPECT_EQ(SimHitRetention::kSteps, SimHitRetention::Parse("steps"));
+    EXPECT_EQ(SimHitRetention::kEndpoints, SimHitRetention::Parse("endpoints"));
+    EXPECT_EQ(SimHitRetention::kSummary, SimHitRetention::Parse("summary"));
+    EXPECT_EQ(SimHitRetention::kSteps, SimHitRetention::Parse("unknown"));
+    EXPECT_EQ(SimHitRetention::kSteps, SimHitRetention::Parse(nullptr));
+    EXPECT_STREQ("summary", SimHitRetention::Name(SimHitRetention::kSummary));
+}
+
+TEST(SimHitRetentionTest, StepsKeepsEverything) {
+    TClonesArray hits("TSimHit");
+    TClonesArray out("TSimHit");
+    FillSteps(hits);
+    SimHitRetention retention;
+    retention.Reduce(&hits, SimHitRetention::kSteps, &out);
+    ASSERT_EQ(hits.GetEntriesFast(), out.GetEntriesFast());
+    for (int i = 0; i < hits.GetEntriesFast(); ++i) EXPECT_DOUBLE_EQ(At(hits, i)->fPreTime, At(out, i)->fPreTime);
+}
+
+TEST(SimHitRetentionTest, EndpointsKeepFirstAndLastStepPerTrackAndDetector) {
+    TClonesArray hits("TSimHit");
+    TClonesArray out("TSimHit");
+    FillSteps(hits);
+    SimHitRetention retention;
+    retention.Reduce(&hits, SimHitRetention::kEndpoints, &out);
+
+    // [EN] Input indices 0, 2, 3, 4, 5, 6 survive (index 1 is the middle step of track 1 in copy 1), in input order.
+    // [CN] 保留输入下标 0、2、3、4、5、6（下标 1 是径迹 1 在拷贝 1 中的中间步），顺序与输入相同。
+    const double expected[] = {1.0, 0.5, 3.0, 4.0, 1.5, 5.0};
+    ASSERT_EQ(6, out.GetEntriesFast());
+    for (int i = 0; i < 6; ++i) EXPECT_DOUBLE_EQ(expected[i], At(out, i)->fPreTime);
+}
+
+TEST(SimHitRetentionTest, SummaryMergesEachDetectorCopy) {
+    TClonesArray hits("TSimHit");
+    TClonesArray out("TSimHit");
+    FillSteps(hits);
+    SimHitRetention retention;
+    retention.Reduce(&hits, SimHitRetention::kSummary, &out);
+
+    ASSERT_EQ(2, out.GetEntriesFast());
+    const TSimHit* copy1 = At(out, 0);
+    EXPECT_EQ(1, copy1->fID);
+    EXPECT_EQ(2, copy1->fTrackID);  // earliest step belongs to track 2
+    EXPECT_DOUBLE_EQ(0.5, copy1->fPreTime);
+    EXPECT_DOUBLE_EQ(3.5, copy1->fPostTime);
+    EXPECT_DOUBLE_EQ(2.375, copy1->fEnergyDeposit);
+    EXPECT_DOUBLE_EQ(5.0, copy1->fFlightLength);
+
+    const TSimHit* copy2 = At(out, 1);
+    EXPECT_EQ(2, copy2->fID);
+    EXPECT_DOUBLE_EQ(4.0, copy2->fPreTime);
+    EXPECT_DOUBLE_EQ(5.5, copy2->fPostTime);
+    EXPECT_DOUBLE_EQ(3.0, copy2->fEnergyDeposit);
+}
+
+TEST(SimHitRetentionTest, PDCLayersStaySeparate) {
+    // [EN] As written by FragmentSD: detector = PDC volume, fID = PDC copy, layer U/X/V only in the module name.
+    // [CN] 与 FragmentSD 写法相同：探测器名为 PDC 体积，fID 为 PDC 拷贝号，U/X/V 层只体现在模块名中。
+    TClonesArray hits("TSimHit");
+    const Int_t pdc = 3;
+    const Int_t layers[] = {10, 11, 12};  // U, X, V
+    for (int l = 0; l < 3; ++l) {
+        for (int step = 0; step < 3; ++step) {
+            TSimHit* hit = new (hits[hits.GetEntriesFast()]) TSimHit;
+            hit->fTrackID = 1;
+            hit->fDetectorNameID = pdc;
+            hit->fModuleNameID = layers[l];
+            hit->fID = 1;
+            hit->fPreTime = 10.0 * l + step;
+            hit->fPostTime = 10.0 * l + step + 0.5;
+            hit->fEnergyDeposit = 0.1;
+        }
+    }
+
+    SimHitRetention retention;
+    TClonesArray summary("TSimHit");
+    retention.Reduce(&hits, SimHitRetention::kSummary, &summary);
+    ASSERT_EQ(3, summary.GetEntriesFast());
+    for (int l = 0; l < 3; ++l) {
+        EXPECT_EQ(layers[l], At(summary, l)->fModuleNameID);
+        EXPECT_DOUBLE_EQ(10.0 * l, At(summary, l)->fPreTime);
+        EXPECT_DOUBLE_EQ(10.0 * l + 2.5, At(summary, l)->fPostTime);
+        EXPECT_NEAR(0.3, At(summary, l)->fEnergyDeposit, 1e-12);
+    }
+
+    TClonesArray endpoints("TSimHit");
+    retention.Reduce(&hits, SimHitRetention::kEndpoints, &endpoints);
+    ASSERT_EQ(6, endpoints.GetEntriesFast());
+    for (int l = 0; l < 3; ++l) {
+        EXPECT_EQ(layers[l], At(endpoints, 2 * l)->fModuleNameID);
+        EXPECT_DOUBLE_EQ(10.0 * l, At(endpoints, 2 * l)->fPreTime);
+        EXPECT_EQ(layers[l], At(endpoints, 2 * l + 1)->fModuleNameID);
+        EXPECT_DOUBLE_EQ(10.0 * l + 2.0, At(endpoints, 2 * l + 1)->fPreTime);
+    }
+}
+
+TEST(SimHitRetentionTest, CompressionSettingsFollowTheRunParameter) {
+    using Algorithm = ROOT::RCompressionSetting::EAlgorithm;
+    TRunSimParameter prm;
+    EXPECT_EQ(-1, prm.GetCompressionSettings());
+
+    prm.fCompression = "zstd";
+    EXPECT_EQ(ROOT::CompressionSettings(Algorithm::kZSTD, 5), prm.GetCompressionSettings());
+    prm.fCompressionLevel = 3;
+    EXPECT_EQ(ROOT::CompressionSettings(Algorithm::kZSTD, 3), prm.GetCompressionSettings());
+    prm.fCompression = "lz4";
+    prm.fCompressionLevel = 0;
+    EXPECT_EQ(ROOT::CompressionSettings(Algorithm::kLZ4, 0), prm.GetCompressionSettings());
+}
+
+}  // namespace
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include "NEBULAQuenching.hh"
+#include "SimModuleAccumulator.hh"
+#include "TSimModuleData.hh"
+
+#include "TClonesArray.h"
+
+namespace {
+
+TEST(SimModuleAccumulatorTest, SumsPerModuleInIDOrder) {
+    SimModuleAccumulator acc;
+    const double a[3] = {10.0, 0.0, 0.0};
+    const double b[3] = {30.0, 0.0, 0.0};
+    const double c[3] = {0.0, 5.0, 0.0};
+    acc.Add(12, 1.0, 1.0, 5.0, a);
+    acc.Add(3, 2.0, 0.5, 7.0, c);
+    acc.Add(12, 3.0, 3.0, 4.0, b);
+    EXPECT_EQ(2, acc.GetNModules());
+
+    TClonesArray out("TSimModuleData");
+    acc.Flush(&out);
+    ASSERT_EQ(2, out.GetEntriesFast());
+    EXPECT_EQ(0, acc.GetNModules());
+
+    const TSimModuleData* low = static_cast<const TSimModuleData*>(out.At(0));
+    EXPECT_EQ(3, low->fID);
+    EXPECT_EQ(1, low->fNSteps);
+
+    const TSimModuleData* high = static_cast<const TSimModuleData*>(out.At(1));
+    EXPECT_EQ(12, high->fID);
+    EXPECT_EQ(2, high->fNSteps);
+    EXPECT_DOUBLE_EQ(4.0, high->fEnergyDeposit);
+    EXPECT_DOUBLE_EQ(4.0, high->fLight);
+    // [EN] First = earliest step, not the first one added. / [CN] First 指最早的一步，而非最先加入的一步。
+    EXPECT_DOUBLE_EQ(4.0, high->fFirstTime);
+    EXPECT_DOUBLE_EQ(30.0, high->fFirstPosition[0]);
+    EXPECT_DOUBLE_EQ((1.0 * 5.0 + 3.0 * 4.0) / 4.0, high->fLightTime);
+    EXPECT_DOUBLE_EQ(25.0, high->fLightPosition[0]);
+
+    // [EN] Slots are reset by Flush(). / [CN] Flush() 会清零各槽。
+    acc.Add(12, 1.0, 0.0, 9.0, a);
+    TClonesArray next("TSimModuleData");
+    acc.Flush(&next);
+    ASSERT_EQ(1, next.GetEntriesFast());
+    const TSimModuleData* again = static_cast<const TSimModuleData*>(next.At(0));
+    EXPECT_EQ(1, again->fNSteps);
+    EXPECT_DOUBLE_EQ(9.0, again->fLightTime);
+}
+
+TEST(SimModuleAccumulatorTest, QuenchingTableFollowsPDGCodes) {
+    // [EN] Leptons are not quenched; heavier ions give less light for the same energy.
+    // [CN] 轻子不淬灭；同样能量下越重的离子光输出越少。
+    EXPECT_DOUBLE_EQ(5.0, NEBULAQuenching::Light(10.0, 5.0, 11));
+    EXPECT_GT(NEBULAQuenching::Light(50.0, 0.0, 2212), NEBULAQuenching::Light(50.0, 0.0, 1000020040));
+    // [EN] Excited He4 and unlisted particles fall back to the C12 parameters, as in the name-based converter.
+    // [CN] 激发态 He4 与未列出的粒子退回 C12 参数，与按名字比较的 converter 一致。
+    EXPECT_EQ(NEBULAQuenching::Coefficients(1000060120), NEBULAQuenching::Coefficients(1000020041));
+    EXPECT_EQ(NEBULAQuenching::Coefficients(1000060120), NEBULAQuenching::Coefficients(211));
+    EXPECT_NE(NEBULAQuenching::Coefficients(1000060120), NEBULAQuenching::Coefficients(1000030070));
+    EXPECT_DOUBLE_EQ(0.0, NEBULAQuenching::Light(1.0, 2.0, 2212));
+}
+
+}  // namespace